@@ -0,0 +1,67 @@
+/**
+ * Tests that capped collections capped only by size delete their oldest documents in the
+ * background, staying within their soft overflow allowance, and that capped collections with a
+ * maximum number of documents still enforce it exactly on insert.
+ * @tags: [requires_wiredtiger]
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const cappedSize = 1024 * 1024;
+    const padding = "x".repeat(1000);
+
+    function fillAndCheck(backgroundDeletion) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, wiredTigerCappedDeletionInBackground: backgroundDeletion}));
+
+        const coll = testDB.capped_background_deletion;
+        coll.drop();
+        assert.commandWorked(
+            testDB.createCollection(coll.getName(), {capped: true, size: cappedSize}));
+        assert.commandWorked(coll.createIndex({a: 1}));
+
+        const numDocs = 5000;
+        for (let i = 0; i < numDocs; i += 100) {
+            let bulk = coll.initializeOrderedBulkOp();
+            for (let j = i; j < i + 100; ++j) {
+                bulk.insert({_id: j, a: j, padding: padding});
+            }
+            assert.commandWorked(bulk.execute());
+        }
+
+        // The collection converges to its maximum size once the pending deletions have run.
+        assert.soon(() => coll.stats().size <= cappedSize, () => tojson(coll.stats()));
+
+        // Only the oldest documents were deleted, and the newest one is still there.
+        const docs = coll.find().sort({$natural: 1}).toArray();
+        assert.gt(docs.length, 0);
+        assert.eq(numDocs - 1, docs[docs.length - 1]._id);
+        for (let i = 1; i < docs.length; ++i) {
+            assert.eq(docs[i - 1]._id + 1, docs[i]._id);
+        }
+
+        // The index entries of the deleted documents were removed as well.
+        assert.eq(docs.length, coll.find().hint({a: 1}).itcount());
+        const res = assert.commandWorked(coll.validate({full: true}));
+        assert(res.valid, tojson(res));
+    }
+
+    fillAndCheck(true);
+    fillAndCheck(false);
+
+    // A maximum number of documents is enforced exactly by every insert.
+    const maxDocsColl = testDB.capped_background_deletion_max;
+    maxDocsColl.drop();
+    assert.commandWorked(
+        testDB.createCollection(maxDocsColl.getName(), {capped: true, size: cappedSize, max: 10}));
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(maxDocsColl.insert({_id: i}));
+        assert.lte(maxDocsColl.find().itcount(), 10);
+    }
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,97 @@
+/**
+ * Tests that concurrent change streams read the oplog through the node's shared oplog reader, that
+ * they each see every event in order, and that resuming keeps its semantics.
+ * @tags: [requires_replication, requires_majority_read_concern, uses_change_streams]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/replsets/rslib.js");  // For startSetIfSupportsReadMajority.
+
+    const rst = new ReplSetTest({nodes: 1});
+    if (!startSetIfSupportsReadMajority(rst)) {
+        jsTestLog("Skipping test since storage engine doesn't support majority read concern.");
+        rst.stopSet();
+        return;
+    }
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    const testDB = primary.getDB("test");
+    const coll = testDB.change_stream_shared_oplog_reader;
+    assert.commandWorked(testDB.createCollection(coll.getName()));
+
+    const numStreams = 10;
+    const numDocs = 100;
+
+    function sharedOplogReaderMetrics() {
+        return testDB.serverStatus().metrics.changeStreams.sharedOplogReader;
+    }
+
+    function readInserts(stream, expectedIds) {
+        const events = [];
+        for (let id of expectedIds) {
+            assert.soon(() => stream.hasNext());
+            const event = stream.next();
+            assert.eq("insert", event.operationType, tojson(event));
+            assert.eq(id, event.documentKey._id, tojson(event));
+            events.push(event);
+        }
+        return events;
+    }
+
+    const streams = [];
+    for (let i = 0; i < numStreams; i++) {
+        // Mix collection and whole-database streams, which use different oplog filters.
+        streams.push(i % 2 === 0 ? coll.watch() : testDB.watch());
+    }
+
+    const before = sharedOplogReaderMetrics();
+    for (let i = 0; i < numDocs; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+
+    const allIds = Array.from({length: numDocs}, (value, i) => i);
+    const events = streams.map(stream => readInserts(stream, allIds));
+
+    // Every stream saw the same events, but the oplog was read far fewer times than once per
+    // stream.
+    for (let i = 1; i < numStreams; i++) {
+        assert.eq(events[0].map(event => event._id), events[i].map(event => event._id));
+    }
+    const after = sharedOplogReaderMetrics();
+    const entriesRead = (after.oplogEntriesRead - before.oplogEntriesRead) +
+        (after.privateOplogEntriesRead - before.privateOplogEntriesRead);
+    assert.lt(entriesRead, numStreams * numDocs / 2, tojson({before: before, after: after}));
+    assert.gt(after.entriesServedFromBuffer, before.entriesServedFromBuffer, tojson(after));
+
+    // Resuming after an event returns the events that followed it, whether or not the stream reads
+    // through the shared reader.
+    for (let useSharedReader of [true, false]) {
+        assert.commandWorked(primary.adminCommand(
+            {setParameter: 1, internalChangeStreamUseSharedOplogReader: useSharedReader}));
+        const resumed = coll.watch([], {resumeAfter: events[0][49]._id});
+        readInserts(resumed, allIds.slice(50));
+        resumed.close();
+    }
+    assert.commandWorked(
+        primary.adminCommand({setParameter: 1, internalChangeStreamUseSharedOplogReader: true}));
+
+    // A stream whose position has fallen out of the buffer reads the oplog privately until it
+    // reaches the buffered entries.
+    assert.commandWorked(primary.adminCommand(
+        {setParameter: 1, internalChangeStreamSharedOplogBufferSizeBytes: 1024 * 1024}));
+    const slow = coll.watch([], {resumeAfter: events[0][0]._id});
+    const bigString = "x".repeat(64 * 1024);
+    for (let i = numDocs; i < numDocs + 40; i++) {
+        assert.writeOK(coll.insert({_id: i, s: bigString}));
+    }
+    streams[0].close();
+    streams[0] = coll.watch([], {resumeAfter: events[0][numDocs - 1]._id});
+    readInserts(streams[0], Array.from({length: 40}, (value, i) => numDocs + i));
+    readInserts(slow, Array.from({length: numDocs + 39}, (value, i) => i + 1));
+
+    streams.forEach(stream => stream.close());
+    slow.close();
+    rst.stopSet();
+})();
@@ -0,0 +1,78 @@
+/**
+ * Tests that foreground index builds produce the same indexes regardless of the number of threads
+ * used to generate keys, including multikey tracking, partial filters and unique constraint
+ * violations.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: {maxIndexBuildKeyGenerationThreads: 4}});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const coll = testDB.index_build_parallel_key_generation;
+    coll.drop();
+
+    const numDocs = 20 * 1000;
+    const padding = "x".repeat(1024);
+    let bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; ++i) {
+        bulk.insert({
+            _id: i,
+            a: numDocs - i,
+            b: (i % 100 === 0) ? [i, i + 1] : i,
+            c: i % 7,
+            padding: padding
+        });
+    }
+    assert.commandWorked(bulk.execute());
+
+    function validateIndexes() {
+        const res = assert.commandWorked(coll.validate({full: true}));
+        assert(res.valid, tojson(res));
+    }
+
+    function buildWithThreads(numThreads) {
+        assert.commandWorked(
+            testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: numThreads}));
+        assert.commandWorked(coll.dropIndexes());
+
+        assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}, {c: 1, a: -1}]));
+        assert.commandWorked(
+            coll.createIndex({c: 1}, {name: "partial_c", partialFilterExpression: {c: 3}}));
+        validateIndexes();
+
+        assert.eq(numDocs, coll.find().hint({a: 1}).itcount());
+        assert.eq(numDocs + numDocs / 100, coll.find().hint({b: 1}).itcount());
+        assert.eq(numDocs, coll.find().hint({c: 1, a: -1}).itcount());
+        assert.eq(coll.find({c: 3}).hint({$natural: 1}).itcount(),
+                  coll.find({c: 3}).hint("partial_c").itcount());
+
+        // The sort order of the merged partitions must match the order of the documents.
+        let prev = null;
+        coll.find({}, {a: 1}).hint({a: 1}).forEach(doc => {
+            if (prev !== null) {
+                assert.lt(prev, doc.a);
+            }
+            prev = doc.a;
+        });
+
+        // Only the array valued field makes its index multikey.
+        const explainA = coll.find({a: 1}).hint({a: 1}).explain();
+        assert(!tojson(explainA).includes('"isMultiKey" : true'), tojson(explainA));
+        const explainB = coll.find({b: 1}).hint({b: 1}).explain();
+        assert(tojson(explainB).includes('"isMultiKey" : true'), tojson(explainB));
+
+        // Duplicate keys generated on different threads are still detected.
+        assert.commandFailedWithCode(coll.createIndex({c: 1}, {unique: true, name: "unique_c"}),
+                                     ErrorCodes.DuplicateKey);
+        assert.commandWorked(coll.createIndex({a: 1, c: 1}, {unique: true}));
+        validateIndexes();
+    }
+
+    buildWithThreads(1);
+    buildWithThreads(4);
+    buildWithThreads(16);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,84 @@
+/**
+ * Tests that a new member configured with initialSyncMethod "fileCopy" copies the data files of its
+ * sync source through a backup cursor and then catches up through steady state replication.
+ * @tags: [requires_replication, requires_wiredtiger, requires_persistence]
+ */
+(function() {
+    "use strict";
+
+    const rst = new ReplSetTest({name: "initial_sync_file_copy", nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    const primaryDB = primary.getDB("test");
+    const primaryAdmin = primary.getDB("admin");
+
+    // The commands that serve the files require backup cursor support in the storage engine.
+    const openRes = primaryAdmin.runCommand({_initialSyncOpenBackupCursor: 1});
+    if (openRes.code === ErrorCodes.CommandNotSupported) {
+        jsTestLog("Skipping test: backup cursors are not supported by this build");
+        rst.stopSet();
+        return;
+    }
+    assert.commandWorked(openRes);
+
+    // Only one node at a time can copy files, and reads are limited to the files of the backup.
+    assert.commandFailedWithCode(primaryAdmin.runCommand({_initialSyncOpenBackupCursor: 1}),
+                                 ErrorCodes.ConflictingOperationInProgress);
+    assert.commandFailedWithCode(primaryAdmin.runCommand({
+        _initialSyncReadBackupFile: 1,
+        backupId: openRes.backupId,
+        file: "../mongod.lock",
+        offset: 0,
+        length: 1
+    }),
+                                 ErrorCodes.BadValue);
+    assert.commandWorked(
+        primaryAdmin.runCommand({_initialSyncCloseBackupCursor: 1, backupId: openRes.backupId}));
+    assert.commandFailedWithCode(primaryAdmin.runCommand({
+        _initialSyncReadBackupFile: 1,
+        backupId: openRes.backupId,
+        file: openRes.files[0].filename,
+        offset: 0,
+        length: 1
+    }),
+                                 ErrorCodes.CursorNotFound);
+
+    for (let i = 0; i < 4; i++) {
+        const bulk = primaryDB["coll" + i].initializeUnorderedBulkOp();
+        for (let j = 0; j < 1000; j++) {
+            bulk.insert({_id: j, x: j, s: "s" + j});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(primaryDB["coll" + i].createIndex({x: 1}));
+    }
+
+    const secondary = rst.add({
+        setParameter: {
+            initialSyncMethod: "fileCopy",
+            fileCopyInitialSyncSource: primary.host,
+            numFileCopyInitialSyncConnections: 2,
+        }
+    });
+    rst.reInitiate();
+    rst.awaitSecondaryNodes();
+
+    // Writes after the copy reach the new member through steady state replication.
+    assert.writeOK(primaryDB.coll0.insert({_id: "after"}, {writeConcern: {w: 2}}));
+    rst.awaitReplication();
+
+    const secondaryDB = secondary.getDB("test");
+    for (let i = 0; i < 4; i++) {
+        assert.eq(primaryDB["coll" + i].getIndexes(), secondaryDB["coll" + i].getIndexes());
+    }
+    assert.eq(1001, secondaryDB.coll0.find().itcount());
+    rst.checkReplicatedDataHashes();
+
+    // The copy finished, so a restart opens the copied files as they are.
+    rst.restart(secondary);
+    rst.awaitSecondaryNodes();
+    assert.eq(1001, secondary.getDB("test").coll0.find().itcount());
+
+    rst.stopSet();
+})();
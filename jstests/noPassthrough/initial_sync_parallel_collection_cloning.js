@@ -0,0 +1,78 @@
+/**
+ * Tests that initial sync clones large collections over several _id ranges concurrently and clones
+ * several collections of a database concurrently, producing the same data as the sync source.
+ * @tags: [requires_replication]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/libs/check_log.js");
+
+    const rst = new ReplSetTest({name: "initial_sync_parallel_collection_cloning", nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    const primaryDB = primary.getDB("test");
+    const numCollections = 4;
+    const numDocs = 5000;
+
+    // The _id values span several types so that the ranges cross type boundaries.
+    for (let i = 0; i < numCollections; i++) {
+        const bulk = primaryDB["coll" + i].initializeUnorderedBulkOp();
+        for (let j = 0; j < numDocs; j++) {
+            let id = j;
+            if (j % 3 === 1) {
+                id = "s" + j;
+            } else if (j % 3 === 2) {
+                id = ObjectId();
+            }
+            bulk.insert({_id: id, x: j});
+        }
+        assert.writeOK(bulk.execute());
+    }
+    assert.commandWorked(primaryDB.createCollection("capped", {capped: true, size: 1024 * 1024}));
+    for (let j = 0; j < numDocs; j++) {
+        assert.writeOK(primaryDB.capped.insert({_id: numDocs - j, x: j}));
+    }
+
+    const secondary = rst.add({
+        setParameter: {
+            numInitialSyncAttempts: 1,
+            numInitialSyncCollectionClonersPerDatabase: 3,
+            maxNumInitialSyncCollectionClonerCursors: 4,
+            initialSyncCollectionClonerMinDocumentsPerCursor: 500,
+        }
+    });
+    assert.commandWorked(secondary.adminCommand(
+        {configureFailPoint: "initialSyncHangBeforeFinish", mode: "alwaysOn"}));
+    rst.reInitiate();
+    checkLog.contains(secondary, "initial sync - initialSyncHangBeforeFinish fail point enabled");
+
+    const res =
+        assert.commandWorked(secondary.adminCommand({replSetGetStatus: 1, initialSync: 1}));
+    const dbStats = res.initialSyncStatus.databases.test;
+    assert.eq(numCollections + 1, dbStats.clonedCollections, tojson(dbStats));
+    for (let i = 0; i < numCollections; i++) {
+        const collStats = dbStats["test.coll" + i];
+        assert.eq(numDocs, collStats.documentsCopied, tojson(collStats));
+        assert.gt(collStats.cursors, 1, tojson(collStats));
+    }
+
+    // Capped collections are always cloned with a single cursor, in their natural order.
+    assert(!dbStats["test.capped"].hasOwnProperty("cursors"), tojson(dbStats["test.capped"]));
+
+    assert.commandWorked(
+        secondary.adminCommand({configureFailPoint: "initialSyncHangBeforeFinish", mode: "off"}));
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+
+    const secondaryDB = secondary.getDB("test");
+    for (let i = 0; i < numCollections; i++) {
+        assert.eq(numDocs, secondaryDB["coll" + i].find().itcount());
+    }
+    assert.eq(primaryDB.capped.find().toArray(), secondaryDB.capped.find().toArray());
+    rst.checkReplicatedDataHashes();
+
+    rst.stopSet();
+})();
@@ -0,0 +1,117 @@
+/**
+ * Tests that secondaries which write the next batch to the oplog while applying the current one
+ * end up with the same data and oplog as the primary, with the pipelining enabled and disabled,
+ * and that a secondary which crashes with a batch written to the oplog but not yet applied
+ * truncates that batch on restart.
+ * @tags: [requires_replication, requires_persistence, requires_journaling]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/libs/check_log.js");
+
+    const rst = new ReplSetTest({
+        nodes: [{}, {rsConfig: {priority: 0}}],
+        nodeOptions: {setParameter: {replPipelineOplogWrites: true, replBatchLimitOperations: 100}}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    let secondary = rst.getSecondary();
+    const dbName = "test";
+
+    function pipelinedBatches() {
+        return secondary.getDB("admin").serverStatus().metrics.repl.apply.pipelinedBatches;
+    }
+
+    function runInsertLoad(collName) {
+        const writers = [];
+        for (let i = 0; i < 4; i++) {
+            writers.push(startParallelShell(
+                'const coll = db.getSiblingDB("' + dbName + '").' + collName + ';' +
+                    'for (let j = 0; j < 50; j++) {' +
+                    '    const docs = [];' +
+                    '    for (let k = 0; k < 100; k++) {' +
+                    '        docs.push({writer: ' + i + ', j: j, k: k});' +
+                    '    }' +
+                    '    assert.commandWorked(coll.insert(docs, {ordered: false}));' +
+                    '    assert.writeOK(coll.update({writer: ' + i + ', k: 0}, {$inc: {n: 1}},' +
+                    '                               {multi: true}));' +
+                    '}',
+                primary.port));
+        }
+        writers.forEach(join => join());
+
+        rst.awaitReplication();
+        assert.eq(4 * 50 * 100, secondary.getDB(dbName)[collName].find().itcount());
+    }
+
+    // Writes many batches' worth of operations on the primary while the secondary is not fetching,
+    // so that once it resumes the next batch is always waiting while the current one is applied.
+    function insertBacklog(collName) {
+        assert.commandWorked(
+            secondary.adminCommand({configureFailPoint: "stopReplProducer", mode: "alwaysOn"}));
+        const coll = primary.getDB(dbName)[collName];
+        for (let i = 0; i < 20; i++) {
+            const docs = [];
+            for (let k = 0; k < 100; k++) {
+                docs.push({i: i, k: k});
+            }
+            assert.commandWorked(coll.insert(docs, {writeConcern: {w: 1}}));
+        }
+        assert.commandWorked(
+            secondary.adminCommand({configureFailPoint: "stopReplProducer", mode: "off"}));
+    }
+
+    function checkOplogsMatch() {
+        const primaryOplog = primary.getDB("local").oplog.rs;
+        const secondaryOplog = secondary.getDB("local").oplog.rs;
+        assert.eq(primaryOplog.find().itcount(), secondaryOplog.find().itcount());
+        const lastPrimaryEntry = primaryOplog.find().sort({$natural: -1}).limit(1).next();
+        const lastSecondaryEntry = secondaryOplog.find().sort({$natural: -1}).limit(1).next();
+        assert.eq(lastPrimaryEntry.ts, lastSecondaryEntry.ts);
+    }
+
+    runInsertLoad("pipelined");
+    checkOplogsMatch();
+
+    // A backlog of batches is applied with the oplog writes of each batch overlapping the apply of
+    // the one before it.
+    let pipelinedBefore = pipelinedBatches();
+    insertBacklog("backlog");
+    rst.awaitReplication();
+    assert.eq(20 * 100, secondary.getDB(dbName).backlog.find().itcount());
+    assert.gt(pipelinedBatches(), pipelinedBefore);
+    checkOplogsMatch();
+
+    // Crash the secondary after a batch was written to the oplog while the previous one was being
+    // applied, but before the batch itself was applied. On restart the unapplied entries are
+    // truncated from the oplog and fetched again.
+    assert.commandWorked(secondary.adminCommand(
+        {configureFailPoint: "hangBeforeApplyingPipelinedBatch", mode: "alwaysOn"}));
+    insertBacklog("crash");
+    checkLog.contains(secondary, "hangBeforeApplyingPipelinedBatch fail point enabled");
+
+    // Make the pipelined oplog writes and the truncate-after point durable before crashing.
+    assert.commandWorked(secondary.adminCommand({fsync: 1}));
+    rst.stop(secondary, 9, {allowedExitCode: MongoRunner.EXIT_SIGKILL});
+    secondary = rst.start(secondary, {}, true /* restart */);
+    checkLog.contains(secondary, "Removing unapplied entries starting at");
+
+    rst.awaitSecondaryNodes();
+    rst.awaitReplication();
+    assert.eq(20 * 100, secondary.getDB(dbName).crash.find().itcount());
+    checkOplogsMatch();
+
+    assert.commandWorked(
+        secondary.adminCommand({setParameter: 1, replPipelineOplogWrites: false}));
+    pipelinedBefore = pipelinedBatches();
+    runInsertLoad("not_pipelined");
+    insertBacklog("not_pipelined_backlog");
+    rst.awaitReplication();
+    assert.eq(pipelinedBefore, pipelinedBatches());
+    checkOplogsMatch();
+
+    rst.stopSet();
+})();
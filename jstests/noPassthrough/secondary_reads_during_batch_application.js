@@ -0,0 +1,72 @@
+/**
+ * Tests that reads on a secondary are not blocked by batch application and only observe the state
+ * at the end of a batch, even while many batches are being applied concurrently with the readers.
+ * @tags: [requires_replication, requires_wiredtiger]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/replsets/libs/secondary_reads_test.js");
+
+    const name = "secondary_reads_during_batch_application";
+    const collName = "accounts";
+    const secondaryReadsTest = new SecondaryReadsTest(name);
+    const replSet = secondaryReadsTest.getReplset();
+
+    const primaryDB = secondaryReadsTest.getPrimaryDB();
+    const secondaryDB = secondaryReadsTest.getSecondaryDB();
+
+    if (!primaryDB.serverStatus().storageEngine.supportsSnapshotReadConcern) {
+        secondaryReadsTest.stop();
+        return;
+    }
+
+    const primaryColl = primaryDB.getCollection(collName);
+    const secondaryColl = secondaryDB.getCollection(collName);
+    assert.commandWorked(primaryColl.insert([{_id: "a", balance: 0}, {_id: "b", balance: 0}]));
+    replSet.awaitLastOpCommitted();
+
+    // Each transfer is a single atomic applyOps entry, so it is applied as part of one batch. A
+    // reader at the last applied timestamp must never observe one half of a transfer.
+    secondaryReadsTest.startSecondaryReaders(4, function() {
+        const docs = db.getCollection("accounts").find().toArray();
+        assert.eq(2, docs.length, tojson(docs));
+        assert.eq(0, docs[0].balance + docs[1].balance, tojson(docs));
+    });
+
+    function transfer(amount) {
+        const ns = primaryColl.getFullName();
+        assert.commandWorked(primaryDB.adminCommand({
+            applyOps: [
+                {op: "u", ns: ns, o2: {_id: "a"}, o: {$inc: {balance: amount}}},
+                {op: "u", ns: ns, o2: {_id: "b"}, o: {$inc: {balance: -amount}}}
+            ]
+        }));
+    }
+
+    for (let i = 1; i <= 500; i++) {
+        transfer(i);
+    }
+    replSet.awaitLastOpCommitted();
+
+    // While a batch is paused before completion, with the ParallelBatchWriterMode lock held, reads
+    // complete promptly and see the state as of the previous batch.
+    const expected = secondaryColl.find().sort({_id: 1}).toArray();
+    const pauseAwait = secondaryReadsTest.pauseSecondaryBatchApplication();
+    transfer(1000);
+    pauseAwait();
+
+    assert.eq(expected,
+              secondaryColl.find().sort({_id: 1}).maxTimeMS(10 * 1000).toArray(),
+              "read during batch application did not return the last applied state");
+    assert.eq(expected.length,
+              secondaryColl.find().readConcern("local").maxTimeMS(10 * 1000).itcount());
+
+    secondaryReadsTest.resumeSecondaryBatchApplication();
+    replSet.awaitLastOpCommitted();
+
+    assert.eq(primaryColl.find().sort({_id: 1}).toArray(),
+              secondaryColl.find().sort({_id: 1}).toArray());
+
+    secondaryReadsTest.stop();
+})();
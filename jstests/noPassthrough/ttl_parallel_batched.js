@@ -0,0 +1,73 @@
+/**
+ * Tests that the TTL monitor deletes expired documents from many collections concurrently, in
+ * batches, and reports per-collection statistics in the "ttl" serverStatus section.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({
+        setParameter: {ttlMonitorSleepSecs: 1, ttlMonitorWorkerThreads: 4, ttlMonitorBatchSize: 50}
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const numCollections = 10;
+    const numExpired = 500;
+    const numLive = 20;
+
+    const past = new Date(0);
+    const future = new Date(Date.now() + 24 * 60 * 60 * 1000);
+    for (let i = 0; i < numCollections; ++i) {
+        const coll = testDB["ttl_parallel_batched_" + i];
+        coll.drop();
+        assert.commandWorked(coll.createIndex({expireAt: 1}, {expireAfterSeconds: 0}));
+
+        let bulk = coll.initializeUnorderedBulkOp();
+        for (let j = 0; j < numExpired; ++j) {
+            bulk.insert({expireAt: past});
+        }
+        for (let j = 0; j < numLive; ++j) {
+            bulk.insert({expireAt: future});
+        }
+        assert.commandWorked(bulk.execute());
+    }
+
+    assert.soon(function() {
+        for (let i = 0; i < numCollections; ++i) {
+            if (testDB["ttl_parallel_batched_" + i].count() !== numLive) {
+                return false;
+            }
+        }
+        return true;
+    }, "TTL monitor didn't delete the expired documents before timing out.");
+
+    // The section is only reported when requested.
+    assert(!testDB.serverStatus().hasOwnProperty("ttl"));
+
+    assert.soon(function() {
+        const ttl = testDB.serverStatus({ttl: 1}).ttl;
+        for (let i = 0; i < numCollections; ++i) {
+            const stats = ttl.collections["test.ttl_parallel_batched_" + i];
+            if (!stats || stats.deletedDocuments !== numExpired || stats.backlog) {
+                return false;
+            }
+        }
+        return ttl.collectionsWithBacklog === 0;
+    }, () => "unexpected ttl statistics: " + tojson(testDB.serverStatus({ttl: 1}).ttl));
+
+    const ttl = testDB.serverStatus({ttl: 1}).ttl;
+    assert.gte(ttl.deletedDocuments, numCollections * numExpired, tojson(ttl));
+    assert.eq(ttl.deletedDocuments, testDB.serverStatus().metrics.ttl.deletedDocuments);
+
+    // Dropping a collection removes its statistics on the next pass.
+    assert(testDB.ttl_parallel_batched_0.drop());
+    assert.soon(function() {
+        return !testDB.serverStatus({ttl: 1})
+                    .ttl.collections.hasOwnProperty("test.ttl_parallel_batched_0");
+    });
+
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, ttlMonitorBatchSize: 0}));
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, ttlMonitorWorkerThreads: 8}));
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,73 @@
+/**
+ * Tests that enabling WiredTiger admission control keeps the number of tickets within the
+ * configured bounds under load, and that disabling it restores the configured ticket counts.
+ * @tags: [requires_wiredtiger]
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({
+        setParameter: {
+            wiredTigerConcurrentReadTransactions: 64,
+            wiredTigerConcurrentWriteTransactions: 64,
+            wiredTigerAdmissionControlMinTickets: 8,
+            wiredTigerAdmissionControlIntervalMillis: 100,
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const testDB = conn.getDB("test");
+    const coll = testDB.wt_admission_control;
+
+    function concurrentTransactions() {
+        return testDB.serverStatus().wiredTiger.concurrentTransactions;
+    }
+
+    let stats = concurrentTransactions();
+    assert.eq(64, stats.read.totalTickets, tojson(stats));
+    assert.eq(64, stats.write.totalTickets, tojson(stats));
+    assert.eq(0, stats.write.queued, tojson(stats));
+
+    assert.commandFailed(
+        testDB.adminCommand({setParameter: 1, wiredTigerAdmissionControlMinTickets: 4}));
+    assert.commandFailed(
+        testDB.adminCommand({setParameter: 1, wiredTigerAdmissionControlIntervalMillis: 0}));
+
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, wiredTigerAdmissionControl: true}));
+
+    // Lowering the maximum applies while the controller is running.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, wiredTigerConcurrentWriteTransactions: 32}));
+
+    // Generate enough concurrent writes to queue for tickets.
+    const writers = [];
+    for (let i = 0; i < 8; i++) {
+        writers.push(startParallelShell(
+            'for (let j = 0; j < 2000; j++) {' +
+                '    assert.writeOK(db.getSiblingDB("test").wt_admission_control.insert({x: j}));' +
+                '}',
+            conn.port));
+    }
+
+    for (let i = 0; i < 20; i++) {
+        stats = concurrentTransactions();
+        assert.gte(stats.write.totalTickets, 8, tojson(stats));
+        assert.lte(stats.write.totalTickets, 32, tojson(stats));
+        sleep(50);
+    }
+    writers.forEach(join => join());
+    assert.eq(8 * 2000, coll.find().itcount());
+
+    // The setting reports the configured maximum, not the current number of tickets.
+    const res = assert.commandWorked(
+        testDB.adminCommand({getParameter: 1, wiredTigerConcurrentWriteTransactions: 1}));
+    assert.eq(32, res.wiredTigerConcurrentWriteTransactions);
+
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, wiredTigerAdmissionControl: false}));
+    assert.soon(() => concurrentTransactions().write.totalTickets === 32,
+                () => tojson(concurrentTransactions()));
+    assert.soon(() => concurrentTransactions().read.totalTickets === 64,
+                () => tojson(concurrentTransactions()));
+
+    MongoRunner.stopMongod(conn);
+})();
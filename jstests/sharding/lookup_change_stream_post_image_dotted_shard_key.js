@@ -0,0 +1,61 @@
+// Tests looking up the post images of updates to a collection sharded on a field of an embedded
+// document. A change stream opened directly on the shard looks up the post images of consecutive
+// updates together, and must match each looked up document to its dotted document key.
+// @tags: [uses_change_streams]
+(function() {
+    "use strict";
+
+    // For supportsMajorityReadConcern().
+    load("jstests/multiVersion/libs/causal_consistency_helpers.js");
+
+    if (!supportsMajorityReadConcern()) {
+        jsTestLog("Skipping test since storage engine doesn't support majority read concern.");
+        return;
+    }
+
+    const st = new ShardingTest({
+        shards: 1,
+        rs: {
+            nodes: 1,
+            enableMajorityReadConcern: '',
+            // Use a higher frequency for periodic noops to speed up the test.
+            setParameter: {writePeriodicNoops: true, periodicNoopIntervalSecs: 1}
+        }
+    });
+
+    const mongosDB = st.s0.getDB(jsTestName());
+    const mongosColl = mongosDB['coll'];
+
+    assert.commandWorked(mongosDB.dropDatabase());
+    assert.commandWorked(mongosDB.adminCommand({enableSharding: mongosDB.getName()}));
+    assert.commandWorked(
+        mongosDB.adminCommand({shardCollection: mongosColl.getFullName(), key: {"a.b": 1}}));
+
+    const nDocs = 6;
+    for (let id = 0; id < nDocs; ++id) {
+        assert.writeOK(mongosColl.insert({_id: id, a: {b: id}}));
+    }
+
+    const shardColl = st.rs0.getPrimary().getDB(mongosDB.getName())[mongosColl.getName()];
+    const changeStreamOnShard = shardColl.watch([], {fullDocument: "updateLookup"});
+    const changeStreamOnMongos = mongosColl.watch([], {fullDocument: "updateLookup"});
+
+    // Make all of the updates before reading any of them, so that the shard looks up their post
+    // images together.
+    for (let id = 0; id < nDocs; ++id) {
+        assert.writeOK(mongosColl.update({_id: id, "a.b": id}, {$set: {updated: true}}));
+    }
+
+    [changeStreamOnShard, changeStreamOnMongos].forEach(function(changeStream) {
+        for (let id = 0; id < nDocs; ++id) {
+            assert.soon(() => changeStream.hasNext());
+            const next = changeStream.next();
+            assert.eq(next.operationType, "update", tojson(next));
+            assert.eq(next.documentKey, {"a.b": id, _id: id}, tojson(next));
+            assert.docEq(next.fullDocument, {_id: id, a: {b: id}, updated: true}, tojson(next));
+        }
+        changeStream.close();
+    });
+
+    st.stop();
+})();
@@ -165,7 +165,7 @@ TEST_F(DBClientCursorTest, DBClientCursorHandlesOpMsgExhaustCorrectly) {
     auto m = conn.getLastSentMessage();
     ASSERT(!m.empty());
     auto msg = OpMsg::parse(m);
-    ASSERT_EQ(OpMsg::flags(m), 0U);
+    ASSERT_EQ(OpMsg::flags(m), uint32_t(OpMsg::kExhaustSupported));
     ASSERT_EQ(msg.body.getStringField("find"), nss.coll());
     ASSERT_EQ(msg.body["batchSize"].number(), 0);
 
@@ -209,6 +209,38 @@ TEST_F(DBClientCursorTest, DBClientCursorHandlesOpMsgExhaustCorrectly) {
     ASSERT(cursor.isDead());
 }
 
+TEST_F(DBClientCursorTest, DBClientCursorReceivesExhaustStreamStartedByFind) {
+
+    // Set up the DBClientCursor and a mock client connection.
+    DBClientConnectionForTest conn;
+    const NamespaceString nss("test", "coll");
+    DBClientCursor cursor(
+        &conn, NamespaceStringOrUUID(nss), Query().obj, 0, 0, nullptr, QueryOption_Exhaust, 0);
+    cursor.setBatchSize(1);
+
+    // Set up a mock 'find' response with the 'moreToCome' flag set, which indicates that the
+    // server will stream the following batches without waiting for 'getMore' requests.
+    const long long cursorId = 42;
+    Message findResponseMsg = mockFindResponse(nss, cursorId, {docObj(1)});
+    OpMsg::setFlag(&findResponseMsg, OpMsg::kMoreToCome);
+
+    conn.setCallResponse(findResponseMsg);
+    ASSERT(cursor.init());
+
+    auto m = conn.getLastSentMessage();
+    ASSERT(!m.empty());
+    ASSERT(OpMsg::isFlagSet(m, OpMsg::kExhaustSupported));
+    ASSERT_BSONOBJ_EQ(docObj(1), cursor.next());
+
+    // The next batch is received without sending a 'getMore'.
+    conn.setRecvResponse(mockGetMoreResponse(nss, 0, {docObj(2)}));
+    conn.clearLastSentMessage();
+    ASSERT(cursor.more());
+    ASSERT(conn.getLastSentMessage().empty());
+    ASSERT_BSONOBJ_EQ(docObj(2), cursor.next());
+    ASSERT(cursor.isDead());
+}
+
 TEST_F(DBClientCursorTest, DBClientCursorResendsGetMoreIfMoreToComeFlagIsOmittedInExhaustMessage) {
 
     // Set up the DBClientCursor and a mock client connection.
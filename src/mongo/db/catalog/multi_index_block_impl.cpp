@@ -52,6 +52,7 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -64,6 +65,20 @@ namespace mongo {
 
 MONGO_EXPORT_SERVER_PARAMETER(useReadOnceCursorsForIndexBuilds, bool, true);
 
+/**
+ * Number of threads that generate and sort index keys while a foreground index build scans the
+ * collection. A value of 1 generates keys on the thread performing the scan.
+ */
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildKeyGenerationThreads, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "maxIndexBuildKeyGenerationThreads must be between 1 and 64");
+        }
+
+        return Status::OK();
+    });
+
 using std::unique_ptr;
 using std::string;
 using std::endl;
@@ -133,12 +148,188 @@ private:
     MultiIndexBlockImpl* const _indexer;
 };
 
+/**
+ * Generates keys for documents scanned by a foreground index build on a pool of worker threads.
+ *
+ * The scanning thread accumulates owned copies of documents into batches. Each batch is handed to
+ * a worker together with a bulk builder partition that no other in-flight batch is using, so that
+ * every partition's Sorter is only ever touched by one thread at a time. Since there are exactly as
+ * many partitions as workers, the scan blocks once every worker is busy, which bounds the memory
+ * held by pending batches.
+ */
+class MultiIndexBlockImpl::ParallelKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelKeyGenerator);
+
+public:
+    ParallelKeyGenerator(OperationContext* opCtx,
+                         bool allowInterruption,
+                         std::vector<IndexToBuild>* indexes,
+                         size_t numThreads)
+        : _opCtx(opCtx),
+          _allowInterruption(allowInterruption),
+          _indexes(indexes),
+          _numPartitions(numThreads),
+          _pool(_makePoolOptions(numThreads)) {
+        for (size_t partition = 0; partition < _numPartitions; ++partition) {
+            _freePartitions.push_back(partition);
+        }
+        _pool.startup();
+    }
+
+    ~ParallelKeyGenerator() {
+        // The bulk builders outlive this object, so all in-flight batches must be drained before
+        // returning.
+        _pool.shutdown();
+        _pool.join();
+    }
+
+    /**
+     * Queues 'doc' for key generation. Returns the first error encountered by any worker.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _batch.emplace_back(doc.getOwned(), loc);
+        _batchBytes += doc.objsize();
+        if (_batch.size() < kMaxBatchDocuments && _batchBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _flush();
+    }
+
+    /**
+     * Generates keys for any remaining documents and waits for all workers to finish. Returns early
+     * if the operation is interrupted while waiting and the build allows interruption.
+     */
+    Status finish() {
+        Status status = _flush();
+        if (!status.isOK()) {
+            return status;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        status = _waitForPartitions_inlock(
+            lk, [&] { return _freePartitions.size() == _numPartitions; });
+        if (!status.isOK()) {
+            return status;
+        }
+        return _status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static const size_t kMaxBatchDocuments = 1000;
+    static const size_t kMaxBatchBytes = 4 * 1024 * 1024;
+
+    static ThreadPool::Options _makePoolOptions(size_t numThreads) {
+        ThreadPool::Options options;
+        options.poolName = "IndexBuildKeyGenerationPool";
+        options.threadNamePrefix = "IndexBuildKeyGen-";
+        options.minThreads = options.maxThreads = numThreads;
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+        };
+        return options;
+    }
+
+    template <typename Pred>
+    Status _waitForPartitions_inlock(stdx::unique_lock<stdx::mutex>& lk, Pred pred) {
+        if (!_allowInterruption) {
+            _partitionAvailable.wait(lk, pred);
+            return Status::OK();
+        }
+        return _opCtx->waitForConditionOrInterruptNoAssert(_partitionAvailable, lk, pred);
+    }
+
+    Status _flush() {
+        if (_batch.empty()) {
+            return Status::OK();
+        }
+
+        size_t partition;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            Status status = _waitForPartitions_inlock(
+                lk, [&] { return !_freePartitions.empty() || !_status.isOK(); });
+            if (!status.isOK()) {
+                return status;
+            }
+            if (!_status.isOK()) {
+                return _status;
+            }
+            partition = _freePartitions.back();
+            _freePartitions.pop_back();
+        }
+
+        auto batch = std::make_shared<Batch>(std::move(_batch));
+        _batch.clear();
+        _batchBytes = 0;
+
+        Status status = _pool.schedule([this, batch, partition] {
+            Status status = Status::OK();
+            try {
+                _generateKeys(*batch, partition);
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!status.isOK() && _status.isOK()) {
+                _status = status;
+            }
+            _freePartitions.push_back(partition);
+            _partitionAvailable.notify_all();
+        });
+
+        if (!status.isOK()) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _freePartitions.push_back(partition);
+        }
+        return status;
+    }
+
+    void _generateKeys(const Batch& batch, size_t partition) {
+        for (const auto& docAndLoc : batch) {
+            for (auto& index : *_indexes) {
+                if (index.filterExpression &&
+                    !index.filterExpression->matchesBSON(docAndLoc.first)) {
+                    continue;
+                }
+                uassertStatusOK(index.bulk->insertIntoPartition(
+                    docAndLoc.first, docAndLoc.second, index.options, partition));
+            }
+        }
+    }
+
+    OperationContext* const _opCtx;
+    const bool _allowInterruption;
+    std::vector<IndexToBuild>* const _indexes;
+    const size_t _numPartitions;
+
+    // Documents accumulated by the scanning thread but not yet handed to a worker.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    // Guards '_freePartitions' and '_status'.
+    stdx::mutex _mutex;
+    stdx::condition_variable _partitionAvailable;
+
+    // Bulk builder partitions not in use by any in-flight batch.
+    std::vector<size_t> _freePartitions;
+
+    // The first error returned by a worker.
+    Status _status = Status::OK();
+
+    // Declared last so that it is destroyed before the state the workers reference.
+    ThreadPool _pool;
+};
+
 MultiIndexBlockImpl::MultiIndexBlockImpl(OperationContext* opCtx, Collection* collection)
     : _collection(collection),
       _opCtx(opCtx),
       _buildInBackground(false),
       _allowInterruption(false),
       _ignoreUnique(false),
+      _eachIndexBuildMaxMemoryUsageBytes(0),
       _needToCleanup(true) {}
 
 MultiIndexBlockImpl::~MultiIndexBlockImpl() {
@@ -232,9 +423,9 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
 
     std::vector<BSONObj> indexInfoObjs;
     indexInfoObjs.reserve(indexSpecs.size());
-    std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
+    _eachIndexBuildMaxMemoryUsageBytes = 0;
     if (!indexSpecs.empty()) {
-        eachIndexBuildMaxMemoryUsageBytes =
+        _eachIndexBuildMaxMemoryUsageBytes =
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
             indexSpecs.size();
     }
@@ -263,7 +454,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
         if (!_buildInBackground) {
             // Bulk build process requires foreground building as it assumes nothing is changing
             // under it.
-            index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+            index.bulk = index.real->initiateBulk(_eachIndexBuildMaxMemoryUsageBytes);
         }
 
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -278,7 +469,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlockImpl::init(const std::vector<BSO
         log() << "build index on: " << ns << " properties: " << descriptor->toString();
         if (index.bulk)
             log() << "\t building index using bulk method; build may temporarily use up to "
-                  << eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
+                  << _eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
 
         index.filterExpression = index.block->getEntry()->getFilterExpression();
 
@@ -369,6 +560,21 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection() {
     bool readOnce = !_buildInBackground && useReadOnceCursorsForIndexBuilds.load();
     _opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    // Foreground builds feed bulk builders only, which generate keys without touching the storage
+    // engine, so key generation and sorting can be moved off of the scanning thread. Nothing has
+    // been inserted yet, so the bulk builders can be replaced with partitioned ones.
+    std::unique_ptr<ParallelKeyGenerator> keyGenerator;
+    const auto numKeyGenerationThreads =
+        static_cast<size_t>(maxIndexBuildKeyGenerationThreads.load());
+    if (!_buildInBackground && numKeyGenerationThreads > 1) {
+        for (auto& index : _indexes) {
+            index.bulk = index.real->initiateBulk(_eachIndexBuildMaxMemoryUsageBytes,
+                                                  numKeyGenerationThreads);
+        }
+        keyGenerator = stdx::make_unique<ParallelKeyGenerator>(
+            _opCtx, _allowInterruption, &_indexes, numKeyGenerationThreads);
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -402,7 +608,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection() {
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
             WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = keyGenerator ? keyGenerator->add(objToIndex.value(), loc)
+                                      : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (!ret.isOK()) {
@@ -467,6 +674,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection() {
         }
     }
 
+    if (keyGenerator) {
+        Status ret = keyGenerator->finish();
+        if (!ret.isOK())
+            return ret;
+        keyGenerator.reset();
+    }
+
     progress->finished();
 
     Status ret = doneInserting();
@@ -201,6 +201,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelKeyGenerator;
 
     struct IndexToBuild {
         std::unique_ptr<IndexCatalog::IndexBuildBlockInterface> block;
@@ -226,6 +227,9 @@ private:
     bool _allowInterruption;
     bool _ignoreUnique;
 
+    // Memory budget of each index's bulk builder, computed in init().
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes;
+
     bool _needToCleanup;
 };
 
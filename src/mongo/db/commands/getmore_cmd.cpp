@@ -422,7 +422,9 @@ public:
 
             CursorId respondWithId = 0;
 
-            CursorResponseBuilder nextBatch(reply, CursorResponseBuilder::Options());
+            CursorResponseBuilder::Options options;
+            options.useDocumentSequences = reply->documentSequencesSupported();
+            CursorResponseBuilder nextBatch(reply, options);
             BSONObj obj;
             PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
             std::uint64_t numResults = 0;
@@ -129,6 +129,34 @@ BENCHMARK_DEFINE_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)(benchmark
     }
 }
 
+/**
+ * Acquires the global, database and collection locks in 'mode' through a new locker on every
+ * iteration, as each operation does.
+ */
+void runIntentLockPerOperation(benchmark::State& state, LockMode mode) {
+    const ResourceId resIdDb(RESOURCE_DATABASE, StringData("test"));
+    const ResourceId resIdColl(RESOURCE_COLLECTION, StringData("test.coll"));
+
+    for (auto keepRunning : state) {
+        LockerImpl locker;
+        locker.lockGlobal(mode);
+        locker.lock(resIdDb, mode);
+        locker.lock(resIdColl, mode);
+        locker.unlock(resIdColl);
+        locker.unlock(resIdDb);
+        locker.unlockGlobal();
+    }
+}
+
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_IntentSharedLockPerOperation)(benchmark::State& state) {
+    runIntentLockPerOperation(state, MODE_IS);
+}
+
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_IntentExclusiveLockPerOperation)
+(benchmark::State& state) {
+    runIntentLockPerOperation(state, MODE_IX);
+}
+
 BENCHMARK_DEFINE_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)(benchmark::State& state) {
     std::unique_ptr<ForceSupportsDocLocking> supportDocLocking;
 
@@ -177,6 +205,11 @@ BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentSharedLock)
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_CollectionIntentExclusiveLock)
     ->ThreadRange(1, kMaxPerfThreads);
 
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_IntentSharedLockPerOperation)
+    ->ThreadRange(1, kMaxPerfThreads);
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_IntentExclusiveLockPerOperation)
+    ->ThreadRange(1, kMaxPerfThreads);
+
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)
     ->ThreadRange(1, kMaxPerfThreads);
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionExclusiveLock)
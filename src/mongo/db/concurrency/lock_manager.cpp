@@ -44,6 +44,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/cpu_hint.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
 #include "mongo/util/timer.h"
@@ -416,10 +417,7 @@ const unsigned LockManager::_numLockBuckets(128);
 // The exact value doesn't appear very important, but should be power of two
 const unsigned LockManager::_numPartitions = 32;
 
-LockManager::LockManager() {
-    _lockBuckets = new LockBucket[_numLockBuckets];
-    _partitions = new Partition[_numPartitions];
-}
+LockManager::LockManager() : _lockBuckets(_numLockBuckets), _partitions(_numPartitions) {}
 
 LockManager::~LockManager() {
     cleanupUnusedLocks();
@@ -428,9 +426,6 @@ LockManager::~LockManager() {
         // TODO: dump more information about the non-empty bucket to see what locks were leaked
         invariant(_lockBuckets[i].data.empty());
     }
-
-    delete[] _lockBuckets;
-    delete[] _partitions;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -441,6 +436,13 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
     request->mode = mode;
 
+    // Intent locks taken on the same CPU share a partition, which keeps the partition's mutex
+    // and map in that CPU's cache. The choice is recorded so that unlock uses the same partition
+    // even if the thread has migrated in the meantime.
+    if (request->partitioned) {
+        request->partitionId = currentCPUHint() % _numPartitions;
+    }
+
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
@@ -812,7 +814,7 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
 }
 
 LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions];
+    return &_partitions[request->partitionId];
 }
 
 void LockManager::dump() const {
@@ -1176,6 +1178,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    partitionId = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
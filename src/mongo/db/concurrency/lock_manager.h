@@ -35,6 +35,8 @@
 #include <map>
 #include <vector>
 
+#include <boost/align/aligned_allocator.hpp>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
@@ -45,6 +47,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -149,7 +152,7 @@ private:
         LockHead* findOrInsert(ResourceId resId);
     };
 
-    // Each locker maps to a partition that is used for resources acquired in intent modes
+    // Each CPU maps to a partition that is used for resources acquired in intent modes
     // modes and potentially other modes that don't conflict with themselves. This avoids
     // contention on the regular LockHead in the lock manager.
     struct Partition {
@@ -168,7 +171,8 @@ private:
 
 
     /**
-     * Retrieves the Partition that a particular LockRequest should use for intent locking.
+     * Retrieves the Partition that a particular LockRequest uses for intent locking. The
+     * partition is chosen by LockManager::lock from the CPU on which the request is made.
      */
     Partition* _getPartition(LockRequest* request) const;
 
@@ -213,11 +217,17 @@ private:
      */
     void _cleanupUnusedLocksInBucket(LockBucket* bucket);
 
+    // Buckets and partitions are each padded to a cache line, so that threads working on
+    // neighbouring entries do not invalidate each other's caches.
+    template <typename T>
+    using CacheAlignedArray =
+        std::vector<CacheAligned<T>, boost::alignment::aligned_allocator<CacheAligned<T>>>;
+
     static const unsigned _numLockBuckets;
-    LockBucket* _lockBuckets;
+    mutable CacheAlignedArray<LockBucket> _lockBuckets;
 
     static const unsigned _numPartitions;
-    Partition* _partitions;
+    mutable CacheAlignedArray<Partition> _partitions;
 };
 
 
@@ -376,6 +376,15 @@ struct LockRequest {
     // No synchronization
     bool partitioned;
 
+    // Index of the LockManager partition used by this request if it is partitioned. Chosen from
+    // the CPU of the locking thread, so that concurrent intent locks taken on different CPUs do
+    // not share a partition.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    unsigned partitionId;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
@@ -30,6 +30,7 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -318,6 +319,50 @@ TEST(LockManager, Conflict) {
     ASSERT(request2.numNotifies == 1);
 }
 
+TEST(LockManager, IntentLocksFromManyThreadsBlockConflictingRequest) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    // Intent requests made on different threads, and thus potentially on different CPUs, end up
+    // in different partitions and must all be migrated once a conflicting request arrives.
+    const int kNumThreads = 8;
+    std::vector<std::unique_ptr<LockerImpl>> lockers;
+    std::vector<std::unique_ptr<LockRequestCombo>> requests;
+    for (int i = 0; i < kNumThreads; i++) {
+        lockers.push_back(std::make_unique<LockerImpl>());
+        requests.push_back(std::make_unique<LockRequestCombo>(lockers.back().get()));
+    }
+
+    // Assertions can only be made on the main thread, so collect the results of the threads.
+    std::vector<LockResult> results(kNumThreads, LOCK_INVALID);
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&, i] {
+            results[i] = lockMgr.lock(resId, requests[i].get(), (i % 2) ? MODE_IX : MODE_IS);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < kNumThreads; i++) {
+        ASSERT(LOCK_OK == results[i]);
+    }
+
+    LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+    // Releasing on a thread other than the acquiring one must find each request's partition.
+    for (int i = 0; i < kNumThreads; i++) {
+        ASSERT(requestX.numNotifies == 0);
+        lockMgr.unlock(requests[i].get());
+    }
+
+    ASSERT(requestX.numNotifies == 1);
+    ASSERT(requestX.lastResult == LOCK_OK);
+    lockMgr.unlock(&requestX);
+}
+
 TEST(LockManager, MultipleConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
@@ -330,8 +330,8 @@ LockResult LockerImpl::_acquireTicket(OperationContext* opCtx, LockMode mode, Da
 
         OperationContext* interruptible = _uninterruptibleLocksRequested ? nullptr : opCtx;
         if (deadline == Date_t::max()) {
-            holder->waitForTicket(interruptible);
-        } else if (!holder->waitForTicketUntil(interruptible, deadline)) {
+            holder->waitForTicket(interruptible, getAdmissionPriority());
+        } else if (!holder->waitForTicketUntil(interruptible, deadline, getAdmissionPriority())) {
             return LOCK_TIMEOUT;
         }
         restoreStateOnErrorGuard.Dismiss();
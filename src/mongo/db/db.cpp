@@ -99,6 +99,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -333,6 +334,14 @@ ExitCode _initAndListen(int listenPort) {
         }
         serviceContext->setTransportLayer(std::move(tl));
     }
+
+    if (replSettings.usingReplSets() && repl::isFileCopyInitialSyncEnabled()) {
+        auto status = repl::runFileCopyInitialSync();
+        if (!status.isOK()) {
+            error() << "File copy initial sync failed: " << redact(status);
+            return EXIT_REPLICATION_ERROR;
+        }
+    }
     initializeStorageEngine(serviceContext, StorageEngineInitFlags::kNone);
 
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
@@ -40,6 +40,8 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/snapshot_manager.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/util/log.h"
 
@@ -134,9 +136,11 @@ AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* opCtx,
 
         // This timestamp could be earlier than the timestamp seen when the transaction is opened
         // because it is set asynchonously. This is not problematic because holding the collection
-        // lock guarantees no metadata changes will occur in that time.
+        // lock guarantees no metadata changes will occur in that time. It is read from the
+        // snapshot manager, which the transaction is opened on, rather than the replication
+        // coordinator so that secondary reads do not contend on its mutex with batch application.
         auto lastAppliedTimestamp = readAtLastAppliedTimestamp
-            ? boost::optional<Timestamp>(replCoord->getMyLastAppliedOpTime().getTimestamp())
+            ? boost::optional<Timestamp>(_getLastAppliedTimestamp(opCtx))
             : boost::none;
 
         auto minSnapshot = coll->getMinimumVisibleSnapshot();
@@ -220,6 +224,14 @@ bool AutoGetCollectionForRead::_shouldReadAtLastAppliedTimestamp(
     return true;
 }
 
+Timestamp AutoGetCollectionForRead::_getLastAppliedTimestamp(OperationContext* opCtx) const {
+    auto snapshotManager = opCtx->getServiceContext()->getStorageEngine()->getSnapshotManager();
+    if (snapshotManager) {
+        return snapshotManager->getLocalSnapshot().value_or(Timestamp());
+    }
+    return repl::ReplicationCoordinator::get(opCtx)->getMyLastAppliedOpTime().getTimestamp();
+}
+
 bool AutoGetCollectionForRead::_conflictingCatalogChanges(
     OperationContext* opCtx,
     boost::optional<Timestamp> minSnapshot,
@@ -124,6 +124,10 @@ private:
                                            const NamespaceString& nss,
                                            repl::ReadConcernLevel readConcernLevel) const;
 
+    // Returns the last applied timestamp that reads at ReadSource::kLastApplied are opened on, or a
+    // null timestamp if there is none yet.
+    Timestamp _getLastAppliedTimestamp(OperationContext* opCtx) const;
+
     // Returns true if the minSnapshot causes conflicting catalog changes for either the provided
     // lastAppliedTimestamp or the point-in-time snapshot of the RecoveryUnit on 'opCtx'.
     bool _conflictingCatalogChanges(OperationContext* opCtx,
@@ -32,6 +32,8 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "mongo/base/static_assert.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/client/constants.h"
@@ -448,6 +450,10 @@ Message makeGetMoreMessage(StringData ns, long long cursorId, int nToReturn, int
 struct DbResponse {
     Message response;       // If empty, nothing will be returned to the client.
     std::string exhaustNS;  // Namespace of cursor if exhaust mode, else "".
+
+    // The body of the OP_MSG request to run next, in place of a request from the client, when
+    // 'response' is one batch of an OP_MSG exhaust stream.
+    boost::optional<BSONObj> nextInvocation;
 };
 
 /**
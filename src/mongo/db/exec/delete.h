@@ -64,6 +64,10 @@ struct DeleteStageParams {
     // Should we return the document we just deleted?
     bool returnDeleted;
 
+    // For a multi delete, the maximum number of documents to delete, or 0 to delete all documents
+    // returned from the child.
+    long long limit = 0;
+
     // The stmtId for this particular delete.
     StmtId stmtId = kUninitializedStmtId;
 
@@ -504,13 +504,19 @@ class AbstractIndexAccessMethod::BulkBuilderImpl : public IndexAccessMethod::Bul
 public:
     BulkBuilderImpl(const IndexAccessMethod* index,
                     const IndexDescriptor* descriptor,
-                    size_t maxMemoryUsageBytes);
+                    size_t maxMemoryUsageBytes,
+                    size_t numPartitions);
 
     Status insert(OperationContext* opCtx,
                   const BSONObj& obj,
                   const RecordId& loc,
                   const InsertDeleteOptions& options) final;
 
+    Status insertIntoPartition(const BSONObj& obj,
+                               const RecordId& loc,
+                               const InsertDeleteOptions& options,
+                               size_t partition) final;
+
     const MultikeyPaths& getMultikeyPaths() const final;
 
     bool isMultikey() const final;
@@ -524,89 +530,167 @@ public:
     int64_t getKeysInserted() const final;
 
 private:
-    std::unique_ptr<Sorter> _sorter;
-    const IndexAccessMethod* _real;
-    int64_t _keysInserted = 0;
+    /**
+     * Key generation state that is only ever touched by one thread at a time.
+     */
+    struct Partition {
+        std::unique_ptr<Sorter> sorter;
+        int64_t keysInserted = 0;
 
-    // Set to true if any document added to the BulkBuilder causes the index to become multikey.
-    bool _isMultiKey = false;
+        // Set to true if any document added to this partition causes the index to become
+        // multikey.
+        bool isMultiKey = false;
 
-    // Holds the path components that cause this index to be multikey. The '_indexMultikeyPaths'
-    // vector remains empty if this index doesn't support path-level multikey tracking.
-    MultikeyPaths _indexMultikeyPaths;
+        // Holds the path components that cause this index to be multikey. The
+        // 'indexMultikeyPaths' vector remains empty if this index doesn't support path-level
+        // multikey tracking.
+        MultikeyPaths indexMultikeyPaths;
 
-    // Caches the set of all multikey metadata keys generated during the bulk build process.
-    // These are inserted into the sorter after all normal data keys have been added, just
-    // before the bulk build is committed.
-    BSONObjSet _multikeyMetadataKeys{SimpleBSONObjComparator::kInstance.makeBSONObjSet()};
+        // Caches the set of all multikey metadata keys generated during the bulk build process.
+        // These are inserted into the sorter after all normal data keys have been added, just
+        // before the bulk build is committed.
+        BSONObjSet multikeyMetadataKeys{SimpleBSONObjComparator::kInstance.makeBSONObjSet()};
+    };
+
+    /**
+     * Folds the multikey state and key counts of every partition into the first one.
+     */
+    void _mergePartitions();
+
+    const IndexAccessMethod* _real;
+    const SortOptions _sortOptions;
+    const BtreeExternalSortComparison _comparator;
+    std::vector<Partition> _partitions;
 };
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
-    size_t maxMemoryUsageBytes) {
-    return std::make_unique<BulkBuilderImpl>(this, _descriptor, maxMemoryUsageBytes);
+    size_t maxMemoryUsageBytes, size_t numPartitions) {
+    return std::make_unique<BulkBuilderImpl>(
+        this, _descriptor, maxMemoryUsageBytes, numPartitions);
 }
 
 AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(const IndexAccessMethod* index,
                                                             const IndexDescriptor* descriptor,
-                                                            size_t maxMemoryUsageBytes)
-    : _sorter(Sorter::make(
-          SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
-              .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
-          BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
-      _real(index) {}
+                                                            size_t maxMemoryUsageBytes,
+                                                            size_t numPartitions)
+    : _real(index),
+      _sortOptions(SortOptions()
+                       .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                       .ExtSortAllowed()
+                       .MaxMemoryUsageBytes(maxMemoryUsageBytes / numPartitions)),
+      _comparator(descriptor->keyPattern(), descriptor->version()),
+      _partitions(numPartitions) {
+    invariant(numPartitions > 0);
+    for (auto& partition : _partitions) {
+        partition.sorter.reset(Sorter::make(_sortOptions, _comparator));
+    }
+}
 
 Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCtx,
                                                           const BSONObj& obj,
                                                           const RecordId& loc,
                                                           const InsertDeleteOptions& options) {
+    return insertIntoPartition(obj, loc, options, 0);
+}
+
+Status AbstractIndexAccessMethod::BulkBuilderImpl::insertIntoPartition(
+    const BSONObj& obj, const RecordId& loc, const InsertDeleteOptions& options, size_t partition) {
+    invariant(partition < _partitions.size());
+    auto& part = _partitions[partition];
+
     BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     MultikeyPaths multikeyPaths;
 
-    _real->getKeys(obj, options.getKeysMode, &keys, &_multikeyMetadataKeys, &multikeyPaths);
+    _real->getKeys(obj, options.getKeysMode, &keys, &part.multikeyMetadataKeys, &multikeyPaths);
 
     if (!multikeyPaths.empty()) {
-        if (_indexMultikeyPaths.empty()) {
-            _indexMultikeyPaths = multikeyPaths;
+        if (part.indexMultikeyPaths.empty()) {
+            part.indexMultikeyPaths = multikeyPaths;
         } else {
-            invariant(_indexMultikeyPaths.size() == multikeyPaths.size());
+            invariant(part.indexMultikeyPaths.size() == multikeyPaths.size());
             for (size_t i = 0; i < multikeyPaths.size(); ++i) {
-                _indexMultikeyPaths[i].insert(multikeyPaths[i].begin(), multikeyPaths[i].end());
+                part.indexMultikeyPaths[i].insert(multikeyPaths[i].begin(),
+                                                  multikeyPaths[i].end());
             }
         }
     }
 
     for (const auto& key : keys) {
-        _sorter->add(key, loc);
-        ++_keysInserted;
+        part.sorter->add(key, loc);
+        ++part.keysInserted;
     }
 
-    _isMultiKey =
-        _isMultiKey || _real->shouldMarkIndexAsMultikey(keys, _multikeyMetadataKeys, multikeyPaths);
+    part.isMultiKey = part.isMultiKey ||
+        _real->shouldMarkIndexAsMultikey(keys, part.multikeyMetadataKeys, multikeyPaths);
 
     return Status::OK();
 }
 
 const MultikeyPaths& AbstractIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
-    return _indexMultikeyPaths;
+    return _partitions.front().indexMultikeyPaths;
 }
 
 bool AbstractIndexAccessMethod::BulkBuilderImpl::isMultikey() const {
-    return _isMultiKey;
+    return _partitions.front().isMultiKey;
+}
+
+void AbstractIndexAccessMethod::BulkBuilderImpl::_mergePartitions() {
+    auto& first = _partitions.front();
+    for (size_t p = 1; p < _partitions.size(); ++p) {
+        auto& part = _partitions[p];
+        first.keysInserted += part.keysInserted;
+        part.keysInserted = 0;
+        first.isMultiKey = first.isMultiKey || part.isMultiKey;
+
+        if (!part.indexMultikeyPaths.empty()) {
+            if (first.indexMultikeyPaths.empty()) {
+                first.indexMultikeyPaths = std::move(part.indexMultikeyPaths);
+            } else {
+                invariant(first.indexMultikeyPaths.size() == part.indexMultikeyPaths.size());
+                for (size_t i = 0; i < part.indexMultikeyPaths.size(); ++i) {
+                    first.indexMultikeyPaths[i].insert(part.indexMultikeyPaths[i].begin(),
+                                                       part.indexMultikeyPaths[i].end());
+                }
+            }
+            part.indexMultikeyPaths.clear();
+        }
+
+        first.multikeyMetadataKeys.insert(part.multikeyMetadataKeys.begin(),
+                                          part.multikeyMetadataKeys.end());
+        part.multikeyMetadataKeys.clear();
+    }
 }
 
 IndexAccessMethod::BulkBuilder::Sorter::Iterator*
 AbstractIndexAccessMethod::BulkBuilderImpl::done() {
-    for (const auto& key : _multikeyMetadataKeys) {
-        _sorter->add(key, kMultikeyMetadataKeyId);
-        ++_keysInserted;
+    _mergePartitions();
+
+    auto& first = _partitions.front();
+    for (const auto& key : first.multikeyMetadataKeys) {
+        first.sorter->add(key, kMultikeyMetadataKeyId);
+        ++first.keysInserted;
+    }
+
+    if (_partitions.size() == 1) {
+        return first.sorter->done();
     }
-    return _sorter->done();
+
+    // Each partition's iterator owns the cleanup of its own spill file, so the merging iterator
+    // has no file of its own to remove.
+    std::vector<std::shared_ptr<Sorter::Iterator>> iters;
+    iters.reserve(_partitions.size());
+    for (auto& partition : _partitions) {
+        iters.push_back(std::shared_ptr<Sorter::Iterator>(partition.sorter->done()));
+    }
+    return Sorter::Iterator::merge(iters, "", _sortOptions, _comparator);
 }
 
 int64_t AbstractIndexAccessMethod::BulkBuilderImpl::getKeysInserted() const {
-    return _keysInserted;
+    int64_t keysInserted = 0;
+    for (const auto& partition : _partitions) {
+        keysInserted += partition.keysInserted;
+    }
+    return keysInserted;
 }
 
 Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
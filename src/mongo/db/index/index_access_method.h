@@ -224,13 +224,28 @@ public:
                               const RecordId& loc,
                               const InsertDeleteOptions& options) = 0;
 
+        /**
+         * Same as above, but generates keys into the given partition of the BulkBuilder. Each
+         * partition feeds its own Sorter and tracks its own multikey state, so distinct partitions
+         * may be inserted into concurrently from different threads without an OperationContext.
+         * The partitions are merged in done().
+         *
+         * 'partition' must be less than the 'numPartitions' passed to initiateBulk().
+         */
+        virtual Status insertIntoPartition(const BSONObj& obj,
+                                           const RecordId& loc,
+                                           const InsertDeleteOptions& options,
+                                           size_t partition) = 0;
+
         virtual const MultikeyPaths& getMultikeyPaths() const = 0;
 
         virtual bool isMultikey() const = 0;
 
         /**
          * Inserts all multikey metadata keys cached during the BulkBuilder's lifetime into the
-         * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset.
+         * underlying Sorter, finalizes it, and returns an iterator over the sorted dataset. When
+         * there is more than one partition, the returned iterator merges the sorted output of
+         * every partition.
          */
         virtual Sorter::Iterator* done() = 0;
 
@@ -248,9 +263,12 @@ public:
      * It is only legal to initiate bulk when the index is new and empty.
      *
      * maxMemoryUsageBytes: amount of memory consumed before the external sorter starts spilling to
-     *                      disk
+     *                      disk. This budget is divided evenly among the partitions.
+     * numPartitions: number of independent key generation partitions. See
+     *                BulkBuilder::insertIntoPartition().
      */
-    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) = 0;
+    virtual std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                                      size_t numPartitions = 1) = 0;
 
     /**
      * Call this when you are ready to finish your bulk work.
@@ -482,7 +500,8 @@ public:
 
     void setIndexIsMultikey(OperationContext* opCtx, MultikeyPaths paths) final;
 
-    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) final;
+    std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes,
+                                              size_t numPartitions) final;
 
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
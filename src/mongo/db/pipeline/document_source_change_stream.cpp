@@ -36,6 +36,7 @@
 #include "mongo/db/bson/bson_helper.h"
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
 #include "mongo/db/logical_clock.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/document_source_change_stream_close_cursor.h"
@@ -55,6 +56,7 @@
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/grid.h"
 #include "mongo/util/log.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -104,8 +106,11 @@ static constexpr StringData kOplogMatchExplainName = "$_internalOplogMatch"_sd;
 }  // namespace
 
 intrusive_ptr<DocumentSourceOplogMatch> DocumentSourceOplogMatch::create(
-    BSONObj filter, const intrusive_ptr<ExpressionContext>& expCtx) {
-    return new DocumentSourceOplogMatch(std::move(filter), expCtx);
+    BSONObj filter,
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    Timestamp startFrom,
+    bool startFromInclusive) {
+    return new DocumentSourceOplogMatch(std::move(filter), expCtx, startFrom, startFromInclusive);
 }
 
 const char* DocumentSourceOplogMatch::getSourceName() const {
@@ -139,8 +144,244 @@ Value DocumentSourceOplogMatch::serialize(optional<ExplainOptions::Verbosity> ex
 }
 
 DocumentSourceOplogMatch::DocumentSourceOplogMatch(BSONObj filter,
-                                                   const intrusive_ptr<ExpressionContext>& expCtx)
-    : DocumentSourceMatch(std::move(filter), expCtx) {}
+                                                   const intrusive_ptr<ExpressionContext>& expCtx,
+                                                   Timestamp startFrom,
+                                                   bool startFromInclusive)
+    : DocumentSourceMatch(std::move(filter), expCtx),
+      _startFrom(startFrom),
+      _startFromInclusive(startFromInclusive) {}
+
+//
+// Helpers for pushing filters on change events down into the oplog filter.
+//
+namespace {
+
+// The op types of the oplog entries which produce insert, update, replace and delete events. Only
+// these entries are discarded by a pushed down filter.
+const std::vector<std::string> kCrudOpTypes{"i", "u", "d"};
+
+/**
+ * Returns true if the leaf predicate 'expr' may match a document in which its path is missing.
+ * Conservatively returns true for any predicate which is not known to require the path.
+ */
+bool canMatchMissingPath(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            auto type = static_cast<const ComparisonMatchExpression*>(expr)->getData().type();
+            return type == BSONType::jstNULL || type == BSONType::Undefined ||
+                type == BSONType::MinKey || type == BSONType::MaxKey;
+        }
+        case MatchExpression::MATCH_IN:
+            return static_cast<const InMatchExpression*>(expr)->hasNull();
+        case MatchExpression::ELEM_MATCH_OBJECT:
+        case MatchExpression::ELEM_MATCH_VALUE:
+        case MatchExpression::SIZE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::BITS_ALL_SET:
+        case MatchExpression::BITS_ALL_CLEAR:
+        case MatchExpression::BITS_ANY_SET:
+        case MatchExpression::BITS_ANY_CLEAR:
+        case MatchExpression::TYPE_OPERATOR:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/**
+ * Returns a filter which matches the oplog entries of type 'opType'.
+ */
+BSONObj buildOpTypeFilter(StringData opType) {
+    return BSON("op" << opType);
+}
+
+/**
+ * Returns a filter which matches the oplog entries of type 'opType' on which the leaf predicate
+ * 'expr' holds when applied to 'path' instead of its own path.
+ */
+BSONObj buildOpTypeFilter(StringData opType, const MatchExpression* expr, const std::string& path) {
+    BSONObjBuilder leafBuilder;
+    expr->serialize(&leafBuilder);
+    auto leaf = leafBuilder.obj();
+
+    BSONObjBuilder filterBuilder;
+    filterBuilder.append("op", opType);
+    filterBuilder.appendAs(leaf.firstElement(), path);
+    return filterBuilder.obj();
+}
+
+/**
+ * Rewrites a predicate on 'operationType' into a predicate on the op type of CRUD oplog entries.
+ * Returns boost::none if the predicate compares against anything other than known operation types.
+ */
+boost::optional<BSONObj> rewriteOperationTypeFilter(const MatchExpression* expr) {
+    static const StringMap<boost::optional<std::string>> kCrudOpTypeForOperationType{
+        {DocumentSourceChangeStream::kInsertOpType.toString(), std::string("i")},
+        {DocumentSourceChangeStream::kUpdateOpType.toString(), std::string("u")},
+        {DocumentSourceChangeStream::kReplaceOpType.toString(), std::string("u")},
+        {DocumentSourceChangeStream::kDeleteOpType.toString(), std::string("d")},
+        {DocumentSourceChangeStream::kDropCollectionOpType.toString(), boost::none},
+        {DocumentSourceChangeStream::kRenameCollectionOpType.toString(), boost::none},
+        {DocumentSourceChangeStream::kDropDatabaseOpType.toString(), boost::none},
+        {DocumentSourceChangeStream::kInvalidateOpType.toString(), boost::none},
+        {DocumentSourceChangeStream::kNewShardDetectedOpType.toString(), boost::none}};
+
+    std::vector<BSONElement> operationTypes;
+    if (expr->matchType() == MatchExpression::EQ) {
+        operationTypes.push_back(static_cast<const ComparisonMatchExpression*>(expr)->getData());
+    } else if (expr->matchType() == MatchExpression::MATCH_IN) {
+        auto inExpr = static_cast<const InMatchExpression*>(expr);
+        if (!inExpr->getRegexes().empty()) {
+            return boost::none;
+        }
+        operationTypes.assign(inExpr->getEqualities().begin(), inExpr->getEqualities().end());
+    } else {
+        return boost::none;
+    }
+
+    std::set<std::string> opTypes;
+    for (auto&& operationType : operationTypes) {
+        if (operationType.type() != BSONType::String) {
+            return boost::none;
+        }
+        auto it = kCrudOpTypeForOperationType.find(operationType.valueStringData());
+        if (it == kCrudOpTypeForOperationType.end()) {
+            return boost::none;
+        }
+        if (it->second) {
+            opTypes.insert(*it->second);
+        }
+    }
+
+    if (opTypes.empty()) {
+        // No CRUD entry produces an event of the requested operation types.
+        return BSON("$alwaysFalse" << 1);
+    }
+    return BSON("op" << BSON("$in" << std::vector<std::string>(opTypes.begin(), opTypes.end())));
+}
+
+/**
+ * Rewrites 'eventFilter', a filter on change events, into a filter on raw CRUD oplog entries which
+ * matches every entry whose event may match 'eventFilter'. Returns boost::none if no part of
+ * 'eventFilter' can be rewritten.
+ */
+boost::optional<BSONObj> rewriteEventFilterForCrudEntries(const MatchExpression* eventFilter) {
+    switch (eventFilter->matchType()) {
+        case MatchExpression::AND: {
+            // Conjuncts which cannot be rewritten are dropped, which only widens the filter.
+            BSONArrayBuilder conjuncts;
+            for (size_t i = 0; i < eventFilter->numChildren(); ++i) {
+                if (auto rewritten = rewriteEventFilterForCrudEntries(eventFilter->getChild(i))) {
+                    conjuncts.append(*rewritten);
+                }
+            }
+            if (conjuncts.arrSize() == 0) {
+                return boost::none;
+            }
+            return BSON("$and" << conjuncts.arr());
+        }
+        case MatchExpression::OR: {
+            BSONArrayBuilder disjuncts;
+            for (size_t i = 0; i < eventFilter->numChildren(); ++i) {
+                auto rewritten = rewriteEventFilterForCrudEntries(eventFilter->getChild(i));
+                if (!rewritten) {
+                    return boost::none;
+                }
+                disjuncts.append(*rewritten);
+            }
+            return BSON("$or" << disjuncts.arr());
+        }
+        default:
+            break;
+    }
+
+    // The remaining rewritable predicates are leaves on a path of the event.
+    auto path = eventFilter->path();
+    if (path.empty()) {
+        return boost::none;
+    }
+    auto rootLength = std::min(path.find('.'), path.size());
+    auto root = path.substr(0, rootLength);
+    auto rest = path.substr(rootLength).toString();
+
+    if (root == DocumentSourceChangeStream::kOperationTypeField) {
+        return rest.empty() ? rewriteOperationTypeFilter(eventFilter) : boost::none;
+    }
+
+    // The fields below are missing from the events of some CRUD operations, so a predicate on them
+    // rules those operations out only if it cannot match a missing field.
+    if (canMatchMissingPath(eventFilter)) {
+        return boost::none;
+    }
+
+    if (root == DocumentSourceChangeStream::kDocumentKeyField) {
+        // The document key of an update is 'o2', and that of a delete is 'o'. The document key of
+        // an insert is extracted from 'o', so each of its fields has the same value in 'o'.
+        auto insertFilter =
+            rest.empty() ? buildOpTypeFilter("i") : buildOpTypeFilter("i", eventFilter, "o" + rest);
+        return BSON("$or" << BSON_ARRAY(insertFilter
+                                        << buildOpTypeFilter("u", eventFilter, "o2" + rest)
+                                        << buildOpTypeFilter("d", eventFilter, "o" + rest)));
+    }
+
+    if (root == DocumentSourceChangeStream::kFullDocumentField) {
+        // The full document of an insert is 'o'. That of an update is either the replacement
+        // document or the result of a post-image lookup, and a delete has none.
+        return BSON("$or" << BSON_ARRAY(buildOpTypeFilter("i", eventFilter, "o" + rest)
+                                        << buildOpTypeFilter("u")));
+    }
+
+    if (root == DocumentSourceChangeStream::kUpdateDescriptionField) {
+        // Only update events have an update description.
+        return buildOpTypeFilter("u");
+    }
+
+    return boost::none;
+}
+
+}  // namespace
+
+void DocumentSourceOplogMatch::pushDownEventFilters(const Pipeline::SourceContainer& container) {
+    auto it = std::find_if(
+        container.begin(), container.end(), [this](const intrusive_ptr<DocumentSource>& stage) {
+            return stage.get() == this;
+        });
+    invariant(it != container.end());
+
+    // Only the $match stages which see the events exactly as the $changeStream stages produce them
+    // can be pushed down. Any other stage may reshape the events.
+    BSONArrayBuilder crudFilters;
+    for (++it; it != container.end(); ++it) {
+        if (auto match = dynamic_cast<DocumentSourceMatch*>(it->get())) {
+            if (auto crudFilter = rewriteEventFilterForCrudEntries(match->getMatchExpression())) {
+                crudFilters.append(*crudFilter);
+            }
+        } else if (!(*it)->constraints().isChangeStreamStage()) {
+            break;
+        }
+    }
+
+    if (crudFilters.arrSize() == 0) {
+        return;
+    }
+
+    // Entries other than CRUD entries are never discarded, since they may invalidate the stream or
+    // be part of a transaction. Neither is the entry at the resume point, which the resume stages
+    // expect to see.
+    BSONArrayBuilder disjuncts;
+    disjuncts.append(BSON("op" << BSON("$nin" << kCrudOpTypes)));
+    if (_startFromInclusive) {
+        disjuncts.append(BSON("ts" << _startFrom));
+    }
+    disjuncts.append(BSON("$and" << crudFilters.arr()));
+    joinMatchWith(DocumentSourceMatch::create(BSON("$or" << disjuncts.arr()), pExpCtx));
+}
 
 void DocumentSourceChangeStream::checkValueType(const Value v,
                                                 const StringData filedName,
@@ -383,7 +624,9 @@ list<intrusive_ptr<DocumentSource>> buildPipeline(const intrusive_ptr<Expression
         const bool startFromInclusive = (resumeStage != nullptr);
         stages.push_back(DocumentSourceOplogMatch::create(
             DocumentSourceChangeStream::buildMatchFilter(expCtx, *startFrom, startFromInclusive),
-            expCtx));
+            expCtx,
+            *startFrom,
+            startFromInclusive));
     }
 
     const auto fcv = serverGlobalParams.featureCompatibility.getVersion();
@@ -215,7 +215,10 @@ private:
 class DocumentSourceOplogMatch final : public DocumentSourceMatch {
 public:
     static boost::intrusive_ptr<DocumentSourceOplogMatch> create(
-        BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+        BSONObj filter,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        Timestamp startFrom,
+        bool startFromInclusive);
 
     const char* getSourceName() const final;
 
@@ -231,8 +234,35 @@ public:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
 
+    /**
+     * The timestamp of the first oplog entry the filter can match. Entries at 'startFrom' match
+     * only if 'isStartFromInclusive()'.
+     */
+    Timestamp getStartFrom() const {
+        return _startFrom;
+    }
+
+    bool isStartFromInclusive() const {
+        return _startFromInclusive;
+    }
+
+    /**
+     * Narrows this filter using the $match stages in 'container' which directly follow the
+     * $changeStream stages. Their predicates on 'operationType', 'documentKey', 'fullDocument' and
+     * 'updateDescription' are rewritten over the fields of the raw oplog entry, so that CRUD
+     * entries which cannot produce a matching event are discarded before being transformed. The
+     * $match stages are left in place, and still apply the exact predicates to each event.
+     */
+    void pushDownEventFilters(const Pipeline::SourceContainer& container);
+
 private:
-    DocumentSourceOplogMatch(BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+    DocumentSourceOplogMatch(BSONObj filter,
+                             const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                             Timestamp startFrom,
+                             bool startFromInclusive);
+
+    const Timestamp _startFrom;
+    const bool _startFromInclusive;
 };
 
 }  // namespace mongo
@@ -1717,5 +1717,137 @@ TEST_F(ChangeStreamStageDBTest, StartAfterSucceedsEvenIfResumeTokenDoesNotContai
                         BSON("$changeStream" << BSON("startAfter" << resumeToken)));
 }
 
+/**
+ * Fixture for tests of pushing a $match on change events down into the oplog filter.
+ */
+class ChangeStreamPushDownTest : public ChangeStreamStageTest {
+public:
+    /**
+     * Expands 'spec', follows it with a $match on the events with 'eventFilter', and pushes that
+     * $match down into the oplog filter, which is returned.
+     */
+    intrusive_ptr<DocumentSourceOplogMatch> pushDownEventFilter(
+        const BSONObj& eventFilter, const BSONObj& spec = kDefaultSpec) {
+        Pipeline::SourceContainer stages =
+            DSChangeStream::createFromBson(spec.firstElement(), getExpCtx());
+        stages.push_back(DocumentSourceMatch::create(eventFilter, getExpCtx()));
+
+        auto oplogMatch = dynamic_cast<DocumentSourceOplogMatch*>(stages.front().get());
+        ASSERT(oplogMatch);
+        oplogMatch->pushDownEventFilters(stages);
+        return oplogMatch;
+    }
+
+    static bool matches(const intrusive_ptr<DocumentSourceOplogMatch>& oplogMatch,
+                        const OplogEntry& entry) {
+        return oplogMatch->getMatchExpression()->matchesBSON(entry.toBSON());
+    }
+
+    static OplogEntry makeInsert(BSONObj doc) {
+        return makeOplogEntry(OpTypeEnum::kInsert, nss, doc);
+    }
+
+    static OplogEntry makeUpdate(BSONObj documentKey, BSONObj update) {
+        return makeOplogEntry(
+            OpTypeEnum::kUpdate, nss, update, testUuid(), boost::none, documentKey);
+    }
+
+    static OplogEntry makeDelete(BSONObj documentKey) {
+        return makeOplogEntry(OpTypeEnum::kDelete, nss, documentKey);
+    }
+};
+
+TEST_F(ChangeStreamPushDownTest, OperationTypeFilterDiscardsOtherCrudEntries) {
+    auto oplogMatch = pushDownEventFilter(
+        BSON("operationType" << BSON("$in" << BSON_ARRAY("insert"
+                                                         << "delete"))));
+
+    ASSERT_TRUE(matches(oplogMatch, makeInsert(BSON("_id" << 1))));
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+    ASSERT_FALSE(matches(oplogMatch, makeUpdate(BSON("_id" << 1), BSON("$set" << BSON("x" << 1)))));
+
+    // Commands are kept, since they may invalidate the stream.
+    ASSERT_TRUE(matches(oplogMatch, createCommand(BSON("drop" << nss.coll()), testUuid())));
+}
+
+TEST_F(ChangeStreamPushDownTest, NonCrudOperationTypeFilterDiscardsAllCrudEntries) {
+    auto oplogMatch = pushDownEventFilter(BSON("operationType"
+                                               << "drop"));
+
+    ASSERT_FALSE(matches(oplogMatch, makeInsert(BSON("_id" << 1))));
+    ASSERT_TRUE(matches(oplogMatch, createCommand(BSON("drop" << nss.coll()), testUuid())));
+}
+
+TEST_F(ChangeStreamPushDownTest, DocumentKeyFilterIsAppliedToTheDocumentKeyOfEachCrudEntry) {
+    auto oplogMatch = pushDownEventFilter(BSON("documentKey._id" << 2));
+
+    ASSERT_TRUE(matches(oplogMatch, makeInsert(BSON("_id" << 2 << "x" << 1))));
+    ASSERT_FALSE(matches(oplogMatch, makeInsert(BSON("_id" << 3))));
+    ASSERT_TRUE(matches(oplogMatch, makeUpdate(BSON("_id" << 2), BSON("$set" << BSON("x" << 1)))));
+    ASSERT_FALSE(matches(oplogMatch, makeUpdate(BSON("_id" << 3), BSON("$set" << BSON("x" << 1)))));
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 2))));
+    ASSERT_FALSE(matches(oplogMatch, makeDelete(BSON("_id" << 3))));
+}
+
+TEST_F(ChangeStreamPushDownTest, FullDocumentFilterKeepsAllUpdates) {
+    auto oplogMatch = pushDownEventFilter(BSON("fullDocument.x" << BSON("$gt" << 5)));
+
+    ASSERT_TRUE(matches(oplogMatch, makeInsert(BSON("_id" << 1 << "x" << 6))));
+    ASSERT_FALSE(matches(oplogMatch, makeInsert(BSON("_id" << 1 << "x" << 4))));
+
+    // The full document of an update may come from a post-image lookup.
+    ASSERT_TRUE(matches(oplogMatch, makeUpdate(BSON("_id" << 1), BSON("$set" << BSON("y" << 1)))));
+    ASSERT_FALSE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+}
+
+TEST_F(ChangeStreamPushDownTest, FilterWhichMatchesMissingFieldIsNotPushedDown) {
+    auto oplogMatch = pushDownEventFilter(BSON("fullDocument.x" << BSONNULL));
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+
+    oplogMatch = pushDownEventFilter(BSON("fullDocument.x" << BSON("$ne" << 1)));
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+}
+
+TEST_F(ChangeStreamPushDownTest, DisjunctionIsPushedDownOnlyIfEveryBranchIs) {
+    auto oplogMatch = pushDownEventFilter(
+        BSON("$or" << BSON_ARRAY(BSON("operationType"
+                                      << "insert")
+                                 << BSON("ns.coll" << nss.coll()))));
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+
+    oplogMatch = pushDownEventFilter(
+        BSON("$or" << BSON_ARRAY(BSON("operationType"
+                                      << "insert")
+                                 << BSON("updateDescription.removedFields"
+                                         << "x"))));
+    ASSERT_TRUE(
+        matches(oplogMatch, makeUpdate(BSON("_id" << 1), BSON("$unset" << BSON("x" << 1)))));
+    ASSERT_FALSE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+}
+
+TEST_F(ChangeStreamPushDownTest, EntryAtResumePointIsNeverDiscarded) {
+    Collection collection(stdx::make_unique<CollectionMock>(nss));
+    UUIDCatalog::get(getExpCtx()->opCtx)
+        .onCreateCollection(getExpCtx()->opCtx, &collection, testUuid());
+
+    auto resumeToken = makeResumeToken(kDefaultTs, testUuid(), BSON("_id" << 1));
+    auto oplogMatch =
+        pushDownEventFilter(BSON("operationType"
+                                 << "insert"),
+                            BSON("$changeStream" << BSON("resumeAfter" << resumeToken)));
+
+    ASSERT_TRUE(matches(oplogMatch, makeDelete(BSON("_id" << 1))));
+
+    const repl::OpTime laterOpTime(Timestamp(kDefaultTs.getSecs() + 1, 1), 1);
+    ASSERT_FALSE(matches(oplogMatch,
+                         makeOplogEntry(OpTypeEnum::kDelete,
+                                        nss,
+                                        BSON("_id" << 1),
+                                        testUuid(),
+                                        boost::none,
+                                        boost::none,
+                                        laterOpTime)));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -33,6 +33,8 @@
 #include "mongo/db/pipeline/document_source_lookup_change_post_image.h"
 
 #include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -60,19 +62,169 @@ Value assertFieldHasType(const Document& fullDoc, StringData fieldName, BSONType
 DocumentSource::GetNextResult DocumentSourceLookupChangePostImage::getNext() {
     pExpCtx->checkForInterrupt();
 
-    auto input = pSource->getNext();
-    if (!input.isAdvanced()) {
-        return input;
+    if (_batch.empty()) {
+        if (_resultAfterBatch) {
+            auto result = std::move(*_resultAfterBatch);
+            _resultAfterBatch = boost::none;
+            return result;
+        }
+
+        auto input = pSource->getNext();
+        if (!input.isAdvanced()) {
+            return input;
+        }
+        loadBatch(input.releaseDocument());
     }
-    auto opTypeVal = assertFieldHasType(
-        input.getDocument(), DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
-    if (opTypeVal.getString() != DocumentSourceChangeStream::kUpdateOpType) {
-        return input;
+
+    auto next = std::move(_batch.front());
+    _batch.pop_front();
+    return next;
+}
+
+bool DocumentSourceLookupChangePostImage::canExtendBatch(const Document& lastEvent,
+                                                         size_t batchSize,
+                                                         size_t batchBytes) const {
+    if (batchSize >= static_cast<size_t>(internalChangeStreamPostImageLookupBatchSize.load()) ||
+        batchBytes >=
+            static_cast<size_t>(internalChangeStreamPostImageLookupBatchSizeBytes.load())) {
+        return false;
+    }
+
+    // An invalidate is followed by the stream closing, so no event may be read after it before it
+    // has been returned.
+    auto opType = lastEvent[DocumentSourceChangeStream::kOperationTypeField];
+    if (opType.getType() == BSONType::String &&
+        opType.getStringData() == DocumentSourceChangeStream::kInvalidateOpType) {
+        return false;
+    }
+
+    // As long as we're waiting for inserts, reading another event may block until the await
+    // times out, delaying the events already read. On mongos, the merge of the shards' streams may
+    // block in the same way, and the lookups would not be batched anyway.
+    return !pExpCtx->inMongos && !awaitDataState(pExpCtx->opCtx).shouldWaitForInserts;
+}
+
+void DocumentSourceLookupChangePostImage::loadBatch(Document firstEvent) {
+    auto isUpdate = [](const Document& event) {
+        auto opType = event[DocumentSourceChangeStream::kOperationTypeField];
+        return opType.getType() == BSONType::String &&
+            opType.getStringData() == DocumentSourceChangeStream::kUpdateOpType;
+    };
+
+    std::vector<Document> events{std::move(firstEvent)};
+    size_t batchBytes = events.back().getApproximateSize();
+    size_t numPendingUpdates = isUpdate(events.back()) ? 1 : 0;
+    size_t firstPendingEvent = 0;
+    while (true) {
+        // The post-images of the events read since the last lookup are not known yet, so count
+        // each of them as the average size of the post-images looked up so far.
+        const size_t averagePostImageBytes = _numPostImages ? _postImageBytes / _numPostImages : 0;
+        while (!_resultAfterBatch &&
+               canExtendBatch(events.back(),
+                              events.size(),
+                              batchBytes + numPendingUpdates * averagePostImageBytes)) {
+            auto input = pSource->getNext();
+            if (!input.isAdvanced()) {
+                _resultAfterBatch = std::move(input);
+                break;
+            }
+            events.push_back(input.releaseDocument());
+            batchBytes += events.back().getApproximateSize();
+            numPendingUpdates += isUpdate(events.back()) ? 1 : 0;
+        }
+
+        batchBytes += lookUpPostImages(&events, firstPendingEvent);
+        numPendingUpdates = 0;
+        firstPendingEvent = events.size();
+
+        // Read more events if the post-images turned out smaller than expected.
+        if (_resultAfterBatch || !canExtendBatch(events.back(), events.size(), batchBytes)) {
+            break;
+        }
     }
 
-    MutableDocument output(input.releaseDocument());
-    output[kFullDocumentFieldName] = lookupPostImage(output.peek());
-    return output.freeze();
+    _batch.insert(_batch.end(),
+                  std::make_move_iterator(events.begin()),
+                  std::make_move_iterator(events.end()));
+}
+
+size_t DocumentSourceLookupChangePostImage::lookUpPostImages(std::vector<Document>* events,
+                                                            size_t firstEvent) {
+    // The update events of the batch, grouped by the collection they are on.
+    struct LookupGroup {
+        NamespaceString nss;
+        UUID uuid;
+        Timestamp latestClusterTime;
+        std::vector<size_t> positions;
+        std::vector<Document> documentKeys;
+    };
+    std::vector<LookupGroup> groups;
+
+    for (size_t i = firstEvent; i < events->size(); ++i) {
+        auto opTypeVal = assertFieldHasType(
+            (*events)[i], DocumentSourceChangeStream::kOperationTypeField, BSONType::String);
+        if (opTypeVal.getString() != DocumentSourceChangeStream::kUpdateOpType) {
+            continue;
+        }
+
+        // Make sure we have a well-formed input.
+        auto nss = assertValidNamespace((*events)[i]);
+
+        auto documentKey = assertFieldHasType((*events)[i],
+                                              DocumentSourceChangeStream::kDocumentKeyField,
+                                              BSONType::Object)
+                               .getDocument();
+
+        // Extract the UUID from resume token and do change stream lookups by UUID.
+        auto resumeToken =
+            ResumeToken::parse((*events)[i][DocumentSourceChangeStream::kIdField].getDocument());
+        invariant(resumeToken.getData().uuid);
+        const auto& uuid = *resumeToken.getData().uuid;
+        const auto clusterTime = resumeToken.getData().clusterTime;
+
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const LookupGroup& candidate) {
+            return candidate.uuid == uuid && candidate.nss == nss;
+        });
+        if (group == groups.end()) {
+            groups.push_back({nss, uuid, clusterTime, {}, {}});
+            group = std::prev(groups.end());
+        }
+        group->latestClusterTime = std::max(group->latestClusterTime, clusterTime);
+        group->positions.push_back(i);
+        group->documentKeys.push_back(std::move(documentKey));
+    }
+
+    size_t postImageBytes = 0;
+    for (auto&& group : groups) {
+        // Reading at the time of the latest update in the group returns a post-image which is at
+        // least as recent as each of its updates.
+        const auto readConcern = pExpCtx->inMongos
+            ? boost::optional<BSONObj>(BSON("level"
+                                            << "majority"
+                                            << "afterClusterTime"
+                                            << group.latestClusterTime))
+            : boost::none;
+        auto lookedUpDocs = pExpCtx->mongoProcessInterface->lookupDocuments(
+            pExpCtx, group.nss, group.uuid, group.documentKeys, readConcern);
+        invariant(lookedUpDocs.size() == group.positions.size());
+
+        for (size_t i = 0; i < group.positions.size(); ++i) {
+            // Check whether the lookup returned a document. Even if the lookup itself succeeded,
+            // the document may have been deleted in the time since the update op.
+            MutableDocument output(std::move((*events)[group.positions[i]]));
+            if (lookedUpDocs[i]) {
+                postImageBytes += lookedUpDocs[i]->getApproximateSize();
+                ++_numPostImages;
+                output[kFullDocumentFieldName] = Value(*lookedUpDocs[i]);
+            } else {
+                output[kFullDocumentFieldName] = Value(BSONNULL);
+            }
+            (*events)[group.positions[i]] = output.freeze();
+        }
+    }
+
+    _postImageBytes += postImageBytes;
+    return postImageBytes;
 }
 
 NamespaceString DocumentSourceLookupChangePostImage::assertValidNamespace(
@@ -97,32 +249,4 @@ NamespaceString DocumentSourceLookupChangePostImage::assertValidNamespace(
     return nss;
 }
 
-Value DocumentSourceLookupChangePostImage::lookupPostImage(const Document& updateOp) const {
-    // Make sure we have a well-formed input.
-    auto nss = assertValidNamespace(updateOp);
-
-    auto documentKey = assertFieldHasType(updateOp,
-                                          DocumentSourceChangeStream::kDocumentKeyField,
-                                          BSONType::Object)
-                           .getDocument();
-
-    // Extract the UUID from resume token and do change stream lookups by UUID.
-    auto resumeToken =
-        ResumeToken::parse(updateOp[DocumentSourceChangeStream::kIdField].getDocument());
-
-    const auto readConcern = pExpCtx->inMongos
-        ? boost::optional<BSONObj>(BSON("level"
-                                        << "majority"
-                                        << "afterClusterTime"
-                                        << resumeToken.getData().clusterTime))
-        : boost::none;
-    invariant(resumeToken.getData().uuid);
-    auto lookedUpDoc = pExpCtx->mongoProcessInterface->lookupSingleDocument(
-        pExpCtx, nss, *resumeToken.getData().uuid, documentKey, readConcern);
-
-    // Check whether the lookup returned any documents. Even if the lookup itself succeeded, it may
-    // not have returned any results if the document was deleted in the time since the update op.
-    return (lookedUpDoc ? Value(*lookedUpDoc) : Value(BSONNULL));
-}
-
 }  // namespace mongo
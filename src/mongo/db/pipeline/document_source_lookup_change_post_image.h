@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 
@@ -37,7 +39,9 @@ namespace mongo {
 
 /**
  * Part of the change stream API machinery used to look up the post-image of a document. Uses the
- * "documentKey" field of the input to look up the new version of the document.
+ * "documentKey" field of the input to look up the new version of the document. The post-images of
+ * the update events in a batch of consecutive events are looked up together, with one query per
+ * collection.
  */
 class DocumentSourceLookupChangePostImage final : public DocumentSource {
 public:
@@ -110,10 +114,26 @@ private:
         : DocumentSource(expCtx) {}
 
     /**
-     * Uses the "documentKey" field from 'updateOp' to look up the current version of the document.
-     * Returns Value(BSONNULL) if the document couldn't be found.
+     * Reads a batch of events from the source, starting with 'firstEvent', and uses the
+     * "documentKey" field of each update event among them to look up the current version of the
+     * document. Sets "fullDocument" to null if the document couldn't be found.
+     *
+     * The size of the batch includes the post-images looked up for it. The events are read and
+     * their post-images looked up in rounds until the batch is full.
+     */
+    void loadBatch(Document firstEvent);
+
+    /**
+     * Looks up the post-images of the update events of 'events' from 'firstEvent' on, and returns
+     * their total size.
+     */
+    size_t lookUpPostImages(std::vector<Document>* events, size_t firstEvent);
+
+    /**
+     * Returns true if another event may be read from the source into the current batch of
+     * 'batchSize' events, which take up roughly 'batchBytes' and the last of which is 'lastEvent'.
      */
-    Value lookupPostImage(const Document& updateOp) const;
+    bool canExtendBatch(const Document& lastEvent, size_t batchSize, size_t batchBytes) const;
 
     /**
      * Throws a AssertionException if the namespace found in 'inputDoc' doesn't match the one on the
@@ -121,6 +141,17 @@ private:
      * function verifies that the only the database names match.
      */
     NamespaceString assertValidNamespace(const Document& inputDoc) const;
+
+    // Events whose post-images have been looked up, and which have not yet been returned.
+    std::deque<Document> _batch;
+
+    // The result which ended the current batch, if it was not an event. Returned after '_batch'.
+    boost::optional<GetNextResult> _resultAfterBatch;
+
+    // The number and total size of the post-images looked up by this stage, which are used to
+    // estimate the size of the post-images of the events read into a batch.
+    size_t _numPostImages = 0;
+    size_t _postImageBytes = 0;
 };
 
 }  // namespace mongo
@@ -46,6 +46,9 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/stub_mongo_process_interface.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -145,6 +148,25 @@ public:
         return lookedUpDocument;
     }
 
+    std::vector<boost::optional<Document>> lookupDocuments(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const NamespaceString& nss,
+        UUID collectionUUID,
+        const std::vector<Document>& documentKeys,
+        boost::optional<BSONObj> readConcern) final {
+        lookupBatchSizes.push_back(documentKeys.size());
+
+        std::vector<boost::optional<Document>> lookedUpDocuments;
+        for (auto&& documentKey : documentKeys) {
+            lookedUpDocuments.push_back(
+                lookupSingleDocument(expCtx, nss, collectionUUID, documentKey, readConcern));
+        }
+        return lookedUpDocuments;
+    }
+
+    // The number of document keys passed to each call of lookupDocuments().
+    std::vector<size_t> lookupBatchSizes;
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
 };
@@ -395,5 +417,230 @@ TEST_F(DocumentSourceLookupChangePostImageTest, ShouldPropagatePauses) {
     ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldLookUpPostImagesOfConsecutiveUpdates) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // Mock its input with several updates, and an insert between them.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document{{"_id", makeResumeToken(0)},
+                  {"documentKey", Document{{"_id", 0}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}},
+         Document{{"_id", makeResumeToken(1)},
+                  {"documentKey", Document{{"_id", 1}}},
+                  {"operationType", "insert"_sd},
+                  {"ns", ns},
+                  {"fullDocument", Document{{"_id", 1}}}},
+         Document{{"_id", makeResumeToken(2)},
+                  {"documentKey", Document{{"_id", 2}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}},
+         Document{{"_id", makeResumeToken(3)},
+                  {"documentKey", Document{{"_id", 3}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}}});
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection. The document with _id 3 has since been deleted.
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}, {"x", 0}},
+                                                             Document{{"_id", 2}, {"x", 2}}};
+    auto mongoProcessInterface =
+        stdx::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockMongoInterface = mongoProcessInterface.get();
+    expCtx->mongoProcessInterface = std::move(mongoProcessInterface);
+
+    const std::vector<Value> expectedFullDocuments{Value(Document{{"_id", 0}, {"x", 0}}),
+                                                   Value(Document{{"_id", 1}}),
+                                                   Value(Document{{"_id", 2}, {"x", 2}}),
+                                                   Value(BSONNULL)};
+    for (int id = 0; id < 4; ++id) {
+        auto next = lookupChangeStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        auto event = next.releaseDocument();
+        ASSERT_VALUE_EQ(event["documentKey"]["_id"], Value(id));
+        ASSERT_VALUE_EQ(event["fullDocument"], expectedFullDocuments[id]);
+    }
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+
+    // The three updates were looked up together.
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == std::vector<size_t>{3});
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldNotReadPastAnInvalidate) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // Mock its input with an invalidate between two updates.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document{{"_id", makeResumeToken(0)},
+                  {"documentKey", Document{{"_id", 0}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}},
+         Document{{"_id", makeResumeToken()}, {"operationType", "invalidate"_sd}},
+         Document{{"_id", makeResumeToken(1)},
+                  {"documentKey", Document{{"_id", 1}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}}});
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    auto mongoProcessInterface =
+        stdx::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockMongoInterface = mongoProcessInterface.get();
+    expCtx->mongoProcessInterface = std::move(mongoProcessInterface);
+
+    ASSERT_TRUE(lookupChangeStage->getNext().isAdvanced());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == std::vector<size_t>{1});
+
+    auto next = lookupChangeStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["operationType"], Value("invalidate"_sd));
+
+    ASSERT_TRUE(lookupChangeStage->getNext().isAdvanced());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == (std::vector<size_t>{1, 1}));
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldNotBatchWhileWaitingForInserts) {
+    auto expCtx = getExpCtx();
+    awaitDataState(expCtx->opCtx).shouldWaitForInserts = true;
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document{{"_id", makeResumeToken(0)},
+                  {"documentKey", Document{{"_id", 0}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}},
+         Document{{"_id", makeResumeToken(1)},
+                  {"documentKey", Document{{"_id", 1}}},
+                  {"operationType", "update"_sd},
+                  {"ns", ns}}});
+
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{Document{{"_id", 0}},
+                                                             Document{{"_id", 1}}};
+    auto mongoProcessInterface =
+        stdx::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockMongoInterface = mongoProcessInterface.get();
+    expCtx->mongoProcessInterface = std::move(mongoProcessInterface);
+
+    // The first event is returned without reading the second, which could block.
+    ASSERT_TRUE(lookupChangeStage->getNext().isAdvanced());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == std::vector<size_t>{1});
+
+    // Once a result has been returned, the operation no longer waits.
+    awaitDataState(expCtx->opCtx).shouldWaitForInserts = false;
+    ASSERT_TRUE(lookupChangeStage->getNext().isAdvanced());
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == (std::vector<size_t>{1, 1}));
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldEndBatchAtSizeLimitInBytes) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    std::vector<Document> updates;
+    for (int id = 0; id < 3; ++id) {
+        updates.push_back(Document{{"_id", makeResumeToken(id)},
+                                   {"documentKey", Document{{"_id", id}}},
+                                   {"operationType", "update"_sd},
+                                   {"ns", ns}});
+    }
+
+    // Only the first two updates fit in a batch.
+    const int savedBatchSizeBytes = internalChangeStreamPostImageLookupBatchSizeBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalChangeStreamPostImageLookupBatchSizeBytes.store(savedBatchSizeBytes); });
+    internalChangeStreamPostImageLookupBatchSizeBytes.store(
+        static_cast<int>(updates[0].getApproximateSize() + updates[1].getApproximateSize()));
+
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document(updates[0]), Document(updates[1]), Document(updates[2])});
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}}, Document{{"_id", 1}}, Document{{"_id", 2}}};
+    auto mongoProcessInterface =
+        stdx::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockMongoInterface = mongoProcessInterface.get();
+    expCtx->mongoProcessInterface = std::move(mongoProcessInterface);
+
+    for (int id = 0; id < 3; ++id) {
+        auto next = lookupChangeStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.releaseDocument()["fullDocument"], Value(Document{{"_id", id}}));
+    }
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == (std::vector<size_t>{2, 1}));
+}
+
+TEST_F(DocumentSourceLookupChangePostImageTest, ShouldCountPostImagesTowardsSizeLimitInBytes) {
+    auto expCtx = getExpCtx();
+
+    // Set up the lookup change post image stage.
+    auto lookupChangeStage = DocumentSourceLookupChangePostImage::create(expCtx);
+
+    // The invalidate ends the first batch, after which the size of a post-image is known.
+    const auto ns = Document{{"db", expCtx->ns.db()}, {"coll", expCtx->ns.coll()}};
+    std::vector<Document> updates;
+    for (int id = 0; id < 4; ++id) {
+        updates.push_back(Document{{"_id", makeResumeToken(id)},
+                                   {"documentKey", Document{{"_id", id}}},
+                                   {"operationType", "update"_sd},
+                                   {"ns", ns}});
+    }
+    auto mockLocalSource = DocumentSourceMock::create(
+        {Document(updates[0]),
+         Document{{"_id", makeResumeToken()}, {"operationType", "invalidate"_sd}},
+         Document(updates[1]),
+         Document(updates[2]),
+         Document(updates[3])});
+    lookupChangeStage->setSource(mockLocalSource.get());
+
+    // Mock out the foreign collection with post-images much larger than the events.
+    const std::string padding(1024, 'x');
+    deque<DocumentSource::GetNextResult> mockForeignContents;
+    for (int id = 0; id < 4; ++id) {
+        mockForeignContents.push_back(Document{{"_id", id}, {"padding", padding}});
+    }
+    const size_t postImageBytes = mockForeignContents.front().getDocument().getApproximateSize();
+    auto mongoProcessInterface =
+        stdx::make_unique<MockMongoInterface>(std::move(mockForeignContents));
+    auto mockMongoInterface = mongoProcessInterface.get();
+    expCtx->mongoProcessInterface = std::move(mongoProcessInterface);
+
+    // Three of the events fit in a batch, but only two of them with one post-image.
+    const int savedBatchSizeBytes = internalChangeStreamPostImageLookupBatchSizeBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalChangeStreamPostImageLookupBatchSizeBytes.store(savedBatchSizeBytes); });
+    internalChangeStreamPostImageLookupBatchSizeBytes.store(static_cast<int>(
+        updates[1].getApproximateSize() + updates[2].getApproximateSize() + postImageBytes + 1));
+
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_TRUE(lookupChangeStage->getNext().isAdvanced());
+    }
+    ASSERT_TRUE(lookupChangeStage->getNext().isEOF());
+    ASSERT_TRUE(mockMongoInterface->lookupBatchSizes == (std::vector<size_t>{1, 2, 1}));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,204 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_shared_oplog_cursor.h"
+
+#include <limits>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document_source_change_stream.h"
+#include "mongo/db/pipeline/shared_oplog_reader.h"
+#include "mongo/db/query/find_common.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Returns the latest timestamp before 'ts'. No oplog entry can fall between the two.
+ */
+Timestamp predecessor(Timestamp ts) {
+    if (ts.getInc() > 0) {
+        return Timestamp(ts.getSecs(), ts.getInc() - 1);
+    }
+    if (ts.getSecs() > 0) {
+        return Timestamp(ts.getSecs() - 1, std::numeric_limits<uint32_t>::max());
+    }
+    return ts;
+}
+
+/**
+ * Mirrors the conditions under which a tailable, awaitData PlanExecutor waits for inserts.
+ */
+bool shouldWaitForInserts(OperationContext* opCtx) {
+    const auto& state = awaitDataState(opCtx);
+    const auto now = opCtx->getServiceContext()->getPreciseClockSource()->now();
+    if (!state.shouldWaitForInserts || !opCtx->checkForInterruptNoAssert().isOK() ||
+        state.waitForInsertsDeadline <= now) {
+        return false;
+    }
+
+    // Return early to inform the client of a new commit point.
+    const auto& clientsCommittedOpTime = clientsLastKnownCommittedOpTime(opCtx);
+    if (!clientsCommittedOpTime.isNull()) {
+        return clientsCommittedOpTime >=
+            repl::ReplicationCoordinator::get(opCtx)->getLastCommittedOpTime();
+    }
+    return true;
+}
+
+}  // namespace
+
+bool DocumentSourceSharedOplogCursor::canUseSharedOplogReader(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    return internalChangeStreamUseSharedOplogReader.load() && !expCtx->inMongos &&
+        !expCtx->explain && expCtx->isTailableAwaitData() &&
+        repl::ReadConcernArgs::get(expCtx->opCtx).getLevel() ==
+        repl::ReadConcernLevel::kMajorityReadConcern;
+}
+
+boost::intrusive_ptr<DocumentSourceSharedOplogCursor> DocumentSourceSharedOplogCursor::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const DocumentSourceOplogMatch& oplogMatch) {
+    // Parse the filter with the pipeline's collation, as the query over the oplog would.
+    auto filter = uassertStatusOK(MatchExpressionParser::parse(oplogMatch.getQuery(), expCtx));
+    const auto after = oplogMatch.isStartFromInclusive()
+        ? predecessor(oplogMatch.getStartFrom())
+        : oplogMatch.getStartFrom();
+    return new DocumentSourceSharedOplogCursor(expCtx, std::move(filter), after);
+}
+
+DocumentSourceSharedOplogCursor::DocumentSourceSharedOplogCursor(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    std::unique_ptr<MatchExpression> filter,
+    Timestamp after)
+    : DocumentSource(expCtx), _filter(std::move(filter)), _after(after) {}
+
+const char* DocumentSourceSharedOplogCursor::getSourceName() const {
+    return "$sharedOplogCursor";
+}
+
+Value DocumentSourceSharedOplogCursor::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    // This stage is never parsed, and is not used for explain.
+    return Value();
+}
+
+DocumentSource::GetNextResult DocumentSourceSharedOplogCursor::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (_currentBatch.empty()) {
+        loadBatch();
+
+        if (_currentBatch.empty())
+            return GetNextResult::makeEOF();
+    }
+
+    Document out(_currentBatch.front());
+    _currentBatch.pop_front();
+    return std::move(out);
+}
+
+void DocumentSourceSharedOplogCursor::loadBatch() {
+    auto opCtx = pExpCtx->opCtx;
+    auto reader = SharedOplogReader::get(opCtx->getServiceContext());
+
+    // As in DocumentSourceCursor, return one entry at a time if the pipeline must see each entry
+    // to decide whether to keep waiting for inserts, or if the latest oplog timestamp reported to
+    // mongos must be that of the last entry returned.
+    const std::size_t maxEntries =
+        (awaitDataState(opCtx).shouldWaitForInserts || pExpCtx->needsMerge)
+        ? 1
+        : std::numeric_limits<std::size_t>::max();
+
+    std::shared_ptr<CappedInsertNotifier> notifier;
+    uint64_t lastEOFVersion = ~0;
+    while (true) {
+        uint64_t currentNotifierVersion;
+        {
+            AutoGetCollectionForRead autoColl(opCtx, NamespaceString::kRsOplogNamespace);
+            uassertStatusOK(repl::ReplicationCoordinator::get(opCtx)->checkCanServeReadsFor(
+                opCtx, NamespaceString::kRsOplogNamespace, true));
+            auto oplog = autoColl.getCollection();
+            if (!oplog) {
+                return;
+            }
+
+            if (!notifier) {
+                notifier = oplog->getCappedInsertNotifier();
+            }
+            currentNotifierVersion = notifier->getVersion();
+
+            auto batch = reader->getNextBatch(opCtx,
+                                              oplog,
+                                              _after,
+                                              *_filter,
+                                              maxEntries,
+                                              internalDocumentSourceCursorBatchSizeBytes.load(),
+                                              _examinedAnyEntry);
+            if (batch.lastExaminedTs) {
+                _after = *batch.lastExaminedTs;
+                _latestOplogTimestamp = *batch.lastExaminedTs;
+                _examinedAnyEntry = true;
+            }
+            for (auto&& entry : batch.entries) {
+                _currentBatch.push_back(std::move(entry));
+            }
+        }
+
+        if (!_currentBatch.empty() || !shouldWaitForInserts(opCtx)) {
+            return;
+        }
+
+        // Like a tailable cursor over the oplog, wait without locks for new entries, and read them
+        // from a new snapshot. The notifier only waits once its version has stopped changing
+        // across two reads that found nothing, so it never waits while entries are available.
+        opCtx->recoveryUnit()->abandonSnapshot();
+        auto curOp = CurOp::get(opCtx);
+        curOp->pauseTimer();
+        ON_BLOCK_EXIT([curOp] { curOp->resumeTimer(); });
+        notifier->waitUntil(lastEOFVersion, awaitDataState(opCtx).waitForInsertsDeadline);
+        lastEOFVersion = currentNotifierVersion;
+        opCtx->checkForInterrupt();
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,106 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/pipeline/document_source.h"
+
+namespace mongo {
+
+class DocumentSourceOplogMatch;
+
+/**
+ * Produces the oplog entries matching a change stream's oplog filter, read through the node's
+ * SharedOplogReader rather than a cursor of its own. Takes the place of the DocumentSourceCursor
+ * over the oplog, and returns the same entries in the same order.
+ */
+class DocumentSourceSharedOplogCursor final : public DocumentSource {
+public:
+    /**
+     * Returns true if the change stream pipeline of 'expCtx' can read the oplog through the shared
+     * reader, which only buffers majority committed entries.
+     */
+    static bool canUseSharedOplogReader(const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    static boost::intrusive_ptr<DocumentSourceSharedOplogCursor> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const DocumentSourceOplogMatch& oplogMatch);
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kAnyShard,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    /**
+     * The timestamp of the last oplog entry examined, whether or not it matched the filter.
+     */
+    Timestamp getLatestOplogTimestamp() const {
+        return _latestOplogTimestamp;
+    }
+
+private:
+    DocumentSourceSharedOplogCursor(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                    std::unique_ptr<MatchExpression> filter,
+                                    Timestamp after);
+
+    void loadBatch();
+
+    const std::unique_ptr<MatchExpression> _filter;
+
+    // The timestamp of the last entry examined. The next batch starts after it.
+    Timestamp _after;
+
+    // Set once an entry has been examined. From then on, the entry at '_after' must remain in the
+    // oplog for the stream to continue, as with a tailable cursor over the oplog.
+    bool _examinedAnyEntry = false;
+
+    Timestamp _latestOplogTimestamp;
+
+    std::deque<BSONObj> _currentBatch;
+};
+
+}  // namespace mongo
@@ -240,6 +240,18 @@ public:
         const Document& documentKey,
         boost::optional<BSONObj> readConcern) = 0;
 
+    /**
+     * Looks up the documents with each of the document keys in 'documentKeys', with the same
+     * semantics as lookupSingleDocument(). Returns a vector with an entry for each key, in the
+     * same order, which is boost::none if no matching document was found.
+     */
+    virtual std::vector<boost::optional<Document>> lookupDocuments(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const NamespaceString& nss,
+        UUID,
+        const std::vector<Document>& documentKeys,
+        boost::optional<BSONObj> readConcern) = 0;
+
     /**
      * Returns a vector of all idle (non-pinned) local cursors.
      */
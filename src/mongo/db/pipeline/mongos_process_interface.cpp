@@ -210,6 +210,21 @@ boost::optional<Document> MongoSInterface::lookupSingleDocument(
     return (!batch.empty() ? Document(batch.front()) : boost::optional<Document>{});
 }
 
+std::vector<boost::optional<Document>> MongoSInterface::lookupDocuments(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const NamespaceString& nss,
+    UUID collectionUUID,
+    const std::vector<Document>& documentKeys,
+    boost::optional<BSONObj> readConcern) {
+    // Each key may be owned by a different shard, so each is looked up with its own targeted find.
+    std::vector<boost::optional<Document>> lookedUpDocuments;
+    for (auto&& documentKey : documentKeys) {
+        lookedUpDocuments.push_back(
+            lookupSingleDocument(expCtx, nss, collectionUUID, documentKey, readConcern));
+    }
+    return lookedUpDocuments;
+}
+
 std::pair<std::vector<FieldPath>, bool> MongoSInterface::collectDocumentKeyFields(
     OperationContext* opCtx, NamespaceStringOrUUID nssOrUUID) const {
 
@@ -60,6 +60,7 @@
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
+#include "mongo/db/pipeline/document_source_shared_oplog_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_sort.h"
 #include "mongo/db/pipeline/pipeline.h"
@@ -283,6 +284,24 @@ void PipelineD::prepareCursorSource(Collection* collection,
     // We are going to generate an input cursor, so we need to be holding the collection lock.
     dassert(expCtx->opCtx->lockState()->isCollectionLockedForMode(nss.ns(), MODE_IS));
 
+    if (!sources.empty()) {
+        if (auto oplogMatch = dynamic_cast<DocumentSourceOplogMatch*>(sources.front().get())) {
+            // Discard the oplog entries of a change stream which cannot produce an event matching
+            // the user's filter before they are transformed into events.
+            oplogMatch->pushDownEventFilters(sources);
+
+            // A change stream reading at the majority commit point shares the node's reader of the
+            // oplog with the other change streams, instead of tailing the oplog with a cursor of
+            // its own.
+            if (DocumentSourceSharedOplogCursor::canUseSharedOplogReader(expCtx)) {
+                auto cursor = DocumentSourceSharedOplogCursor::create(expCtx, *oplogMatch);
+                sources.pop_front();
+                pipeline->addInitialSource(std::move(cursor));
+                return;
+            }
+        }
+    }
+
     if (!sources.empty()) {
         auto sampleStage = dynamic_cast<DocumentSourceSample*>(sources.front().get());
         // Optimize an initial $sample stage if possible.
@@ -759,6 +778,10 @@ Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
         return docSourceCursor->getLatestOplogTimestamp();
     }
+    if (auto sharedOplogCursor =
+            dynamic_cast<DocumentSourceSharedOplogCursor*>(pipeline->_sources.front().get())) {
+        return sharedOplogCursor->getLatestOplogTimestamp();
+    }
     return Timestamp();
 }
 
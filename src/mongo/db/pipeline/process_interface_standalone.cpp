@@ -386,6 +386,97 @@ boost::optional<Document> MongoInterfaceStandalone::lookupSingleDocument(
     return lookedUpDocument;
 }
 
+std::vector<boost::optional<Document>> MongoInterfaceStandalone::lookupDocuments(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    const NamespaceString& nss,
+    UUID collectionUUID,
+    const std::vector<Document>& documentKeys,
+    boost::optional<BSONObj> readConcern) {
+    invariant(!readConcern);  // We don't currently support a read concern on mongod - it's only
+                              // expected to be necessary on mongos.
+
+    std::vector<boost::optional<Document>> lookedUpDocuments(documentKeys.size());
+    if (documentKeys.empty()) {
+        return lookedUpDocuments;
+    }
+
+    // Look up all of the keys with a single query. Keys which consist of only an _id, as they do
+    // for any unsharded collection, are looked up with an $in on the _id index.
+    const bool onlyIds = std::all_of(
+        documentKeys.begin(), documentKeys.end(), [](const Document& documentKey) {
+            return documentKey.size() == 1 && !documentKey["_id"].missing();
+        });
+    BSONArrayBuilder keys;
+    for (auto&& documentKey : documentKeys) {
+        if (onlyIds) {
+            documentKey["_id"].addToBsonArray(&keys);
+        } else {
+            keys.append(documentKey.toBson());
+        }
+    }
+    auto filter = onlyIds ? BSON("_id" << BSON("$in" << keys.arr())) : BSON("$or" << keys.arr());
+
+    intrusive_ptr<ExpressionContext> foreignExpCtx;
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+    try {
+        // Be sure to do the lookup using the collection default collation
+        foreignExpCtx = expCtx->copyWith(
+            nss,
+            collectionUUID,
+            _getCollectionDefaultCollator(expCtx->opCtx, nss.db(), collectionUUID));
+        pipeline = uassertStatusOK(makePipeline({BSON("$match" << filter)}, foreignExpCtx));
+    } catch (const ExceptionFor<ErrorCodes::NamespaceNotFound>&) {
+        return lookedUpDocuments;
+    }
+
+    // Map each distinct key to the positions at which it was requested, comparing keys with the
+    // collation the query used. Keys of one collection usually all have the same fields, but a
+    // collection which becomes sharded gains shard key fields.
+    auto positionsByKey =
+        foreignExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<std::vector<std::string>> keyShapes;
+    for (size_t i = 0; i < documentKeys.size(); ++i) {
+        positionsByKey[Value(documentKeys[i])].push_back(i);
+
+        std::vector<std::string> keyShape;
+        for (auto it = documentKeys[i].fieldIterator(); it.more();) {
+            keyShape.push_back(it.next().first.toString());
+        }
+        if (std::find(keyShapes.begin(), keyShapes.end(), keyShape) == keyShapes.end()) {
+            keyShapes.push_back(std::move(keyShape));
+        }
+    }
+
+    while (auto lookedUpDocument = pipeline->getNext()) {
+        for (auto&& keyShape : keyShapes) {
+            MutableDocument key;
+            for (auto&& fieldName : keyShape) {
+                // The fields of a document key are paths, which are dotted for a shard key on a
+                // field of an embedded document.
+                key.addField(fieldName, lookedUpDocument->getNestedField(FieldPath(fieldName)));
+            }
+            auto positions = positionsByKey.find(Value(key.freeze()));
+            if (positions == positionsByKey.end()) {
+                continue;
+            }
+            for (auto position : positions->second) {
+                if (auto& previous = lookedUpDocuments[position]) {
+                    uasserted(ErrorCodes::TooManyMatchingDocuments,
+                              str::stream() << "found more than one document with document key "
+                                            << documentKeys[position].toString()
+                                            << " ["
+                                            << previous->toString()
+                                            << ", "
+                                            << lookedUpDocument->toString()
+                                            << "]");
+                }
+                lookedUpDocuments[position] = *lookedUpDocument;
+            }
+        }
+    }
+    return lookedUpDocuments;
+}
+
 BackupCursorState MongoInterfaceStandalone::openBackupCursor(OperationContext* opCtx) {
     auto backupCursorHooks = BackupCursorHooks::get(opCtx->getServiceContext());
     if (backupCursorHooks->enabled()) {
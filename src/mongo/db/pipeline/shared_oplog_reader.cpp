@@ -0,0 +1,279 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/shared_oplog_reader.h"
+
+#include <algorithm>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getSharedOplogReader = ServiceContext::declareDecoration<SharedOplogReader>();
+
+Counter64 oplogEntriesRead;
+Counter64 privateOplogEntriesRead;
+Counter64 entriesServedFromBuffer;
+
+// The largest number of entries copied out of the buffer at once.
+const std::size_t kMaxEntriesPerCopy = 1024;
+
+ServerStatusMetricField<Counter64> displayOplogEntriesRead(
+    "changeStreams.sharedOplogReader.oplogEntriesRead", &oplogEntriesRead);
+ServerStatusMetricField<Counter64> displayPrivateOplogEntriesRead(
+    "changeStreams.sharedOplogReader.privateOplogEntriesRead", &privateOplogEntriesRead);
+ServerStatusMetricField<Counter64> displayEntriesServedFromBuffer(
+    "changeStreams.sharedOplogReader.entriesServedFromBuffer", &entriesServedFromBuffer);
+
+/**
+ * Reads the entries after 'after' from the oplog, until roughly 'maxBytes' have been read.
+ */
+std::vector<BSONObj> readOplog(OperationContext* opCtx,
+                               Collection* oplog,
+                               Timestamp after,
+                               int maxBytes,
+                               bool failIfPositionLost) {
+    auto recordStore = oplog->getRecordStore();
+    auto cursor = recordStore->getCursor(opCtx);
+    boost::optional<Record> record;
+    const auto startId =
+        recordStore->oplogStartHack(opCtx, uassertStatusOK(oploghack::keyForOptime(after)));
+    if (!startId) {
+        // This storage engine cannot seek in the oplog, so scan it from the start.
+        record = cursor->next();
+    } else if (startId->isNull()) {
+        // Every entry in the oplog is after 'after'.
+        uassert(ErrorCodes::CappedPositionLost,
+                str::stream() << "The oplog no longer contains the entry at " << after.toString(),
+                !failIfPositionLost);
+        record = cursor->next();
+    } else {
+        record = cursor->seekExact(*startId);
+        uassert(ErrorCodes::CappedPositionLost,
+                str::stream() << "The oplog no longer contains the entry at " << after.toString(),
+                record);
+    }
+
+    std::vector<BSONObj> entries;
+    int bytes = 0;
+    for (; record && bytes < maxBytes; record = cursor->next()) {
+        auto obj = record->data.releaseToBson();
+        if (obj["ts"].timestamp() <= after) {
+            continue;
+        }
+        bytes += obj.objsize();
+        entries.push_back(obj.getOwned());
+    }
+    return entries;
+}
+
+}  // namespace
+
+SharedOplogReader* SharedOplogReader::get(ServiceContext* service) {
+    return &getSharedOplogReader(service);
+}
+
+SharedOplogReader::Batch SharedOplogReader::getNextBatch(OperationContext* opCtx,
+                                                         Collection* oplog,
+                                                         Timestamp after,
+                                                         const MatchExpression& filter,
+                                                         std::size_t maxEntries,
+                                                         int maxBytes,
+                                                         bool failIfPositionLost) {
+    invariant(maxEntries > 0);
+
+    // Entries are copied out of the buffer in chunks, so that a caller wanting few entries does
+    // not copy many more under the mutex only to discard them.
+    const std::size_t maxEntriesPerCopy = std::min(maxEntries, kMaxEntriesPerCopy);
+
+    std::vector<BSONObj> candidates;
+    auto position = _copyFromBuffer(after, maxEntriesPerCopy, maxBytes, &candidates);
+    if ((position == Position::kInBuffer && candidates.empty()) || position == Position::kAhead) {
+        _refill(opCtx, oplog, after, maxBytes, failIfPositionLost);
+        position = _copyFromBuffer(after, maxEntriesPerCopy, maxBytes, &candidates);
+    }
+
+    if (position != Position::kInBuffer) {
+        // The caller has fallen behind the buffer, or is ahead of a buffer still in use by other
+        // callers. Leave the buffer to the callers that keep up with it.
+        candidates = readOplog(opCtx, oplog, after, maxBytes, failIfPositionLost);
+        privateOplogEntriesRead.increment(candidates.size());
+    }
+
+    Batch batch;
+    int bytes = 0;
+    while (true) {
+        for (auto&& entry : candidates) {
+            bytes += entry.objsize();
+            batch.lastExaminedTs = entry["ts"].timestamp();
+            if (filter.matchesBSON(entry)) {
+                batch.entries.push_back(std::move(entry));
+                if (batch.entries.size() == maxEntries) {
+                    return batch;
+                }
+            }
+        }
+
+        // Entries read privately are not copied in chunks. Stop once the buffer runs out of
+        // entries or evicts the next one.
+        if (position != Position::kInBuffer || bytes >= maxBytes) {
+            return batch;
+        }
+        candidates.clear();
+        position = _copyFromBuffer(
+            *batch.lastExaminedTs, maxEntriesPerCopy, maxBytes - bytes, &candidates);
+        if (candidates.empty()) {
+            return batch;
+        }
+    }
+}
+
+SharedOplogReader::Stats SharedOplogReader::getStats() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return {_entries.size(), _bytes, _coveredAfter, _coveredTo, _oplogEntriesRead};
+}
+
+SharedOplogReader::Position SharedOplogReader::_copyFromBuffer(Timestamp after,
+                                                               std::size_t maxEntries,
+                                                               int maxBytes,
+                                                               std::vector<BSONObj>* out) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_coveredTo || after > *_coveredTo) {
+        return Position::kAhead;
+    }
+    if (after < *_coveredAfter) {
+        return Position::kBehind;
+    }
+    _inUse = true;
+
+    auto it = std::upper_bound(
+        _entries.begin(), _entries.end(), after, [](const Timestamp& ts, const Entry& entry) {
+            return ts < entry.ts;
+        });
+    int bytes = 0;
+    std::size_t numEntries = 0;
+    for (; it != _entries.end() && numEntries < maxEntries && bytes < maxBytes; ++it) {
+        bytes += it->obj.objsize();
+        out->push_back(it->obj);
+        ++numEntries;
+    }
+    entriesServedFromBuffer.increment(numEntries);
+    return Position::kInBuffer;
+}
+
+void SharedOplogReader::_refill(OperationContext* opCtx,
+                                Collection* oplog,
+                                Timestamp after,
+                                int maxBytes,
+                                bool failIfPositionLost) {
+    stdx::lock_guard<stdx::mutex> refillLk(_refillMutex);
+    const long long maxBufferBytes = internalChangeStreamSharedOplogBufferSizeBytes.load();
+    const int maxReadBytes = std::min<long long>(maxBytes, maxBufferBytes / 2);
+
+    // Only one caller reads at a time, so the end of the buffer cannot move during the read.
+    bool restart = false;
+    Timestamp readFrom = after;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (!_coveredTo) {
+            restart = true;
+        } else if (after < *_coveredTo) {
+            // A concurrent caller buffered the entries after 'after' while this one waited.
+            return;
+        } else if (after > *_coveredTo) {
+            // The buffer ends before 'after'. If other callers still read from it, extend it
+            // towards 'after' instead of pulling it away from them. Otherwise restart it at
+            // 'after' rather than read the entries in between, which no caller is waiting for.
+            if (_inUse) {
+                readFrom = *_coveredTo;
+            } else {
+                restart = true;
+            }
+            _inUse = false;
+        }
+    }
+
+    std::vector<BSONObj> entries;
+    if (!restart) {
+        try {
+            entries = readOplog(opCtx,
+                                oplog,
+                                readFrom,
+                                maxReadBytes,
+                                readFrom != after || failIfPositionLost);
+        } catch (const ExceptionFor<ErrorCodes::CappedPositionLost>&) {
+            // The end of the buffer is no longer in the oplog, so the buffer cannot be extended.
+            if (readFrom == after) {
+                throw;
+            }
+            restart = true;
+        }
+    }
+    if (restart) {
+        entries = readOplog(opCtx, oplog, after, maxReadBytes, failIfPositionLost);
+    }
+    oplogEntriesRead.increment(entries.size());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (restart) {
+        _entries.clear();
+        _bytes = 0;
+        _coveredAfter = after;
+        _coveredTo = after;
+    }
+    _oplogEntriesRead += entries.size();
+    for (auto&& obj : entries) {
+        const auto ts = obj["ts"].timestamp();
+        _bytes += obj.objsize();
+        _entries.push_back({ts, std::move(obj)});
+        _coveredTo = ts;
+    }
+    while (_bytes > maxBufferBytes && !_entries.empty()) {
+        _coveredAfter = _entries.front().ts;
+        _bytes -= _entries.front().obj.objsize();
+        _entries.pop_front();
+    }
+}
+
+}  // namespace mongo
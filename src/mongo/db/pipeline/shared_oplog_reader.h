@@ -0,0 +1,160 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class Collection;
+class MatchExpression;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * A reader of the oplog shared by all of the change streams on a node.
+ *
+ * Without it, every change stream tails the oplog with its own cursor, so a node serving many
+ * streams reads each oplog entry once per stream. The shared reader keeps a bounded buffer of the
+ * most recent oplog entries: the first stream to reach the end of the buffer reads the next
+ * entries from the oplog and appends them, and every other stream is served from the buffer. Each
+ * stream still applies its own filter to the entries it is given.
+ *
+ * Streams that fall behind the start of the buffer read the oplog with a private cursor until they
+ * catch up, so a slow stream never holds entries in memory on behalf of the others.
+ */
+class SharedOplogReader {
+    MONGO_DISALLOW_COPYING(SharedOplogReader);
+
+public:
+    struct Batch {
+        // The entries that matched the filter, in timestamp order.
+        std::vector<BSONObj> entries;
+
+        // The timestamp of the last entry examined, whether or not it matched. Every entry up to
+        // and including it has been examined.
+        boost::optional<Timestamp> lastExaminedTs;
+    };
+
+    struct Stats {
+        // The number of buffered entries and their total size.
+        std::size_t numEntries;
+        long long bytes;
+
+        // The buffer holds every oplog entry in (coveredAfter, coveredTo].
+        boost::optional<Timestamp> coveredAfter;
+        boost::optional<Timestamp> coveredTo;
+
+        // The number of entries read from the oplog into the buffer.
+        long long oplogEntriesRead;
+    };
+
+    SharedOplogReader() = default;
+
+    static SharedOplogReader* get(ServiceContext* service);
+
+    /**
+     * Returns the oplog entries after 'after' that match 'filter', in timestamp order. Stops after
+     * 'maxEntries' matching entries or once roughly 'maxBytes' of entries have been examined.
+     * Returns an empty batch without 'lastExaminedTs' if there are no entries after 'after' yet.
+     *
+     * The caller must hold a lock on 'oplog' and read at the majority commit point, so that
+     * entries buffered on behalf of other streams can never be rolled back. If
+     * 'failIfPositionLost' is true, throws CappedPositionLost if the oplog no longer contains
+     * the entry at 'after'.
+     */
+    Batch getNextBatch(OperationContext* opCtx,
+                       Collection* oplog,
+                       Timestamp after,
+                       const MatchExpression& filter,
+                       std::size_t maxEntries,
+                       int maxBytes,
+                       bool failIfPositionLost);
+
+    Stats getStats();
+
+private:
+    struct Entry {
+        Timestamp ts;
+        BSONObj obj;
+    };
+
+    enum class Position { kBehind, kInBuffer, kAhead };
+
+    /**
+     * Appends up to 'maxEntries' and roughly 'maxBytes' of the buffered entries after 'after' to
+     * 'out' and returns kInBuffer if the buffer holds every entry after 'after'. Otherwise,
+     * returns whether 'after' is before or after the buffered entries.
+     */
+    Position _copyFromBuffer(Timestamp after,
+                             std::size_t maxEntries,
+                             int maxBytes,
+                             std::vector<BSONObj>* out);
+
+    /**
+     * Reads the entries after 'after' from the oplog into the buffer. Does nothing if a concurrent
+     * caller has already buffered entries after 'after' while this caller waited.
+     *
+     * If 'after' is beyond the end of the buffer, the buffer is extended from its end while other
+     * callers read from it, and only restarted at 'after' once it is no longer in use.
+     */
+    void _refill(OperationContext* opCtx,
+                 Collection* oplog,
+                 Timestamp after,
+                 int maxBytes,
+                 bool failIfPositionLost);
+
+    // Serializes reads from the oplog into the buffer, so that each entry is read once.
+    stdx::mutex _refillMutex;
+
+    // Protects the members below.
+    stdx::mutex _mutex;
+
+    // Every oplog entry with a timestamp in (_coveredAfter, _coveredTo], in timestamp order.
+    std::deque<Entry> _entries;
+    boost::optional<Timestamp> _coveredAfter;
+    boost::optional<Timestamp> _coveredTo;
+    long long _bytes = 0;
+    long long _oplogEntriesRead = 0;
+
+    // Set whenever a caller is served from the buffer, and cleared when a caller beyond its end
+    // extends it. The buffer is only restarted if no caller was served from it in between.
+    bool _inUse = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,318 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/shared_oplog_reader.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/repl/replication_coordinator_mock.h"
+#include "mongo/db/repl/storage_interface_impl.h"
+#include "mongo/db/service_context_d_test_fixture.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int kNumEntries = 100;
+
+Timestamp entryTs(int i) {
+    return Timestamp(1, i);
+}
+
+BSONObj makeEntry(int i) {
+    return BSON("ts" << entryTs(i) << "t" << 1LL << "h" << 0LL << "v" << 2 << "op"
+                     << "n"
+                     << "ns"
+                     << ""
+                     << "o"
+                     << BSON("i" << i)
+                     << "pad"
+                     << std::string(100, 'x'));
+}
+
+// Every entry has the same size.
+const int kEntrySize = makeEntry(1).objsize();
+
+class SharedOplogReaderTest : public ServiceContextMongoDTest {
+protected:
+    void setUp() override {
+        ServiceContextMongoDTest::setUp();
+        _savedBufferSizeBytes = internalChangeStreamSharedOplogBufferSizeBytes.load();
+
+        auto service = getServiceContext();
+        repl::ReplicationCoordinator::set(
+            service, stdx::make_unique<repl::ReplicationCoordinatorMock>(service));
+
+        auto opCtx = makeOperationContext();
+        repl::StorageInterfaceImpl storage;
+        CollectionOptions options;
+        options.capped = true;
+        options.cappedSize = 64 * 1024 * 1024LL;
+        options.autoIndexId = CollectionOptions::NO;
+        ASSERT_OK(storage.createCollection(
+            opCtx.get(), NamespaceString::kRsOplogNamespace, options));
+        for (int i = 1; i <= kNumEntries; ++i) {
+            ASSERT_OK(storage.insertDocument(opCtx.get(),
+                                             NamespaceString::kRsOplogNamespace,
+                                             {makeEntry(i), entryTs(i)},
+                                             1));
+        }
+
+        _matchAll = parseFilter(BSONObj());
+    }
+
+    void tearDown() override {
+        internalChangeStreamSharedOplogBufferSizeBytes.store(_savedBufferSizeBytes);
+        ServiceContextMongoDTest::tearDown();
+    }
+
+    std::unique_ptr<MatchExpression> parseFilter(const BSONObj& filter) {
+        boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+        return uassertStatusOK(MatchExpressionParser::parse(filter, expCtx));
+    }
+
+    SharedOplogReader::Batch getNextBatch(Timestamp after,
+                                          int maxBytes,
+                                          const MatchExpression* filter = nullptr,
+                                          std::size_t maxEntries = kNumEntries) {
+        // Called from the threads of the test as well, each with its own Client.
+        auto opCtx = cc().makeOperationContext();
+        AutoGetCollection oplog(opCtx.get(), NamespaceString::kRsOplogNamespace, MODE_IS);
+        return _reader.getNextBatch(opCtx.get(),
+                                    oplog.getCollection(),
+                                    after,
+                                    filter ? *filter : *_matchAll,
+                                    maxEntries,
+                                    maxBytes,
+                                    false /* failIfPositionLost */);
+    }
+
+    /**
+     * Returns the value of 'o.i' of each entry of 'batch'.
+     */
+    static std::vector<int> entryNumbers(const SharedOplogReader::Batch& batch) {
+        std::vector<int> numbers;
+        for (auto&& entry : batch.entries) {
+            numbers.push_back(entry["o"]["i"].numberInt());
+        }
+        return numbers;
+    }
+
+    static std::vector<int> range(int first, int last) {
+        std::vector<int> numbers;
+        for (int i = first; i <= last; ++i) {
+            numbers.push_back(i);
+        }
+        return numbers;
+    }
+
+    SharedOplogReader _reader;
+    std::unique_ptr<MatchExpression> _matchAll;
+
+private:
+    int _savedBufferSizeBytes;
+};
+
+TEST_F(SharedOplogReaderTest, ReturnsMatchingEntriesInOrder) {
+    auto evenEntries = parseFilter(fromjson("{'o.i': {$mod: [2, 0]}}"));
+
+    std::vector<int> numbers;
+    Timestamp after = entryTs(0);
+    while (true) {
+        auto batch = getNextBatch(after, 1024 * 1024, evenEntries.get(), 7);
+        if (!batch.lastExaminedTs) {
+            ASSERT_TRUE(batch.entries.empty());
+            break;
+        }
+        ASSERT_LTE(batch.entries.size(), 7U);
+        ASSERT_GT(*batch.lastExaminedTs, after);
+        after = *batch.lastExaminedTs;
+        for (int i : entryNumbers(batch)) {
+            numbers.push_back(i);
+        }
+    }
+
+    std::vector<int> expected;
+    for (int i = 2; i <= kNumEntries; i += 2) {
+        expected.push_back(i);
+    }
+    ASSERT(numbers == expected);
+    ASSERT_EQ(after, entryTs(kNumEntries));
+
+    // Every entry was read from the oplog once.
+    ASSERT_EQ(_reader.getStats().oplogEntriesRead, kNumEntries);
+}
+
+TEST_F(SharedOplogReaderTest, ReturnsOneMatchingEntryAtATime) {
+    auto everyTenthEntry = parseFilter(fromjson("{'o.i': {$mod: [10, 0]}}"));
+
+    // Entries are copied out of the buffer one at a time until one matches, and the entries after
+    // it are examined by the next call.
+    Timestamp after = entryTs(0);
+    for (int i = 10; i <= 50; i += 10) {
+        auto batch = getNextBatch(after, 1024 * 1024, everyTenthEntry.get(), 1);
+        ASSERT(entryNumbers(batch) == std::vector<int>({i}));
+        ASSERT_EQ(*batch.lastExaminedTs, entryTs(i));
+        after = *batch.lastExaminedTs;
+    }
+}
+
+TEST_F(SharedOplogReaderTest, BufferInUseExtendsTowardsCallerAheadOfIt) {
+    auto batch = getNextBatch(entryTs(0), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(1, 5));
+
+    // The buffer was just read from, so it is extended up to the caller instead of being moved.
+    batch = getNextBatch(entryTs(8), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(9, 10));
+    auto stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(0));
+    ASSERT_EQ(*stats.coveredTo, entryTs(10));
+    ASSERT_EQ(stats.numEntries, 10U);
+    ASSERT_EQ(stats.oplogEntriesRead, 10);
+
+    // A caller too far ahead for one read to reach it still extends the buffer, and reads the
+    // oplog on its own.
+    batch = getNextBatch(entryTs(50), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(51, 55));
+    stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(0));
+    ASSERT_EQ(*stats.coveredTo, entryTs(15));
+    ASSERT_EQ(stats.oplogEntriesRead, 15);
+}
+
+TEST_F(SharedOplogReaderTest, BufferNoLongerInUseRestartsAtCallerAheadOfIt) {
+    auto batch = getNextBatch(entryTs(0), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(1, 5));
+    batch = getNextBatch(entryTs(50), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(51, 55));
+
+    // No caller was served from the buffer since it was last extended, so the entries between its
+    // end and the caller are not read.
+    batch = getNextBatch(entryTs(50), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(51, 55));
+    auto stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(50));
+    ASSERT_EQ(*stats.coveredTo, entryTs(55));
+    ASSERT_EQ(stats.numEntries, 5U);
+    ASSERT_EQ(stats.bytes, 5 * kEntrySize);
+    ASSERT_EQ(stats.oplogEntriesRead, 15);
+
+    // The caller left behind by the restart reads the oplog on its own and leaves the buffer
+    // alone.
+    batch = getNextBatch(entryTs(5), 5 * kEntrySize);
+    ASSERT(entryNumbers(batch) == range(6, 10));
+    stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(50));
+    ASSERT_EQ(*stats.coveredTo, entryTs(55));
+    ASSERT_EQ(stats.oplogEntriesRead, 15);
+}
+
+TEST_F(SharedOplogReaderTest, OldestEntriesAreEvicted) {
+    internalChangeStreamSharedOplogBufferSizeBytes.store(20 * kEntrySize);
+
+    // Each refill reads half of the buffer.
+    Timestamp after = entryTs(0);
+    for (int i = 0; i < kNumEntries / 10; ++i) {
+        auto batch = getNextBatch(after, 1024 * 1024);
+        ASSERT(entryNumbers(batch) == range(10 * i + 1, 10 * i + 10));
+        after = *batch.lastExaminedTs;
+
+        const auto stats = _reader.getStats();
+        ASSERT_LTE(stats.bytes, 20 * kEntrySize);
+        ASSERT_EQ(*stats.coveredTo, after);
+    }
+
+    auto stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(kNumEntries - 20));
+    ASSERT_EQ(stats.numEntries, 20U);
+    ASSERT_EQ(stats.oplogEntriesRead, kNumEntries);
+    ASSERT_FALSE(getNextBatch(after, 1024 * 1024).lastExaminedTs);
+
+    // A caller at the start of the buffer is still served from it.
+    auto batch = getNextBatch(entryTs(kNumEntries - 20), 1024 * 1024);
+    ASSERT(entryNumbers(batch) == range(kNumEntries - 19, kNumEntries));
+
+    // A caller behind the buffer reads the evicted entries from the oplog on its own.
+    batch = getNextBatch(entryTs(5), 1024 * 1024);
+    ASSERT(entryNumbers(batch) == range(6, kNumEntries));
+    stats = _reader.getStats();
+    ASSERT_EQ(*stats.coveredAfter, entryTs(kNumEntries - 20));
+    ASSERT_EQ(*stats.coveredTo, entryTs(kNumEntries));
+    ASSERT_EQ(stats.oplogEntriesRead, kNumEntries);
+}
+
+TEST_F(SharedOplogReaderTest, ConcurrentCallersReadEachEntryOnce) {
+    internalChangeStreamSharedOplogBufferSizeBytes.store(64 * 1024 * 1024);
+
+    const int kNumThreads = 8;
+    std::vector<std::vector<int>> numbers(kNumThreads);
+    std::vector<stdx::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([&, t] {
+            ThreadClient tc("SharedOplogReaderTest", getServiceContext());
+            Timestamp after = entryTs(0);
+            while (after < entryTs(kNumEntries)) {
+                auto batch = getNextBatch(after, 3 * kEntrySize);
+                if (batch.lastExaminedTs) {
+                    after = *batch.lastExaminedTs;
+                }
+                for (int i : entryNumbers(batch)) {
+                    numbers[t].push_back(i);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < kNumThreads; ++t) {
+        ASSERT(numbers[t] == range(1, kNumEntries)) << "thread " << t;
+    }
+    const auto stats = _reader.getStats();
+    ASSERT_EQ(stats.oplogEntriesRead, kNumEntries);
+    ASSERT_EQ(stats.numEntries, static_cast<std::size_t>(kNumEntries));
+}
+
+}  // namespace
+}  // namespace mongo
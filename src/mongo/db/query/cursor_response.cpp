@@ -35,6 +35,7 @@
 #include "mongo/db/query/cursor_response.h"
 
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/query/getmore_request.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 
 namespace mongo {
@@ -273,10 +274,95 @@ void CursorResponse::addToBSON(CursorResponse::ResponseType responseType,
     }
 }
 
+void CursorResponse::addToReply(CursorResponse::ResponseType responseType,
+                                rpc::ReplyBuilderInterface* reply) const {
+    if (!reply->documentSequencesSupported()) {
+        auto bob = reply->getBodyBuilder();
+        addToBSON(responseType, &bob);
+        return;
+    }
+
+    CursorResponseBuilder::Options options;
+    options.isInitialResponse = (responseType == ResponseType::InitialResponse);
+    options.useDocumentSequences = true;
+    CursorResponseBuilder batchBuilder(reply, options);
+    for (const BSONObj& obj : _batch) {
+        batchBuilder.append(obj);
+    }
+    if (_latestOplogTimestamp) {
+        batchBuilder.setLatestOplogTimestamp(*_latestOplogTimestamp);
+    }
+    batchBuilder.done(_cursorId, _nss.ns());
+
+    auto bob = reply->getBodyBuilder();
+    bob.append("ok", 1.0);
+    if (_writeConcernError) {
+        bob.append("writeConcernError", *_writeConcernError);
+    }
+}
+
 BSONObj CursorResponse::toBSON(CursorResponse::ResponseType responseType) const {
     BSONObjBuilder builder;
     addToBSON(responseType, &builder);
     return builder.obj();
 }
 
+boost::optional<BSONObj> getNextExhaustInvocation(const OpMsgRequest& request,
+                                                  const BSONObj& reply) {
+    const auto commandName = request.getCommandName();
+    const bool isFind = (commandName == "find"_sd);
+    if (!isFind && commandName != "getMore"_sd) {
+        return boost::none;
+    }
+
+    // The batches of tailable cursors and of cursors opened in a multi-statement transaction are
+    // only returned when the client asks for them.
+    if (isFind && (request.body["tailable"].trueValue() || request.body.hasField("txnNumber"))) {
+        return boost::none;
+    }
+
+    if (reply["ok"].number() != 1.0) {
+        return boost::none;
+    }
+
+    // A cursor id of 0 indicates that the cursor is exhausted, in which case this reply ends the
+    // stream.
+    const auto cursorObj = reply.getObjectField(kCursorField);
+    const auto cursorId = cursorObj[kIdField].numberLong();
+    const auto cursorNs = cursorObj[kNsField].str();
+    if (cursorId == 0 || cursorNs.empty()) {
+        return boost::none;
+    }
+
+    if (!isFind) {
+        return request.body.getOwned();
+    }
+
+    boost::optional<std::int64_t> batchSize;
+    if (auto batchSizeElem = request.body["batchSize"]) {
+        if (batchSizeElem.isNumber() && batchSizeElem.numberLong() > 0) {
+            batchSize = batchSizeElem.numberLong();
+        }
+    }
+
+    BSONObjBuilder bob(GetMoreRequest(NamespaceString(cursorNs),
+                                      cursorId,
+                                      batchSize,
+                                      boost::none,   // awaitDataTimeout
+                                      boost::none,   // term
+                                      boost::none)  // lastKnownCommittedOpTime
+                           .toBSON());
+    bob.append("$db", request.getDatabase());
+
+    // Carry over the generic arguments of the find that apply to each of its getMores. The find's
+    // 'maxTimeMS' is a deadline for the find alone, and getMore only accepts one for the awaitData
+    // cursors of tailable finds, which are not continued. getMore does not accept 'comment'.
+    for (auto fieldName : {"lsid"_sd, "$readPreference"_sd, "$clusterTime"_sd, "$audit"_sd}) {
+        if (auto elem = request.body[fieldName]) {
+            bob.append(elem);
+        }
+    }
+    return bob.obj();
+}
+
 }  // namespace mongo
@@ -253,6 +253,12 @@ public:
         return toBSON(ResponseType::InitialResponse);
     }
 
+    /**
+     * Appends this response to 'reply'. The batch goes into a document sequence if the client
+     * supports them, and into the body otherwise.
+     */
+    void addToReply(ResponseType responseType, rpc::ReplyBuilderInterface* reply) const;
+
 private:
     NamespaceString _nss;
     CursorId _cursorId;
@@ -262,4 +268,14 @@ private:
     boost::optional<BSONObj> _writeConcernError;
 };
 
+/**
+ * Returns the body of the getMore to run next on behalf of a client that sent 'request' with the
+ * OP_MSG exhaustAllowed flag and is about to receive 'reply', so that the remaining batches can be
+ * streamed to it without waiting for another request. Returns boost::none if the command failed,
+ * if its cursor is exhausted, or if 'request' isn't a find or getMore that may be continued this
+ * way.
+ */
+boost::optional<BSONObj> getNextExhaustInvocation(const OpMsgRequest& request,
+                                                  const BSONObj& reply);
+
 }  // namespace mongo
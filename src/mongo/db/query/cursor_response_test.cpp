@@ -32,10 +32,14 @@
 
 #include "mongo/db/query/cursor_response.h"
 
+#include "mongo/db/query/getmore_request.h"
+
 #include "mongo/rpc/op_msg_rpc_impls.h"
 
 #include "mongo/unittest/unittest.h"
 
+#include "mongo/util/uuid.h"
+
 namespace mongo {
 
 namespace {
@@ -360,6 +364,97 @@ TEST(CursorResponseTest, cursorReturnDocumentSequences) {
     ASSERT_BSONOBJ_EQ(opMsg.body, expectedBody);
 }
 
+TEST(CursorResponseTest, addToReplyUsesDocumentSequencesIfSupported) {
+    std::vector<BSONObj> batch = {BSON("_id" << 1), BSON("_id" << 2)};
+    CursorResponse response(NamespaceString("db.coll"),
+                            CursorId(123),
+                            batch,
+                            boost::none,
+                            Timestamp(1, 2),
+                            BSON("code" << 64 << "errmsg"
+                                        << "waiting for replication timed out"));
+
+    rpc::OpMsgReplyBuilder builder;
+    builder.setDocumentSequencesSupported(true);
+    response.addToReply(CursorResponse::ResponseType::SubsequentResponse, &builder);
+
+    auto msg = builder.done();
+    auto opMsg = OpMsg::parse(msg);
+    ASSERT_EQ(opMsg.sequences.size(), 1U);
+    ASSERT_EQ(opMsg.sequences[0].name, "cursor.nextBatch");
+    ASSERT_EQ(opMsg.sequences[0].objs.size(), 2U);
+    ASSERT_BSONOBJ_EQ(opMsg.sequences[0].objs[0], batch[0]);
+    ASSERT_BSONOBJ_EQ(opMsg.sequences[0].objs[1], batch[1]);
+    ASSERT_BSONOBJ_EQ(opMsg.body,
+                      BSON("cursor" << BSON("id" << CursorId(123) << "ns"
+                                                 << "db.coll")
+                                    << "$_internalLatestOplogTimestamp"
+                                    << Timestamp(1, 2)
+                                    << "ok"
+                                    << 1.0
+                                    << "writeConcernError"
+                                    << BSON("code" << 64 << "errmsg"
+                                                   << "waiting for replication timed out")));
+}
+
+TEST(CursorResponseTest, addToReplyUsesArrayIfDocumentSequencesUnsupported) {
+    CursorResponse response(
+        NamespaceString("db.coll"), CursorId(123), {BSON("_id" << 1), BSON("_id" << 2)});
+
+    rpc::OpMsgReplyBuilder builder;
+    response.addToReply(CursorResponse::ResponseType::InitialResponse, &builder);
+
+    auto msg = builder.done();
+    auto opMsg = OpMsg::parse(msg);
+    ASSERT(opMsg.sequences.empty());
+    ASSERT_BSONOBJ_EQ(opMsg.body, response.toBSON(CursorResponse::ResponseType::InitialResponse));
+}
+
+TEST(CursorResponseTest, exhaustGetMoreForFindKeepsGenericArguments) {
+    const auto lsid = BSON("id" << UUID::gen());
+    const auto readPreference = BSON("mode"
+                                     << "secondaryPreferred");
+    const auto clusterTime = BSON("clusterTime" << Timestamp(1, 2));
+    auto request = OpMsgRequest::fromDBAndBody("db",
+                                               BSON("find"
+                                                    << "coll"
+                                                    << "batchSize"
+                                                    << 2
+                                                    << "maxTimeMS"
+                                                    << 1000
+                                                    << "comment"
+                                                    << "exhaust"
+                                                    << "lsid"
+                                                    << lsid
+                                                    << "$readPreference"
+                                                    << readPreference
+                                                    << "$clusterTime"
+                                                    << clusterTime));
+    const auto reply = BSON("cursor" << BSON("id" << CursorId(123) << "ns"
+                                                  << "db.coll"
+                                                  << "firstBatch"
+                                                  << BSONArray())
+                                     << "ok"
+                                     << 1.0);
+
+    auto getMore = getNextExhaustInvocation(request, reply);
+    ASSERT(getMore);
+    ASSERT_BSONOBJ_EQ(*getMore,
+                      BSON("getMore" << CursorId(123) << "collection"
+                                     << "coll"
+                                     << "batchSize"
+                                     << 2LL
+                                     << "$db"
+                                     << "db"
+                                     << "lsid"
+                                     << lsid
+                                     << "$readPreference"
+                                     << readPreference
+                                     << "$clusterTime"
+                                     << clusterTime));
+    ASSERT_OK(GetMoreRequest::parseFromBSON("db", *getMore).getStatus());
+}
+
 }  // namespace
 
 }  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/db/query/plan_cache.h"
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 
 #include <algorithm>
@@ -157,14 +158,16 @@ bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
 // CachedSolution
 //
 
-CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& entry)
+CachedSolution::CachedSolution(const PlanCacheKey& key,
+                               const PlanCacheEntry& entry,
+                               size_t decisionWorks)
     : plannerData(entry.plannerData.size()),
       key(key),
       query(entry.query.getOwned()),
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
       collation(entry.collation.getOwned()),
-      decisionWorks(entry.works) {
+      decisionWorks(decisionWorks) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -354,12 +357,37 @@ std::string SolutionCacheData::toString() const {
 
 PlanCache::PlanCache() : PlanCache(internalQueryCacheSize.load()) {}
 
-PlanCache::PlanCache(size_t size) : _cache(size) {}
+PlanCache::PlanCache(size_t size) {
+    const size_t numPartitions =
+        std::max<size_t>(1, std::min(kMaxPartitions, size / kMinEntriesPerPartition));
+    _partitions.reserve(numPartitions);
+
+    // The first 'size % numPartitions' partitions take one extra entry, so that the partitions
+    // together hold exactly 'size' entries.
+    boost::alignment::aligned_allocator<AlignedPartition> allocator;
+    for (size_t i = 0; i < numPartitions; ++i) {
+        const size_t partitionSize = size / numPartitions + (i < size % numPartitions ? 1 : 0);
+        AlignedPartition* partition = allocator.allocate(1);
+        try {
+            new (partition) AlignedPartition(partitionSize);
+        } catch (...) {
+            allocator.deallocate(partition, 1);
+            throw;
+        }
+        _partitions.emplace_back(partition);
+    }
+}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : PlanCache(internalQueryCacheSize.load()) {
+    _ns = ns;
+}
 
 PlanCache::~PlanCache() {}
 
+PlanCache::Partition& PlanCache::_getPartition(const PlanCacheKey& key) const {
+    return *_partitions[PlanCacheKeyHasher()(key) % _partitions.size()];
+}
+
 std::unique_ptr<CachedSolution> PlanCache::getCacheEntryIfActive(const PlanCacheKey& key) const {
 
     PlanCache::GetResult res = get(key);
@@ -477,46 +505,15 @@ Status PlanCache::set(const CanonicalQuery& query,
 
     const auto key = computeKey(query);
     const size_t newWorks = why->stats[0]->common.works;
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    bool isNewEntryActive = false;
-    uint32_t queryHash;
-    uint32_t planCacheKey;
-    if (internalQueryCacheDisableInactiveEntries.load()) {
-        // All entries are always active.
-        isNewEntryActive = true;
-        planCacheKey = canonical_query_encoder::computeHash(key.stringData());
-        queryHash = canonical_query_encoder::computeHash(key.getStableKeyStringData());
-    } else {
-        PlanCacheEntry* oldEntry = nullptr;
-        Status cacheStatus = _cache.get(key, &oldEntry);
-        invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
-        if (oldEntry) {
-            queryHash = oldEntry->queryHash;
-            planCacheKey = oldEntry->planCacheKey;
-        } else {
-            planCacheKey = canonical_query_encoder::computeHash(key.stringData());
-            queryHash = canonical_query_encoder::computeHash(key.getStableKeyStringData());
-        }
-
-        const auto newState = getNewEntryState(
-            query,
-            queryHash,
-            planCacheKey,
-            oldEntry,
-            newWorks,
-            worksGrowthCoefficient.get_value_or(internalQueryCacheWorksGrowthCoefficient));
-
-        if (!newState.shouldBeCreated) {
-            return Status::OK();
-        }
-        isNewEntryActive = newState.shouldBeActive;
-    }
+    const uint32_t planCacheKey = canonical_query_encoder::computeHash(key.stringData());
+    const uint32_t queryHash = canonical_query_encoder::computeHash(key.getStableKeyStringData());
 
-    auto newEntry = std::make_unique<PlanCacheEntry>(solns, why.release(), queryHash, planCacheKey);
+    // Build the new entry before taking the partition lock. Its 'isActive' and 'works' values
+    // depend on the current entry for this shape and are filled in under the lock.
+    auto newEntry = std::make_shared<PlanCacheEntry>(solns, why.release(), queryHash, planCacheKey);
     const QueryRequest& qr = query.getQueryRequest();
     newEntry->query = qr.getFilter().getOwned();
     newEntry->sort = qr.getSort().getOwned();
-    newEntry->isActive = isNewEntryActive;
     newEntry->works = newWorks;
     if (query.getCollator()) {
         newEntry->collation = query.getCollator()->getSpec().toBSON();
@@ -534,11 +531,40 @@ Status PlanCache::set(const CanonicalQuery& query,
     }
     newEntry->projection = projBuilder.obj();
 
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(key, newEntry.release());
+    // The evicted entry, if any, is destroyed after the partition lock is released.
+    std::unique_ptr<std::shared_ptr<PlanCacheEntry>> evictedEntry;
+    {
+        auto& partition = _getPartition(key);
+        stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+        if (internalQueryCacheDisableInactiveEntries.load()) {
+            // All entries are always active.
+            newEntry->isActive = true;
+        } else {
+            std::shared_ptr<PlanCacheEntry>* oldEntry = nullptr;
+            Status cacheStatus = partition.cache.get(key, &oldEntry);
+            invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
+
+            const auto newState = getNewEntryState(
+                query,
+                queryHash,
+                planCacheKey,
+                oldEntry ? oldEntry->get() : nullptr,
+                newWorks,
+                worksGrowthCoefficient.get_value_or(internalQueryCacheWorksGrowthCoefficient));
+
+            if (!newState.shouldBeCreated) {
+                return Status::OK();
+            }
+            newEntry->isActive = newState.shouldBeActive;
+        }
 
-    if (NULL != evictedEntry.get()) {
+        evictedEntry =
+            partition.cache.add(key, new std::shared_ptr<PlanCacheEntry>(std::move(newEntry)));
+    }
+
+    if (evictedEntry) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
-               << "removed least recently used entry " << redact(evictedEntry->toString());
+               << "removed least recently used entry " << redact((*evictedEntry)->toString());
     }
 
     return Status::OK();
@@ -551,15 +577,16 @@ void PlanCache::deactivate(const CanonicalQuery& query) {
     }
 
     PlanCacheKey key = computeKey(query);
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry = nullptr;
-    Status cacheStatus = _cache.get(key, &entry);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+    std::shared_ptr<PlanCacheEntry>* entry = nullptr;
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         invariant(cacheStatus == ErrorCodes::NoSuchKey);
         return;
     }
     invariant(entry);
-    entry->isActive = false;
+    (*entry)->isActive = false;
 }
 
 PlanCache::GetResult PlanCache::get(const CanonicalQuery& query) const {
@@ -568,47 +595,64 @@ PlanCache::GetResult PlanCache::get(const CanonicalQuery& query) const {
 }
 
 PlanCache::GetResult PlanCache::get(const PlanCacheKey& key) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry = nullptr;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        invariant(cacheStatus == ErrorCodes::NoSuchKey);
-        return {CacheEntryState::kNotPresent, nullptr};
+    std::shared_ptr<const PlanCacheEntry> entry;
+    bool isActive;
+    size_t works;
+    {
+        auto& partition = _getPartition(key);
+        stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+        std::shared_ptr<PlanCacheEntry>* found = nullptr;
+        Status cacheStatus = partition.cache.get(key, &found);
+        if (!cacheStatus.isOK()) {
+            invariant(cacheStatus == ErrorCodes::NoSuchKey);
+            return {CacheEntryState::kNotPresent, nullptr};
+        }
+        invariant(found);
+        entry = *found;
+        isActive = entry->isActive;
+        works = entry->works;
     }
-    invariant(entry);
 
-    auto state =
-        entry->isActive ? CacheEntryState::kPresentActive : CacheEntryState::kPresentInactive;
-    return {state, stdx::make_unique<CachedSolution>(key, *entry)};
+    // The planner data is immutable, so the deep copy is made without holding the partition lock.
+    auto state = isActive ? CacheEntryState::kPresentActive : CacheEntryState::kPresentInactive;
+    return {state, stdx::make_unique<CachedSolution>(key, *entry, works)};
 }
 
 Status PlanCache::feedback(const CanonicalQuery& cq, double score) {
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    auto& partition = _getPartition(ck);
+    stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+    std::shared_ptr<PlanCacheEntry>* entry;
+    Status cacheStatus = partition.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
     invariant(entry);
 
     // We store up to a constant number of feedback entries.
-    if (entry->feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
-        entry->feedback.push_back(score);
+    auto& feedback = (*entry)->feedback;
+    if (feedback.size() < static_cast<size_t>(internalQueryCacheFeedbacksStored.load())) {
+        feedback.push_back(score);
     }
 
     return Status::OK();
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+    return partition.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    // Every entry added before clear() was called is gone once it returns. Entries added
+    // concurrently may survive, as they would if they had been added just after clear().
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> partitionLock(partition->mutex);
+        partition->cache.clear();
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -622,32 +666,39 @@ PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
 StatusWith<std::unique_ptr<PlanCacheEntry>> PlanCache::getEntry(const CanonicalQuery& query) const {
     PlanCacheKey key = computeKey(query);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    auto& partition = _getPartition(key);
+    stdx::lock_guard<stdx::mutex> partitionLock(partition.mutex);
+    std::shared_ptr<PlanCacheEntry>* entry;
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
     invariant(entry);
 
-    return std::unique_ptr<PlanCacheEntry>(entry->clone());
+    return std::unique_ptr<PlanCacheEntry>((*entry)->clone());
 }
 
 std::vector<std::unique_ptr<PlanCacheEntry>> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<std::unique_ptr<PlanCacheEntry>> entries;
 
-    for (auto&& cacheEntry : _cache) {
-        auto entry = cacheEntry.second;
-        entries.push_back(std::unique_ptr<PlanCacheEntry>(entry->clone()));
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> partitionLock(partition->mutex);
+        for (auto&& cacheEntry : partition->cache) {
+            const auto& entry = *cacheEntry.second;
+            entries.push_back(std::unique_ptr<PlanCacheEntry>(entry->clone()));
+        }
     }
 
     return entries;
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> partitionLock(partition->mutex);
+        size += partition->cache.size();
+    }
+    return size;
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
@@ -658,13 +709,15 @@ std::vector<BSONObj> PlanCache::getMatchingStats(
     const std::function<BSONObj(const PlanCacheEntry&)>& serializationFunc,
     const std::function<bool(const BSONObj&)>& filterFunc) const {
     std::vector<BSONObj> results;
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
 
-    for (auto&& cacheEntry : _cache) {
-        const auto entry = cacheEntry.second;
-        auto serializedEntry = serializationFunc(*entry);
-        if (filterFunc(serializedEntry)) {
-            results.push_back(serializedEntry);
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> partitionLock(partition->mutex);
+        for (auto&& cacheEntry : partition->cache) {
+            const auto& entry = *cacheEntry.second;
+            auto serializedEntry = serializationFunc(*entry);
+            if (filterFunc(serializedEntry)) {
+                results.push_back(serializedEntry);
+            }
         }
     }
 
@@ -30,7 +30,9 @@
 
 #pragma once
 
+#include <boost/align/aligned_delete.hpp>
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
 
 #include "mongo/db/exec/plan_stats.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -245,7 +248,11 @@ private:
     MONGO_DISALLOW_COPYING(CachedSolution);
 
 public:
-    CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& entry);
+    /**
+     * Copies the planner data and query shape out of 'entry'. The 'works' value of 'entry' may be
+     * changed concurrently, so the caller passes the value it read under the cache lock.
+     */
+    CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& entry, size_t decisionWorks);
     ~CachedSolution();
 
     // Owned here.
@@ -306,6 +313,9 @@ public:
     // Data provided to the planner to allow it to recreate the solutions this entry
     // represents. Each SolutionCacheData is fully owned here, so in order to return
     // it from the cache a deep copy is made and returned inside CachedSolution.
+    //
+    // The planner data and the query shape below are never modified once the entry is in the
+    // cache, so they may be read without holding the cache lock.
     std::vector<SolutionCacheData*> plannerData;
 
     // TODO: Do we really want to just hold a copy of the CanonicalQuery?  For now we just
@@ -500,7 +510,8 @@ public:
     StatusWith<std::unique_ptr<PlanCacheEntry>> getEntry(const CanonicalQuery& cq) const;
 
     /**
-     * Returns a vector of all cache entries.
+     * Returns a vector of all cache entries. Entries are grouped by partition, and are ordered
+     * from most to least recently used within each partition.
      * Used by planCacheListQueryShapes and index_filter_commands_test.cpp.
      */
     std::vector<std::unique_ptr<PlanCacheEntry>> getAllEntries() const;
@@ -544,10 +555,33 @@ private:
                                    size_t newWorks,
                                    double growthCoefficient);
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> _cache;
+    // The cache is split into at most this many partitions, each with its own mutex and LRU
+    // list, so that lookups of different query shapes do not contend with each other.
+    static const size_t kMaxPartitions = 16;
+
+    // Caches too small to give every partition this many entries use fewer partitions. This
+    // keeps the eviction order of small caches close to that of a single LRU list.
+    static const size_t kMinEntriesPerPartition = 64;
+
+    // Entries are shared so that a lookup can copy the solution out of an entry after it has
+    // released the partition lock, even if the entry is evicted or replaced in the meantime.
+    using EntryCache =
+        LRUKeyValue<PlanCacheKey, std::shared_ptr<PlanCacheEntry>, PlanCacheKeyHasher>;
+
+    struct Partition {
+        explicit Partition(size_t size) : cache(size) {}
+
+        // Protects 'cache' and the performance stats of the entries in it.
+        stdx::mutex mutex;
+        EntryCache cache;
+    };
+
+    Partition& _getPartition(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    // Partitions are allocated individually because their mutexes can't be moved, and with an
+    // aligned allocator because operator new ignores the over-alignment of CacheAligned.
+    using AlignedPartition = CacheAligned<Partition>;
+    std::vector<std::unique_ptr<AlignedPartition, boost::alignment::aligned_delete>> _partitions;
 
     // Full namespace of collection.
     std::string _ns;
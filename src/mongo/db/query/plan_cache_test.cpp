@@ -586,6 +586,67 @@ TEST(PlanCacheTest, PlanCacheFlushDeletesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
 }
 
+TEST(PlanCacheTest, PartitionedCacheListsAndClearsEveryEntry) {
+    // The default cache size is large enough to use several partitions.
+    PlanCache planCache;
+    QueryTestServiceContext serviceContext;
+
+    const size_t kNumShapes = 200;
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < kNumShapes; ++i) {
+        queries.push_back(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        addCacheEntryForShape(*queries.back(), &planCache);
+    }
+    ASSERT_EQ(planCache.size(), kNumShapes);
+
+    auto entries = planCache.getAllEntries();
+    ASSERT_EQ(entries.size(), kNumShapes);
+    for (auto&& cq : queries) {
+        const BSONObj& filter = cq->getQueryRequest().getFilter();
+        ASSERT_EQ(1,
+                  std::count_if(entries.begin(), entries.end(), [&](const auto& entry) {
+                      return SimpleBSONObjComparator::kInstance.evaluate(entry->query == filter);
+                  }));
+        ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+    }
+
+    planCache.clear();
+    ASSERT_EQ(planCache.size(), 0U);
+    ASSERT(planCache.getAllEntries().empty());
+    for (auto&& cq : queries) {
+        ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
+    }
+}
+
+TEST(PlanCacheTest, PartitionedCacheRespectsMaximumSize) {
+    const size_t kCacheSize = 128;
+    PlanCache planCache(kCacheSize);
+    QueryTestServiceContext serviceContext;
+
+    unique_ptr<CanonicalQuery> cq;
+    for (size_t i = 0; i < 1000; ++i) {
+        cq = canonicalize(BSON(("a" + std::to_string(i)) << 1));
+        addCacheEntryForShape(*cq, &planCache);
+        ASSERT_LTE(planCache.size(), kCacheSize);
+    }
+
+    // The most recently added entry is never the one evicted.
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+}
+
+TEST(PlanCacheTest, PartitionedCacheHoldsExactlyMaximumSize) {
+    // Not a multiple of the number of partitions.
+    const size_t kCacheSize = 131;
+    PlanCache planCache(kCacheSize);
+    QueryTestServiceContext serviceContext;
+
+    for (size_t i = 0; i < 2000; ++i) {
+        auto cq = canonicalize(BSON(("a" + std::to_string(i)) << 1));
+        addCacheEntryForShape(*cq, &planCache);
+    }
+    ASSERT_EQ(planCache.size(), kCacheSize);
+}
+
 TEST(PlanCacheTest, AddActiveCacheEntry) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -1095,7 +1156,7 @@ protected:
         uint32_t queryHash = canonical_query_encoder::computeHash(ck.stringData());
         uint32_t planCacheKey = queryHash;
         PlanCacheEntry entry(solutions, createDecision(1U).release(), queryHash, planCacheKey);
-        CachedSolution cachedSoln(ck, entry);
+        CachedSolution cachedSoln(ck, entry, entry.works);
 
         auto statusWithQs = QueryPlanner::planFromCache(*scopedCq, params, cachedSoln);
         ASSERT_OK(statusWithQs.getStatus());
@@ -118,4 +118,37 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalChangeStreamUseSharedOplogReader, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalChangeStreamSharedOplogBufferSizeBytes,
+                              int,
+                              32 * 1024 * 1024)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1024 * 1024) {
+            return Status(ErrorCodes::BadValue,
+                          "internalChangeStreamSharedOplogBufferSizeBytes must be >= 1MB");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(internalChangeStreamPostImageLookupBatchSize, int, 100)
+    ->withValidator([](const int& newVal) {
+        if (newVal <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          "internalChangeStreamPostImageLookupBatchSize must be > 0");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(internalChangeStreamPostImageLookupBatchSizeBytes,
+                              int,
+                              16 * 1024 * 1024)
+    ->withValidator([](const int& newVal) {
+        if (newVal <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          "internalChangeStreamPostImageLookupBatchSizeBytes must be > 0");
+        }
+        return Status::OK();
+    });
 }  // namespace mongo
@@ -139,4 +139,17 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
+
+// Whether change streams read the oplog through the node's shared oplog reader.
+extern AtomicBool internalChangeStreamUseSharedOplogReader;
+
+// The number of bytes of recent oplog entries buffered by the shared oplog reader.
+extern AtomicInt32 internalChangeStreamSharedOplogBufferSizeBytes;
+
+// The maximum number of change events whose post-images are looked up together.
+extern AtomicInt32 internalChangeStreamPostImageLookupBatchSize;
+
+// The approximate number of bytes of change events read into a batch whose post-images are looked
+// up together.
+extern AtomicInt32 internalChangeStreamPostImageLookupBatchSizeBytes;
 }  // namespace mongo
@@ -55,6 +55,13 @@ const auto kInsertGroupMaxBatchSize = insertVectorMaxBytes;
 // Limit number of ops in a single group.
 constexpr auto kInsertGroupMaxBatchCount = 64;
 
+// Limit number of ops applied in a single WriteUnitOfWork.
+constexpr auto kUpdateDeleteGroupMaxBatchCount = 64;
+
+bool isUpdateOrDelete(const OplogEntry& entry) {
+    return entry.getOpType() == OpTypeEnum::kUpdate || entry.getOpType() == OpTypeEnum::kDelete;
+}
+
 }  // namespace
 
 // static
@@ -217,5 +224,77 @@ StatusWith<InsertGroup::ConstIterator> InsertGroup::groupAndApplyInserts(ConstIt
     MONGO_UNREACHABLE;
 }
 
+using UpdateDeleteGroup = ApplierHelpers::UpdateDeleteGroup;
+
+UpdateDeleteGroup::UpdateDeleteGroup(ApplierHelpers::OperationPtrs* ops,
+                                     OperationContext* opCtx,
+                                     UpdateDeleteGroup::Mode mode)
+    : _doNotGroupBeforePoint(ops->cbegin()), _end(ops->cend()), _opCtx(opCtx), _mode(mode) {}
+
+StatusWith<UpdateDeleteGroup::ConstIterator> UpdateDeleteGroup::groupAndApplyUpdatesAndDeletes(
+    ConstIterator it) {
+    const auto& entry = **it;
+
+    // The following conditions must be met before attempting to group the oplog entries starting
+    // at 'it':
+    // 1) The CRUD operation must be an update or a delete;
+    // 2) The namespace cannot be a capped collection;
+    // 3) We have not attempted to group this operation during a previous call to this function.
+    if (!isUpdateOrDelete(entry)) {
+        return Status(ErrorCodes::TypeMismatch, "Can only group update and delete operations.");
+    }
+    if (entry.isForCappedCollection) {
+        return Status(ErrorCodes::InvalidOptions,
+                      "Cannot group update and delete operations on capped collections.");
+    }
+    if (it <= _doNotGroupBeforePoint) {
+        return Status(ErrorCodes::InvalidPath,
+                      "Cannot group an operation that we previously attempted to group.");
+    }
+
+    // Find the first op that can't be added to the group. Updates and deletes may be mixed; they
+    // are applied in their original order.
+    auto batchCount = OperationPtrs::size_type(1);
+    auto endOfGroupableOpsIterator =
+        std::find_if(it + 1, _end, [&](const OplogEntry* nextEntry) -> bool {
+            batchCount += 1;
+            return !isUpdateOrDelete(*nextEntry)            // Must be an update or a delete.
+                || nextEntry->getNss() != entry.getNss()    // Must be in the same namespace.
+                || nextEntry->getUuid() != entry.getUuid()  // Must be the same collection.
+                || batchCount > kUpdateDeleteGroupMaxBatchCount;  // Limit ops in a single group.
+        });
+
+    // See if we were able to create a group that contains more than a single op.
+    if (std::distance(it, endOfGroupableOpsIterator) == 1) {
+        return Status(ErrorCodes::NoSuchKey,
+                      "Not able to create a group with more than a single update or delete");
+    }
+
+    try {
+        // Apply the group in a single WriteUnitOfWork.
+        uassertStatusOK(
+            SyncTail::syncApplyUpdatesAndDeletes(_opCtx, it, endOfGroupableOpsIterator, _mode));
+        return endOfGroupableOpsIterator - 1;
+    } catch (...) {
+        // The group failed, so fall through to the application of individual ops. Errors such as
+        // a missing document during initial sync are handled there.
+        auto status = exceptionToStatus().withContext(
+            str::stream() << "Error applying " << std::distance(it, endOfGroupableOpsIterator)
+                          << " updates and deletes as a group. Trying first operation on its own: "
+                          << redact(entry.raw));
+
+        // The operations report their own errors, if any, when applied individually.
+        LOG(1) << status;
+
+        // Avoid quadratic run time from a failed group by not retrying until we are beyond this
+        // group of ops.
+        _doNotGroupBeforePoint = endOfGroupableOpsIterator - 1;
+
+        return status;
+    }
+
+    MONGO_UNREACHABLE;
+}
+
 }  // namespace repl
 }  // namespace mongo
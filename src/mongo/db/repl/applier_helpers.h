@@ -53,6 +53,7 @@ public:
     static void stableSortByNamespace(OperationPtrs* oplogEntryPointers);
 
     class InsertGroup;
+    class UpdateDeleteGroup;
 };
 
 /**
@@ -90,5 +91,39 @@ private:
     Mode _mode;
 };
 
+/**
+ * Groups consecutive update and delete operations on the same collection and applies them in a
+ * single WriteUnitOfWork, looking the collection up once for the whole group.
+ * Advances the MultiApplier::OperationPtrs iterator if the group is applied successfully.
+ */
+class ApplierHelpers::UpdateDeleteGroup {
+    MONGO_DISALLOW_COPYING(UpdateDeleteGroup);
+
+public:
+    using ConstIterator = OperationPtrs::const_iterator;
+    using Mode = OplogApplication::Mode;
+
+    UpdateDeleteGroup(OperationPtrs* ops, OperationContext* opCtx, Mode mode);
+
+    /**
+     * Attempts to group update and delete operations starting at 'iter'.
+     * If the group is applied successfully, returns the iterator to the last operation included
+     * in the group.
+     */
+    StatusWith<ConstIterator> groupAndApplyUpdatesAndDeletes(ConstIterator oplogEntriesIterator);
+
+private:
+    // Marks the final op of a failed group. Operations up to this point are applied individually
+    // so that a failing group is not retried.
+    ConstIterator _doNotGroupBeforePoint;
+
+    // Used for constructing search bounds when grouping operations.
+    ConstIterator _end;
+
+    // Passed to SyncTail::syncApplyUpdatesAndDeletes when applying a group.
+    OperationContext* _opCtx;
+    Mode _mode;
+};
+
 }  // namespace repl
 }  // namespace mongo
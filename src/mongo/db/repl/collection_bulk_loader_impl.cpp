@@ -56,20 +56,14 @@ namespace repl {
 
 CollectionBulkLoaderImpl::CollectionBulkLoaderImpl(ServiceContext::UniqueClient&& client,
                                                    ServiceContext::UniqueOperationContext&& opCtx,
-                                                   std::unique_ptr<AutoGetCollection>&& autoColl,
+                                                   const NamespaceString& nss,
                                                    const BSONObj& idIndexSpec)
     : _client{std::move(client)},
       _opCtx{std::move(opCtx)},
-      _autoColl{std::move(autoColl)},
-      _nss{_autoColl->getCollection()->ns()},
-      _idIndexBlock(
-          std::make_unique<MultiIndexBlockImpl>(_opCtx.get(), _autoColl->getCollection())),
-      _secondaryIndexesBlock(
-          std::make_unique<MultiIndexBlockImpl>(_opCtx.get(), _autoColl->getCollection())),
+      _nss{nss},
       _idIndexSpec(idIndexSpec.getOwned()) {
 
     invariant(_opCtx);
-    invariant(_autoColl->getCollection());
 }
 
 CollectionBulkLoaderImpl::~CollectionBulkLoaderImpl() {
@@ -78,34 +72,40 @@ CollectionBulkLoaderImpl::~CollectionBulkLoaderImpl() {
 }
 
 Status CollectionBulkLoaderImpl::init(const std::vector<BSONObj>& secondaryIndexSpecs) {
-    return _runTaskReleaseResourcesOnFailure(
-        [ coll = _autoColl->getCollection(), &secondaryIndexSpecs, this ]()->Status {
-            // All writes in CollectionBulkLoaderImpl should be unreplicated.
-            // The opCtx is accessed indirectly through _secondaryIndexesBlock.
-            UnreplicatedWritesBlock uwb(_opCtx.get());
-            std::vector<BSONObj> specs(secondaryIndexSpecs);
-            // This enforces the buildIndexes setting in the replica set configuration.
-            _secondaryIndexesBlock->removeExistingIndexes(&specs);
-            if (specs.size()) {
-                _secondaryIndexesBlock->ignoreUniqueConstraint();
-                auto status = _secondaryIndexesBlock->init(specs).getStatus();
-                if (!status.isOK()) {
-                    return status;
-                }
-            } else {
-                _secondaryIndexesBlock.reset();
+    return _runTaskReleaseResourcesOnFailure([&secondaryIndexSpecs, this]() -> Status {
+        // All writes in CollectionBulkLoaderImpl should be unreplicated.
+        // The opCtx is accessed indirectly through _secondaryIndexesBlock.
+        UnreplicatedWritesBlock uwb(_opCtx.get());
+        AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
+        auto coll = autoColl.getCollection();
+        invariant(coll);
+
+        _idIndexBlock = std::make_unique<MultiIndexBlockImpl>(_opCtx.get(), coll);
+        _secondaryIndexesBlock = std::make_unique<MultiIndexBlockImpl>(_opCtx.get(), coll);
+
+        std::vector<BSONObj> specs(secondaryIndexSpecs);
+        // This enforces the buildIndexes setting in the replica set configuration.
+        _secondaryIndexesBlock->removeExistingIndexes(&specs);
+        if (specs.size()) {
+            _secondaryIndexesBlock->ignoreUniqueConstraint();
+            auto status = _secondaryIndexesBlock->init(specs).getStatus();
+            if (!status.isOK()) {
+                return status;
             }
-            if (!_idIndexSpec.isEmpty()) {
-                auto status = _idIndexBlock->init(_idIndexSpec).getStatus();
-                if (!status.isOK()) {
-                    return status;
-                }
-            } else {
-                _idIndexBlock.reset();
+        } else {
+            _secondaryIndexesBlock.reset();
+        }
+        if (!_idIndexSpec.isEmpty()) {
+            auto status = _idIndexBlock->init(_idIndexSpec).getStatus();
+            if (!status.isOK()) {
+                return status;
             }
+        } else {
+            _idIndexBlock.reset();
+        }
 
-            return Status::OK();
-        });
+        return Status::OK();
+    });
 }
 
 Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::const_iterator begin,
@@ -113,6 +113,9 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
     int count = 0;
     return _runTaskReleaseResourcesOnFailure([&]() -> Status {
         UnreplicatedWritesBlock uwb(_opCtx.get());
+        AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
+        auto coll = autoColl.getCollection();
+        invariant(coll);
 
         for (auto iter = begin; iter != end; ++iter) {
             Status status = writeConflictRetry(
@@ -125,16 +128,16 @@ Status CollectionBulkLoaderImpl::insertDocuments(const std::vector<BSONObj>::con
                         auto onRecordInserted = [&](const RecordId& loc) {
                             return _addDocumentToIndexBlocks(doc, loc);
                         };
-                        const auto status = _autoColl->getCollection()->insertDocumentForBulkLoader(
-                            _opCtx.get(), doc, onRecordInserted);
+                        const auto status =
+                            coll->insertDocumentForBulkLoader(_opCtx.get(), doc, onRecordInserted);
                         if (!status.isOK()) {
                             return status;
                         }
                     } else {
                         // For capped collections, we use regular insertDocument, which will update
                         // pre-existing indexes.
-                        const auto status = _autoColl->getCollection()->insertDocument(
-                            _opCtx.get(), InsertStatement(doc), nullptr);
+                        const auto status =
+                            coll->insertDocument(_opCtx.get(), InsertStatement(doc), nullptr);
                         if (!status.isOK()) {
                             return status;
                         }
@@ -160,6 +163,9 @@ Status CollectionBulkLoaderImpl::commit() {
         _stats.startBuildingIndexes = Date_t::now();
         LOG(2) << "Creating indexes for ns: " << _nss.ns();
         UnreplicatedWritesBlock uwb(_opCtx.get());
+        AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
+        auto coll = autoColl.getCollection();
+        invariant(coll);
 
         // Commit before deleting dups, so the dups will be removed from secondary indexes when
         // deleted.
@@ -193,14 +199,14 @@ Status CollectionBulkLoaderImpl::commit() {
 
             for (auto&& it : dups) {
                 writeConflictRetry(
-                    _opCtx.get(), "CollectionBulkLoaderImpl::commit", _nss.ns(), [this, &it] {
+                    _opCtx.get(), "CollectionBulkLoaderImpl::commit", _nss.ns(), [this, coll, &it] {
                         WriteUnitOfWork wunit(_opCtx.get());
-                        _autoColl->getCollection()->deleteDocument(_opCtx.get(),
-                                                                   kUninitializedStmtId,
-                                                                   it,
-                                                                   nullptr /** OpDebug **/,
-                                                                   false /* fromMigrate */,
-                                                                   true /* noWarn */);
+                        coll->deleteDocument(_opCtx.get(),
+                                             kUninitializedStmtId,
+                                             it,
+                                             nullptr /** OpDebug **/,
+                                             false /* fromMigrate */,
+                                             true /* noWarn */);
                         wunit.commit();
                     });
             }
@@ -222,20 +228,15 @@ Status CollectionBulkLoaderImpl::commit() {
 
 void CollectionBulkLoaderImpl::_releaseResources() {
     invariant(&cc() == _opCtx->getClient());
-    if (_secondaryIndexesBlock) {
-        // A valid Client is required to drop unfinished indexes.
-        Client::initThreadIfNotAlready();
-        _secondaryIndexesBlock.reset();
-    }
-
-    if (_idIndexBlock) {
-        // A valid Client is required to drop unfinished indexes.
-        Client::initThreadIfNotAlready();
-        _idIndexBlock.reset();
+    if (!_secondaryIndexesBlock && !_idIndexBlock) {
+        return;
     }
 
-    // release locks.
-    _autoColl.reset();
+    // A valid Client and the collection lock are required to drop unfinished indexes.
+    Client::initThreadIfNotAlready();
+    AutoGetCollection autoColl(_opCtx.get(), _nss, MODE_IX);
+    _secondaryIndexesBlock.reset();
+    _idIndexBlock.reset();
 }
 
 template <typename F>
@@ -47,6 +47,10 @@ namespace repl {
 /**
  * Class in charge of building a collection during data loading (like initial sync).
  *
+ * The collection is only locked while one of the methods below works on it, not for the lifetime
+ * of the loader. Loaders for other collections of the same database can therefore be created,
+ * which locks the database exclusively, while this one is in use.
+ *
  * Note: Call commit when done inserting documents.
  */
 class CollectionBulkLoaderImpl : public CollectionBulkLoader {
@@ -63,7 +67,7 @@ public:
 
     CollectionBulkLoaderImpl(ServiceContext::UniqueClient&& client,
                              ServiceContext::UniqueOperationContext&& opCtx,
-                             std::unique_ptr<AutoGetCollection>&& autoColl,
+                             const NamespaceString& nss,
                              const BSONObj& idIndexSpec);
     virtual ~CollectionBulkLoaderImpl();
 
@@ -91,7 +95,6 @@ private:
 
     ServiceContext::UniqueClient _client;
     ServiceContext::UniqueOperationContext _opCtx;
-    std::unique_ptr<AutoGetCollection> _autoColl;
     NamespaceString _nss;
     std::unique_ptr<MultiIndexBlock> _idIndexBlock;
     std::unique_ptr<MultiIndexBlock> _secondaryIndexesBlock;
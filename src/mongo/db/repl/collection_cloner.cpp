@@ -34,6 +34,8 @@
 
 #include "mongo/db/repl/collection_cloner.h"
 
+#include <algorithm>
+#include <system_error>
 #include <utility>
 
 #include "mongo/base/string_data.h"
@@ -41,6 +43,7 @@
 #include "mongo/client/dbclient_connection.h"
 #include "mongo/client/remote_command_retry_scheduler.h"
 #include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/client.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/repl/oplogreader.h"
@@ -48,6 +51,7 @@
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/fail_point_service.h"
@@ -75,6 +79,35 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
 // Whether to use the "exhaust cursor" feature when retrieving collection data.
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(collectionClonerUsesExhaust, bool, true);
+
+// The maximum number of cursors, each over its own _id range, used to clone a single collection.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncCollectionClonerCursors, int, 1)
+    ->withValidator([](const int& numCursors) {
+        return (numCursors >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream()
+                         << "maxNumInitialSyncCollectionClonerCursors must be greater than or "
+                            "equal to 1. '"
+                         << numCursors
+                         << "' is an invalid setting.");
+    });
+
+// The minimum number of documents for each cursor of a collection cloned over several _id ranges.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionClonerMinDocumentsPerCursor, int, 100000)
+    ->withValidator([](const int& numDocuments) {
+        return (numDocuments >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream() << "initialSyncCollectionClonerMinDocumentsPerCursor must be "
+                                      "greater than or equal to 1. '"
+                                   << numDocuments
+                                   << "' is an invalid setting.");
+    });
+
+// The number of _id values sampled from the sync source for each cursor when choosing the
+// boundaries of the _id ranges.
+const int kIdSamplesPerCursor = 20;
 }  // namespace
 
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
@@ -266,6 +299,9 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_queryState == QueryState::kRunning) {
         _queryState = QueryState::kCanceling;
         _clientConnection->shutdownAndDisallowReconnect();
+        for (auto&& connection : _idRangeConnections) {
+            connection->shutdownAndDisallowReconnect();
+        }
     } else {
         _queryState = QueryState::kFinished;
     }
@@ -552,13 +588,196 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
     auto onCompletionGuard =
         std::make_shared<OnCompletionGuard>(cancelRemainingWorkInLock, finishCallbackFn);
 
+    const auto splitKeys = _getIdRangeSplitKeys();
+    bool queriesSucceeded = true;
+    if (splitKeys.empty()) {
+        queriesSucceeded = _runIdRangeQuery(_clientConnection.get(), Query(), onCompletionGuard);
+    } else {
+        log() << "CollectionCloner ns:" << _destNss << " cloning " << splitKeys.size() + 1
+              << " _id ranges concurrently";
+        {
+            LockGuard lk(_mutex);
+            _stats.cursors = splitKeys.size() + 1;
+        }
+
+        // Every range but the first is fetched by its own thread over its own connection. The
+        // documents of all ranges are inserted through the same collection loader.
+        std::vector<stdx::thread> idRangeThreads;
+        std::vector<char> idRangeResults(splitKeys.size(), false);
+        try {
+            for (size_t i = 1; i <= splitKeys.size(); ++i) {
+                idRangeThreads.emplace_back(
+                    [this, i, &splitKeys, &idRangeResults, onCompletionGuard] {
+                        idRangeResults[i - 1] = _runIdRangeThread(
+                            i, _makeIdRangeQuery(splitKeys, i), onCompletionGuard);
+                    });
+            }
+        } catch (const std::system_error& e) {
+            // Cancel the ranges whose threads did start, and wait for them below.
+            LockGuard lk(_mutex);
+            onCompletionGuard->setResultAndCancelRemainingWork_inlock(
+                lk,
+                {ErrorCodes::UnknownError,
+                 str::stream() << "Failed to start a thread cloning an _id range of collection '"
+                               << _sourceNss.ns()
+                               << "': "
+                               << e.what()});
+        }
+        if (idRangeThreads.size() == splitKeys.size()) {
+            queriesSucceeded = _runIdRangeQuery(
+                _clientConnection.get(), _makeIdRangeQuery(splitKeys, 0), onCompletionGuard);
+        } else {
+            queriesSucceeded = false;
+        }
+        for (auto&& thread : idRangeThreads) {
+            thread.join();
+        }
+        queriesSucceeded = queriesSucceeded &&
+            std::all_of(idRangeResults.begin(), idRangeResults.end(), [](char ok) { return ok; });
+    }
+    if (!queriesSucceeded) {
+        return;
+    }
+    waitForDbWorker();
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, Status::OK());
+}
+
+std::vector<BSONObj> CollectionCloner::_getIdRangeSplitKeys() {
+    long long documentsToCopy = 0;
+    {
+        LockGuard lk(_mutex);
+        documentsToCopy = _stats.documentToCopy;
+    }
+    const long long minDocumentsPerCursor = initialSyncCollectionClonerMinDocumentsPerCursor.load();
+    const long long numCursors = std::min<long long>(
+        maxNumInitialSyncCollectionClonerCursors.load(), documentsToCopy / minDocumentsPerCursor);
+
+    // Capped collections must be cloned in their natural order, and the ranges are bounded using
+    // the _id index.
+    if (numCursors < 2 || _options.capped || _idIndexSpec.isEmpty()) {
+        return {};
+    }
+
+    // Sampling uses a random cursor on the sync source rather than a scan of the collection. The
+    // aggregate command does not take a UUID, so a concurrent rename on the sync source may yield
+    // no samples or samples of another collection, which only affects how even the ranges are.
+    const int numSamples = numCursors * kIdSamplesPerCursor;
+    BSONObj sampleResult;
+    if (!_clientConnection->runCommand(
+            _sourceNss.db().toString(),
+            BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                             << BSON_ARRAY(BSON("$sample" << BSON("size" << numSamples))
+                                           << BSON("$project" << BSON("_id" << 1))
+                                           << BSON("$sort" << BSON("_id" << 1)))
+                             << "cursor"
+                             << BSON("batchSize" << numSamples)),
+            sampleResult,
+            QueryOption_SlaveOk)) {
+        log() << "CollectionCloner ns:" << _destNss << " failed to sample _id values, cloning "
+              << "with a single cursor: " << redact(getStatusFromCommandResult(sampleResult));
+        return {};
+    }
+
+    auto cursorResponse = CursorResponse::parseFromBSON(sampleResult);
+    if (!cursorResponse.isOK()) {
+        log() << "CollectionCloner ns:" << _destNss << " failed to sample _id values, cloning "
+              << "with a single cursor: " << redact(cursorResponse.getStatus());
+        return {};
+    }
+    const auto& samples = cursorResponse.getValue().getBatch();
+
+    // Use evenly spaced samples as the lower bounds of all but the first range.
+    std::vector<BSONObj> splitKeys;
+    for (long long i = 1; i < numCursors; ++i) {
+        const size_t sampleIndex = i * samples.size() / numCursors;
+        if (sampleIndex >= samples.size()) {
+            break;
+        }
+        auto splitKey = samples[sampleIndex].getOwned();
+        if (!splitKeys.empty() && splitKeys.back().woCompare(splitKey) >= 0) {
+            continue;
+        }
+        splitKeys.push_back(std::move(splitKey));
+    }
+    return splitKeys;
+}
+
+Query CollectionCloner::_makeIdRangeQuery(const std::vector<BSONObj>& splitKeys,
+                                          size_t rangeIndex) const {
+    invariant(rangeIndex <= splitKeys.size());
+    Query query;
+    query.hint(BSON("_id" << 1));
+    if (rangeIndex > 0) {
+        query.minKey(splitKeys[rangeIndex - 1]);
+    }
+    if (rangeIndex < splitKeys.size()) {
+        query.maxKey(splitKeys[rangeIndex]);
+    }
+    return query;
+}
+
+bool CollectionCloner::_runIdRangeThread(size_t rangeIndex,
+                                         Query query,
+                                         std::shared_ptr<OnCompletionGuard> onCompletionGuard) {
+    // An exception escaping the thread would terminate the process, so report it as the result of
+    // the clone instead.
+    Status status = Status::OK();
+    try {
+        Client::initThread("collClonerIdRange" + std::to_string(rangeIndex));
+        return _runIdRangeQueryOnNewConnection(query, onCompletionGuard);
+    } catch (const DBException& e) {
+        status = e.toStatus();
+    } catch (const std::exception& e) {
+        status = {ErrorCodes::UnknownError, e.what()};
+    }
+    LockGuard lk(_mutex);
+    onCompletionGuard->setResultAndCancelRemainingWork_inlock(
+        lk,
+        status.withContext(str::stream() << "Error cloning an _id range of collection '"
+                                         << _sourceNss.ns()
+                                         << "'"));
+    return false;
+}
+
+bool CollectionCloner::_runIdRangeQueryOnNewConnection(
+    const Query& query, std::shared_ptr<OnCompletionGuard> onCompletionGuard) {
+    DBClientConnection* connection = nullptr;
+    {
+        LockGuard lk(_mutex);
+        if (_queryState != QueryState::kRunning) {
+            onCompletionGuard->setResultAndCancelRemainingWork_inlock(
+                lk, {ErrorCodes::CallbackCanceled, "Collection cloning cancelled."});
+            return false;
+        }
+        _idRangeConnections.push_back(_createClientFn());
+        connection = _idRangeConnections.back().get();
+    }
+
+    Status connectionStatus = connection->connect(_source, StringData());
+    if (connectionStatus.isOK() && !replAuthenticate(connection)) {
+        connectionStatus = {ErrorCodes::AuthenticationFailed,
+                            str::stream() << "Failed to authenticate to " << _source};
+    }
+    if (!connectionStatus.isOK()) {
+        LockGuard lk(_mutex);
+        onCompletionGuard->setResultAndCancelRemainingWork_inlock(lk, connectionStatus);
+        return false;
+    }
+
+    return _runIdRangeQuery(connection, query, onCompletionGuard);
+}
+
+bool CollectionCloner::_runIdRangeQuery(DBClientConnection* connection,
+                                        const Query& query,
+                                        std::shared_ptr<OnCompletionGuard> onCompletionGuard) {
     try {
-        _clientConnection->query(
+        connection->query(
             [this, onCompletionGuard](DBClientCursorBatchIterator& iter) {
                 _handleNextBatch(onCompletionGuard, iter);
             },
             NamespaceStringOrUUID(_sourceNss.db().toString(), *_options.uuid),
-            Query(),
+            query,
             nullptr /* fieldsToReturn */,
             QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
                 (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
@@ -573,24 +792,22 @@ void CollectionCloner::_runQuery(const executor::TaskExecutor::CallbackArgs& cal
             // cloning.  If so, we'll execute the drop during oplog application, so it's OK to
             // just stop cloning.
             _verifyCollectionWasDropped(lock, queryStatus, onCompletionGuard);
-            return;
+            return false;
         } else if (queryStatus.code() != ErrorCodes::NamespaceNotFound) {
             // NamespaceNotFound means the collection was dropped before we started cloning, so
             // we're OK to ignore the error.  Any other error we must report.
             onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, queryStatus);
-            return;
+            return false;
         }
     }
-    waitForDbWorker();
-    stdx::lock_guard<stdx::mutex> lock(_mutex);
-    onCompletionGuard->setResultAndCancelRemainingWork_inlock(lock, Status::OK());
+    return true;
 }
 
 void CollectionCloner::_handleNextBatch(std::shared_ptr<OnCompletionGuard> onCompletionGuard,
                                         DBClientCursorBatchIterator& iter) {
-    _stats.receivedBatches++;
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stats.receivedBatches++;
         uassert(ErrorCodes::CallbackCanceled,
                 "Collection cloning cancelled.",
                 _queryState != QueryState::kCanceling);
@@ -700,7 +917,12 @@ void CollectionCloner::_insertDocumentsCallback(
     UniqueLock lk(_mutex);
     std::vector<BSONObj> docs;
     if (_documentsToInsert.size() == 0) {
-        warning() << "_insertDocumentsCallback, but no documents to insert for ns:" << _destNss;
+        // When several _id ranges are fetched concurrently, an earlier callback may have already
+        // inserted the documents this callback was scheduled for.
+        if (_stats.cursors <= 1) {
+            warning() << "_insertDocumentsCallback, but no documents to insert for ns:"
+                      << _destNss;
+        }
         return;
     }
     _documentsToInsert.swap(docs);
@@ -804,6 +1026,9 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
         }
     }
     builder->appendNumber("receivedBatches", receivedBatches);
+    if (cursors > 1) {
+        builder->appendNumber("cursors", cursors);
+    }
 }
 }  // namespace repl
 }  // namespace mongo
@@ -83,6 +83,7 @@ public:
         size_t indexes{0};
         size_t fetchedBatches{0};  // This is actually inserted batches.
         size_t receivedBatches{0};
+        size_t cursors{1};  // Number of _id ranges fetched concurrently.
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -219,6 +220,42 @@ private:
      */
     void _runQuery(const executor::TaskExecutor::CallbackArgs& callbackData);
 
+    /**
+     * Returns the lower bounds of all but the first of the _id ranges to clone the collection
+     * with, one cursor per range. Returns no bounds if the collection should be cloned with a
+     * single cursor, either because it is small, capped or cannot be sampled on the sync source.
+     */
+    std::vector<BSONObj> _getIdRangeSplitKeys();
+
+    /**
+     * Returns the query for the _id range at 'rangeIndex' of the ranges bounded by 'splitKeys'.
+     */
+    Query _makeIdRangeQuery(const std::vector<BSONObj>& splitKeys, size_t rangeIndex) const;
+
+    /**
+     * Body of the thread cloning the _id range at 'rangeIndex', which matches 'query'. Exceptions
+     * are reported through 'onCompletionGuard'.
+     */
+    bool _runIdRangeThread(size_t rangeIndex,
+                           Query query,
+                           std::shared_ptr<OnCompletionGuard> onCompletionGuard);
+
+    /**
+     * Opens a new connection to the sync source and clones the documents matching 'query' over
+     * it. Runs on a thread of its own for each _id range but the first.
+     */
+    bool _runIdRangeQueryOnNewConnection(const Query& query,
+                                         std::shared_ptr<OnCompletionGuard> onCompletionGuard);
+
+    /**
+     * Runs 'query' on 'connection', handing each batch to _handleNextBatch. Returns false, after
+     * recording the result in 'onCompletionGuard' or scheduling a check for a dropped collection,
+     * if the query failed.
+     */
+    bool _runIdRangeQuery(DBClientConnection* connection,
+                          const Query& query,
+                          std::shared_ptr<OnCompletionGuard> onCompletionGuard);
+
     /**
      * Put all results from a query batch into a buffer to be inserted, and schedule
      * it to be inserted.
@@ -302,6 +339,10 @@ private:
     // allow cancellation, and those other threads may access it only when holding '_mutex'.
     std::unique_ptr<DBClientConnection> _clientConnection;
 
+    // (M) Client connections used for the _id ranges after the first when the collection is cloned
+    // with several cursors. Only added to while the query is kRunning, and shut down on cancel.
+    std::vector<std::unique_ptr<DBClientConnection>> _idRangeConnections;
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
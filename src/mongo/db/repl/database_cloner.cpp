@@ -83,6 +83,19 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(collectionClonerBatchSize, int, 0)
 // The number of attempts for the listCollections commands.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 
+// The number of collections of a database that are cloned concurrently.
+MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionClonersPerDatabase, int, 1)
+    ->withValidator([](const int& numCloners) {
+        return (numCloners >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream()
+                         << "numInitialSyncCollectionClonersPerDatabase must be greater than or "
+                            "equal to 1. '"
+                         << numCloners
+                         << "' is an invalid setting.");
+    });
+
 // Failpoint which causes initial sync to hang right after listCollections, but before cloning
 // any colelctions in the 'database' database.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangAfterListCollections);
@@ -423,18 +436,53 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    // Start the first collection cloners. The remaining ones are started as these finish.
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    const auto numCloners =
+        std::min(static_cast<size_t>(numInitialSyncCollectionClonersPerDatabase.load()),
+                 _collectionCloners.size());
+    for (size_t i = 0; i < numCloners; ++i) {
+        Status startStatus = _startNextCollectionCloner_inlock();
+        if (!startStatus.isOK()) {
+            _failCollectionCloning_inlock(startStatus);
+            break;
+        }
+    }
+
+    // Nothing was started, so no collection cloner callback will complete the database cloner.
+    if (_activeCollectionCloners == 0) {
+        _finishCallback_inlock(lk, _collectionClonerStatus);
+    }
+}
+
+Status DatabaseCloner::_startNextCollectionCloner_inlock() {
+    invariant(_nextCollectionClonerIter != _collectionCloners.end());
+    auto& collectionCloner = *_nextCollectionClonerIter++;
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+    LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+    Status startStatus = _startCollectionCloner(collectionCloner);
     if (!startStatus.isOK()) {
         LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
+               << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+        return startStatus;
+    }
+    ++_activeCollectionCloners;
+    return Status::OK();
+}
+
+void DatabaseCloner::_failCollectionCloning_inlock(const Status& status) {
+    if (!_collectionClonerStatus.isOK()) {
         return;
     }
+    _collectionClonerStatus = status;
+
+    // Stop the collection cloners still running concurrently and do not start any more of them.
+    // The database cloner completes once all the running cloners have reported back.
+    _nextCollectionClonerIter = _collectionCloners.end();
+    for (auto&& collectionCloner : _collectionCloners) {
+        collectionCloner.shutdown();
+    }
 }
 
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
@@ -452,30 +500,29 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     _collectionWork(collStatus, nss);
     lk.lock();
 
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
+
     // Failure to clone a collection will stop the database cloner from
     // cloning the rest of the collections in the listCollections result.
     if (!collStatus.isOK()) {
-        Status failStatus = {ErrorCodes::InitialSyncFailure, collStatus.toString()};
-        _finishCallback_inlock(lk, failStatus);
-        return;
+        _failCollectionCloning_inlock({ErrorCodes::InitialSyncFailure, collStatus.toString()});
+    } else {
+        ++_stats.clonedCollections;
     }
 
-    ++_stats.clonedCollections;
-    _currentCollectionClonerIter++;
-
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+    if (_nextCollectionClonerIter != _collectionCloners.end()) {
+        Status startStatus = _startNextCollectionCloner_inlock();
         if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
+            _failCollectionCloning_inlock(startStatus);
         }
+    }
+
+    if (_activeCollectionCloners > 0) {
         return;
     }
 
-    _finishCallback_inlock(lk, Status::OK());
+    _finishCallback_inlock(lk, _collectionClonerStatus);
 }
 
 void DatabaseCloner::_finishCallback(const Status& status) {
@@ -187,9 +187,21 @@ private:
     /**
      * Forwards collection cloner result to client.
      * Starts a new cloner on a different collection.
+     * Completes the database cloner once no collection cloners remain active.
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts the collection cloner at '_nextCollectionClonerIter' and advances the iterator.
+     */
+    Status _startNextCollectionCloner_inlock();
+
+    /**
+     * Records the first collection cloning failure and shuts down the remaining collection
+     * cloners.
+     */
+    void _failCollectionCloning_inlock(const Status& status);
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -232,8 +244,10 @@ private:
     // Holds all collection infos from listCollections.
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
-    std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner> _collectionCloners;                   // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;  // (M) Next cloner to start.
+    size_t _activeCollectionCloners = 0;  // (M) Started cloners that have not yet reported back.
+    Status _collectionClonerStatus = Status::OK();  // (M) First collection cloning failure.
     CollectionCloner::ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
     StartCollectionClonerFn _startCollectionCloner;  // (RT)
@@ -40,10 +40,12 @@
 #include "mongo/db/repl/base_cloner_test_fixture.h"
 #include "mongo/db/repl/database_cloner.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/task_executor_proxy.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/uuid.h"
 
 namespace {
@@ -790,6 +792,76 @@ TEST_F(DatabaseClonerTest, ShutdownCancelsCollectionCloning) {
     ASSERT_EQUALS(ErrorCodes::InitialSyncFailure, getStatus());
 }
 
+TEST_F(DatabaseClonerTest, StartsCollectionClonersConcurrentlyUpToConfiguredLimit) {
+    auto numClonersParameter = ServerParameterSet::getGlobal()
+                                   ->getMap()
+                                   .find("numInitialSyncCollectionClonersPerDatabase")
+                                   ->second;
+    ASSERT_OK(numClonersParameter->setFromString("2"));
+    ON_BLOCK_EXIT([numClonersParameter] {
+        numClonersParameter->setFromString("1").transitional_ignore();
+    });
+
+    std::vector<std::string> startedCollections;
+    _databaseCloner->setStartCollectionClonerFn(
+        [&startedCollections, this](CollectionCloner& cloner) {
+            startedCollections.push_back(cloner.getSourceNamespace().coll().toString());
+            return _startCollectionCloner(cloner);
+        });
+
+    ASSERT_OK(_databaseCloner->startup());
+
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+
+        assertRemoteCommandNameEquals(
+            "listCollections",
+            net->scheduleSuccessfulResponse(createListCollectionsResponse(
+                0,
+                BSON_ARRAY(BSON("name"
+                                << "a"
+                                << "options"
+                                << _options1.toBSON())
+                           << BSON("name"
+                                   << "b"
+                                   << "options"
+                                   << _options2.toBSON())
+                           << BSON("name"
+                                   << "c"
+                                   << "options"
+                                   << _options3.toBSON())))));
+        net->runReadyNetworkOperations();
+
+        // Both running collection cloners send their count requests. Blackhole them to leave the
+        // collection cloners active.
+        for (const auto& uuid : {*_options1.uuid, *_options2.uuid}) {
+            auto noi = net->getNextReadyRequest();
+            assertRemoteCommandNameEquals("count", noi->getRequest());
+            ASSERT_EQUALS(uuid, UUID::parse(noi->getRequest().cmdObj.firstElement()));
+            net->blackHole(noi);
+        }
+        ASSERT_FALSE(net->hasReadyRequests());
+    }
+
+    // The third collection cloner waits for one of the first two to finish.
+    ASSERT_EQUALS(2U, startedCollections.size());
+    ASSERT_EQUALS("a", startedCollections[0]);
+    ASSERT_EQUALS("b", startedCollections[1]);
+
+    _databaseCloner->shutdown();
+    executor::NetworkInterfaceMock::InNetworkGuard(net)->runReadyNetworkOperations();
+
+    _databaseCloner->join();
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(ErrorCodes::InitialSyncFailure, getStatus());
+    ASSERT_EQUALS(2U, startedCollections.size());
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled,
+                  _collections[NamespaceString{"db.a"}].status.code());
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled,
+                  _collections[NamespaceString{"db.b"}].status.code());
+}
+
 TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(DatabaseCloner::State::kPreStart, _databaseCloner->getState_forTest());
 
@@ -812,7 +884,7 @@ TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(_databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially by default.
     // This affects the order of the network responses.
     {
         executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
@@ -869,7 +941,7 @@ TEST_F(DatabaseClonerTest, CreateCollections) {
     ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
     ASSERT_TRUE(_databaseCloner->isActive());
 
-    // Collection cloners are run serially for now.
+    // Collection cloners are run serially by default.
     // This affects the order of the network responses.
     {
         executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
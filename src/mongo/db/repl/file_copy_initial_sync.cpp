@@ -0,0 +1,447 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_sync.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <set>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "mongo/client/dbclient_connection.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplogreader.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_engine_lock_file.h"
+#include "mongo/db/storage/storage_file_util.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/file.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// How a new member with an empty dbpath initial syncs: "logical" clones every collection from its
+// sync source, "fileCopy" copies the data files of 'fileCopyInitialSyncSource'.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncMethod, std::string, "logical")
+    ->withValidator([](const std::string& method) {
+        return (method == "logical" || method == "fileCopy")
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream() << "initialSyncMethod must be either 'logical' or 'fileCopy'. '"
+                                   << method
+                                   << "' is an invalid setting.");
+    });
+
+// The host and port of the member whose data files are copied by a file copy initial sync.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(fileCopyInitialSyncSource, std::string, "")
+    ->withValidator([](const std::string& source) {
+        return source.empty() ? Status::OK() : HostAndPort::parse(source).getStatus();
+    });
+
+// The number of files copied concurrently, each over its own connection to the sync source.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(numFileCopyInitialSyncConnections, int, 4)
+    ->withValidator([](const int& numConnections) {
+        return (numConnections >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream()
+                         << "numFileCopyInitialSyncConnections must be greater than or equal to "
+                            "1. '"
+                         << numConnections
+                         << "' is an invalid setting.");
+    });
+
+// Present in the dbpath while files are being copied. Its presence on startup means that a copy
+// was interrupted and that the files in the dbpath cannot be used.
+const char kMarkerFileName[] = "fileCopyInitialSync.inProgress";
+
+// Entries of the dbpath that do not belong to the storage engine's data.
+const char kLockFileName[] = "mongod.lock";
+const char kDiagnosticDataDirectoryName[] = "diagnostic.data";
+
+struct BackupFile {
+    // The path of the file relative to the dbpath.
+    std::string name;
+    long long size;
+};
+
+StatusWith<std::unique_ptr<DBClientConnection>> connectToSyncSource(const HostAndPort& source) {
+    auto connection = stdx::make_unique<DBClientConnection>();
+    auto status = connection->connect(source, "FileCopyInitialSync"_sd);
+    try {
+        if (status.isOK() && !replAuthenticate(connection.get())) {
+            status = {ErrorCodes::AuthenticationFailed,
+                      str::stream() << "Failed to authenticate to " << source};
+        }
+    } catch (const DBException& ex) {
+        // Also called on the copying threads, which must not let exceptions escape.
+        status = ex.toStatus();
+    }
+    if (!status.isOK()) {
+        return status;
+    }
+    return {std::move(connection)};
+}
+
+StatusWith<BSONObj> runSyncSourceCommand(DBClientConnection* connection, const BSONObj& cmdObj) {
+    BSONObj info;
+    if (!connection->runCommand("admin", cmdObj, info)) {
+        return getStatusFromCommandResult(info);
+    }
+    return info;
+}
+
+Status copyBackupFile(DBClientConnection* connection,
+                      long long backupId,
+                      const BackupFile& file,
+                      const boost::filesystem::path& dbpath) {
+    const auto path = dbpath / file.name;
+    boost::filesystem::create_directories(path.parent_path());
+
+    File out;
+    out.open(path.string().c_str());
+    if (out.bad()) {
+        return {ErrorCodes::FileOpenFailed, str::stream() << "Failed to open " << path.string()};
+    }
+
+    long long offset = 0;
+    while (offset < file.size) {
+        const int length = static_cast<int>(
+            std::min<long long>(kFileCopyInitialSyncMaxChunkSizeBytes, file.size - offset));
+        auto swReply = runSyncSourceCommand(connection,
+                                            BSON("_initialSyncReadBackupFile" << 1 << "backupId"
+                                                                              << backupId
+                                                                              << "file"
+                                                                              << file.name
+                                                                              << "offset"
+                                                                              << offset
+                                                                              << "length"
+                                                                              << length));
+        if (!swReply.isOK()) {
+            return swReply.getStatus();
+        }
+
+        const auto dataElem = swReply.getValue()["data"];
+        int dataLength = 0;
+        const char* data = dataElem.type() == BinData ? dataElem.binData(dataLength) : nullptr;
+        if (dataLength != length) {
+            return {ErrorCodes::InitialSyncFailure,
+                    str::stream() << "Expected " << length << " bytes of " << file.name
+                                  << " at offset "
+                                  << offset
+                                  << " but received "
+                                  << dataLength};
+        }
+
+        out.write(offset, data, dataLength);
+        if (out.bad()) {
+            return {ErrorCodes::FileStreamFailed,
+                    str::stream() << "Failed to write to " << path.string()};
+        }
+        offset += dataLength;
+    }
+
+    out.fsync();
+    if (out.bad()) {
+        return {ErrorCodes::FileStreamFailed, str::stream() << "Failed to fsync " << path.string()};
+    }
+    return Status::OK();
+}
+
+/**
+ * Returns the entries of the dbpath that belong to the storage engine's data.
+ */
+std::vector<boost::filesystem::path> listDataFiles(const boost::filesystem::path& dbpath) {
+    std::vector<boost::filesystem::path> dataFiles;
+    for (auto&& entry : boost::filesystem::directory_iterator(dbpath)) {
+        const auto name = entry.path().filename().string();
+        if (name != kLockFileName && name != kDiagnosticDataDirectoryName &&
+            name != kMarkerFileName) {
+            dataFiles.push_back(entry.path());
+        }
+    }
+    return dataFiles;
+}
+
+Status copyBackupFiles(const HostAndPort& source, const boost::filesystem::path& dbpath) {
+    auto swConnection = connectToSyncSource(source);
+    if (!swConnection.isOK()) {
+        return swConnection.getStatus();
+    }
+    auto connection = std::move(swConnection.getValue());
+
+    auto swOpenReply =
+        runSyncSourceCommand(connection.get(), BSON("_initialSyncOpenBackupCursor" << 1));
+    if (!swOpenReply.isOK()) {
+        return swOpenReply.getStatus().withContext(
+            str::stream() << "Failed to open a backup cursor on " << source);
+    }
+    const auto& openReply = swOpenReply.getValue();
+    const long long backupId = openReply["backupId"].safeNumberLong();
+    ON_BLOCK_EXIT([&] {
+        // The sync source also closes the backup cursor once it is left idle.
+        const auto cmdObj = BSON("_initialSyncCloseBackupCursor" << 1 << "backupId" << backupId);
+        BSONObj info;
+        try {
+            connection->runCommand("admin", cmdObj, info);
+        } catch (const DBException& ex) {
+            warning() << "Failed to close the backup cursor on " << source << ": " << ex;
+        }
+    });
+
+    std::vector<BackupFile> files;
+    long long totalBytes = 0;
+    for (auto&& elem : openReply["files"].Obj()) {
+        const auto fileObj = elem.Obj();
+        files.push_back({fileObj["filename"].str(), fileObj["fileSize"].safeNumberLong()});
+        auto status = validateBackupFileName(files.back().name);
+        if (!status.isOK()) {
+            return status;
+        }
+        totalBytes += files.back().size;
+    }
+    log() << "Copying " << files.size() << " files (" << totalBytes << " bytes) from " << source;
+    if (openReply.hasField("preamble")) {
+        log() << "Backup cursor preamble: " << openReply["preamble"];
+    }
+
+    // Starting with the largest files keeps the connections busy until the end of the copy.
+    std::sort(files.begin(), files.end(), [](const BackupFile& lhs, const BackupFile& rhs) {
+        return lhs.size > rhs.size;
+    });
+
+    stdx::mutex mutex;
+    std::size_t nextFile = 0;
+    Status copyStatus = Status::OK();
+    auto copyFiles = [&](DBClientConnection* conn) {
+        while (true) {
+            const BackupFile* file;
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (!copyStatus.isOK() || nextFile == files.size()) {
+                    return;
+                }
+                file = &files[nextFile++];
+            }
+
+            Status status = Status::OK();
+            try {
+                status = copyBackupFile(conn, backupId, *file, dbpath);
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            } catch (const boost::filesystem::filesystem_error& ex) {
+                status = {ErrorCodes::FileStreamFailed, ex.what()};
+            } catch (const std::exception& ex) {
+                status = {ErrorCodes::UnknownError, ex.what()};
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (!status.isOK() && copyStatus.isOK()) {
+                copyStatus = status.withContext(str::stream() << "Failed to copy " << file->name);
+            }
+            if (!copyStatus.isOK()) {
+                return;
+            }
+        }
+    };
+
+    const auto numConnections =
+        std::min<std::size_t>(numFileCopyInitialSyncConnections, files.size());
+    std::vector<stdx::thread> threads;
+    try {
+        for (std::size_t i = 1; i < numConnections; ++i) {
+            threads.emplace_back([&, i] {
+                setThreadName("fileCopyInitialSync" + std::to_string(i));
+                auto swConn = connectToSyncSource(source);
+                if (!swConn.isOK()) {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    if (copyStatus.isOK()) {
+                        copyStatus = swConn.getStatus();
+                    }
+                    return;
+                }
+                copyFiles(swConn.getValue().get());
+            });
+        }
+    } catch (const std::system_error& ex) {
+        // Stops the threads that did start after their current file. They are joined below.
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        if (copyStatus.isOK()) {
+            copyStatus = {ErrorCodes::UnknownError,
+                          str::stream() << "Failed to start a thread copying backup files: "
+                                        << ex.what()};
+        }
+    }
+    copyFiles(connection.get());
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    if (!copyStatus.isOK()) {
+        return copyStatus;
+    }
+
+    std::set<std::string> directories;
+    for (auto&& file : files) {
+        const auto path = dbpath / file.name;
+        if (directories.insert(path.parent_path().string()).second) {
+            auto status = fsyncParentDirectory(path);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+    }
+    return Status::OK();
+}
+
+Status runFileCopyInitialSyncWithLockFile(const boost::filesystem::path& dbpath) {
+    auto swCopyFiles = prepareDbpathForFileCopyInitialSync(dbpath.string());
+    if (!swCopyFiles.isOK()) {
+        return swCopyFiles.getStatus();
+    }
+    if (!swCopyFiles.getValue()) {
+        return Status::OK();
+    }
+
+    const auto markerFile = dbpath / kMarkerFileName;
+    const auto source = HostAndPort(fileCopyInitialSyncSource);
+    log() << "Starting file copy initial sync from " << source;
+    Timer timer;
+
+    auto status = copyBackupFiles(source, dbpath);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    boost::filesystem::remove(markerFile);
+    status = fsyncParentDirectory(markerFile);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    log() << "File copy initial sync from " << source << " finished in " << timer.millis()
+          << "ms. The copied oplog is replayed from the backup checkpoint during startup recovery.";
+    return Status::OK();
+}
+
+}  // namespace
+
+Status validateBackupFileName(const std::string& name) {
+    const boost::filesystem::path path(name);
+    bool valid = !name.empty() && path.is_relative();
+    for (auto&& component : path) {
+        valid = valid && component != "..";
+    }
+    return valid ? Status::OK()
+                 : Status(ErrorCodes::InitialSyncFailure,
+                          str::stream() << "Invalid backup file name from sync source: " << name);
+}
+
+StatusWith<bool> prepareDbpathForFileCopyInitialSync(const std::string& dbpathString) {
+    const boost::filesystem::path dbpath(dbpathString);
+    const auto markerFile = dbpath / kMarkerFileName;
+    if (boost::filesystem::exists(markerFile)) {
+        log() << "Removing the files of an interrupted file copy initial sync from "
+              << dbpath.string();
+        for (auto&& path : listDataFiles(dbpath)) {
+            boost::filesystem::remove_all(path);
+        }
+        return true;
+    }
+
+    if (!listDataFiles(dbpath).empty()) {
+        log() << "Skipping file copy initial sync because " << dbpath.string()
+              << " already contains data files";
+        return false;
+    }
+
+    File marker;
+    marker.open(markerFile.string().c_str());
+    if (marker.bad()) {
+        return {ErrorCodes::FileOpenFailed,
+                str::stream() << "Failed to create " << markerFile.string()};
+    }
+    auto status = fsyncParentDirectory(markerFile);
+    if (!status.isOK()) {
+        return status;
+    }
+    return true;
+}
+
+bool isFileCopyInitialSyncEnabled() {
+    return initialSyncMethod == "fileCopy";
+}
+
+Status runFileCopyInitialSync() {
+    if (fileCopyInitialSyncSource.empty()) {
+        return {ErrorCodes::InvalidOptions,
+                "fileCopyInitialSyncSource must be set when initialSyncMethod is 'fileCopy'"};
+    }
+
+    try {
+        const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+
+        // Keep other processes out of the dbpath while it is being filled. The storage engine
+        // takes the lock file again when it starts.
+        StorageEngineLockFile lockFile(storageGlobalParams.dbpath);
+        auto status = lockFile.open();
+        if (!status.isOK()) {
+            return status;
+        }
+        ON_BLOCK_EXIT([&] { lockFile.close(); });
+
+        return runFileCopyInitialSyncWithLockFile(dbpath);
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    } catch (const std::exception& ex) {
+        return {ErrorCodes::InitialSyncFailure,
+                str::stream() << "File copy initial sync failed: " << ex.what()};
+    }
+}
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,91 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+
+namespace mongo {
+namespace repl {
+
+/**
+ * File copy based initial sync.
+ *
+ * Instead of cloning every document and rebuilding every index, a new member with an empty dbpath
+ * opens a backup cursor on its sync source (see BackupCursorHooks) and copies the source's storage
+ * engine files into its own dbpath before its storage engine is started. Opening the copied files
+ * then behaves like restarting the sync source after a crash: the storage engine recovers the
+ * checkpoint of the backup cursor and replication recovery replays the copied oplog from the
+ * checkpoint timestamp, after which the member catches up through steady state replication.
+ *
+ * The sync source serves the files with the internal commands _initialSyncOpenBackupCursor,
+ * _initialSyncReadBackupFile and _initialSyncCloseBackupCursor.
+ */
+
+/**
+ * The largest number of bytes of a file returned by a single _initialSyncReadBackupFile command.
+ * This keeps the reply well under the maximum size of a BSON object.
+ */
+constexpr int kFileCopyInitialSyncMaxChunkSizeBytes = 8 * 1024 * 1024;
+
+/**
+ * Returns true if this node is configured to run a file copy initial sync through the
+ * 'initialSyncMethod' and 'fileCopyInitialSyncSource' server parameters.
+ */
+bool isFileCopyInitialSyncEnabled();
+
+/**
+ * Returns an error if 'name', the name of a backup file sent by the sync source, could refer to a
+ * file outside of the dbpath.
+ */
+Status validateBackupFileName(const std::string& name);
+
+/**
+ * Readies 'dbpath' for the files of a file copy initial sync and returns whether they should be
+ * copied. If 'dbpath' holds the data files of an interrupted copy, they are removed. Otherwise the
+ * copy is skipped if 'dbpath' already holds data files, and a marker file that is only removed once
+ * the copy finishes is created in it if not.
+ */
+StatusWith<bool> prepareDbpathForFileCopyInitialSync(const std::string& dbpath);
+
+/**
+ * Copies the files of a backup cursor opened on 'fileCopyInitialSyncSource' into the dbpath. Must
+ * be called before the storage engine is initialized.
+ *
+ * Does nothing if the dbpath already contains data files, unless they are the remains of a file
+ * copy initial sync that was interrupted, in which case they are removed and the copy restarts.
+ */
+Status runFileCopyInitialSync();
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,395 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/backup_cursor_hooks.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/file.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/periodic_runner.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// The number of seconds after which the backup cursor opened for a file copy initial sync is
+// closed if the syncing node stops reading files from it.
+MONGO_EXPORT_SERVER_PARAMETER(fileCopyInitialSyncBackupCursorTimeoutSecs, int, 5 * 60)
+    ->withValidator([](const int& timeoutSecs) {
+        return (timeoutSecs >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::BadValue,
+                     str::stream()
+                         << "fileCopyInitialSyncBackupCursorTimeoutSecs must be greater than or "
+                            "equal to 1. '"
+                         << timeoutSecs
+                         << "' is an invalid setting.");
+    });
+
+// Not a storage engine file, but it describes the layout of the data files and is copied with
+// them.
+const char kStorageMetadataFileName[] = "storage.bson";
+
+/**
+ * The backup cursor opened on behalf of a node running a file copy initial sync. The storage
+ * engine supports a single backup cursor, so only one node at a time copies files from this node.
+ */
+struct InitialSyncBackup {
+    std::uint64_t backupId;
+    // The size of each file of the backup when the backup cursor was opened, keyed by its path
+    // relative to the dbpath.
+    std::map<std::string, long long> fileSizes;
+    Date_t lastUsed;
+};
+
+struct InitialSyncBackupState {
+    stdx::mutex mutex;
+    boost::optional<InitialSyncBackup> backup;
+    bool reaperStarted = false;
+};
+
+const auto getInitialSyncBackupState = ServiceContext::declareDecoration<InitialSyncBackupState>();
+
+bool isIdle(ServiceContext* service, const InitialSyncBackup& backup) {
+    return service->getFastClockSource()->now() - backup.lastUsed >
+        Seconds(fileCopyInitialSyncBackupCursorTimeoutSecs.load());
+}
+
+InitialSyncBackup& getInitialSyncBackup_inlock(InitialSyncBackupState* state,
+                                               long long backupId) {
+    uassert(ErrorCodes::CursorNotFound,
+            str::stream() << "No open backup cursor with id " << backupId,
+            state->backup && static_cast<long long>(state->backup->backupId) == backupId);
+    return *state->backup;
+}
+
+void closeInitialSyncBackup_inlock(OperationContext* opCtx, InitialSyncBackupState* state) {
+    BackupCursorHooks::get(opCtx->getServiceContext())
+        ->closeBackupCursor(opCtx, state->backup->backupId);
+    state->backup = boost::none;
+}
+
+/**
+ * Closes the backup cursor once it is left idle, so that a syncing node that goes away does not
+ * keep the storage engine from removing old checkpoints and journal files.
+ */
+void startIdleBackupReaper_inlock(ServiceContext* service, InitialSyncBackupState* state) {
+    auto periodicRunner = service->getPeriodicRunner();
+    if (state->reaperStarted || !periodicRunner) {
+        return;
+    }
+    state->reaperStarted = true;
+
+    PeriodicRunner::PeriodicJob job("closeIdleInitialSyncBackupCursor",
+                                    [](Client* client) {
+                                        auto service = client->getServiceContext();
+                                        auto& state = getInitialSyncBackupState(service);
+                                        stdx::lock_guard<stdx::mutex> lk(state.mutex);
+                                        if (!state.backup || !isIdle(service, *state.backup)) {
+                                            return;
+                                        }
+
+                                        log() << "Closing idle file copy initial sync backup "
+                                                 "cursor "
+                                              << state.backup->backupId;
+                                        auto opCtx = client->makeOperationContext();
+                                        closeInitialSyncBackup_inlock(opCtx.get(), &state);
+                                    },
+                                    Seconds(1));
+    periodicRunner->scheduleJob(std::move(job));
+}
+
+/**
+ * Returns 'filename', a file in 'dbpath', as a path relative to 'dbpath' in the portable format.
+ */
+std::string relativeToDbpath(const std::string& dbpath, const std::string& filename) {
+    auto prefix = boost::filesystem::path(dbpath).string();
+    if (!prefix.empty() && prefix.back() != boost::filesystem::path::preferred_separator) {
+        prefix += boost::filesystem::path::preferred_separator;
+    }
+    uassert(ErrorCodes::InternalError,
+            str::stream() << "Backup file " << filename << " is not in the dbpath " << dbpath,
+            StringData(filename).startsWith(prefix));
+    return boost::filesystem::path(filename.substr(prefix.size())).generic_string();
+}
+
+void addInternalPrivilege(std::vector<Privilege>* out) {
+    ActionSet actions;
+    actions.addAction(ActionType::internal);
+    out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+}
+
+/**
+ * { _initialSyncOpenBackupCursor: 1 }
+ *
+ * Opens a backup cursor and returns its id, its preamble and the name and size of every file to
+ * copy.
+ */
+class CmdInitialSyncOpenBackupCursor : public BasicCommand {
+public:
+    CmdInitialSyncOpenBackupCursor() : BasicCommand("_initialSyncOpenBackupCursor") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    std::string help() const override {
+        return "{ _initialSyncOpenBackupCursor : 1 } INTERNAL ONLY";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        addInternalPrivilege(out);
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        auto service = opCtx->getServiceContext();
+        auto hooks = BackupCursorHooks::get(service);
+        uassert(ErrorCodes::CommandNotSupported,
+                "File copy initial sync requires backup cursor support on the sync source",
+                hooks->enabled());
+
+        auto& state = getInitialSyncBackupState(service);
+        stdx::lock_guard<stdx::mutex> lk(state.mutex);
+        if (state.backup && isIdle(service, *state.backup)) {
+            closeInitialSyncBackup_inlock(opCtx, &state);
+        }
+        uassert(ErrorCodes::ConflictingOperationInProgress,
+                "Another node is already copying the data files of this node",
+                !state.backup);
+
+        auto backupCursorState = hooks->openBackupCursor(opCtx);
+        InitialSyncBackup backup{
+            backupCursorState.cursorId, {}, service->getFastClockSource()->now()};
+        auto closeGuard =
+            MakeGuard([&] { hooks->closeBackupCursor(opCtx, backupCursorState.cursorId); });
+
+        const auto& dbpath = storageGlobalParams.dbpath;
+        for (auto&& filename : backupCursorState.filenames) {
+            backup.fileSizes[relativeToDbpath(dbpath, filename)] =
+                boost::filesystem::file_size(filename);
+        }
+        const auto metadataFile = boost::filesystem::path(dbpath) / kStorageMetadataFileName;
+        if (boost::filesystem::exists(metadataFile)) {
+            backup.fileSizes[kStorageMetadataFileName] = boost::filesystem::file_size(metadataFile);
+        }
+
+        result.append("backupId", static_cast<long long>(backup.backupId));
+        if (backupCursorState.preamble) {
+            result.append("preamble", backupCursorState.preamble->toBson());
+        }
+        BSONArrayBuilder files(result.subarrayStart("files"));
+        for (auto&& file : backup.fileSizes) {
+            files.append(BSON("filename" << file.first << "fileSize" << file.second));
+        }
+        files.doneFast();
+
+        log() << "Opened backup cursor " << backup.backupId << " for a file copy initial sync of "
+              << backup.fileSizes.size() << " files";
+        closeGuard.Dismiss();
+        state.backup = std::move(backup);
+        startIdleBackupReaper_inlock(service, &state);
+        return true;
+    }
+} cmdInitialSyncOpenBackupCursor;
+
+/**
+ * { _initialSyncReadBackupFile: 1, backupId: <id>, file: <name>, offset: <n>, length: <n> }
+ *
+ * Returns 'length' bytes of a file of the backup, starting at 'offset', in the 'data' field.
+ */
+class CmdInitialSyncReadBackupFile : public BasicCommand {
+public:
+    CmdInitialSyncReadBackupFile() : BasicCommand("_initialSyncReadBackupFile") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    std::string help() const override {
+        return "{ _initialSyncReadBackupFile : 1, backupId : <id>, file : <name>, offset : <n>, "
+               "length : <n> } INTERNAL ONLY";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        addInternalPrivilege(out);
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        long long backupId;
+        std::string file;
+        long long offset;
+        long long length;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "backupId", &backupId));
+        uassertStatusOK(bsonExtractStringField(cmdObj, "file", &file));
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "offset", &offset));
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "length", &length));
+        uassert(ErrorCodes::BadValue,
+                str::stream() << "length must be between 1 and "
+                              << kFileCopyInitialSyncMaxChunkSizeBytes,
+                length >= 1 && length <= kFileCopyInitialSyncMaxChunkSizeBytes);
+
+        auto service = opCtx->getServiceContext();
+        auto& state = getInitialSyncBackupState(service);
+        {
+            stdx::lock_guard<stdx::mutex> lk(state.mutex);
+            auto& backup = getInitialSyncBackup_inlock(&state, backupId);
+            auto it = backup.fileSizes.find(file);
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << file << " is not a file of backup cursor " << backupId,
+                    it != backup.fileSizes.end());
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "Cannot read " << length << " bytes of " << file
+                                  << " at offset "
+                                  << offset
+                                  << ", its size is "
+                                  << it->second,
+                    offset >= 0 && offset <= it->second - length);
+            backup.lastUsed = service->getFastClockSource()->now();
+        }
+
+        const auto path = boost::filesystem::path(storageGlobalParams.dbpath) / file;
+        File in;
+        in.open(path.string().c_str(), true /* read-only */);
+        uassert(ErrorCodes::FileOpenFailed, str::stream() << "Failed to open " << file, !in.bad());
+        std::unique_ptr<char[]> data(new char[length]);
+        in.read(offset, data.get(), length);
+        uassert(
+            ErrorCodes::FileStreamFailed, str::stream() << "Failed to read " << file, !in.bad());
+
+        {
+            // The file is only known to hold the backup's data while the backup cursor is open.
+            stdx::lock_guard<stdx::mutex> lk(state.mutex);
+            getInitialSyncBackup_inlock(&state, backupId);
+        }
+
+        result.appendBinData("data", length, BinDataGeneral, data.get());
+        return true;
+    }
+} cmdInitialSyncReadBackupFile;
+
+/**
+ * { _initialSyncCloseBackupCursor: 1, backupId: <id> }
+ *
+ * Closes the backup cursor, if it is still open.
+ */
+class CmdInitialSyncCloseBackupCursor : public BasicCommand {
+public:
+    CmdInitialSyncCloseBackupCursor() : BasicCommand("_initialSyncCloseBackupCursor") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    std::string help() const override {
+        return "{ _initialSyncCloseBackupCursor : 1, backupId : <id> } INTERNAL ONLY";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        addInternalPrivilege(out);
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        long long backupId;
+        uassertStatusOK(bsonExtractIntegerField(cmdObj, "backupId", &backupId));
+
+        auto& state = getInitialSyncBackupState(opCtx->getServiceContext());
+        stdx::lock_guard<stdx::mutex> lk(state.mutex);
+        if (state.backup && static_cast<long long>(state.backup->backupId) == backupId) {
+            log() << "Closing file copy initial sync backup cursor " << backupId;
+            closeInitialSyncBackup_inlock(opCtx, &state);
+        }
+        return true;
+    }
+} cmdInitialSyncCloseBackupCursor;
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
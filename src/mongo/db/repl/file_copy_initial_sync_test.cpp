@@ -0,0 +1,334 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/backup_cursor_hooks.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+#include "mongo/util/periodic_runner_impl.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const char kCollectionFile[] = "collection-0.wt";
+const char kJournalFile[] = "journal/WiredTigerLog.0000000001";
+const int kCollectionFileSize = 1000;
+const int kJournalFileSize = 10;
+
+/**
+ * Backup cursor hooks of a storage engine whose backup is made of the collection and journal
+ * files created by the test.
+ */
+class BackupCursorHooksMock : public BackupCursorHooks {
+public:
+    bool enabled() const override {
+        return true;
+    }
+
+    BackupCursorState openBackupCursor(OperationContext* opCtx) override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ASSERT_FALSE(_open);
+        _open = true;
+        const boost::filesystem::path dbpath(storageGlobalParams.dbpath);
+        return {++_lastCursorId,
+                boost::none,
+                {(dbpath / kCollectionFile).string(), (dbpath / kJournalFile).string()}};
+    }
+
+    void closeBackupCursor(OperationContext* opCtx, std::uint64_t cursorId) override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ASSERT_TRUE(_open);
+        ASSERT_EQ(cursorId, _lastCursorId);
+        _open = false;
+    }
+
+    bool isBackupCursorOpen() const override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _open;
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    bool _open = false;
+    std::uint64_t _lastCursorId = 0;
+};
+
+void writeFile(const boost::filesystem::path& path, int size) {
+    boost::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path.string(), std::ios::binary);
+    for (int i = 0; i < size; ++i) {
+        out.put(static_cast<char>('a' + i % 26));
+    }
+    ASSERT_TRUE(out.good());
+}
+
+class FileCopyInitialSyncCommandsTest : public ServiceContextTest {
+protected:
+    void setUp() override {
+        _savedDbpath = storageGlobalParams.dbpath;
+        storageGlobalParams.dbpath = _tempDir.path();
+        const boost::filesystem::path dbpath(_tempDir.path());
+        writeFile(dbpath / kCollectionFile, kCollectionFileSize);
+        writeFile(dbpath / kJournalFile, kJournalFileSize);
+        writeFile(dbpath / "mongod.lock", 1);
+
+        auto service = getServiceContext();
+        BackupCursorHooks::registerInitializer(
+            [](StorageEngine*) { return stdx::make_unique<BackupCursorHooksMock>(); });
+        BackupCursorHooks::initialize(service, nullptr);
+        _hooks = static_cast<BackupCursorHooksMock*>(BackupCursorHooks::get(service));
+
+        // The idle backup cursor reaper runs on the same mock clock that the commands use to
+        // track when the backup cursor was last used.
+        auto clockSource = stdx::make_unique<ClockSourceMock>();
+        _clockSource = clockSource.get();
+        service->setFastClockSource(std::move(clockSource));
+        service->setPeriodicRunner(stdx::make_unique<PeriodicRunnerImpl>(service, _clockSource));
+        service->getPeriodicRunner()->startup();
+    }
+
+    void tearDown() override {
+        getServiceContext()->getPeriodicRunner()->shutdown();
+        storageGlobalParams.dbpath = _savedDbpath;
+    }
+
+    BSONObj runCommand(const BSONObj& cmdObj) {
+        auto opCtx = makeOperationContext();
+        return CommandHelpers::runCommandDirectly(opCtx.get(),
+                                                  OpMsgRequest::fromDBAndBody("admin", cmdObj));
+    }
+
+    long long openBackupCursor() {
+        auto reply = runCommand(BSON("_initialSyncOpenBackupCursor" << 1));
+        ASSERT_OK(getStatusFromCommandResult(reply));
+        return reply["backupId"].numberLong();
+    }
+
+    Status readBackupFile(long long backupId,
+                          const std::string& file,
+                          long long offset,
+                          long long length,
+                          std::string* data = nullptr) {
+        auto reply = runCommand(BSON("_initialSyncReadBackupFile" << 1 << "backupId" << backupId
+                                                                  << "file"
+                                                                  << file
+                                                                  << "offset"
+                                                                  << offset
+                                                                  << "length"
+                                                                  << length));
+        auto status = getStatusFromCommandResult(reply);
+        if (status.isOK() && data) {
+            int dataLength;
+            const char* bytes = reply["data"].binData(dataLength);
+            data->assign(bytes, dataLength);
+        }
+        return status;
+    }
+
+    Status closeBackupCursor(long long backupId) {
+        return getStatusFromCommandResult(
+            runCommand(BSON("_initialSyncCloseBackupCursor" << 1 << "backupId" << backupId)));
+    }
+
+    BackupCursorHooksMock* _hooks = nullptr;
+    ClockSourceMock* _clockSource = nullptr;
+
+private:
+    unittest::TempDir _tempDir{"file_copy_initial_sync_test"};
+    std::string _savedDbpath;
+};
+
+TEST_F(FileCopyInitialSyncCommandsTest, OpenReadAndClose) {
+    auto reply = runCommand(BSON("_initialSyncOpenBackupCursor" << 1));
+    ASSERT_OK(getStatusFromCommandResult(reply));
+    ASSERT_TRUE(_hooks->isBackupCursorOpen());
+    const long long backupId = reply["backupId"].numberLong();
+
+    // The files are listed relative to the dbpath.
+    std::vector<BSONObj> files;
+    for (auto&& elem : reply["files"].Obj()) {
+        files.push_back(elem.Obj().getOwned());
+    }
+    ASSERT_EQ(files.size(), 2U);
+    ASSERT_BSONOBJ_EQ(files[0], BSON("filename" << kCollectionFile << "fileSize" << 1000LL));
+    ASSERT_BSONOBJ_EQ(files[1], BSON("filename" << kJournalFile << "fileSize" << 10LL));
+
+    std::string data;
+    ASSERT_OK(readBackupFile(backupId, kCollectionFile, 26, 3, &data));
+    ASSERT_EQ(data, "abc");
+    ASSERT_OK(readBackupFile(backupId, kJournalFile, 0, kJournalFileSize, &data));
+    ASSERT_EQ(data, "abcdefghij");
+
+    ASSERT_OK(closeBackupCursor(backupId));
+    ASSERT_FALSE(_hooks->isBackupCursorOpen());
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, 0, 1), ErrorCodes::CursorNotFound);
+
+    // Closing a backup cursor that is already closed is not an error.
+    ASSERT_OK(closeBackupCursor(backupId));
+
+    ASSERT_NE(openBackupCursor(), backupId);
+    ASSERT_TRUE(_hooks->isBackupCursorOpen());
+}
+
+TEST_F(FileCopyInitialSyncCommandsTest, OnlyOneBackupCursorAtATime) {
+    const long long backupId = openBackupCursor();
+    auto reply = runCommand(BSON("_initialSyncOpenBackupCursor" << 1));
+    ASSERT_EQ(getStatusFromCommandResult(reply), ErrorCodes::ConflictingOperationInProgress);
+
+    // Closing an unknown backup cursor leaves the open one alone.
+    ASSERT_OK(closeBackupCursor(backupId + 1));
+    ASSERT_TRUE(_hooks->isBackupCursorOpen());
+    ASSERT_OK(readBackupFile(backupId, kCollectionFile, 0, 1));
+}
+
+TEST_F(FileCopyInitialSyncCommandsTest, ReadIsBoundsChecked) {
+    const long long backupId = openBackupCursor();
+
+    ASSERT_OK(readBackupFile(backupId, kCollectionFile, 0, kCollectionFileSize));
+    ASSERT_OK(readBackupFile(backupId, kCollectionFile, kCollectionFileSize - 1, 1));
+
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, 0, 0), ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, 0, -1), ErrorCodes::BadValue);
+    ASSERT_EQ(
+        readBackupFile(backupId, kCollectionFile, 0, kFileCopyInitialSyncMaxChunkSizeBytes + 1),
+        ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, -1, 1), ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, kCollectionFileSize, 1),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, kCollectionFileSize - 10, 11),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, 0, kCollectionFileSize + 1),
+              ErrorCodes::BadValue);
+}
+
+TEST_F(FileCopyInitialSyncCommandsTest, OnlyFilesOfTheBackupCanBeRead) {
+    const long long backupId = openBackupCursor();
+
+    ASSERT_EQ(readBackupFile(backupId, "mongod.lock", 0, 1), ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, "journal/../mongod.lock", 0, 1), ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId, "../" + std::string(kCollectionFile), 0, 1),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId,
+                             (boost::filesystem::path(storageGlobalParams.dbpath) /
+                              kCollectionFile)
+                                 .string(),
+                             0,
+                             1),
+              ErrorCodes::BadValue);
+    ASSERT_EQ(readBackupFile(backupId + 1, kCollectionFile, 0, 1), ErrorCodes::CursorNotFound);
+}
+
+TEST_F(FileCopyInitialSyncCommandsTest, IdleBackupCursorIsClosed) {
+    const long long backupId = openBackupCursor();
+
+    // Reading from the backup cursor keeps it open past the timeout, which defaults to 5 minutes.
+    _clockSource->advance(Minutes(4));
+    ASSERT_OK(readBackupFile(backupId, kCollectionFile, 0, 1));
+    _clockSource->advance(Minutes(4));
+    auto reply = runCommand(BSON("_initialSyncOpenBackupCursor" << 1));
+    ASSERT_EQ(getStatusFromCommandResult(reply), ErrorCodes::ConflictingOperationInProgress);
+    ASSERT_TRUE(_hooks->isBackupCursorOpen());
+
+    _clockSource->advance(Minutes(2));
+    while (_hooks->isBackupCursorOpen()) {
+        sleepmillis(1);
+    }
+    ASSERT_EQ(readBackupFile(backupId, kCollectionFile, 0, 1), ErrorCodes::CursorNotFound);
+}
+
+TEST(FileCopyInitialSyncTest, ValidateBackupFileName) {
+    ASSERT_OK(validateBackupFileName("collection-0.wt"));
+    ASSERT_OK(validateBackupFileName("journal/WiredTigerLog.0000000001"));
+    ASSERT_OK(validateBackupFileName("db/..collection-0.wt"));
+
+    ASSERT_EQ(validateBackupFileName(""), ErrorCodes::InitialSyncFailure);
+    ASSERT_EQ(validateBackupFileName("/etc/passwd"), ErrorCodes::InitialSyncFailure);
+    ASSERT_EQ(validateBackupFileName(".."), ErrorCodes::InitialSyncFailure);
+    ASSERT_EQ(validateBackupFileName("../collection-0.wt"), ErrorCodes::InitialSyncFailure);
+    ASSERT_EQ(validateBackupFileName("journal/../../collection-0.wt"),
+              ErrorCodes::InitialSyncFailure);
+}
+
+TEST(FileCopyInitialSyncTest, PrepareDbpath) {
+    unittest::TempDir tempDir("file_copy_initial_sync_test");
+    const boost::filesystem::path dbpath(tempDir.path());
+    const auto markerFile = dbpath / "fileCopyInitialSync.inProgress";
+    writeFile(dbpath / "mongod.lock", 1);
+    writeFile(dbpath / "diagnostic.data" / "metrics.interim", 1);
+
+    // An empty dbpath is filled, with the marker file present while files are copied.
+    auto swCopyFiles = prepareDbpathForFileCopyInitialSync(tempDir.path());
+    ASSERT_OK(swCopyFiles.getStatus());
+    ASSERT_TRUE(swCopyFiles.getValue());
+    ASSERT_TRUE(boost::filesystem::exists(markerFile));
+
+    // A copy that was interrupted is restarted from scratch.
+    writeFile(dbpath / kCollectionFile, kCollectionFileSize);
+    writeFile(dbpath / kJournalFile, kJournalFileSize);
+    swCopyFiles = prepareDbpathForFileCopyInitialSync(tempDir.path());
+    ASSERT_OK(swCopyFiles.getStatus());
+    ASSERT_TRUE(swCopyFiles.getValue());
+    ASSERT_TRUE(boost::filesystem::exists(markerFile));
+    ASSERT_FALSE(boost::filesystem::exists(dbpath / kCollectionFile));
+    ASSERT_FALSE(boost::filesystem::exists(dbpath / "journal"));
+    ASSERT_TRUE(boost::filesystem::exists(dbpath / "mongod.lock"));
+    ASSERT_TRUE(boost::filesystem::exists(dbpath / "diagnostic.data" / "metrics.interim"));
+
+    // The data files of a finished copy, or of any other node, are left alone.
+    boost::filesystem::remove(markerFile);
+    writeFile(dbpath / kCollectionFile, kCollectionFileSize);
+    swCopyFiles = prepareDbpathForFileCopyInitialSync(tempDir.path());
+    ASSERT_OK(swCopyFiles.getStatus());
+    ASSERT_FALSE(swCopyFiles.getValue());
+    ASSERT_FALSE(boost::filesystem::exists(markerFile));
+    ASSERT_TRUE(boost::filesystem::exists(dbpath / kCollectionFile));
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
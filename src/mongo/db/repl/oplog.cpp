@@ -1075,7 +1075,8 @@ Status applyOperation_inlock(OperationContext* opCtx,
                              const BSONObj& op,
                              bool alwaysUpsert,
                              OplogApplication::Mode mode,
-                             IncrementOpsAppliedStatsFn incrementOpsAppliedStats) {
+                             IncrementOpsAppliedStatsFn incrementOpsAppliedStats,
+                             bool isGroupedApplication) {
     LOG(3) << "applying op: " << redact(op)
            << ", oplog application mode: " << OplogApplication::modeToString(mode);
 
@@ -1195,7 +1196,16 @@ Status applyOperation_inlock(OperationContext* opCtx,
     //    the individual operations will not contain a `ts` field. The caller is responsible for
     //    setting the timestamp before committing. Assigning a competing timestamp in this
     //    codepath would break that atomicity. Sharding is a consumer of this use-case.
-    const bool assignOperationTimestamp = [opCtx, haveWrappingWriteUnitOfWork, mode] {
+    //
+    //   Grouped secondary oplog application: The secondary applies a run of updates and deletes on
+    //    one collection in a single `WriteUnitOfWork`. Each write still uses the timestamp in its
+    //    operation document, which the storage engine allows within one transaction.
+    const bool assignOperationTimestamp = [
+        opCtx,
+        haveWrappingWriteUnitOfWork,
+        mode,
+        isGroupedApplication
+    ] {
         const auto replMode = ReplicationCoordinator::get(opCtx)->getReplicationMode();
         if (opCtx->writesAreReplicated()) {
             // We do not assign timestamps on replicated writes since they will get their oplog
@@ -1204,7 +1214,7 @@ Status applyOperation_inlock(OperationContext* opCtx,
         } else {
             switch (replMode) {
                 case ReplicationCoordinator::modeReplSet: {
-                    if (haveWrappingWriteUnitOfWork) {
+                    if (haveWrappingWriteUnitOfWork && !isGroupedApplication) {
                         // We do not assign timestamps to non-replicated writes that have a wrapping
                         // WUOW. These must be operations inside of atomic 'applyOps' commands being
                         // applied on a secondary. They will get the timestamp of the outer
@@ -1225,6 +1235,8 @@ Status applyOperation_inlock(OperationContext* opCtx,
     invariant(!assignOperationTimestamp || !fieldTs.eoo(),
               str::stream() << "Oplog entry did not have 'ts' field when expected: " << redact(op));
 
+    invariant(!isGroupedApplication || *opType == 'u' || *opType == 'd');
+
     if (*opType == 'i') {
         uassert(ErrorCodes::NamespaceNotFound,
                 str::stream() << "Failed to apply insert due to missing collection: "
@@ -214,6 +214,9 @@ inline std::ostream& operator<<(std::ostream& s, OplogApplication::Mode mode) {
  * @param alwaysUpsert convert some updates to upserts for idempotency reasons
  * @param mode specifies what oplog application mode we are in
  * @param incrementOpsAppliedStats is called whenever an op is applied.
+ * @param isGroupedApplication the op is an update or delete that the caller applies together with
+ *        others in a single WriteUnitOfWork. Unlike ops in an atomic applyOps, it is still written
+ *        with the timestamp from its 'ts' field.
  * Returns failure status if the op was an update that could not be applied.
  */
 Status applyOperation_inlock(OperationContext* opCtx,
@@ -221,7 +224,8 @@ Status applyOperation_inlock(OperationContext* opCtx,
                              const BSONObj& op,
                              bool alwaysUpsert,
                              OplogApplication::Mode mode,
-                             IncrementOpsAppliedStatsFn incrementOpsAppliedStats = {});
+                             IncrementOpsAppliedStatsFn incrementOpsAppliedStats = {},
+                             bool isGroupedApplication = false);
 
 /**
  * Take a command op and apply it locally
@@ -194,43 +194,6 @@ ExportedServerParameter<bool, ServerParameterType::kStartupOnly> TestingSnapshot
 
 }  // namespace
 
-ReplicationCoordinatorImpl::Waiter::Waiter(OpTime _opTime, const WriteConcernOptions* _writeConcern)
-    : opTime(std::move(_opTime)), writeConcern(_writeConcern) {}
-
-BSONObj ReplicationCoordinatorImpl::Waiter::toBSON() const {
-    BSONObjBuilder bob;
-    bob.append("opTime", opTime.toBSON());
-    if (writeConcern) {
-        bob.append("writeConcern", writeConcern->toBSON());
-    }
-    return bob.obj();
-};
-
-std::string ReplicationCoordinatorImpl::Waiter::toString() const {
-    return toBSON().toString();
-};
-
-
-ReplicationCoordinatorImpl::ThreadWaiter::ThreadWaiter(OpTime _opTime,
-                                                       const WriteConcernOptions* _writeConcern,
-                                                       stdx::condition_variable* _condVar)
-    : Waiter(_opTime, _writeConcern), condVar(_condVar) {}
-
-void ReplicationCoordinatorImpl::ThreadWaiter::notify_inlock() {
-    invariant(condVar);
-    condVar->notify_all();
-}
-
-ReplicationCoordinatorImpl::CallbackWaiter::CallbackWaiter(OpTime _opTime,
-                                                           FinishFunc _finishCallback)
-    : Waiter(_opTime, nullptr), finishCallback(std::move(_finishCallback)) {}
-
-void ReplicationCoordinatorImpl::CallbackWaiter::notify_inlock() {
-    invariant(finishCallback);
-    finishCallback();
-}
-
-
 class ReplicationCoordinatorImpl::WaiterGuard {
 public:
     /**
@@ -261,60 +224,6 @@ private:
     Waiter* _waiter;
 };
 
-void ReplicationCoordinatorImpl::WaiterList::add_inlock(WaiterType waiter) {
-    _list.push_back(waiter);
-}
-
-void ReplicationCoordinatorImpl::WaiterList::signalIf_inlock(
-    stdx::function<bool(WaiterType)> func) {
-    for (auto it = _list.begin(); it != _list.end();) {
-        if (!func(*it)) {
-            // This element doesn't match, so we advance the iterator to the next one.
-            ++it;
-            continue;
-        }
-
-        if (!(*it)->runs_once()) {
-            (*it)->notify_inlock();
-            // Keep the waiter on the list and let the guard remove it instead. Advance the
-            // iterator since we are skipping the removal.
-            ++it;
-            continue;
-        }
-
-        // Remove the waiter from the list if it was only meant to be notified once.
-        WaiterType waiter = std::move(*it);
-
-        if (it == std::prev(_list.end())) {
-            // Iterator will be invalid after erasing the last element, so set it to the
-            // next one (i.e. end()).
-            it = _list.erase(it);
-        } else {
-            // Iterator is still valid after pop_back().
-            std::swap(*it, _list.back());
-            _list.pop_back();
-        }
-        // It's important to call notify() after the waiter has been removed from the list
-        // since notify() might remove the waiter itself.
-        waiter->notify_inlock();
-    }
-}
-
-
-void ReplicationCoordinatorImpl::WaiterList::signalAll_inlock() {
-    this->signalIf_inlock([](Waiter* waiter) { return true; });
-}
-
-bool ReplicationCoordinatorImpl::WaiterList::remove_inlock(WaiterType waiter) {
-    auto it = std::find(_list.begin(), _list.end(), waiter);
-    if (it == _list.end()) {
-        return false;
-    }
-    std::swap(*it, _list.back());
-    _list.pop_back();
-    return true;
-}
-
 namespace {
 ReplicationCoordinator::Mode getReplicationModeFromSettings(const ReplSettings& settings) {
     if (settings.usingReplSets()) {
@@ -1429,7 +1338,7 @@ Status ReplicationCoordinatorImpl::setLastDurableOptime_forTest(long long cfgVer
 
     const UpdatePositionArgs::UpdateInfo update(OpTime(), opTime, cfgVer, memberId);
     long long configVersion;
-    const auto status = _setLastOptime_inlock(update, &configVersion);
+    const auto status = _setLastOptime_inlock(update, &configVersion).getStatus();
     _updateLastCommittedOpTime_inlock();
     return status;
 }
@@ -1442,24 +1351,19 @@ Status ReplicationCoordinatorImpl::setLastAppliedOptime_forTest(long long cfgVer
 
     const UpdatePositionArgs::UpdateInfo update(opTime, OpTime(), cfgVer, memberId);
     long long configVersion;
-    const auto status = _setLastOptime_inlock(update, &configVersion);
+    const auto status = _setLastOptime_inlock(update, &configVersion).getStatus();
     _updateLastCommittedOpTime_inlock();
     return status;
 }
 
-Status ReplicationCoordinatorImpl::_setLastOptime_inlock(const UpdatePositionArgs::UpdateInfo& args,
-                                                         long long* configVersion) {
+StatusWith<bool> ReplicationCoordinatorImpl::_setLastOptime_inlock(
+    const UpdatePositionArgs::UpdateInfo& args, long long* configVersion) {
     auto result = _topCoord->setLastOptime(args, _replExecutor->now(), configVersion);
     if (!result.isOK())
         return result.getStatus();
-    const bool advancedOpTime = result.getValue();
-    // Only update committed optime if the remote optimes increased.
-    if (advancedOpTime) {
-        _updateLastCommittedOpTime_inlock();
-    }
 
     _cancelAndRescheduleLivenessUpdate_inlock(args.memberId);
-    return Status::OK();
+    return result.getValue();
 }
 
 bool ReplicationCoordinatorImpl::_doneWaitingForReplication_inlock(
@@ -2875,14 +2779,23 @@ Status ReplicationCoordinatorImpl::processReplSetUpdatePosition(const UpdatePosi
     stdx::unique_lock<stdx::mutex> lock(_mutex);
     Status status = Status::OK();
     bool somethingChanged = false;
+    bool advancedOpTime = false;
     for (UpdatePositionArgs::UpdateIterator update = updates.updatesBegin();
          update != updates.updatesEnd();
          ++update) {
-        status = _setLastOptime_inlock(*update, configVersion);
-        if (!status.isOK()) {
+        auto result = _setLastOptime_inlock(*update, configVersion);
+        if (!result.isOK()) {
+            status = result.getStatus();
             break;
         }
         somethingChanged = true;
+        advancedOpTime = advancedOpTime || result.getValue();
+    }
+
+    // Only update committed optime if the remote optimes increased, and only once for all the
+    // members in the command.
+    if (advancedOpTime) {
+        _updateLastCommittedOpTime_inlock();
     }
 
     if (somethingChanged && !_getMemberState_inlock().primary()) {
@@ -0,0 +1,149 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/replication_waiter_list.h"
+
+#include <functional>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+ReplicationWaiter::ReplicationWaiter(OpTime _opTime, const WriteConcernOptions* _writeConcern)
+    : opTime(std::move(_opTime)), writeConcern(_writeConcern) {}
+
+BSONObj ReplicationWaiter::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("opTime", opTime.toBSON());
+    if (writeConcern) {
+        bob.append("writeConcern", writeConcern->toBSON());
+    }
+    return bob.obj();
+};
+
+std::string ReplicationWaiter::toString() const {
+    return toBSON().toString();
+};
+
+
+ThreadWaiter::ThreadWaiter(OpTime _opTime,
+                           const WriteConcernOptions* _writeConcern,
+                           stdx::condition_variable* _condVar)
+    : ReplicationWaiter(_opTime, _writeConcern), condVar(_condVar) {}
+
+void ThreadWaiter::notify_inlock() {
+    invariant(condVar);
+    condVar->notify_all();
+}
+
+CallbackWaiter::CallbackWaiter(OpTime _opTime, FinishFunc _finishCallback)
+    : ReplicationWaiter(_opTime, nullptr), finishCallback(std::move(_finishCallback)) {}
+
+void CallbackWaiter::notify_inlock() {
+    invariant(finishCallback);
+    finishCallback();
+}
+
+bool ReplicationWaiterList::WaiterLess::operator()(WaiterType lhs, WaiterType rhs) const {
+    if (lhs->opTime != rhs->opTime) {
+        return lhs->opTime < rhs->opTime;
+    }
+    // Several waiters may wait for the same opTime, so break ties by address.
+    return std::less<WaiterType>()(lhs, rhs);
+}
+
+ReplicationWaiterList::WriteConcernKey ReplicationWaiterList::_makeKey(WaiterType waiter) {
+    if (!waiter->writeConcern) {
+        return WriteConcernKey{};
+    }
+    const auto& writeConcern = *waiter->writeConcern;
+    return WriteConcernKey{writeConcern.wMode, writeConcern.wNumNodes, writeConcern.syncMode};
+}
+
+void ReplicationWaiterList::add_inlock(WaiterType waiter) {
+    if (_waiters[_makeKey(waiter)].insert(waiter).second) {
+        ++_size;
+    }
+}
+
+bool ReplicationWaiterList::remove_inlock(WaiterType waiter) {
+    auto group = _waiters.find(_makeKey(waiter));
+    if (group == _waiters.end() || !group->second.erase(waiter)) {
+        return false;
+    }
+    if (group->second.empty()) {
+        _waiters.erase(group);
+    }
+    --_size;
+    return true;
+}
+
+void ReplicationWaiterList::signalIf_inlock(stdx::function<bool(WaiterType)> func) {
+    std::vector<WaiterType> satisfied;
+    for (auto group = _waiters.begin(); group != _waiters.end();) {
+        auto& waiters = group->second;
+        // Since the condition is monotonic in opTime, no waiter after the first unsatisfied one
+        // can be satisfied either.
+        for (auto it = waiters.begin(); it != waiters.end() && func(*it);) {
+            satisfied.push_back(*it);
+            if (!(*it)->runs_once()) {
+                // Keep the waiter on the list and let the guard remove it instead.
+                ++it;
+                continue;
+            }
+
+            // Remove the waiter from the list if it was only meant to be notified once.
+            it = waiters.erase(it);
+            --_size;
+        }
+        group = waiters.empty() ? _waiters.erase(group) : std::next(group);
+    }
+
+    // It's important to call notify() after the waiters have been removed from the list since
+    // notify() might add or remove waiters itself.
+    for (auto&& waiter : satisfied) {
+        waiter->notify_inlock();
+    }
+}
+
+void ReplicationWaiterList::signalAll_inlock() {
+    this->signalIf_inlock([](WaiterType waiter) { return true; });
+}
+
+size_t ReplicationWaiterList::size_inlock() const {
+    return _size;
+}
+
+}  // namespace repl
+}  // namespace mongo
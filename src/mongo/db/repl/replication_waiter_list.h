@@ -0,0 +1,141 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/write_concern_options.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+namespace repl {
+
+// Abstract struct that holds information about clients waiting for replication.
+// Subclasses need to define how to notify them.
+struct ReplicationWaiter {
+    ReplicationWaiter(OpTime _opTime, const WriteConcernOptions* _writeConcern);
+    virtual ~ReplicationWaiter() = default;
+
+    BSONObj toBSON() const;
+    std::string toString() const;
+    // Controls whether or not this Waiter should stay on the list upon notification.
+    virtual bool runs_once() const = 0;
+
+    // It is invalid to call notify_inlock() unless holding ReplicationCoordinatorImpl::_mutex.
+    virtual void notify_inlock() = 0;
+
+    const OpTime opTime;
+    const WriteConcernOptions* writeConcern = nullptr;
+};
+
+// When ThreadWaiter gets notified, it will signal the conditional variable.
+//
+// This is used when a thread wants to block inline until the opTime is reached with the given
+// writeConcern.
+struct ThreadWaiter : public ReplicationWaiter {
+    ThreadWaiter(OpTime _opTime,
+                 const WriteConcernOptions* _writeConcern,
+                 stdx::condition_variable* _condVar);
+    void notify_inlock() override;
+    bool runs_once() const override {
+        return false;
+    }
+
+    stdx::condition_variable* condVar = nullptr;
+};
+
+// When the waiter is notified, finishCallback will be called while holding replCoord _mutex
+// since ReplicationWaiterLists are protected by _mutex.
+//
+// This is used when we want to run a callback when the opTime is reached.
+struct CallbackWaiter : public ReplicationWaiter {
+    using FinishFunc = stdx::function<void()>;
+
+    CallbackWaiter(OpTime _opTime, FinishFunc _finishCallback);
+    void notify_inlock() override;
+    bool runs_once() const override {
+        return true;
+    }
+
+    // The callback that will be called when this waiter is notified.
+    FinishFunc finishCallback = nullptr;
+};
+
+/**
+ * The waiters for replication or for an opTime, indexed by write concern and then ordered by
+ * opTime, so that a progress update only visits the waiters it satisfies rather than every
+ * waiter on the list.
+ *
+ * Like the waiters themselves, the list is guarded by ReplicationCoordinatorImpl::_mutex.
+ */
+class ReplicationWaiterList {
+public:
+    using WaiterType = ReplicationWaiter*;
+
+    // Adds waiter into the list.
+    void add_inlock(WaiterType waiter);
+    // Returns whether waiter is found and removed.
+    bool remove_inlock(WaiterType waiter);
+    // Signals all waiters that satisfy the condition. The condition must be monotonic in opTime:
+    // if it holds for a waiter, it must also hold for every waiter with the same write concern and
+    // an earlier opTime. The waiters of each write concern are visited in opTime order, stopping at
+    // the first one which does not satisfy it.
+    void signalIf_inlock(stdx::function<bool(WaiterType)> fun);
+    // Signals all waiters from the list.
+    void signalAll_inlock();
+    // Returns the number of waiters on the list.
+    size_t size_inlock() const;
+
+private:
+    // The fields of a write concern which decide whether a waiter is satisfied at an opTime.
+    using WriteConcernKey = std::tuple<std::string, int, WriteConcernOptions::SyncMode>;
+
+    struct WaiterLess {
+        bool operator()(WaiterType lhs, WaiterType rhs) const;
+    };
+
+    using WaiterSet = std::set<WaiterType, WaiterLess>;
+
+    static WriteConcernKey _makeKey(WaiterType waiter);
+
+    std::map<WriteConcernKey, WaiterSet> _waiters;
+    size_t _size = 0;
+};
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,103 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <deque>
+
+#include "mongo/db/repl/replication_waiter_list.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * A waiter for a w:majority write which only counts its notifications.
+ */
+struct CountingWaiter : public ReplicationWaiter {
+    CountingWaiter(OpTime opTime, const WriteConcernOptions* writeConcern, int64_t* notified)
+        : ReplicationWaiter(opTime, writeConcern), notified(notified) {}
+
+    void notify_inlock() override {
+        ++*notified;
+    }
+
+    bool runs_once() const override {
+        return true;
+    }
+
+    int64_t* notified;
+};
+
+OpTime makeOpTime(int64_t i) {
+    return OpTime(Timestamp(Seconds(i), 0), 1);
+}
+
+/**
+ * Models state.range(0) concurrent w:majority writers: each iteration advances the commit point by
+ * one write, which satisfies exactly one waiter, and a new writer starts waiting at the tip.
+ */
+void BM_SignalMajorityWaiters(benchmark::State& state) {
+    const int64_t numWaiters = state.range(0);
+    const WriteConcernOptions writeConcern(
+        WriteConcernOptions::kMajority, WriteConcernOptions::SyncMode::JOURNAL, Milliseconds(0));
+
+    ReplicationWaiterList waiterList;
+    std::deque<std::unique_ptr<CountingWaiter>> waiters;
+    int64_t notified = 0;
+    for (int64_t i = 1; i <= numWaiters; ++i) {
+        waiters.push_back(
+            stdx::make_unique<CountingWaiter>(makeOpTime(i), &writeConcern, &notified));
+        waiterList.add_inlock(waiters.back().get());
+    }
+
+    int64_t commitPoint = 0;
+    for (auto _ : state) {
+        const auto committed = makeOpTime(++commitPoint);
+        waiterList.signalIf_inlock(
+            [&](ReplicationWaiter* waiter) { return waiter->opTime <= committed; });
+
+        waiters.pop_front();
+        waiters.push_back(stdx::make_unique<CountingWaiter>(
+            makeOpTime(commitPoint + numWaiters), &writeConcern, &notified));
+        waiterList.add_inlock(waiters.back().get());
+    }
+
+    invariant(notified == commitPoint);
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SignalMajorityWaiters)->Arg(1)->Arg(1000)->Arg(20000);
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
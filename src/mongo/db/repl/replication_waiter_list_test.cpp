@@ -0,0 +1,174 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/replication_waiter_list.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * A waiter which records the order in which waiters are notified.
+ */
+struct RecordingWaiter : public ReplicationWaiter {
+    RecordingWaiter(OpTime opTime,
+                    const WriteConcernOptions* writeConcern,
+                    std::vector<ReplicationWaiter*>* notified,
+                    bool runsOnce = true)
+        : ReplicationWaiter(opTime, writeConcern), notified(notified), runsOnce(runsOnce) {}
+
+    void notify_inlock() override {
+        notified->push_back(this);
+    }
+
+    bool runs_once() const override {
+        return runsOnce;
+    }
+
+    std::vector<ReplicationWaiter*>* notified;
+    const bool runsOnce;
+};
+
+OpTime makeOpTime(unsigned int secs) {
+    return OpTime(Timestamp(secs, 0), 1);
+}
+
+const WriteConcernOptions kMajority(WriteConcernOptions::kMajority,
+                                    WriteConcernOptions::SyncMode::JOURNAL,
+                                    Milliseconds(0));
+const WriteConcernOptions kTwoNodes(2, WriteConcernOptions::SyncMode::NONE, Milliseconds(0));
+
+TEST(ReplicationWaiterListTest, SignalsSatisfiedWaitersInOpTimeOrder) {
+    std::vector<ReplicationWaiter*> notified;
+    RecordingWaiter waiter3(makeOpTime(3), &kMajority, &notified);
+    RecordingWaiter waiter1(makeOpTime(1), &kMajority, &notified);
+    RecordingWaiter waiter2(makeOpTime(2), &kMajority, &notified);
+
+    ReplicationWaiterList waiterList;
+    waiterList.add_inlock(&waiter3);
+    waiterList.add_inlock(&waiter1);
+    waiterList.add_inlock(&waiter2);
+    ASSERT_EQ(3U, waiterList.size_inlock());
+
+    waiterList.signalIf_inlock(
+        [](ReplicationWaiter* candidate) { return candidate->opTime <= makeOpTime(2); });
+    ASSERT_EQ(2U, notified.size());
+    ASSERT_EQ(&waiter1, notified[0]);
+    ASSERT_EQ(&waiter2, notified[1]);
+    ASSERT_EQ(1U, waiterList.size_inlock());
+
+    // Notified waiters which run once are no longer on the list.
+    ASSERT_FALSE(waiterList.remove_inlock(&waiter1));
+    ASSERT_TRUE(waiterList.remove_inlock(&waiter3));
+    ASSERT_EQ(0U, waiterList.size_inlock());
+}
+
+TEST(ReplicationWaiterListTest, StopsAtFirstUnsatisfiedWaiterOfEachWriteConcern) {
+    std::vector<ReplicationWaiter*> notified;
+    std::vector<RecordingWaiter> waiters;
+    waiters.reserve(20);
+    ReplicationWaiterList waiterList;
+    for (unsigned int i = 1; i <= 10; ++i) {
+        waiters.emplace_back(makeOpTime(i), &kMajority, &notified);
+        waiterList.add_inlock(&waiters.back());
+        waiters.emplace_back(makeOpTime(i), &kTwoNodes, &notified);
+        waiterList.add_inlock(&waiters.back());
+    }
+
+    // Majority is satisfied through opTime 3, and w:2 through opTime 5.
+    int checked = 0;
+    waiterList.signalIf_inlock([&](ReplicationWaiter* waiter) {
+        ++checked;
+        const auto satisfiedUpTo = waiter->writeConcern == &kMajority ? 3U : 5U;
+        return waiter->opTime <= makeOpTime(satisfiedUpTo);
+    });
+    ASSERT_EQ(8U, notified.size());
+    ASSERT_EQ(12U, waiterList.size_inlock());
+
+    // Only the satisfied waiters and the first unsatisfied waiter of each write concern are
+    // checked.
+    ASSERT_EQ(10, checked);
+}
+
+TEST(ReplicationWaiterListTest, KeepsWaitersWhichDoNotRunOnce) {
+    std::vector<ReplicationWaiter*> notified;
+    RecordingWaiter waiter(makeOpTime(1), nullptr, &notified, false);
+
+    ReplicationWaiterList waiterList;
+    waiterList.add_inlock(&waiter);
+    waiterList.signalIf_inlock(
+        [](ReplicationWaiter* candidate) { return candidate->opTime <= makeOpTime(1); });
+    ASSERT_EQ(1U, notified.size());
+
+    // The waiter stays on the list until its owner removes it.
+    ASSERT_EQ(1U, waiterList.size_inlock());
+    ASSERT_TRUE(waiterList.remove_inlock(&waiter));
+    ASSERT_EQ(0U, waiterList.size_inlock());
+}
+
+TEST(ReplicationWaiterListTest, SignalAllNotifiesEveryWaiter) {
+    std::vector<ReplicationWaiter*> notified;
+    RecordingWaiter waiter1(makeOpTime(1), &kMajority, &notified);
+    RecordingWaiter waiter2(makeOpTime(1), &kMajority, &notified);
+    RecordingWaiter waiter3(makeOpTime(2), &kTwoNodes, &notified);
+    RecordingWaiter waiter4(makeOpTime(3), nullptr, &notified);
+
+    ReplicationWaiterList waiterList;
+    waiterList.add_inlock(&waiter1);
+    waiterList.add_inlock(&waiter2);
+    waiterList.add_inlock(&waiter3);
+    waiterList.add_inlock(&waiter4);
+    ASSERT_EQ(4U, waiterList.size_inlock());
+
+    waiterList.signalAll_inlock();
+    ASSERT_EQ(4U, notified.size());
+    ASSERT_EQ(0U, waiterList.size_inlock());
+}
+
+TEST(ReplicationWaiterListTest, NotifiedWaiterCanAddWaiters) {
+    std::vector<ReplicationWaiter*> notified;
+    ReplicationWaiterList waiterList;
+    RecordingWaiter next(makeOpTime(2), nullptr, &notified);
+    CallbackWaiter waiter(makeOpTime(1), [&] { waiterList.add_inlock(&next); });
+
+    waiterList.add_inlock(&waiter);
+    waiterList.signalIf_inlock(
+        [](ReplicationWaiter* candidate) { return candidate->opTime <= makeOpTime(2); });
+    ASSERT_TRUE(notified.empty());
+    ASSERT_EQ(1U, waiterList.size_inlock());
+    ASSERT_TRUE(waiterList.remove_inlock(&next));
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
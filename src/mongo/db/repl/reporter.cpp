@@ -34,6 +34,8 @@
 
 #include "mongo/db/repl/reporter.h"
 
+#include <algorithm>
+
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/repl/update_position_args.h"
 #include "mongo/rpc/get_status_from_command_result.h"
@@ -91,12 +93,14 @@ Reporter::Reporter(executor::TaskExecutor* executor,
                    PrepareReplSetUpdatePositionCommandFn prepareReplSetUpdatePositionCommandFn,
                    const HostAndPort& target,
                    Milliseconds keepAliveInterval,
-                   Milliseconds updatePositionTimeout)
+                   Milliseconds updatePositionTimeout,
+                   size_t maxCommandsInFlight)
     : _executor(executor),
       _prepareReplSetUpdatePositionCommandFn(prepareReplSetUpdatePositionCommandFn),
       _target(target),
       _keepAliveInterval(keepAliveInterval),
-      _updatePositionTimeout(updatePositionTimeout) {
+      _updatePositionTimeout(updatePositionTimeout),
+      _maxCommandsInFlight(maxCommandsInFlight) {
     uassert(ErrorCodes::BadValue, "null task executor", executor);
     uassert(ErrorCodes::BadValue,
             "null function to create replSetUpdatePosition command object",
@@ -108,6 +112,9 @@ Reporter::Reporter(executor::TaskExecutor* executor,
     uassert(ErrorCodes::BadValue,
             "update position timeout must be positive",
             updatePositionTimeout > Milliseconds(0));
+    uassert(ErrorCodes::BadValue,
+            "maximum number of commands in flight must be positive",
+            maxCommandsInFlight > 0);
 }
 
 Reporter::~Reporter() {
@@ -139,17 +146,17 @@ void Reporter::shutdown() {
 
     _isWaitingToSendReporter = false;
 
-    executor::TaskExecutor::CallbackHandle handle;
-    if (_remoteCommandCallbackHandle.isValid()) {
-        invariant(!_prepareAndSendCommandCallbackHandle.isValid());
-        handle = _remoteCommandCallbackHandle;
-    } else {
-        invariant(!_remoteCommandCallbackHandle.isValid());
-        invariant(_prepareAndSendCommandCallbackHandle.isValid());
-        handle = _prepareAndSendCommandCallbackHandle;
-    }
+    // With a single command in flight, at most one of the remote command and the task preparing
+    // the next command is scheduled.
+    invariant(_maxCommandsInFlight > 1 || _remoteCommandCallbackHandles.empty() ||
+              !_prepareAndSendCommandCallbackHandle.isValid());
 
-    _executor->cancel(handle);
+    for (auto&& handle : _remoteCommandCallbackHandles) {
+        _executor->cancel(handle);
+    }
+    if (_prepareAndSendCommandCallbackHandle.isValid()) {
+        _executor->cancel(_prepareAndSendCommandCallbackHandle);
+    }
 }
 
 Status Reporter::join() {
@@ -172,7 +179,8 @@ Status Reporter::trigger() {
         _keepAliveTimeoutWhen = Date_t();
         _executor->cancel(_prepareAndSendCommandCallbackHandle);
         return Status::OK();
-    } else if (_isActive_inlock()) {
+    } else if (_prepareAndSendCommandCallbackHandle.isValid() ||
+               _remoteCommandCallbackHandles.size() >= _maxCommandsInFlight) {
         _isWaitingToSendReporter = true;
         return Status::OK();
     }
@@ -234,7 +242,7 @@ void Reporter::_sendCommand_inlock(BSONObj commandRequest, Milliseconds netTimeo
         return;
     }
 
-    _remoteCommandCallbackHandle = scheduleResult.getValue();
+    _remoteCommandCallbackHandles.push_back(scheduleResult.getValue());
 }
 
 void Reporter::_processResponseCallback(
@@ -243,15 +251,18 @@ void Reporter::_processResponseCallback(
         stdx::lock_guard<stdx::mutex> lk(_mutex);
 
         // If the reporter was shut down before this callback is invoked,
-        // return the canceled "_status".
+        // return the canceled "_status". With several commands in flight, the reporter may also
+        // have been stopped by the failure of another command.
         if (!_status.isOK()) {
-            invariant(_status == ErrorCodes::CallbackCanceled);
+            invariant(_status == ErrorCodes::CallbackCanceled || _maxCommandsInFlight > 1);
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
             _onShutdown_inlock();
             return;
         }
 
         _status = rcbd.response.status;
         if (!_status.isOK()) {
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
             _onShutdown_inlock();
             return;
         }
@@ -270,10 +281,24 @@ void Reporter::_processResponseCallback(
             // Do not resend update command immediately.
             _isWaitingToSendReporter = false;
         } else if (!_status.isOK()) {
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
             _onShutdown_inlock();
             return;
         }
 
+        // The task preparing the next command will report the latest progress.
+        if (_prepareAndSendCommandCallbackHandle.isValid()) {
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
+            return;
+        }
+
+        // A command sent after this one is still in flight, and will schedule the keep alive once
+        // it completes.
+        if (!_isWaitingToSendReporter && _remoteCommandCallbackHandles.size() > 1) {
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
+            return;
+        }
+
         if (!_isWaitingToSendReporter) {
             // Since we are also on a timer, schedule a report for that interval, or until
             // triggered.
@@ -285,6 +310,7 @@ void Reporter::_processResponseCallback(
                 });
             _status = scheduleResult.getStatus();
             if (!_status.isOK()) {
+                _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
                 _onShutdown_inlock();
                 return;
             }
@@ -292,7 +318,7 @@ void Reporter::_processResponseCallback(
             _prepareAndSendCommandCallbackHandle = scheduleResult.getValue();
             _keepAliveTimeoutWhen = when;
 
-            _remoteCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
+            _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
             return;
         }
     }
@@ -301,6 +327,7 @@ void Reporter::_processResponseCallback(
     auto prepareResult = _prepareCommand();
 
     stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _eraseRemoteCommandCallbackHandle_inlock(rcbd.myHandle);
     if (!_status.isOK()) {
         _onShutdown_inlock();
         return;
@@ -312,7 +339,7 @@ void Reporter::_processResponseCallback(
         return;
     }
 
-    invariant(_remoteCommandCallbackHandle.isValid());
+    invariant(!_remoteCommandCallbackHandles.empty());
     _isWaitingToSendReporter = false;
 }
 
@@ -321,6 +348,7 @@ void Reporter::_prepareAndSendCommandCallback(const executor::TaskExecutor::Call
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         if (!_status.isOK()) {
+            _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
             _onShutdown_inlock();
             return;
         }
@@ -334,6 +362,7 @@ void Reporter::_prepareAndSendCommandCallback(const executor::TaskExecutor::Call
         }
 
         if (!_status.isOK()) {
+            _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
             _onShutdown_inlock();
             return;
         }
@@ -344,26 +373,42 @@ void Reporter::_prepareAndSendCommandCallback(const executor::TaskExecutor::Call
 
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     if (!_status.isOK()) {
+        _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
         _onShutdown_inlock();
         return;
     }
 
     _sendCommand_inlock(prepareResult.getValue(), _updatePositionTimeout);
     if (!_status.isOK()) {
+        _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
         _onShutdown_inlock();
         return;
     }
 
-    invariant(_remoteCommandCallbackHandle.isValid());
+    invariant(!_remoteCommandCallbackHandles.empty());
     _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
     _keepAliveTimeoutWhen = Date_t();
 }
 
+void Reporter::_eraseRemoteCommandCallbackHandle_inlock(
+    const executor::TaskExecutor::CallbackHandle& handle) {
+    auto it = std::find(
+        _remoteCommandCallbackHandles.begin(), _remoteCommandCallbackHandles.end(), handle);
+    invariant(it != _remoteCommandCallbackHandles.end());
+    _remoteCommandCallbackHandles.erase(it);
+}
+
 void Reporter::_onShutdown_inlock() {
     _isWaitingToSendReporter = false;
-    _remoteCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
-    _prepareAndSendCommandCallbackHandle = executor::TaskExecutor::CallbackHandle();
     _keepAliveTimeoutWhen = Date_t();
+
+    // Any other outstanding work becomes inactive once its callback runs.
+    for (auto&& handle : _remoteCommandCallbackHandles) {
+        _executor->cancel(handle);
+    }
+    if (_prepareAndSendCommandCallbackHandle.isValid()) {
+        _executor->cancel(_prepareAndSendCommandCallbackHandle);
+    }
     _condition.notify_all();
 }
 
@@ -373,7 +418,8 @@ bool Reporter::isActive() const {
 }
 
 bool Reporter::_isActive_inlock() const {
-    return _remoteCommandCallbackHandle.isValid() || _prepareAndSendCommandCallbackHandle.isValid();
+    return !_remoteCommandCallbackHandles.empty() ||
+        _prepareAndSendCommandCallbackHandle.isValid();
 }
 
 bool Reporter::isWaitingToSendReport() const {
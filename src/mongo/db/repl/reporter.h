@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/jsobj.h"
@@ -60,6 +62,11 @@ namespace repl {
  * Calling trigger() while the reporter is in state 1 or 2 will cause the reporter to immediately
  * send a new command upon receiving a successful command response.
  *
+ * If the reporter is allowed more than one command in flight, calling trigger() in state 2 instead
+ * sends a new command right away, as long as fewer than "_maxCommandsInFlight" commands are
+ * awaiting their response. Progress made while that many are in flight is coalesced into a single
+ * command sent once one of them completes.
+ *
  * Calling trigger() while it is in state 3 sends a command upstream and cancels the current
  * keep alive timeout, resetting the keep alive schedule.
  */
@@ -79,7 +86,8 @@ public:
              PrepareReplSetUpdatePositionCommandFn prepareReplSetUpdatePositionCommandFn,
              const HostAndPort& target,
              Milliseconds keepAliveInterval,
-             Milliseconds updatePositionTimeout);
+             Milliseconds updatePositionTimeout,
+             size_t maxCommandsInFlight = 1);
 
     virtual ~Reporter();
 
@@ -166,7 +174,15 @@ private:
                                         bool fromTrigger);
 
     /**
-     * Signals end of Reporter work and notifies waiters.
+     * Forgets the remote command with the given callback handle once its response is processed.
+     */
+    void _eraseRemoteCommandCallbackHandle_inlock(
+        const executor::TaskExecutor::CallbackHandle& handle);
+
+    /**
+     * Signals end of Reporter work and notifies waiters. The caller must have cleared the callback
+     * handle of the work it is running. Other commands still in flight are canceled, and become
+     * inactive when their callbacks run.
      */
     void _onShutdown_inlock();
 
@@ -186,6 +202,9 @@ private:
     // The network timeout used when sending an updatePosition command to our sync source.
     const Milliseconds _updatePositionTimeout;
 
+    // The number of updatePosition commands which may await their response at the same time.
+    const size_t _maxCommandsInFlight;
+
     // Protects member data of this Reporter declared below.
     mutable stdx::mutex _mutex;
 
@@ -198,8 +217,8 @@ private:
     // subsequent updates have come in.
     bool _isWaitingToSendReporter = false;
 
-    // Callback handle to the scheduled remote command.
-    executor::TaskExecutor::CallbackHandle _remoteCommandCallbackHandle;
+    // Callback handles to the scheduled remote commands, in the order they were sent.
+    std::vector<executor::TaskExecutor::CallbackHandle> _remoteCommandCallbackHandles;
 
     // Callback handle to the scheduled task for preparing and sending the remote command.
     executor::TaskExecutor::CallbackHandle _prepareAndSendCommandCallbackHandle;
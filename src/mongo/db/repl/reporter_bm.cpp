@@ -0,0 +1,165 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <deque>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/reporter.h"
+#include "mongo/executor/network_interface_mock.h"
+#include "mongo/executor/thread_pool_task_executor_test_fixture.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+using executor::NetworkInterfaceMock;
+
+/**
+ * Models a secondary applying one batch per iteration against a sync source state.range(1)
+ * milliseconds away: the batch's applied optime is reported, and the journal flush which makes it
+ * durable follows state.range(2) milliseconds later. The reporter may have state.range(0)
+ * replSetUpdatePosition commands in flight.
+ *
+ * Reports, in the mock network's virtual time, how long it takes from the journal flush until the
+ * sync source acknowledges a command carrying the durable optime, which is what a w:majority
+ * write waits for on top of the flush itself.
+ */
+void BM_ReportDurableProgress(benchmark::State& state) {
+    const size_t maxCommandsInFlight = state.range(0);
+    const Milliseconds roundTrip(state.range(1));
+    const Milliseconds journalFlushDelay(state.range(2));
+
+    auto ownedNet = stdx::make_unique<NetworkInterfaceMock>();
+    auto net = ownedNet.get();
+    auto executor = executor::makeThreadPoolTestExecutor(std::move(ownedNet));
+    executor->startup();
+
+    // Progress is read by the executor thread when it prepares a command.
+    AtomicInt64 lastApplied;
+    AtomicInt64 lastDurable;
+    auto reporter = stdx::make_unique<Reporter>(
+        executor.get(),
+        [&]() -> StatusWith<BSONObj> {
+            return BSON("replSetUpdatePosition" << 1 << "applied" << lastApplied.load()
+                                                << "durable"
+                                                << lastDurable.load());
+        },
+        HostAndPort("syncSource", 27017),
+        Milliseconds(30 * 1000),
+        Milliseconds(30 * 1000),
+        maxCommandsInFlight);
+
+    // The responses scheduled by the sync source, in the order they arrive, with the durable
+    // optime of the command each one acknowledges.
+    struct PendingResponse {
+        Date_t when;
+        long long durable;
+    };
+    std::deque<PendingResponse> pending;
+    long long numCommands = 0;
+    auto respondToReadyRequests = [&] {
+        while (net->hasReadyRequests()) {
+            auto noi = net->getNextReadyRequest();
+            const auto durable = noi->getRequest().cmdObj["durable"].numberLong();
+            const auto when = net->now() + roundTrip;
+            net->scheduleSuccessfulResponse(
+                noi, when, executor::RemoteCommandResponse(BSON("ok" << 1), Milliseconds(0)));
+            pending.push_back({when, durable});
+            ++numCommands;
+        }
+    };
+
+    // Delivers the responses due next, and returns true if one acknowledged 'durable'.
+    auto deliverNextResponses = [&](long long durable) {
+        respondToReadyRequests();
+        invariant(!pending.empty());
+        const auto now = net->runUntil(pending.front().when);
+        bool acknowledged = false;
+        while (!pending.empty() && pending.front().when <= now) {
+            acknowledged = acknowledged || pending.front().durable >= durable;
+            pending.pop_front();
+        }
+        return acknowledged;
+    };
+
+    long long optime = 0;
+    Milliseconds totalLatency(0);
+    for (auto _ : state) {
+        const auto batchStart = net->now();
+        lastApplied.store(++optime);
+        invariant(reporter->trigger().isOK());
+
+        net->enterNetwork();
+        respondToReadyRequests();
+        net->runUntil(batchStart + journalFlushDelay);
+        while (!pending.empty() && pending.front().when <= net->now()) {
+            pending.pop_front();
+        }
+        net->exitNetwork();
+
+        const auto flushed = net->now();
+        lastDurable.store(optime);
+        invariant(reporter->trigger().isOK());
+
+        net->enterNetwork();
+        while (!deliverNextResponses(optime)) {
+        }
+        totalLatency += net->now() - flushed;
+
+        // Let the remaining commands complete before the next batch.
+        while (!pending.empty() || net->hasReadyRequests()) {
+            deliverNextResponses(optime);
+        }
+        net->exitNetwork();
+    }
+
+    state.counters["durableReportMillis"] =
+        double(durationCount<Milliseconds>(totalLatency)) / state.iterations();
+    state.counters["commandsPerBatch"] = double(numCommands) / state.iterations();
+
+    executor->shutdown();
+    executor->join();
+    reporter.reset();
+}
+
+BENCHMARK(BM_ReportDurableProgress)
+    ->Args({1, 2, 1})
+    ->Args({2, 2, 1})
+    ->Args({1, 20, 1})
+    ->Args({2, 20, 1});
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -126,6 +126,8 @@ protected:
 private:
     virtual bool triggerAtSetUp() const;
 
+    virtual size_t maxCommandsInFlight() const;
+
 protected:
     std::unique_ptr<unittest::TaskExecutorProxy> _executorProxy;
     std::unique_ptr<MockProgressManager> posUpdater;
@@ -138,6 +140,11 @@ private:
     virtual bool triggerAtSetUp() const override;
 };
 
+class ReporterTestWithTwoCommandsInFlight : public ReporterTest {
+private:
+    virtual size_t maxCommandsInFlight() const override;
+};
+
 ReporterTest::ReporterTest() {}
 
 void ReporterTest::setUp() {
@@ -157,7 +164,8 @@ void ReporterTest::setUp() {
                                     [this]() { return prepareReplSetUpdatePositionCommandFn(); },
                                     HostAndPort("h1"),
                                     Milliseconds(1000),
-                                    Milliseconds(5000));
+                                    Milliseconds(5000),
+                                    maxCommandsInFlight());
     launchExecutorThread();
 
     if (triggerAtSetUp()) {
@@ -187,6 +195,14 @@ bool ReporterTestNoTriggerAtSetUp::triggerAtSetUp() const {
     return false;
 }
 
+size_t ReporterTest::maxCommandsInFlight() const {
+    return 1;
+}
+
+size_t ReporterTestWithTwoCommandsInFlight::maxCommandsInFlight() const {
+    return 2;
+}
+
 BSONObj ReporterTest::processNetworkResponse(const BSONObj& obj,
                                              bool expectReadyRequestsAfterProcessing) {
     auto net = getNet();
@@ -730,4 +746,88 @@ TEST_F(ReporterTest, ShutdownImmediatelyAfterTriggerWhileKeepAliveTimeoutIsSched
     assertReporterDone();
 }
 
+TEST_F(ReporterTestWithTwoCommandsInFlight,
+       TriggeringReporterWhileCommandRequestIsInProgressSendsSecondCommandRequestImmediately) {
+    // Send the first command request (triggered in setUp).
+    runReadyScheduledTasks();
+
+    ASSERT_OK(reporter->trigger());
+    ASSERT_TRUE(reporter->isActive());
+    ASSERT_FALSE(reporter->isWaitingToSendReport());
+    runReadyScheduledTasks();
+
+    // The second command request is ready without waiting for the response to the first.
+    processNetworkResponse(BSON("ok" << 1), true);
+
+    // The keep alive is only scheduled once the last command request completes.
+    ASSERT_TRUE(reporter->isActive());
+    ASSERT_EQUALS(Date_t(), reporter->getKeepAliveTimeoutWhen_forTest());
+
+    processNetworkResponse(BSON("ok" << 1));
+
+    ASSERT_TRUE(reporter->isActive());
+    ASSERT_FALSE(reporter->isWaitingToSendReport());
+    ASSERT_NOT_EQUALS(Date_t(), reporter->getKeepAliveTimeoutWhen_forTest());
+}
+
+TEST_F(ReporterTestWithTwoCommandsInFlight,
+       TriggeringReporterWhileTwoCommandRequestsAreInProgressCoalescesUpdates) {
+    runReadyScheduledTasks();
+    ASSERT_OK(reporter->trigger());
+    runReadyScheduledTasks();
+
+    // Both command requests are in flight, so these updates wait for one of them to complete.
+    ASSERT_OK(reporter->trigger());
+    ASSERT_TRUE(reporter->isWaitingToSendReport());
+    ASSERT_OK(reporter->trigger());
+    ASSERT_TRUE(reporter->isWaitingToSendReport());
+
+    // The first response sends a single command request for both updates.
+    processNetworkResponse(BSON("ok" << 1), true);
+    ASSERT_FALSE(reporter->isWaitingToSendReport());
+
+    processNetworkResponse(BSON("ok" << 1), true);
+    ASSERT_EQUALS(Date_t(), reporter->getKeepAliveTimeoutWhen_forTest());
+
+    processNetworkResponse(BSON("ok" << 1));
+    ASSERT_TRUE(reporter->isActive());
+    ASSERT_NOT_EQUALS(Date_t(), reporter->getKeepAliveTimeoutWhen_forTest());
+}
+
+TEST_F(ReporterTestWithTwoCommandsInFlight, FailedCommandRequestCancelsOtherCommandRequest) {
+    runReadyScheduledTasks();
+    ASSERT_OK(reporter->trigger());
+    runReadyScheduledTasks();
+
+    auto net = getNet();
+    net->enterNetwork();
+    net->scheduleErrorResponse({ErrorCodes::NoSuchKey, "waaaah", Milliseconds(0)});
+    net->runReadyNetworkOperations();
+    // Deliver the cancellation of the second command request.
+    net->runReadyNetworkOperations();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_EQUALS(ErrorCodes::NoSuchKey, reporter->join());
+    assertReporterDone();
+}
+
+TEST_F(ReporterTestWithTwoCommandsInFlight,
+       ShuttingReporterDownWhileTwoCommandRequestsAreInProgressStopsTheReporter) {
+    runReadyScheduledTasks();
+    ASSERT_OK(reporter->trigger());
+    runReadyScheduledTasks();
+
+    reporter->shutdown();
+
+    auto net = getNet();
+    net->enterNetwork();
+    net->runReadyNetworkOperations();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_EQUALS(ErrorCodes::CallbackCanceled, reporter->join());
+    assertReporterDone();
+}
+
 }  // namespace
@@ -211,7 +211,6 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
 
     documentValidationDisabled(opCtx.get()) = true;
 
-    std::unique_ptr<AutoGetCollection> autoColl;
     // Retry if WCE.
     Status status = writeConflictRetry(opCtx.get(), "beginCollectionClone", nss.ns(), [&] {
         UnreplicatedWritesBlock uwb(opCtx.get());
@@ -224,32 +223,30 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
             return Status(ErrorCodes::NamespaceExists,
                           str::stream() << "Collection " << nss.ns() << " already exists.");
         }
+        Collection* collection;
         {
             // Create the collection.
             WriteUnitOfWork wunit(opCtx.get());
-            fassert(40332, db.getDb()->createCollection(opCtx.get(), nss.ns(), options, false));
+            collection = db.getDb()->createCollection(opCtx.get(), nss.ns(), options, false);
+            fassert(40332, collection);
             wunit.commit();
         }
 
-        autoColl = stdx::make_unique<AutoGetCollection>(opCtx.get(), nss, MODE_IX);
-
         // Build empty capped indexes.  Capped indexes cannot be built by the MultiIndexBlock
         // because the cap might delete documents off the back while we are inserting them into
         // the front.
         if (options.capped) {
             WriteUnitOfWork wunit(opCtx.get());
             if (!idIndexSpec.isEmpty()) {
-                auto status =
-                    autoColl->getCollection()->getIndexCatalog()->createIndexOnEmptyCollection(
-                        opCtx.get(), idIndexSpec);
+                auto status = collection->getIndexCatalog()->createIndexOnEmptyCollection(
+                    opCtx.get(), idIndexSpec);
                 if (!status.getStatus().isOK()) {
                     return status.getStatus();
                 }
             }
             for (auto&& spec : secondaryIndexSpecs) {
-                auto status =
-                    autoColl->getCollection()->getIndexCatalog()->createIndexOnEmptyCollection(
-                        opCtx.get(), spec);
+                auto status = collection->getIndexCatalog()->createIndexOnEmptyCollection(
+                    opCtx.get(), spec);
                 if (!status.getStatus().isOK()) {
                     return status.getStatus();
                 }
@@ -264,11 +261,11 @@ StorageInterfaceImpl::createCollectionForBulkLoading(
         return status;
     }
 
-    // Move locks into loader, so it now controls their lifetime.
+    // The loader takes over the Client and OperationContext.
     auto loader =
         stdx::make_unique<CollectionBulkLoaderImpl>(Client::releaseCurrent(),
                                                     std::move(opCtx),
-                                                    std::move(autoColl),
+                                                    nss,
                                                     options.capped ? BSONObj() : idIndexSpec);
 
     status = loader->init(options.capped ? std::vector<BSONObj>() : secondaryIndexSpecs);
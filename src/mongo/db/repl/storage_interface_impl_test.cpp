@@ -610,6 +610,41 @@ TEST_F(StorageInterfaceImplTest, CreateCollectionWithIDIndexCommits) {
     ASSERT_EQ(count, 2LL);
 }
 
+TEST_F(StorageInterfaceImplTest, CollectionBulkLoadersOnOneDatabaseRunConcurrently) {
+    auto opCtx = getOperationContext();
+    StorageInterfaceImpl storage;
+    auto nss1 = makeNamespace(_agent, "1");
+    auto nss2 = makeNamespace(_agent, "2");
+    ASSERT_EQ(nss1.db(), nss2.db());
+    std::vector<BSONObj> indexes;
+
+    // Creating the second collection locks the database exclusively. This would block forever if
+    // the first loader kept its collection locked between operations.
+    auto loader1 = unittest::assertGet(storage.createCollectionForBulkLoading(
+        nss1, generateOptionsWithUuid(), makeIdIndexSpec(nss1), indexes));
+    std::vector<BSONObj> docs = {BSON("_id" << 1), BSON("_id" << 2)};
+    ASSERT_OK(loader1->insertDocuments(docs.begin(), docs.end()));
+    auto loader2 = unittest::assertGet(storage.createCollectionForBulkLoading(
+        nss2, generateOptionsWithUuid(), makeIdIndexSpec(nss2), indexes));
+
+    // Interleave the work of both loaders, and commit them in the opposite order.
+    ASSERT_OK(loader2->insertDocuments(docs.begin(), docs.end()));
+    std::vector<BSONObj> moreDocs = {BSON("_id" << 3)};
+    ASSERT_OK(loader1->insertDocuments(moreDocs.begin(), moreDocs.end()));
+    ASSERT_OK(loader2->commit());
+    ASSERT_OK(loader1->commit());
+
+    for (auto&& nssAndCount : {std::make_pair(nss1, 3LL), std::make_pair(nss2, 2LL)}) {
+        AutoGetCollectionForReadCommand autoColl(opCtx, nssAndCount.first);
+        auto coll = autoColl.getCollection();
+        ASSERT(coll);
+        ASSERT_EQ(coll->getRecordStore()->numRecords(opCtx), nssAndCount.second);
+        auto collIdxCat = coll->getIndexCatalog();
+        auto idIdxDesc = collIdxCat->findIdIndex(opCtx);
+        ASSERT_EQ(getIndexKeyCount(opCtx, collIdxCat, idIdxDesc), nssAndCount.second);
+    }
+}
+
 void _testDestroyUncommitedCollectionBulkLoader(
     OperationContext* opCtx,
     const NamespaceString& nss,
@@ -39,6 +39,7 @@
 #include "mongo/db/repl/repl_set_config.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/reporter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
@@ -57,6 +58,20 @@ const Milliseconds maximumKeepAliveIntervalMS(30 * 1000);
 // The network timeout used for replSetUpdatePosition requests made to a node's sync source.
 const Seconds syncSourceFeedbackNetworkTimeoutSecs(30);
 
+// The number of replSetUpdatePosition requests a node may have in flight to its sync source. With
+// more than one, progress such as a journal flush is reported as soon as it happens instead of
+// after the response to the previous request, and progress made while the limit is reached is
+// coalesced into the next request.
+MONGO_EXPORT_SERVER_PARAMETER(maxSyncSourceFeedbackRequestsInFlight, int, 2)
+    ->withValidator([](const int& potentialNewValue) {
+        if (potentialNewValue < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "maxSyncSourceFeedbackRequestsInFlight must be greater than 0");
+        }
+
+        return Status::OK();
+    });
+
 /**
  * Calculates the keep alive interval based on the given ReplSetConfig.
  */
@@ -219,7 +234,8 @@ void SyncSourceFeedback::run(executor::TaskExecutor* executor,
                           makePrepareReplSetUpdatePositionCommandFn(replCoord, syncTarget, bgsync),
                           syncTarget,
                           keepAliveInterval,
-                          syncSourceFeedbackNetworkTimeoutSecs);
+                          syncSourceFeedbackNetworkTimeoutSecs,
+                          maxSyncSourceFeedbackRequestsInFlight.load());
         {
             stdx::lock_guard<stdx::mutex> lock(_mtx);
             if (_shutdownSignaled) {
@@ -70,6 +70,7 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_state_transition_lock_guard.h"
 #include "mongo/db/repl/session_update_tracker.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/session.h"
 #include "mongo/db/session_txn_record_gen.h"
@@ -90,6 +91,11 @@ namespace {
 
 MONGO_FAIL_POINT_DEFINE(pauseBatchApplicationBeforeCompletion);
 MONGO_FAIL_POINT_DEFINE(hangAfterRecordingOpApplicationStartTime);
+MONGO_FAIL_POINT_DEFINE(hangBeforeApplyingPipelinedBatch);
+
+// If true, secondaries start writing the next batch to the oplog while the current batch is being
+// applied.
+MONGO_EXPORT_SERVER_PARAMETER(replPipelineOplogWrites, bool, true);
 
 // The oplog entries applied
 Counter64 opsAppliedStats;
@@ -100,6 +106,11 @@ Counter64 attemptsToBecomeSecondary;
 ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
     "repl.apply.attemptsToBecomeSecondary", &attemptsToBecomeSecondary);
 
+// Number of batches written to the oplog while the previous batch was being applied.
+Counter64 pipelinedBatchesStats;
+ServerStatusMetricField<Counter64> displayPipelinedBatches("repl.apply.pipelinedBatches",
+                                                           &pipelinedBatchesStats);
+
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
@@ -378,6 +389,73 @@ Status SyncTail::syncApply(OperationContext* opCtx,
     MONGO_UNREACHABLE;
 }
 
+// static
+Status SyncTail::syncApplyUpdatesAndDeletes(OperationContext* opCtx,
+                                            MultiApplier::OperationPtrs::const_iterator begin,
+                                            MultiApplier::OperationPtrs::const_iterator end,
+                                            OplogApplication::Mode oplogApplicationMode) {
+    invariant(begin != end);
+    const OplogEntry& firstEntry = **begin;
+    const NamespaceString& nss = firstEntry.getNss();
+
+    // Count the group as a single operation, for reporting purposes.
+    CurOp groupOp(opCtx);
+
+    auto clockSource = opCtx->getServiceContext()->getFastClockSource();
+    auto applyStartTime = clockSource->now();
+
+    // Updates are converted to upserts outside of initial sync, as in syncApply().
+    const bool shouldAlwaysUpsert = (oplogApplicationMode != OplogApplication::Mode::kInitialSync);
+    const bool isGroupedApplication = true;
+
+    // Only counted once the whole group has committed.
+    size_t numApplied = 0;
+    auto status = writeConflictRetry(opCtx, "syncApply_updatesAndDeletes", nss.ns(), [&] {
+        numApplied = 0;
+        AutoGetCollection autoColl(opCtx, getNsOrUUID(nss, firstEntry.raw), MODE_IX);
+        auto db = autoColl.getDb();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "missing database (" << nss.db() << ")",
+                db);
+        OldClientContext ctx(opCtx, autoColl.getNss().ns(), db);
+
+        UnreplicatedWritesBlock uwb(opCtx);
+        DisableDocumentValidation validationDisabler(opCtx);
+
+        WriteUnitOfWork wuow(opCtx);
+        for (auto it = begin; it != end; ++it) {
+            Status status = applyOperation_inlock(opCtx,
+                                                  ctx.db(),
+                                                  (*it)->raw,
+                                                  shouldAlwaysUpsert,
+                                                  oplogApplicationMode,
+                                                  [&numApplied] { ++numApplied; },
+                                                  isGroupedApplication);
+            if (!status.isOK()) {
+                if (status.code() == ErrorCodes::WriteConflict) {
+                    throw WriteConflictException();
+                }
+                return status;
+            }
+        }
+        wuow.commit();
+        return Status::OK();
+    });
+
+    if (!status.isOK()) {
+        return status;
+    }
+    opsAppliedStats.increment(numApplied);
+
+    // This group was slow to apply, so we should log a report of it.
+    auto diffMS = durationCount<Milliseconds>(clockSource->now() - applyStartTime);
+    if (diffMS > serverGlobalParams.slowMS) {
+        log() << "applied " << numApplied << " CRUD ops on " << nss << " starting with "
+              << redact(firstEntry.raw) << ", took " << diffMS << "ms";
+    }
+    return Status::OK();
+}
+
 SyncTail::SyncTail(OplogApplier::Observer* observer,
                    ReplicationConsistencyMarkers* consistencyMarkers,
                    StorageInterface* storageInterface,
@@ -406,10 +484,58 @@ const OplogApplier::Options& SyncTail::getOptions() const {
 
 namespace {
 
+/**
+ * Tracks the tasks that one phase of batch application schedules on the writer pool, so that the
+ * phase can wait for its own tasks rather than for the whole pool to become idle. The pool may be
+ * writing the next batch to the oplog at the same time.
+ */
+class WriterTaskGroup {
+    MONGO_DISALLOW_COPYING(WriterTaskGroup);
+
+public:
+    WriterTaskGroup() = default;
+
+    ~WriterTaskGroup() {
+        wait();
+    }
+
+    void schedule(ThreadPool* writerPool, ThreadPool::Task task) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            ++_numPending;
+        }
+        invariant(writerPool->schedule([ this, task = std::move(task) ] {
+            ON_BLOCK_EXIT([this] { _taskDone(); });
+            task();
+        }));
+    }
+
+    /**
+     * Waits until every task scheduled through this group has run.
+     */
+    void wait() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [this] { return _numPending == 0; });
+    }
+
+private:
+    void _taskDone() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (--_numPending == 0) {
+            _cv.notify_all();
+        }
+    }
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    size_t _numPending = 0;
+};
+
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               ThreadPool* writerPool,
+              WriterTaskGroup* tasks,
               const SyncTail::MultiSyncApplyFunc& func,
               SyncTail* st,
               std::vector<Status>* statusVector,
@@ -417,25 +543,27 @@ void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
     invariant(writerVectors.size() == statusVector->size());
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
-            invariant(writerPool->schedule([
-                &func,
-                st,
-                &writer = writerVectors.at(i),
-                &status = statusVector->at(i),
-                &workerMultikeyPathInfo = workerMultikeyPathInfo->at(i)
-            ] {
-                auto opCtx = cc().makeOperationContext();
-                status = func(opCtx.get(), &writer, st, &workerMultikeyPathInfo);
-            }));
+            tasks->schedule(writerPool,
+                            [
+                              &func,
+                              st,
+                              &writer = writerVectors.at(i),
+                              &status = statusVector->at(i),
+                              &workerMultikeyPathInfo = workerMultikeyPathInfo->at(i)
+                            ] {
+                                auto opCtx = cc().makeOperationContext();
+                                status = func(opCtx.get(), &writer, st, &workerMultikeyPathInfo);
+                            });
         }
     }
 }
 
-// Schedules the writes to the oplog for 'ops' into threadPool. The caller must guarantee that 'ops'
-// stays valid until all scheduled work in the thread pool completes.
+// Schedules the writes to the oplog for 'ops' into threadPool as part of 'tasks'. The caller must
+// guarantee that 'ops' stays valid until all the tasks complete.
 void scheduleWritesToOplog(OperationContext* opCtx,
                            StorageInterface* storageInterface,
                            ThreadPool* threadPool,
+                           WriterTaskGroup* tasks,
                            const MultiApplier::Operations& ops) {
 
     auto makeOplogWriterForRange = [storageInterface, &ops](size_t begin, size_t end) {
@@ -477,7 +605,7 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     if (!enoughToMultiThread ||
         !opCtx->getServiceContext()->getStorageEngine()->supportsDocLocking()) {
 
-        invariant(threadPool->schedule(makeOplogWriterForRange(0, ops.size())));
+        tasks->schedule(threadPool, makeOplogWriterForRange(0, ops.size()));
         return;
     }
 
@@ -487,7 +615,7 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     for (size_t thread = 0; thread < numOplogThreads; thread++) {
         size_t begin = thread * numOpsPerThread;
         size_t end = (thread == numOplogThreads - 1) ? ops.size() : begin + numOpsPerThread;
-        invariant(threadPool->schedule(makeOplogWriterForRange(begin, end)));
+        tasks->schedule(threadPool, makeOplogWriterForRange(begin, end));
     }
 }
 
@@ -681,8 +809,36 @@ void tryToGoLiveAsASecondary(OperationContext* opCtx,
     }
 }
 
+/**
+ * Returns true if the oplog writes of the next batch may overlap with the application of the
+ * current one.
+ */
+bool shouldPipelineOplogWrites(OperationContext* opCtx, const OplogApplier::Options& options) {
+    // Tests that pause batch application expect the oplog to stop growing with it.
+    if (MONGO_FAIL_POINT(rsSyncApplyStop) ||
+        MONGO_FAIL_POINT(pauseBatchApplicationBeforeCompletion)) {
+        return false;
+    }
+
+    // Writing two batches to the oplog at once relies on the storage engine ordering oplog entries
+    // inserted out of order, as it does for the parallel oplog writes within a batch.
+    return replPipelineOplogWrites.load() && !options.skipWritesToOplog &&
+        opCtx->getServiceContext()->getStorageEngine()->supportsDocLocking();
+}
+
 }  // namespace
 
+struct SyncTail::PendingBatch {
+    explicit PendingBatch(MultiApplier::Operations ops) : ops(std::move(ops)) {}
+
+    // The oplog writer tasks refer to 'ops', so it must not be moved while they run.
+    MultiApplier::Operations ops;
+
+    // Declared after 'ops' so that it waits for the oplog writes before 'ops' is destroyed.
+    WriterTaskGroup oplogWrites;
+    bool oplogWritesScheduled = false;
+};
+
 class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
@@ -713,6 +869,23 @@ public:
         return ops;
     }
 
+    /**
+     * Returns the next batch if one is ready, without waiting. A batch that signals shutdown is
+     * left in place for getNextBatch() to return.
+     */
+    OpQueue tryGetNextBatch() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_ops.empty() || _ops.mustShutdown()) {
+            return OpQueue(0);
+        }
+
+        OpQueue ops = std::move(_ops);
+        _ops = OpQueue(0);
+        _cv.notify_all();
+
+        return ops;
+    }
+
 private:
     /**
      * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
@@ -803,14 +976,20 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
     // Get replication consistency markers.
     OpTime minValid;
 
+    // The batch after the one last applied, if its oplog writes were started while that batch was
+    // being applied. It is applied before any other batch is taken from the batcher.
+    std::unique_ptr<PendingBatch> nextBatch;
+
     while (true) {  // Exits on message from OpQueueBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
         const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
         OperationContext& opCtx = *opCtxPtr;
+        opCtx.lockState()->setAdmissionPriority(AdmissionPriority::kHigh);
 
-        // For pausing replication in tests.
-        if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
+        // For pausing replication in tests. A batch which is already in the oplog is applied
+        // first, so that the oplog does not stay ahead of the applied data while paused.
+        if (!nextBatch && MONGO_FAIL_POINT(rsSyncApplyStop)) {
             log() << "sync tail - rsSyncApplyStop fail point enabled. Blocking until fail point is "
                      "disabled.";
             while (MONGO_FAIL_POINT(rsSyncApplyStop)) {
@@ -830,26 +1009,35 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
         // Transition to SECONDARY state, if possible.
         tryToGoLiveAsASecondary(&opCtx, replCoord, minValid);
 
+        if (nextBatch && MONGO_FAIL_POINT(hangBeforeApplyingPipelinedBatch)) {
+            log() << "hangBeforeApplyingPipelinedBatch fail point enabled. Blocking until fail "
+                     "point is disabled.";
+            MONGO_FAIL_POINT_PAUSE_WHILE_SET(hangBeforeApplyingPipelinedBatch);
+        }
+
         long long termWhenBufferIsEmpty = replCoord->getTerm();
-        // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
-        // ready in time, we'll loop again so we can do the above checks periodically.
-        OpQueue ops = batcher->getNextBatch(Seconds(1));
-        if (ops.empty()) {
-            if (ops.mustShutdown()) {
-                // Shut down and exit oplog application loop.
-                return;
-            }
-            if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
-                continue;
+        std::unique_ptr<PendingBatch> batch = std::move(nextBatch);
+        if (!batch) {
+            // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't
+            // become ready in time, we'll loop again so we can do the above checks periodically.
+            OpQueue ops = batcher->getNextBatch(Seconds(1));
+            if (ops.empty()) {
+                if (ops.mustShutdown()) {
+                    // Shut down and exit oplog application loop.
+                    return;
+                }
+                if (MONGO_FAIL_POINT(rsSyncApplyStop)) {
+                    continue;
+                }
+                // Signal drain complete if we're in Draining state and the buffer is empty.
+                replCoord->signalDrainComplete(&opCtx, termWhenBufferIsEmpty);
+                continue;  // Try again.
             }
-            // Signal drain complete if we're in Draining state and the buffer is empty.
-            replCoord->signalDrainComplete(&opCtx, termWhenBufferIsEmpty);
-            continue;  // Try again.
+            batch = stdx::make_unique<PendingBatch>(ops.releaseBatch());
         }
 
-        // Extract some info from ops that we'll need after releasing the batch below.
-        const auto firstOpTimeInBatch = ops.front().getOpTime();
-        const auto lastOpTimeInBatch = ops.back().getOpTime();
+        const auto firstOpTimeInBatch = batch->ops.front().getOpTime();
+        const auto lastOpTimeInBatch = batch->ops.back().getOpTime();
         const auto lastAppliedOpTimeAtStartOfBatch = replCoord->getMyLastAppliedOpTime();
 
         // Make sure the oplog doesn't go back in time or repeat an entry.
@@ -866,10 +1054,25 @@ void SyncTail::_oplogApplication(OplogBuffer* oplogBuffer,
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
-        // Apply the operations in this batch. 'multiApply' returns the optime of the last op that
+        // While this batch is being applied, start writing the next one to the oplog if it is
+        // already waiting in the batcher.
+        auto startNextBatch = [&] {
+            if (!shouldPipelineOplogWrites(&opCtx, _options)) {
+                return;
+            }
+            OpQueue ops = batcher->tryGetNextBatch();
+            if (ops.empty()) {
+                return;
+            }
+            nextBatch = stdx::make_unique<PendingBatch>(ops.releaseBatch());
+            _scheduleWritesToOplog(&opCtx, nextBatch.get());
+            pipelinedBatchesStats.increment();
+        };
+
+        // Apply the operations in this batch. '_multiApply' returns the optime of the last op that
         // was applied, which should be the last optime in the batch.
         auto lastOpTimeAppliedInBatch =
-            fassertNoTrace(34437, multiApply(&opCtx, ops.releaseBatch()));
+            fassertNoTrace(34437, _multiApply(&opCtx, batch.get(), startNextBatch));
         invariant(lastOpTimeAppliedInBatch == lastOpTimeInBatch);
 
         // In order to provide resilience in the event of a crash in the middle of batch
@@ -1192,6 +1395,7 @@ Status multiSyncApply(OperationContext* opCtx,
     // ShouldNotConflictWithSecondaryBatchApplicationBlock will touch the locker that has been
     // destroyed by unstash in its destructor. Thus we set the flag explicitly.
     opCtx->lockState()->setShouldConflictWithSecondaryBatchApplication(false);
+    opCtx->lockState()->setAdmissionPriority(AdmissionPriority::kHigh);
 
     // Explicitly start future read transactions without a timestamp.
     opCtx->recoveryUnit()->setTimestampReadSource(RecoveryUnit::ReadSource::kNoTimestamp);
@@ -1207,6 +1411,7 @@ Status multiSyncApply(OperationContext* opCtx,
                : OplogApplication::Mode::kSecondary);
 
     ApplierHelpers::InsertGroup insertGroup(ops, opCtx, oplogApplicationMode);
+    ApplierHelpers::UpdateDeleteGroup updateDeleteGroup(ops, opCtx, oplogApplicationMode);
 
     {  // Ensure that the MultikeyPathTracker stops tracking paths.
         ON_BLOCK_EXIT([opCtx] { MultikeyPathTracker::get(opCtx).stopTrackingMultikeyPathInfo(); });
@@ -1223,6 +1428,13 @@ Status multiSyncApply(OperationContext* opCtx,
                 continue;
             }
 
+            // Likewise for a run of updates and deletes on the same collection.
+            groupResult = updateDeleteGroup.groupAndApplyUpdatesAndDeletes(it);
+            if (groupResult.isOK()) {
+                it = groupResult.getValue();
+                continue;
+            }
+
             // If we didn't create a group, try to apply the op individually.
             try {
                 const Status status = SyncTail::syncApply(opCtx, entry.raw, oplogApplicationMode);
@@ -1269,6 +1481,25 @@ Status multiSyncApply(OperationContext* opCtx,
 }
 
 StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations ops) {
+    PendingBatch batch(std::move(ops));
+    return _multiApply(opCtx, &batch, [] {});
+}
+
+void SyncTail::_scheduleWritesToOplog(OperationContext* opCtx, PendingBatch* batch) {
+    invariant(!batch->oplogWritesScheduled);
+    batch->oplogWritesScheduled = true;
+    if (_options.skipWritesToOplog) {
+        return;
+    }
+
+    _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, batch->ops.front().getTimestamp());
+    scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, &batch->oplogWrites, batch->ops);
+}
+
+StatusWith<OpTime> SyncTail::_multiApply(OperationContext* opCtx,
+                                         PendingBatch* batch,
+                                         const stdx::function<void()>& startNextBatch) {
+    auto& ops = batch->ops;
     invariant(!ops.empty());
 
     LOG(2) << "replication batch size is " << ops.size();
@@ -1310,7 +1541,8 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
         }
 
         // We must wait for the all work we've dispatched to complete before leaving this block
-        // because the spawned threads refer to objects on the stack
+        // because the spawned threads refer to objects on the stack. This includes the oplog
+        // writes of the next batch, which must finish while we hold the PBWM lock.
         ON_BLOCK_EXIT([&] {
             _writerPool->waitForIdle();
             if (pinOldestTimestamp) {
@@ -1318,10 +1550,10 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
             }
         });
 
-        // Write batch of ops into oplog.
-        if (!_options.skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
-            scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
+        // Write batch of ops into oplog, unless that was started while the previous batch was
+        // being applied.
+        if (!batch->oplogWritesScheduled) {
+            _scheduleWritesToOplog(opCtx, batch);
         }
 
         // Holds 'pseudo operations' generated by secondaries to aid in replication.
@@ -1337,7 +1569,7 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
         // Wait for writes to finish before applying ops.
-        _writerPool->waitForIdle();
+        batch->oplogWrites.wait();
 
         // Reset consistency markers in case the node fails while applying ops.
         if (!_options.skipWritesToOplog) {
@@ -1347,8 +1579,20 @@ StatusWith<OpTime> SyncTail::multiApply(OperationContext* opCtx, MultiApplier::O
 
         {
             std::vector<Status> statusVector(_writerPool->getStats().numThreads, Status::OK());
-            applyOps(writerVectors, _writerPool, _applyFunc, this, &statusVector, &multikeyVector);
-            _writerPool->waitForIdle();
+            WriterTaskGroup applyTasks;
+            applyOps(writerVectors,
+                     _writerPool,
+                     &applyTasks,
+                     _applyFunc,
+                     this,
+                     &statusVector,
+                     &multikeyVector);
+
+            // Writer threads without operations from this batch write the next batch to the
+            // oplog in the meantime. Only this batch's operations need to finish before it is
+            // complete.
+            startNextBatch();
+            applyTasks.wait();
 
             // If any of the statuses is not ok, return error.
             for (auto it = statusVector.cbegin(); it != statusVector.cend(); ++it) {
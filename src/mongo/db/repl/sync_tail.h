@@ -81,6 +81,16 @@ public:
                             const BSONObj& o,
                             OplogApplication::Mode oplogApplicationMode);
 
+    /**
+     * Applies the update and delete operations in ['begin', 'end'), which must all be on the same
+     * collection, in a single WriteUnitOfWork. Each write keeps the timestamp of its operation.
+     * If any of the operations fails, none of them is applied and the error is returned.
+     */
+    static Status syncApplyUpdatesAndDeletes(OperationContext* opCtx,
+                                             MultiApplier::OperationPtrs::const_iterator begin,
+                                             MultiApplier::OperationPtrs::const_iterator end,
+                                             OplogApplication::Mode oplogApplicationMode);
+
     /**
      *
      * Constructs a SyncTail.
@@ -246,10 +256,32 @@ private:
 
     class OpQueueBatcher;
 
+    // A batch of operations together with the writer pool tasks that write it to the oplog.
+    struct PendingBatch;
+
     void _oplogApplication(OplogBuffer* oplogBuffer,
                            ReplicationCoordinator* replCoord,
                            OpQueueBatcher* batcher) noexcept;
 
+    /**
+     * Sets the oplog truncate after point to the start of 'batch' and schedules the writes of its
+     * operations to the oplog on the writer pool. Does not wait for the writes to finish.
+     */
+    void _scheduleWritesToOplog(OperationContext* opCtx, PendingBatch* batch);
+
+    /**
+     * Implements multiApply(). Writes 'batch' to the oplog, unless its oplog writes have already
+     * been scheduled, and applies it.
+     *
+     * Once the operations of 'batch' have been handed to the writer threads, calls
+     * 'startNextBatch', which may schedule the oplog writes of the following batch so that they
+     * overlap with the application of this one. Those writes are finished by the time this
+     * function returns.
+     */
+    StatusWith<OpTime> _multiApply(OperationContext* opCtx,
+                                   PendingBatch* batch,
+                                   const stdx::function<void()>& startNextBatch);
+
     OplogApplier::Observer* const _observer;
     ReplicationConsistencyMarkers* const _consistencyMarkers;
     StorageInterface* const _storageInterface;
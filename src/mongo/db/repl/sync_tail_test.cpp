@@ -1001,6 +1001,170 @@ TEST_F(SyncTailTest, MultiSyncApplyFallsBackOnApplyingInsertsIndividuallyWhenGro
     ASSERT_EQUALS(1U, numFailedGroupedInserts);
 }
 
+class SyncTailGroupedWriteTest : public SyncTailTest {
+protected:
+    /**
+     * Installs op observer hooks which record, for each write, how many writes had been committed
+     * before it. If 'failFirstWrite' is true, the first write throws, aborting a grouped
+     * application.
+     */
+    void recordWriteCommits(bool failFirstWrite = false) {
+        auto recordWrite = [this, failFirstWrite](OperationContext* opCtx) {
+            if (failFirstWrite && !_failedWrite) {
+                _failedWrite = true;
+                uasserted(ErrorCodes::OperationFailed, "grouped writes not supported");
+            }
+            _commitsBeforeWrite.push_back(_numCommits);
+            opCtx->recoveryUnit()->onCommit([this](boost::optional<Timestamp>) { ++_numCommits; });
+        };
+        _opObserver->onInsertsFn =
+            [recordWrite](OperationContext* opCtx,
+                          const NamespaceString&,
+                          const std::vector<BSONObj>&) { recordWrite(opCtx); };
+        _opObserver->onUpdateFn = [recordWrite](OperationContext* opCtx,
+                                                const OplogUpdateEntryArgs&) {
+            recordWrite(opCtx);
+        };
+        _opObserver->onDeleteFn = [recordWrite](OperationContext* opCtx,
+                                                const NamespaceString&,
+                                                OptionalCollectionUUID,
+                                                StmtId,
+                                                bool,
+                                                const boost::optional<BSONObj>&) {
+            recordWrite(opCtx);
+        };
+    }
+
+    std::vector<std::size_t> _commitsBeforeWrite;
+    std::size_t _numCommits = 0;
+    bool _failedWrite = false;
+};
+
+TEST_F(SyncTailGroupedWriteTest, MultiSyncApplyGroupsDeleteOperationsInOneUnitOfWork) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollectionWithUuid(_opCtx.get(), nss);
+
+    int seconds = 1;
+    MultiApplier::Operations inserts;
+    for (int i = 0; i < 3; ++i) {
+        inserts.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    ASSERT_OK(runOpsSteadyState(inserts));
+
+    MultiApplier::Operations deletes;
+    for (int i = 0; i < 3; ++i) {
+        deletes.push_back(makeDeleteDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    recordWriteCommits();
+    ASSERT_OK(runOpsSteadyState(deletes));
+
+    // All three deletes were applied before any of them committed.
+    ASSERT(_commitsBeforeWrite == std::vector<std::size_t>({0U, 0U, 0U}));
+    ASSERT_EQUALS(3U, _numCommits);
+}
+
+TEST_F(SyncTailGroupedWriteTest,
+       MultiSyncApplyFallsBackOnApplyingDeletesIndividuallyWhenGroupFails) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollectionWithUuid(_opCtx.get(), nss);
+
+    int seconds = 1;
+    MultiApplier::Operations inserts;
+    for (int i = 0; i < 3; ++i) {
+        inserts.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    ASSERT_OK(runOpsSteadyState(inserts));
+
+    MultiApplier::Operations deletes;
+    for (int i = 0; i < 3; ++i) {
+        deletes.push_back(makeDeleteDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    // Fail the first delete, which aborts the grouped application.
+    recordWriteCommits(true);
+    ASSERT_OK(runOpsSteadyState(deletes));
+
+    // After the group failed, each delete was applied and committed on its own.
+    ASSERT(_failedWrite);
+    ASSERT(_commitsBeforeWrite == std::vector<std::size_t>({0U, 1U, 2U}));
+    ASSERT_EQUALS(3U, _numCommits);
+}
+
+TEST_F(SyncTailGroupedWriteTest, MultiSyncApplyGroupsUpdateOperationsInOneUnitOfWork) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollectionWithUuid(_opCtx.get(), nss);
+
+    int seconds = 1;
+    MultiApplier::Operations inserts;
+    for (int i = 0; i < 2; ++i) {
+        inserts.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    ASSERT_OK(runOpsSteadyState(inserts));
+
+    // The last update is of a missing document, which is upserted outside of initial sync.
+    MultiApplier::Operations updates;
+    for (int i = 0; i < 3; ++i) {
+        updates.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL},
+                                                       nss,
+                                                       BSON("_id" << i),
+                                                       BSON("$set" << BSON("x" << i))));
+    }
+
+    recordWriteCommits();
+    ASSERT_OK(runOpsSteadyState(updates));
+
+    // All three updates were applied before any of them committed.
+    ASSERT(_commitsBeforeWrite == std::vector<std::size_t>({0U, 0U, 0U}));
+    ASSERT_EQUALS(3U, _numCommits);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i << "x" << i),
+                          unittest::assertGet(_storageInterface->findById(
+                              _opCtx.get(), nss, BSON("_id" << i).firstElement())));
+    }
+}
+
+TEST_F(SyncTailGroupedWriteTest,
+       MultiSyncApplyFallsBackOnApplyingUpdatesIndividuallyWhenGroupFails) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollectionWithUuid(_opCtx.get(), nss);
+
+    int seconds = 1;
+    MultiApplier::Operations inserts;
+    for (int i = 0; i < 3; ++i) {
+        inserts.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds++), 0), 1LL}, nss, BSON("_id" << i)));
+    }
+    ASSERT_OK(runOpsSteadyState(inserts));
+
+    MultiApplier::Operations updates;
+    for (int i = 0; i < 3; ++i) {
+        updates.push_back(makeUpdateDocumentOplogEntry({Timestamp(Seconds(seconds++), 0), 1LL},
+                                                       nss,
+                                                       BSON("_id" << i),
+                                                       BSON("$set" << BSON("x" << i))));
+    }
+
+    // Fail the first update, which aborts the grouped application.
+    recordWriteCommits(true);
+    ASSERT_OK(runOpsSteadyState(updates));
+
+    // After the group failed, each update was applied and committed on its own.
+    ASSERT(_failedWrite);
+    ASSERT(_commitsBeforeWrite == std::vector<std::size_t>({0U, 1U, 2U}));
+    ASSERT_EQUALS(3U, _numCommits);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i << "x" << i),
+                          unittest::assertGet(_storageInterface->findById(
+                              _opCtx.get(), nss, BSON("_id" << i).firstElement())));
+    }
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyIgnoresUpdateOperationIfDocumentIsMissingFromSyncSource) {
     BSONObj emptyDoc;
     SyncTailWithLocalDocumentFetcher syncTail(emptyDoc);
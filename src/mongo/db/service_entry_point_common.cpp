@@ -60,6 +60,7 @@
 #include "mongo/db/operation_context_session_mongod.h"
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/optime.h"
@@ -839,6 +840,9 @@ DbResponse receivedCommands(OperationContext* opCtx,
                             const Message& message,
                             const ServiceEntryPointCommon::Hooks& behaviors) {
     auto replyBuilder = rpc::makeReplyBuilder(rpc::protocolForMessage(message));
+    replyBuilder->setDocumentSequencesSupported(
+        OpMsg::isFlagSet(message, OpMsg::kDocumentSequencesSupported));
+    boost::optional<BSONObj> nextExhaustInvocation;
     [&] {
         OpMsgRequest request;
         try {  // Parse.
@@ -892,6 +896,11 @@ DbResponse receivedCommands(OperationContext* opCtx,
             }
 
             execCommandDatabase(opCtx, c, request, replyBuilder.get(), behaviors);
+
+            if (OpMsg::isFlagSet(message, OpMsg::kExhaustSupported)) {
+                nextExhaustInvocation = getNextExhaustInvocation(
+                    request, replyBuilder->getBodyBuilder().asTempObj());
+            }
         } catch (const DBException& ex) {
             BSONObjBuilder metadataBob;
             behaviors.appendReplyMetadataOnError(opCtx, &metadataBob);
@@ -920,8 +929,9 @@ DbResponse receivedCommands(OperationContext* opCtx,
     auto response = replyBuilder->done();
     CurOp::get(opCtx)->debug().responseLength = response.header().dataLen();
 
-    // TODO exhaust
-    return DbResponse{std::move(response)};
+    DbResponse dbResponse{std::move(response)};
+    dbResponse.nextInvocation = std::move(nextExhaustInvocation);
+    return dbResponse;
 }
 
 DbResponse receivedQuery(OperationContext* opCtx,
@@ -114,7 +114,7 @@ private:
 
     // Protects the member variables below. The order of lock acquisition should always be:
     //
-    // 1) SessionCatalog mutex (if applicable)
+    // 1) SessionCatalog partition mutex (if applicable)
     // 2) Session mutex
     // 3) Any decoration mutexes and/or the currently running Client's lock
     mutable stdx::mutex _mutex;
@@ -49,18 +49,24 @@ const auto operationSessionDecoration =
 
 }  // namespace
 
+SessionCatalog::SessionCatalog() : _partitions(kNumPartitions) {}
+
 SessionCatalog::~SessionCatalog() {
-    stdx::lock_guard<stdx::mutex> lg(_mutex);
-    for (const auto& entry : _sessions) {
-        auto& sri = entry.second;
-        invariant(!sri->session.currentOperation());
-        invariant(!sri->session.killed());
+    for (auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lg(partition.mutex);
+        for (const auto& entry : partition.sessions) {
+            auto& sri = entry.second;
+            invariant(!sri->session.currentOperation());
+            invariant(!sri->session.killed());
+        }
     }
 }
 
 void SessionCatalog::reset_forTest() {
-    stdx::lock_guard<stdx::mutex> lg(_mutex);
-    _sessions.clear();
+    for (auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lg(partition.mutex);
+        partition.sessions.clear();
+    }
 }
 
 SessionCatalog* SessionCatalog::get(OperationContext* opCtx) {
@@ -82,8 +88,9 @@ ScopedCheckedOutSession SessionCatalog::checkOutSession(OperationContext* opCtx)
     invariant(opCtx->getLogicalSessionId());
     const auto lsid = *opCtx->getLogicalSessionId();
 
-    stdx::unique_lock<stdx::mutex> ul(_mutex);
-    auto sri = _getOrCreateSessionRuntimeInfo(ul, opCtx, lsid);
+    auto& partition = _getPartition(lsid);
+    stdx::unique_lock<stdx::mutex> ul(partition.mutex);
+    auto sri = _getOrCreateSessionRuntimeInfo(ul, &partition, opCtx, lsid);
 
     // Wait until the session is no longer checked out and until the previously scheduled kill has
     // completed
@@ -106,8 +113,9 @@ ScopedCheckedOutSession SessionCatalog::checkOutSessionForKill(OperationContext*
 
     const auto lsid = killToken.lsidToKill;
 
-    stdx::unique_lock<stdx::mutex> ul(_mutex);
-    auto sri = _getOrCreateSessionRuntimeInfo(ul, opCtx, lsid);
+    auto& partition = _getPartition(lsid);
+    stdx::unique_lock<stdx::mutex> ul(partition.mutex);
+    auto sri = _getOrCreateSessionRuntimeInfo(ul, &partition, opCtx, lsid);
     invariant(sri->session.killed());
 
     // Wait until the session is no longer checked out
@@ -128,8 +136,9 @@ ScopedSession SessionCatalog::getOrCreateSession(OperationContext* opCtx,
     invariant(!opCtx->getTxnNumber());
 
     auto ss = [&] {
-        stdx::unique_lock<stdx::mutex> ul(_mutex);
-        return ScopedSession(_getOrCreateSessionRuntimeInfo(ul, opCtx, lsid));
+        auto& partition = _getPartition(lsid);
+        stdx::unique_lock<stdx::mutex> ul(partition.mutex);
+        return ScopedSession(_getOrCreateSessionRuntimeInfo(ul, &partition, opCtx, lsid));
     }();
 
     return ss;
@@ -137,31 +146,50 @@ ScopedSession SessionCatalog::getOrCreateSession(OperationContext* opCtx,
 
 void SessionCatalog::scanSessions(const SessionKiller::Matcher& matcher,
                                   const ScanSessionsCallbackFn& workerFn) {
-    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    // Lock all partitions, always in the same order, so that the scan sees a consistent snapshot of
+    // the catalog.
+    std::vector<stdx::unique_lock<stdx::mutex>> partitionLocks;
+    partitionLocks.reserve(_partitions.size());
+    size_t numSessions = 0;
+    for (auto& partition : _partitions) {
+        partitionLocks.emplace_back(partition.mutex);
+        numSessions += partition.sessions.size();
+    }
 
-    LOG(2) << "Beginning scanSessions. Scanning " << _sessions.size() << " sessions.";
+    LOG(2) << "Beginning scanSessions. Scanning " << numSessions << " sessions.";
 
-    for (auto& sessionEntry : _sessions) {
-        if (matcher.match(sessionEntry.first)) {
-            workerFn(lg, &sessionEntry.second->session);
+    for (size_t i = 0; i < _partitions.size(); ++i) {
+        for (auto& sessionEntry : _partitions[i].sessions) {
+            if (matcher.match(sessionEntry.first)) {
+                workerFn(partitionLocks[i], &sessionEntry.second->session);
+            }
         }
     }
 }
 
 Session::KillToken SessionCatalog::killSession(const LogicalSessionId& lsid) {
-    stdx::lock_guard<stdx::mutex> lg(_mutex);
-    auto it = _sessions.find(lsid);
-    uassert(ErrorCodes::NoSuchSession, "Session not found", it != _sessions.end());
+    auto& partition = _getPartition(lsid);
+    stdx::lock_guard<stdx::mutex> lg(partition.mutex);
+    auto it = partition.sessions.find(lsid);
+    uassert(ErrorCodes::NoSuchSession, "Session not found", it != partition.sessions.end());
 
     auto& sri = it->second;
     return sri->session.kill(lg);
 }
 
+size_t SessionCatalog::getPartitionIndex_forTest(const LogicalSessionId& lsid) {
+    return LogicalSessionIdHash()(lsid) % kNumPartitions;
+}
+
+SessionCatalog::Partition& SessionCatalog::_getPartition(const LogicalSessionId& lsid) {
+    return _partitions[LogicalSessionIdHash()(lsid) % kNumPartitions];
+}
+
 std::shared_ptr<SessionCatalog::SessionRuntimeInfo> SessionCatalog::_getOrCreateSessionRuntimeInfo(
-    WithLock, OperationContext* opCtx, const LogicalSessionId& lsid) {
-    auto it = _sessions.find(lsid);
-    if (it == _sessions.end()) {
-        it = _sessions.emplace(lsid, std::make_shared<SessionRuntimeInfo>(lsid)).first;
+    WithLock, Partition* partition, OperationContext* opCtx, const LogicalSessionId& lsid) {
+    auto it = partition->sessions.find(lsid);
+    if (it == partition->sessions.end()) {
+        it = partition->sessions.emplace(lsid, std::make_shared<SessionRuntimeInfo>(lsid)).first;
     }
 
     return it->second;
@@ -169,10 +197,11 @@ std::shared_ptr<SessionCatalog::SessionRuntimeInfo> SessionCatalog::_getOrCreate
 
 void SessionCatalog::_releaseSession(const LogicalSessionId& lsid,
                                      boost::optional<Session::KillToken> killToken) {
-    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    auto& partition = _getPartition(lsid);
+    stdx::lock_guard<stdx::mutex> lg(partition.mutex);
 
-    auto it = _sessions.find(lsid);
-    invariant(it != _sessions.end());
+    auto it = partition.sessions.find(lsid);
+    invariant(it != partition.sessions.end());
 
     auto& sri = it->second;
     invariant(sri->session.currentOperation());
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/optional.hpp>
 #include <vector>
 
@@ -41,6 +42,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -51,6 +53,11 @@ class ServiceContext;
 
 /**
  * Keeps track of the transaction runtime state for every active session on this instance.
+ *
+ * The sessions are spread over several partitions by the hash of their id, each with its own mutex,
+ * so that checking out different sessions does not contend on a single catalog-wide mutex. The
+ * state of a Session that is protected by "the SessionCatalog mutex" is protected by the mutex of
+ * its partition.
  */
 class SessionCatalog {
     MONGO_DISALLOW_COPYING(SessionCatalog);
@@ -59,7 +66,7 @@ class SessionCatalog {
     friend class ScopedCheckedOutSession;
 
 public:
-    SessionCatalog() = default;
+    SessionCatalog();
     ~SessionCatalog();
 
     /**
@@ -74,6 +81,13 @@ public:
      */
     void reset_forTest();
 
+    /**
+     * Returns the index of the partition which holds the session 'lsid'. Meant only for testing.
+     */
+    static size_t getPartitionIndex_forTest(const LogicalSessionId& lsid);
+
+    static const size_t kNumPartitions = 16;
+
     /**
      * Potentially blocking call, which uses the session information stored in the specified
      * operation context and either creates a brand new session object (if one doesn't exist) or
@@ -106,13 +120,11 @@ public:
     ScopedSession getOrCreateSession(OperationContext* opCtx, const LogicalSessionId& lsid);
 
     /**
-     * Iterates through the SessionCatalog under the SessionCatalog mutex and applies 'workerFn' to
-     * each Session which matches the specified 'matcher'.
+     * Iterates through the SessionCatalog under the mutexes of all partitions and applies
+     * 'workerFn' to each Session which matches the specified 'matcher'.
      *
-     * NOTE: Since this method runs with the session catalog mutex, the work done by 'workerFn' is
+     * NOTE: Since this method runs with the session catalog mutexes, the work done by 'workerFn' is
      * not allowed to block, perform I/O or acquire any lock manager locks.
-     * Iterates through the SessionCatalog and applies 'workerFn' to each Session. This locks the
-     * SessionCatalog.
      *
      * TODO SERVER-33850: Take Matcher out of the SessionKiller namespace.
      */
@@ -121,8 +133,8 @@ public:
                       const ScanSessionsCallbackFn& workerFn);
 
     /**
-     * Shortcut to invoke 'kill' on the specified session under the SessionCatalog mutex. Throws a
-     * NoSuchSession exception if the session doesn't exist.
+     * Shortcut to invoke 'kill' on the specified session under the mutex of its partition. Throws
+     * a NoSuchSession exception if the session doesn't exist.
      */
     Session::KillToken killSession(const LogicalSessionId& lsid);
 
@@ -134,18 +146,30 @@ private:
         // currently has it checked out
         Session session;
 
-        // Signaled when the state becomes available. Uses the transaction table's mutex to protect
-        // the state transitions.
+        // Signaled when the state becomes available. Uses the mutex of the session's partition to
+        // protect the state transitions.
         stdx::condition_variable availableCondVar;
     };
 
+    /**
+     * A subset of the sessions, selected by the hash of their id, and the mutex protecting them.
+     */
+    struct Partition {
+        stdx::mutex mutex;
+
+        // Owns the Session objects for all current Sessions in this partition.
+        LogicalSessionIdMap<std::shared_ptr<SessionRuntimeInfo>> sessions;
+    };
+
+    Partition& _getPartition(const LogicalSessionId& lsid);
+
     /**
      * May release and re-acquire it zero or more times before returning. The returned
-     * 'SessionRuntimeInfo' is guaranteed to be linked on the catalog's _txnTable as long as the
-     * lock is held.
+     * 'SessionRuntimeInfo' is guaranteed to be linked on the partition's sessions as long as the
+     * partition's lock is held.
      */
     std::shared_ptr<SessionRuntimeInfo> _getOrCreateSessionRuntimeInfo(
-        WithLock, OperationContext* opCtx, const LogicalSessionId& lsid);
+        WithLock, Partition* partition, OperationContext* opCtx, const LogicalSessionId& lsid);
 
     /**
      * Makes a session, previously checked out through 'checkoutSession', available again.
@@ -153,10 +177,9 @@ private:
     void _releaseSession(const LogicalSessionId& lsid,
                          boost::optional<Session::KillToken> killToken);
 
-    stdx::mutex _mutex;
-
-    // Owns the Session objects for all current Sessions.
-    LogicalSessionIdMap<std::shared_ptr<SessionRuntimeInfo>> _sessions;
+    using AlignedPartition = CacheAligned<Partition>;
+    std::vector<AlignedPartition, boost::alignment::aligned_allocator<AlignedPartition>>
+        _partitions;
 };
 
 /**
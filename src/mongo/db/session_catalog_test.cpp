@@ -207,6 +207,84 @@ TEST_F(SessionCatalogTestWithDefaultOpCtx, ScanSessions) {
     ASSERT_EQ(lsids.front(), lsid2);
 }
 
+TEST_F(SessionCatalogTestWithDefaultOpCtx, ScanSessionsVisitsEverySessionOnce) {
+    // Enough sessions to land in every partition of the catalog.
+    std::vector<LogicalSessionId> lsids;
+    for (int i = 0; i < 256; ++i) {
+        lsids.push_back(makeLogicalSessionIdForTest());
+        catalog()->getOrCreateSession(_opCtx, lsids.back());
+    }
+
+    LogicalSessionIdSet visited;
+    catalog()->scanSessions(
+        SessionKiller::Matcher(KillAllSessionsByPatternSet{makeKillAllSessionsByPattern(_opCtx)}),
+        [&visited](WithLock, Session* session) {
+            ASSERT(visited.insert(session->getSessionId()).second);
+        });
+
+    ASSERT_EQ(lsids.size(), visited.size());
+    for (const auto& lsid : lsids) {
+        ASSERT_EQ(1U, visited.count(lsid));
+    }
+}
+
+TEST_F(SessionCatalogTest, KillSessionsInEveryPartitionFromScan) {
+    std::vector<Session::KillToken> killTokens;
+    {
+        auto opCtx = makeOperationContext();
+
+        // Create one session in each partition of the catalog.
+        std::vector<bool> partitionCovered(SessionCatalog::kNumPartitions, false);
+        size_t numPartitionsCovered = 0;
+        while (numPartitionsCovered < SessionCatalog::kNumPartitions) {
+            const auto lsid = makeLogicalSessionIdForTest();
+            auto partitionIndex = SessionCatalog::getPartitionIndex_forTest(lsid);
+            if (!partitionCovered[partitionIndex]) {
+                partitionCovered[partitionIndex] = true;
+                catalog()->getOrCreateSession(opCtx.get(), lsid);
+                numPartitionsCovered++;
+            }
+        }
+
+        // The scan holds the lock of each session's partition when it hands the session over, so
+        // the sessions can be killed from the callback.
+        catalog()->scanSessions(SessionKiller::Matcher(KillAllSessionsByPatternSet{
+                                    makeKillAllSessionsByPattern(opCtx.get())}),
+                                [&killTokens](WithLock sessionCatalogLock, Session* session) {
+                                    killTokens.push_back(session->kill(sessionCatalogLock));
+                                });
+    }
+    ASSERT_EQ(SessionCatalog::kNumPartitions, killTokens.size());
+
+    for (auto& killToken : killTokens) {
+        const auto lsid = killToken.lsidToKill;
+
+        // Regular check-out waits for the kill to complete, whichever partition the session is in.
+        {
+            auto opCtx = makeOperationContext();
+            opCtx->setLogicalSessionId(lsid);
+            opCtx->setDeadlineAfterNowBy(Milliseconds(10), ErrorCodes::MaxTimeMSExpired);
+            ASSERT_THROWS_CODE(OperationContextSession(opCtx.get(), true),
+                               AssertionException,
+                               ErrorCodes::MaxTimeMSExpired);
+        }
+
+        // Completing the kill through the session's partition makes it available again.
+        {
+            auto opCtx = makeOperationContext();
+            auto scopedSession =
+                catalog()->checkOutSessionForKill(opCtx.get(), std::move(killToken));
+            ASSERT_EQ(opCtx.get(), scopedSession->currentOperation());
+        }
+        {
+            auto opCtx = makeOperationContext();
+            opCtx->setLogicalSessionId(lsid);
+            OperationContextSession ocs(opCtx.get(), true);
+            ASSERT(OperationContextSession::get(opCtx.get()));
+        }
+    }
+}
+
 TEST_F(SessionCatalogTest, KillSessionWhenSessionIsNotCheckedOut) {
     const auto lsid = makeLogicalSessionIdForTest();
 
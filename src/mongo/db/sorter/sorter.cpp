@@ -50,6 +50,7 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <deque>
 #include <snappy.h>
 #include <vector>
 
@@ -61,6 +62,11 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
@@ -139,6 +145,64 @@ private:
     std::deque<Data> _data;
 };
 
+/**
+ * Runs block reads on behalf of the FileIterators of a single merge on a background thread, so
+ * that the next block of every range is read from disk and decompressed while the merge is still
+ * consuming the current one.
+ *
+ * Tasks are run in the order in which they were scheduled. Any tasks still pending on destruction
+ * are run before the thread exits.
+ */
+class ReadAheadThread {
+    MONGO_DISALLOW_COPYING(ReadAheadThread);
+
+public:
+    using Task = stdx::function<void()>;
+
+    ReadAheadThread() : _thread([this] { _run(); }) {}
+
+    ~ReadAheadThread() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _shutdown = true;
+        }
+        _taskAvailable.notify_one();
+        _thread.join();
+    }
+
+    void schedule(Task task) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _tasks.push_back(std::move(task));
+        }
+        _taskAvailable.notify_one();
+    }
+
+private:
+    void _run() {
+        while (true) {
+            Task task;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _taskAvailable.wait(lk, [&] { return _shutdown || !_tasks.empty(); });
+                if (_tasks.empty())
+                    return;
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _taskAvailable;
+    std::deque<Task> _tasks;
+    bool _shutdown = false;
+
+    // Declared last so that all other members are initialized before the thread starts.
+    stdx::thread _thread;
+};
+
 /**
  * Returns results from a sorted range within a file. Each instance is given a file name and start
  * and end offsets.
@@ -170,6 +234,21 @@ public:
                 boost::filesystem::file_size(_fileName) != 0);
     }
 
+    ~FileIterator() {
+        // Never leave the read-ahead thread with a dangling reference to this iterator.
+        if (_readAheadThread)
+            waitForReadAhead();
+    }
+
+    /**
+     * Reads blocks ahead of the consumer on 'readAheadThread' until the next call to
+     * closeSource(). Must be called before openSource().
+     */
+    void enableReadAhead(ReadAheadThread* readAheadThread) {
+        invariant(!_file.is_open());
+        _readAheadThread = readAheadThread;
+    }
+
     void openSource() {
         _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
         uassert(16814,
@@ -184,9 +263,19 @@ public:
                               << "\": "
                               << myErrnoWithDescription(),
                 _file.good());
+
+        if (_readAheadThread)
+            scheduleReadAhead();
     }
 
     void closeSource() {
+        if (_readAheadThread) {
+            // The read-ahead thread may still be using the file.
+            waitForReadAhead();
+            _readAheadBlock.reset();
+            _readAheadThread = nullptr;
+        }
+
         _file.close();
         uassert(50969,
                 str::stream() << "error closing file \"" << _fileName << "\": "
@@ -214,6 +303,20 @@ public:
     }
 
 private:
+    /**
+     * A block of sorted data that has been read from disk, unprotected and decompressed.
+     */
+    struct Block {
+        std::unique_ptr<char[]> buffer;
+        size_t size = 0;
+
+        // Set when there is no more data to read.
+        bool eof = false;
+
+        // Holds any error encountered while reading the block on the read-ahead thread.
+        Status status = Status::OK();
+    };
+
     /**
      * Attempts to refill the _bufferReader if it is empty. Expects _done to be false.
      */
@@ -225,29 +328,57 @@ private:
     }
 
     /**
-     * Tries to read from disk and places any results in _bufferReader. If there is no more data to
-     * read, then _done is set to true and the function returns immediately.
+     * Places the next block in _bufferReader, either by taking the block read ahead of time or by
+     * reading it from disk. If there is no more data to read, then _done is set to true and the
+     * function returns immediately.
      */
     void fillBufferFromDisk() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
-        if (_done)
+        std::unique_ptr<Block> block;
+        if (_readAheadThread) {
+            waitForReadAhead();
+            block = std::move(_readAheadBlock);
+            uassertStatusOK(block->status);
+        } else {
+            block = readBlock();
+        }
+
+        if (block->eof) {
+            _done = true;
             return;
+        }
+
+        _buffer = std::move(block->buffer);
+        _bufferReader.reset(new BufReader(_buffer.get(), block->size));
+
+        if (_readAheadThread)
+            scheduleReadAhead();
+    }
+
+    /**
+     * Reads, unprotects and decompresses the next block from disk.
+     */
+    std::unique_ptr<Block> readBlock() {
+        auto block = stdx::make_unique<Block>();
+
+        int32_t rawSize;
+        if (!read(&rawSize, sizeof(rawSize))) {
+            block->eof = true;
+            return block;
+        }
 
         // negative size means compressed
         const bool compressed = rawSize < 0;
         int32_t blockSize = std::abs(rawSize);
 
-        _buffer.reset(new char[blockSize]);
-        read(_buffer.get(), blockSize);
-        uassert(16816, "file too short?", !_done);
+        std::unique_ptr<char[]> buffer(new char[blockSize]);
+        uassert(16816, "file too short?", read(buffer.get(), blockSize));
 
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
             size_t outLen;
             Status status =
-                encryptionHooks->unprotectTmpData(reinterpret_cast<uint8_t*>(_buffer.get()),
+                encryptionHooks->unprotectTmpData(reinterpret_cast<uint8_t*>(buffer.get()),
                                                   blockSize,
                                                   reinterpret_cast<uint8_t*>(out.get()),
                                                   blockSize,
@@ -256,43 +387,44 @@ private:
                     str::stream() << "Failed to unprotect data: " << status.toString(),
                     status.isOK());
             blockSize = outLen;
-            _buffer.swap(out);
+            buffer.swap(out);
         }
 
         if (!compressed) {
-            _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
+            block->buffer = std::move(buffer);
+            block->size = blockSize;
+            return block;
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+        dassert(snappy::IsValidCompressedBuffer(buffer.get(), blockSize));
 
         size_t uncompressedSize;
         uassert(17061,
                 "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                snappy::GetUncompressedLength(buffer.get(), blockSize, &uncompressedSize));
 
         std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
         uassert(17062,
                 "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                snappy::RawUncompress(buffer.get(), blockSize, decompressionBuffer.get()));
 
         // hold on to decompressed data and throw out compressed data at block exit
-        _buffer.swap(decompressionBuffer);
-        _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        block->buffer = std::move(decompressionBuffer);
+        block->size = uncompressedSize;
+        return block;
     }
 
     /**
-     * Attempts to read data from disk. Sets _done to true when file offset reaches _fileEndOffset.
+     * Attempts to read data from disk. Returns false when the file offset reaches _fileEndOffset.
      *
      * Masserts on any file errors
      */
-    void read(void* out, size_t size) {
+    bool read(void* out, size_t size) {
         invariant(_file.is_open());
 
         if (static_cast<unsigned int>(_file.tellg()) >= _fileEndOffset) {
             invariant(static_cast<unsigned int>(_file.tellg()) == _fileEndOffset);
-            _done = true;
-            return;
+            return false;
         }
 
         _file.read(reinterpret_cast<char*>(out), size);
@@ -301,6 +433,39 @@ private:
                               << myErrnoWithDescription(),
                 _file.good());
         verify(_file.gcount() == static_cast<std::streamsize>(size));
+        return true;
+    }
+
+    /**
+     * Asks the read-ahead thread for the next block. While the read is pending, only the
+     * read-ahead thread may touch _file.
+     */
+    void scheduleReadAhead() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_readAheadMutex);
+            invariant(!_readAheadPending && !_readAheadBlock);
+            _readAheadPending = true;
+        }
+
+        _readAheadThread->schedule([this] {
+            std::unique_ptr<Block> block;
+            try {
+                block = readBlock();
+            } catch (...) {
+                block = stdx::make_unique<Block>();
+                block->status = exceptionToStatus();
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_readAheadMutex);
+            _readAheadBlock = std::move(block);
+            _readAheadPending = false;
+            _readAheadDone.notify_all();
+        });
+    }
+
+    void waitForReadAhead() {
+        stdx::unique_lock<stdx::mutex> lk(_readAheadMutex);
+        _readAheadDone.wait(lk, [&] { return !_readAheadPending; });
     }
 
     const Settings _settings;
@@ -311,12 +476,25 @@ private:
     unsigned int _fileStartOffset;  // File offset at which the sorted data range starts.
     unsigned int _fileEndOffset;    // File offset at which the sorted data range ends.
     std::ifstream _file;
+
+    // Set while the source is open if blocks are read ahead. Not owned.
+    ReadAheadThread* _readAheadThread = nullptr;
+
+    // Guards _readAheadPending and _readAheadBlock.
+    stdx::mutex _readAheadMutex;
+    stdx::condition_variable _readAheadDone;
+    bool _readAheadPending = false;
+    std::unique_ptr<Block> _readAheadBlock;
 };
 
 /**
  * Merge-sorts results from 0 or more FileIterators, all of which should be iterating over sorted
  * ranges within the same file. This class is given the data source file name upon construction and
  * is responsible for deleting the data source file upon destruction.
+ *
+ * The merge is driven by a tournament tree of losers, which finds the next smallest element with
+ * exactly one comparison per level of the tree. When more than one of the inputs is a
+ * FileIterator, their blocks are read ahead on a background thread.
  */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -331,33 +509,50 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp),
+          _comp(comp),
           _itersSourceFileName(itersSourceFileName) {
+        std::vector<FileIterator<Key, Value>*> fileIters;
+        for (const auto& iter : iters) {
+            if (auto fileIter = dynamic_cast<FileIterator<Key, Value>*>(iter.get())) {
+                fileIters.push_back(fileIter);
+            }
+        }
+        if (fileIters.size() > 1) {
+            _readAheadThread = stdx::make_unique<ReadAheadThread>();
+            for (auto fileIter : fileIters) {
+                fileIter->enableReadAhead(_readAheadThread.get());
+            }
+        }
+
+        // Open every source before reading from any of them, so that their first blocks are read
+        // ahead concurrently.
         for (size_t i = 0; i < iters.size(); i++) {
             iters[i]->openSource();
+        }
+
+        for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(stdx::make_unique<Stream>(iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numLiveStreams = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = buildTree(1);
     }
 
     ~MergeIterator() {
         // Clear the remaining Stream objects first, to close the file handles before deleting the
         // file. Some systems will error closing the file if any file handles are still open.
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
+        _readAheadThread.reset();
         DESTRUCTOR_GUARD(boost::filesystem::remove(_itersSourceFileName));
     }
 
@@ -365,7 +560,7 @@ public:
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _numLiveStreams > 1 || _streams[_tree[0]]->more()))
             return true;
 
         _remaining = 0;
@@ -379,21 +574,17 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_tree[0]]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        size_t winner = _tree[0];
+        if (!_streams[winner]->advance()) {
+            verify(_numLiveStreams > 1);
+            _numLiveStreams--;
         }
+        replay(winner);
 
-        return _current->current();
+        return _streams[_tree[0]]->current();
     }
 
 
@@ -401,67 +592,163 @@ private:
     /**
      * Data iterator over an Input stream.
      *
-     * This class is responsible for closing the Input source upon destruction, unfortunately,
-     * because that is the path of least resistence to a design change requiring MergeIterator to
-     * handle eventual deletion of said Input source.
+     * This class is responsible for closing the Input source once it is exhausted or upon
+     * destruction, unfortunately, because that is the path of least resistence to a design change
+     * requiring MergeIterator to handle eventual deletion of said Input source.
      */
     class Stream {
     public:
-        Stream(size_t fileNum, const Data& first, std::shared_ptr<Input> rest)
-            : fileNum(fileNum), _current(first), _rest(rest) {}
+        Stream(const Data& first, std::shared_ptr<Input> rest) : _current(first), _rest(rest) {}
 
         ~Stream() {
-            _rest->closeSource();
+            if (!_exhausted)
+                _rest->closeSource();
         }
 
         const Data& current() const {
             return _current;
         }
+        bool exhausted() const {
+            return _exhausted;
+        }
         bool more() {
-            return _rest->more();
+            return !_exhausted && _rest->more();
         }
         bool advance() {
-            if (!_rest->more())
+            if (!_rest->more()) {
+                // Release the file handle and the last element as early as possible.
+                _exhausted = true;
+                _current = Data();
+                _rest->closeSource();
                 return false;
+            }
 
             _current = _rest->next();
             return true;
         }
 
-        const size_t fileNum;
-
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted = false;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
-
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
-        }
+    /**
+     * Returns true if the current element of stream 'lhs' sorts before that of stream 'rhs'.
+     * Exhausted streams sort after all others, and ties are broken by stream index to keep the
+     * merge stable.
+     */
+    bool less(size_t lhs, size_t rhs) const {
+        const Stream& lhsStream = *_streams[lhs];
+        const Stream& rhsStream = *_streams[rhs];
+        if (lhsStream.exhausted() || rhsStream.exhausted())
+            return !lhsStream.exhausted() || (rhsStream.exhausted() && lhs < rhs);
+
+        dassertCompIsSane(_comp, lhsStream.current(), rhsStream.current());
+        int ret = _comp(lhsStream.current(), rhsStream.current());
+        if (ret)
+            return ret < 0;
+
+        return lhs < rhs;
+    }
 
-    private:
-        const Comparator _comp;
-    };
+    /**
+     * Plays the matches of the subtree rooted at 'node', storing the loser of each match in the
+     * tree, and returns the winner. Nodes [1, k) are internal and nodes [k, 2k) are the leaves
+     * for the k streams.
+     */
+    size_t buildTree(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
+
+        size_t left = buildTree(2 * node);
+        size_t right = buildTree(2 * node + 1);
+        if (less(right, left))
+            std::swap(left, right);
+        _tree[node] = right;
+        return left;
+    }
+
+    /**
+     * Replays the matches from the leaf of stream 'winner', whose current element changed, up to
+     * the root.
+     */
+    void replay(size_t winner) {
+        for (size_t node = (winner + _streams.size()) / 2; node > 0; node /= 2) {
+            if (less(_tree[node], winner))
+                std::swap(_tree[node], winner);
+        }
+        _tree[0] = winner;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    const Comparator _comp;
     std::string _itersSourceFileName;
+
+    // Destroyed after the streams, since their FileIterators may be using it.
+    std::unique_ptr<ReadAheadThread> _readAheadThread;
+
+    std::vector<std::unique_ptr<Stream>> _streams;
+    size_t _numLiveStreams = 0;
+
+    // _tree[0] is the index of the stream holding the smallest current element, and _tree[i] for
+    // i > 0 is the index of the stream that lost the match played at internal node i.
+    std::vector<size_t> _tree;
 };
 
+/**
+ * Merges 'iters', all of which iterate over sorted ranges within '*fileName', in as many passes as
+ * needed to leave at most opts.maxOpenFilesForMerge ranges, so that a final MergeIterator never
+ * holds more file handles than that. Each pass writes its output to a new file, which replaces
+ * '*fileName', and then deletes the previous file.
+ */
+template <typename Key, typename Value, typename Comparator>
+void mergeSpillsToFitOpenFileBudget(
+    std::vector<std::shared_ptr<SortIteratorInterface<Key, Value>>>* iters,
+    std::string* fileName,
+    const SortOptions& opts,
+    const Comparator& comp,
+    const std::pair<typename Key::SorterDeserializeSettings,
+                    typename Value::SorterDeserializeSettings>& settings) {
+    typedef SortIteratorInterface<Key, Value> Iterator;
+
+    const size_t fanIn = std::max(opts.maxOpenFilesForMerge, size_t(2));
+    while (iters->size() > fanIn) {
+        const std::string mergedFileName = opts.tempDir + "/" + nextFileName();
+        std::vector<std::shared_ptr<Iterator>> merged;
+        try {
+            unsigned int nextSortedFileWriterOffset = 0;
+            for (size_t begin = 0; begin < iters->size(); begin += fanIn) {
+                const size_t end = std::min(begin + fanIn, iters->size());
+                std::vector<std::shared_ptr<Iterator>> group(iters->begin() + begin,
+                                                             iters->begin() + end);
+
+                // The source file still holds the other groups, so it is not handed over here.
+                MergeIterator<Key, Value, Comparator> groupIt(group, "", opts, comp);
+                SortedFileWriter<Key, Value> writer(
+                    opts, mergedFileName, nextSortedFileWriterOffset, settings);
+                while (groupIt.more()) {
+                    auto data = groupIt.next();
+                    writer.addAlreadySorted(data.first, data.second);
+                }
+                merged.push_back(std::shared_ptr<Iterator>(writer.done()));
+                nextSortedFileWriterOffset = writer.getFileEndOffset();
+            }
+        } catch (...) {
+            merged.clear();
+            DESTRUCTOR_GUARD(boost::filesystem::remove(mergedFileName));
+            throw;
+        }
+
+        iters->swap(merged);
+        merged.clear();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(*fileName));
+        *fileName = mergedFileName;
+    }
+}
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -510,6 +797,7 @@ public:
         }
 
         spill();
+        mergeSpillsToFitOpenFileBudget(&_iters, &_fileName, _opts, _comp, _settings);
         Iterator* mergeIt = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return mergeIt;
@@ -718,6 +1006,7 @@ public:
         }
 
         spill();
+        mergeSpillsToFitOpenFileBudget(&_iters, &_fileName, _opts, _comp, _settings);
         Iterator* iterator = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return iterator;
@@ -105,7 +105,16 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The maximum number of spilled ranges that are read at once, each through its own file
+    // handle, when merging. If more ranges than this were spilled, they are first merged in
+    // several passes into fewer, longer ranges.
+    size_t maxOpenFilesForMerge;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          maxOpenFilesForMerge(128) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -128,6 +137,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& MaxOpenFilesForMerge(size_t newMaxOpenFilesForMerge) {
+        maxOpenFilesForMerge = newMaxOpenFilesForMerge;
+        return *this;
+    }
 };
 
 /**
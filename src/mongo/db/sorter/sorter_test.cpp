@@ -364,6 +364,45 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test a number of sources that is not a power of two, exhausted at different times
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            for (int i = 0; i < 37; i++) {
+                vec.push_back(make_shared<IntIterator>(i, 37 * (i + 1), 37));
+            }
+            vec.push_back(make_shared<EmptyIterator>());
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, "", SortOptions(), IWComparator()));
+            std::vector<IWPair> expected;
+            for (int i = 0; i < 37; i++) {
+                for (int j = i; j < 37 * (i + 1); j += 37) {
+                    expected.push_back(IWPair(j, -j));
+                }
+            }
+            std::sort(expected.begin(), expected.end(), [](const IWPair& lhs, const IWPair& rhs) {
+                return lhs.first < rhs.first;
+            });
+            auto expectedIter =
+                std::make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(expected);
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, expectedIter);
+        }
+        {  // test that equal elements are returned in the order of their sources
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            for (int i = 0; i < 5; i++) {
+                vec.push_back(std::make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(
+                    IWPair(7, i)));
+            }
+
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, "", SortOptions(), IWComparator()));
+            std::vector<IWPair> expected;
+            for (int i = 0; i < 5; i++) {
+                expected.push_back(IWPair(7, i));
+            }
+            auto expectedIter =
+                std::make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(expected);
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, expectedIter);
+        }
     }
 };
 
@@ -570,6 +609,18 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+/**
+ * Spills far more ranges than can be merged at once, so that they have to be merged over several
+ * passes before the final merge.
+ */
+template <bool Random = true>
+class LotsOfDataLittleMemoryFewOpenFiles : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).MaxOpenFilesForMerge(4);
+    }
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -591,6 +642,8 @@ public:
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::LotsOfDataLittleMemoryFewOpenFiles</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryFewOpenFiles</*random=*/true>>();
     }
 };
 
@@ -36,7 +36,7 @@
 #include "mongo/db/stats/counters.h"
 
 #include "mongo/db/jsobj.h"
-#include "mongo/util/debug_util.h"
+#include "mongo/util/concurrency/cpu_hint.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -46,38 +46,31 @@ using std::endl;
 OpCounters::OpCounters() {}
 
 void OpCounters::gotInserts(int n) {
-    RARELY _checkWrap();
-    _insert.fetchAndAdd(n);
+    _increment(&Counters::insert, n);
 }
 
 void OpCounters::gotInsert() {
-    RARELY _checkWrap();
-    _insert.fetchAndAdd(1);
+    _increment(&Counters::insert, 1);
 }
 
 void OpCounters::gotQuery() {
-    RARELY _checkWrap();
-    _query.fetchAndAdd(1);
+    _increment(&Counters::query, 1);
 }
 
 void OpCounters::gotUpdate() {
-    RARELY _checkWrap();
-    _update.fetchAndAdd(1);
+    _increment(&Counters::update, 1);
 }
 
 void OpCounters::gotDelete() {
-    RARELY _checkWrap();
-    _delete.fetchAndAdd(1);
+    _increment(&Counters::remove, 1);
 }
 
 void OpCounters::gotGetMore() {
-    RARELY _checkWrap();
-    _getmore.fetchAndAdd(1);
+    _increment(&Counters::getmore, 1);
 }
 
 void OpCounters::gotCommand() {
-    RARELY _checkWrap();
-    _command.fetchAndAdd(1);
+    _increment(&Counters::command, 1);
 }
 
 void OpCounters::gotOp(int op, bool isCommand) {
@@ -108,31 +101,45 @@ void OpCounters::gotOp(int op, bool isCommand) {
     }
 }
 
-void OpCounters::_checkWrap() {
-    const int64_t MAX = 1ULL << 60;
+void OpCounters::_increment(AtomicInt64 Counters::*counter, long long n) {
+    // All counters are reset once a shard of one of them exceeds its part of the limit.
+    const long long kMaxPerShard = (1LL << 60) / kNumShards;
 
-    bool wrap = _insert.loadRelaxed() > MAX || _query.loadRelaxed() > MAX ||
-        _update.loadRelaxed() > MAX || _delete.loadRelaxed() > MAX ||
-        _getmore.loadRelaxed() > MAX || _command.loadRelaxed() > MAX;
+    auto& shardCounter = _shards[currentCPUHint() % kNumShards].*counter;
+    // don't care about the race as its just a counter
+    if (MONGO_unlikely(shardCounter.loadRelaxed() > kMaxPerShard)) {
+        _reset();
+    }
+    shardCounter.fetchAndAdd(n);
+}
+
+long long OpCounters::_sum(AtomicInt64 Counters::*counter) const {
+    long long sum = 0;
+    for (const auto& shard : _shards) {
+        sum += (shard.*counter).loadRelaxed();
+    }
+    return sum;
+}
 
-    if (wrap) {
-        _insert.store(0);
-        _query.store(0);
-        _update.store(0);
-        _delete.store(0);
-        _getmore.store(0);
-        _command.store(0);
+void OpCounters::_reset() {
+    for (auto& shard : _shards) {
+        shard.insert.store(0);
+        shard.query.store(0);
+        shard.update.store(0);
+        shard.remove.store(0);
+        shard.getmore.store(0);
+        shard.command.store(0);
     }
 }
 
 BSONObj OpCounters::getObj() const {
     BSONObjBuilder b;
-    b.append("insert", _insert.loadRelaxed());
-    b.append("query", _query.loadRelaxed());
-    b.append("update", _update.loadRelaxed());
-    b.append("delete", _delete.loadRelaxed());
-    b.append("getmore", _getmore.loadRelaxed());
-    b.append("command", _command.loadRelaxed());
+    b.append("insert", getInsert());
+    b.append("query", getQuery());
+    b.append("update", getUpdate());
+    b.append("delete", getDelete());
+    b.append("getmore", getGetMore());
+    b.append("command", getCommand());
     return b.obj();
 }
 
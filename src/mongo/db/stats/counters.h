@@ -31,10 +31,13 @@
 
 #pragma once
 
+#include <array>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/basic.h"
 #include "mongo/rpc/message.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/with_alignment.h"
@@ -43,7 +46,9 @@ namespace mongo {
 
 /**
  * for storing operation counters
- * note: not thread safe.  ok with that for speed
+ *
+ * Every counter is kept in several shards, each on its own cache line, and a thread increments the
+ * shard of the CPU it runs on. The shards are summed up when the counters are read.
  */
 class OpCounters {
 public:
@@ -60,35 +65,50 @@ public:
 
     BSONObj getObj() const;
 
-    // thse are used by snmp, and other things, do not remove
-    const AtomicInt64* getInsert() const {
-        return &_insert;
+    // These are used by snmp, and other things, do not remove. They return the sum of the per-CPU
+    // shards rather than a pointer to a single counter, so a total may miss increments that race
+    // with the read.
+    long long getInsert() const {
+        return _sum(&Counters::insert);
     }
-    const AtomicInt64* getQuery() const {
-        return &_query;
+    long long getQuery() const {
+        return _sum(&Counters::query);
     }
-    const AtomicInt64* getUpdate() const {
-        return &_update;
+    long long getUpdate() const {
+        return _sum(&Counters::update);
     }
-    const AtomicInt64* getDelete() const {
-        return &_delete;
+    long long getDelete() const {
+        return _sum(&Counters::remove);
     }
-    const AtomicInt64* getGetMore() const {
-        return &_getmore;
+    long long getGetMore() const {
+        return _sum(&Counters::getmore);
     }
-    const AtomicInt64* getCommand() const {
-        return &_command;
+    long long getCommand() const {
+        return _sum(&Counters::command);
     }
 
 private:
-    void _checkWrap();
-
-    CacheAligned<AtomicInt64> _insert;
-    CacheAligned<AtomicInt64> _query;
-    CacheAligned<AtomicInt64> _update;
-    CacheAligned<AtomicInt64> _delete;
-    CacheAligned<AtomicInt64> _getmore;
-    CacheAligned<AtomicInt64> _command;
+    struct Counters {
+        AtomicInt64 insert;
+        AtomicInt64 query;
+        AtomicInt64 update;
+        AtomicInt64 remove;
+        AtomicInt64 getmore;
+        AtomicInt64 command;
+    };
+    static_assert(sizeof(Counters) <= stdx::hardware_constructive_interference_size,
+                  "cache line spill");
+
+    // Enough shards for CPUs not to share one on most machines.
+    static const size_t kNumShards = 64;
+
+    void _increment(AtomicInt64 Counters::*counter, long long n);
+
+    long long _sum(AtomicInt64 Counters::*counter) const;
+
+    void _reset();
+
+    std::array<CacheAligned<Counters>, kNumShards> _shards;
 };
 
 extern OpCounters globalOpCounters;
@@ -0,0 +1,77 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/stats/counters.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(OpCountersTest, IncrementsFromManyThreadsAreCombined) {
+    OpCounters counters;
+    const int kNumThreads = 8;
+    const int kNumOps = 1000;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < kNumOps; ++j) {
+                counters.gotInserts(2);
+                counters.gotQuery();
+                counters.gotOp(dbUpdate, false);
+                counters.gotOp(dbQuery, true);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(2 * kNumThreads * kNumOps, counters.getInsert());
+    ASSERT_EQ(kNumThreads * kNumOps, counters.getQuery());
+    ASSERT_EQ(kNumThreads * kNumOps, counters.getUpdate());
+    ASSERT_EQ(kNumThreads * kNumOps, counters.getCommand());
+    ASSERT_EQ(0, counters.getDelete());
+
+    const auto obj = counters.getObj();
+    ASSERT_EQ(2 * kNumThreads * kNumOps, obj["insert"].numberLong());
+    ASSERT_EQ(kNumThreads * kNumOps, obj["query"].numberLong());
+    ASSERT_EQ(kNumThreads * kNumOps, obj["update"].numberLong());
+    ASSERT_EQ(0, obj["delete"].numberLong());
+    ASSERT_EQ(0, obj["getmore"].numberLong());
+    ASSERT_EQ(kNumThreads * kNumOps, obj["command"].numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -55,6 +55,11 @@ public:
      */
     void increment(uint64_t latency, Command::ReadWriteType type);
 
+    /**
+     * Adds the counts and latencies of 'other' to this histogram.
+     */
+    void merge(const OperationLatencyHistogram& other);
+
     /**
      * Appends the four histograms with latency totals and operation counts.
      */
@@ -78,6 +83,8 @@ private:
 
     void _incrementData(uint64_t latency, int bucket, HistogramData* data);
 
+    static void _mergeData(const HistogramData& other, HistogramData* data);
+
     HistogramData _reads, _writes, _commands, _transactions;
 };
 }  // namespace mongo
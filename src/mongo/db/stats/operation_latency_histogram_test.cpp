@@ -93,4 +93,27 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
         ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
     }
 }
+
+TEST(OperationLatencyHistogram, MergeAddsCountsAndLatencies) {
+    OperationLatencyHistogram first;
+    OperationLatencyHistogram second;
+    first.increment(kLowerBounds[1], Command::ReadWriteType::kRead);
+    first.increment(kLowerBounds[5], Command::ReadWriteType::kWrite);
+    second.increment(kLowerBounds[1], Command::ReadWriteType::kRead);
+    second.increment(kLowerBounds[7], Command::ReadWriteType::kRead);
+
+    first.merge(second);
+    BSONObjBuilder outBuilder;
+    first.append(true, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["reads"]["ops"].Long(), 3);
+    ASSERT_EQUALS(static_cast<uint64_t>(out["reads"]["latency"].Long()),
+                  2 * kLowerBounds[1] + kLowerBounds[7]);
+    std::vector<BSONElement> readBuckets = out["reads"]["histogram"].Array();
+    ASSERT_EQUALS(readBuckets.size(), 2U);
+    ASSERT_EQUALS(readBuckets[0].Obj()["count"].Long(), 2);
+    ASSERT_EQUALS(readBuckets[1].Obj()["count"].Long(), 1);
+    ASSERT_EQUALS(out["writes"]["ops"].Long(), 1);
+    ASSERT_EQUALS(out["commands"]["ops"].Long(), 0);
+}
 }  // namespace mongo
@@ -37,6 +37,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/util/concurrency/cpu_hint.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -69,6 +70,21 @@ Top::CollectionData::CollectionData(const CollectionData& older, const Collectio
       remove(older.remove, newer.remove),
       commands(older.commands, newer.commands) {}
 
+void Top::CollectionData::add(const CollectionData& other) {
+    total.add(other.total);
+    readLock.add(other.readLock);
+    writeLock.add(other.writeLock);
+    queries.add(other.queries);
+    getmore.add(other.getmore);
+    insert.add(other.insert);
+    update.add(other.update);
+    remove.add(other.remove);
+    commands.add(other.commands);
+    opLatencyHistogram.merge(other.opLatencyHistogram);
+}
+
+Top::Top() : _shards(kNumShards) {}
+
 // static
 Top& Top::get(ServiceContext* service) {
     return getTop(service);
@@ -84,19 +100,25 @@ void Top::record(OperationContext* opCtx,
     if (ns[0] == '?')
         return;
 
-    auto hashedNs = UsageMap::HashedKey(ns);
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-
-    if ((command || logicalOp == LogicalOp::opQuery) &&
-        _collDropNs.find(ns.toString()) != _collDropNs.end()) {
-        _collDropNs.erase(ns.toString());
-        return;
+    if ((command || logicalOp == LogicalOp::opQuery) && _numCollDropNs.load() > 0) {
+        stdx::lock_guard<SimpleMutex> lk(_collDropNsLock);
+        if (_collDropNs.erase(ns.toString())) {
+            _numCollDropNs.store(_collDropNs.size());
+            return;
+        }
     }
 
-    CollectionData& coll = _usage[hashedNs];
+    auto hashedNs = UsageMap::HashedKey(ns);
+    auto& shard = _getShard();
+    stdx::lock_guard<SimpleMutex> lk(shard.lock);
+    CollectionData& coll = shard.usage[hashedNs];
     _record(opCtx, coll, logicalOp, lockType, micros, readWriteType);
 }
 
+Top::Shard& Top::_getShard() {
+    return _shards[currentCPUHint() % kNumShards];
+}
+
 void Top::_record(OperationContext* opCtx,
                   CollectionData& c,
                   LogicalOp logicalOp,
@@ -143,24 +165,34 @@ void Top::_record(OperationContext* opCtx,
 }
 
 void Top::collectionDropped(StringData ns, bool databaseDropped) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _usage.erase(ns);
+    for (auto& shard : _shards) {
+        stdx::lock_guard<SimpleMutex> lk(shard.lock);
+        shard.usage.erase(ns);
+    }
 
     if (!databaseDropped) {
         // If a collection drop occurred, there will be a subsequent call to record for this
         // collection namespace which must be ignored. This does not apply to a database drop.
+        stdx::lock_guard<SimpleMutex> lk(_collDropNsLock);
         _collDropNs.insert(ns.toString());
+        _numCollDropNs.store(_collDropNs.size());
     }
 }
 
 void Top::cloneMap(Top::UsageMap& out) const {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    out = _usage;
+    out.clear();
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<SimpleMutex> lk(shard.lock);
+        for (const auto& entry : shard.usage) {
+            out[entry.first].add(entry.second);
+        }
+    }
 }
 
 void Top::append(BSONObjBuilder& b) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _appendToUsageMap(b, _usage);
+    UsageMap usage;
+    cloneMap(usage);
+    _appendToUsageMap(b, usage);
 }
 
 void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
@@ -203,9 +235,25 @@ void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const Usag
 
 void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder) {
     auto hashedNs = UsageMap::HashedKey(ns);
-    stdx::lock_guard<SimpleMutex> lk(_lock);
+    OperationLatencyHistogram histogram;
+    bool found = false;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<SimpleMutex> lk(shard.lock);
+        auto it = shard.usage.find(hashedNs);
+        if (it != shard.usage.end()) {
+            histogram.merge(it->second.opLatencyHistogram);
+            found = true;
+        }
+    }
+    if (!found) {
+        // Reading the statistics of a namespace starts tracking it.
+        auto& shard = _getShard();
+        stdx::lock_guard<SimpleMutex> lk(shard.lock);
+        shard.usage[hashedNs];
+    }
+
     BSONObjBuilder latencyStatsBuilder;
-    _usage[hashedNs].opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    histogram.append(includeHistograms, &latencyStatsBuilder);
     builder->append("ns", ns);
     builder->append("latencyStats", latencyStatsBuilder.obj());
 }
@@ -213,18 +261,24 @@ void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuild
 void Top::incrementGlobalLatencyStats(OperationContext* opCtx,
                                       uint64_t latency,
                                       Command::ReadWriteType readWriteType) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
-    _incrementHistogram(opCtx, latency, &_globalHistogramStats, readWriteType);
+    auto& shard = _getShard();
+    stdx::lock_guard<SimpleMutex> guard(shard.lock);
+    _incrementHistogram(opCtx, latency, &shard.globalHistogramStats, readWriteType);
 }
 
 void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
-    _globalHistogramStats.append(includeHistograms, builder);
+    OperationLatencyHistogram globalHistogramStats;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<SimpleMutex> guard(shard.lock);
+        globalHistogramStats.merge(shard.globalHistogramStats);
+    }
+    globalHistogramStats.append(includeHistograms, builder);
 }
 
 void Top::incrementGlobalTransactionLatencyStats(uint64_t latency) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
-    _globalHistogramStats.increment(latency, Command::ReadWriteType::kTransaction);
+    auto& shard = _getShard();
+    stdx::lock_guard<SimpleMutex> guard(shard.lock);
+    shard.globalHistogramStats.increment(latency, Command::ReadWriteType::kTransaction);
 }
 
 void Top::_incrementHistogram(OperationContext* opCtx,
@@ -32,13 +32,19 @@
 
 #pragma once
 
+#include <boost/align/aligned_allocator.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "mongo/db/commands.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -51,7 +57,7 @@ class Top {
 public:
     static Top& get(ServiceContext* service);
 
-    Top() = default;
+    Top();
 
     struct UsageData {
         UsageData() : time(0), count(0) {}
@@ -63,6 +69,11 @@ public:
             count++;
             time += micros;
         }
+
+        void add(const UsageData& other) {
+            count += other.count;
+            time += other.time;
+        }
     };
 
     struct CollectionData {
@@ -72,6 +83,11 @@ public:
         CollectionData() {}
         CollectionData(const CollectionData& older, const CollectionData& newer);
 
+        /**
+         * Adds the usage recorded in 'other' to this.
+         */
+        void add(const CollectionData& other);
+
         UsageData total;
 
         UsageData readLock;
@@ -148,10 +164,30 @@ private:
                              OperationLatencyHistogram* histogram,
                              Command::ReadWriteType readWriteType);
 
-    mutable SimpleMutex _lock;
-    OperationLatencyHistogram _globalHistogramStats;
-    UsageMap _usage;
+    /**
+     * Usage recorded by the threads running on a subset of the CPUs. Operations only lock the
+     * shard of their current CPU, and the shards are only combined when the statistics are read.
+     */
+    struct Shard {
+        mutable SimpleMutex lock;
+        OperationLatencyHistogram globalHistogramStats;
+        UsageMap usage;
+    };
+
+    // Every shard holds its own copy of the statistics of each collection that is used on its
+    // CPUs, so a small number of shards keeps the memory footprint bounded.
+    static const size_t kNumShards = 8;
+
+    Shard& _getShard();
+
+    // std::allocator does not honour the over-alignment of CacheAligned before C++17.
+    std::vector<CacheAligned<Shard>, boost::alignment::aligned_allocator<CacheAligned<Shard>>>
+        _shards;
+
+    // Guards _collDropNs, which is only consulted by record() while _numCollDropNs is non-zero.
+    SimpleMutex _collDropNsLock;
     std::set<std::string> _collDropNs;
+    AtomicWord<size_t> _numCollDropNs{0};
 };
 
 }  // namespace mongo
@@ -30,15 +30,105 @@
 
 #include "mongo/platform/basic.h"
 
+#include <vector>
+
+#include "mongo/db/client.h"
+#include "mongo/db/service_context_test_fixture.h"
 #include "mongo/db/stats/top.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 
 namespace {
 
 using namespace mongo;
 
+class TopRecordTest : public ServiceContextTest {
+protected:
+    void recordInsert(Top* top, StringData ns) {
+        top->record(_opCtx.get(),
+                    ns,
+                    LogicalOp::opInsert,
+                    Top::LockType::WriteLocked,
+                    10,
+                    false,
+                    Command::ReadWriteType::kWrite);
+    }
+
+    void recordCommand(Top* top, StringData ns) {
+        top->record(_opCtx.get(),
+                    ns,
+                    LogicalOp::opCommand,
+                    Top::LockType::WriteLocked,
+                    10,
+                    true,
+                    Command::ReadWriteType::kCommand);
+    }
+
+    ServiceContext::UniqueOperationContext _opCtx = makeOperationContext();
+};
+
 TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST_F(TopRecordTest, RecordsFromManyThreadsAreCombined) {
+    Top top;
+    const int kNumThreads = 8;
+    const int kNumRecords = 1000;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&] {
+            ThreadClient tc(getServiceContext());
+            auto opCtx = Client::getCurrent()->makeOperationContext();
+            for (int j = 0; j < kNumRecords; ++j) {
+                top.record(opCtx.get(),
+                           "test.coll",
+                           LogicalOp::opInsert,
+                           Top::LockType::WriteLocked,
+                           10,
+                           false,
+                           Command::ReadWriteType::kWrite);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Top::UsageMap usage;
+    top.cloneMap(usage);
+    ASSERT_EQ(1U, usage.size());
+    const auto& coll = usage["test.coll"];
+    ASSERT_EQ(kNumThreads * kNumRecords, coll.total.count);
+    ASSERT_EQ(10 * kNumThreads * kNumRecords, coll.total.time);
+    ASSERT_EQ(kNumThreads * kNumRecords, coll.insert.count);
+    ASSERT_EQ(kNumThreads * kNumRecords, coll.writeLock.count);
+    ASSERT_EQ(0, coll.readLock.count);
+
+    BSONObjBuilder builder;
+    top.append(builder);
+    const auto obj = builder.obj();
+    ASSERT_EQ(kNumThreads * kNumRecords, obj["test.coll"]["insert"]["count"].numberLong());
+}
+
+TEST_F(TopRecordTest, CollectionDroppedIgnoresTheNextCommand) {
+    Top top;
+    recordInsert(&top, "test.coll");
+    recordInsert(&top, "test.other");
+    top.collectionDropped("test.coll");
+
+    Top::UsageMap usage;
+    top.cloneMap(usage);
+    ASSERT_EQ(1U, usage.size());
+    ASSERT_EQ(1U, usage.count("test.other"));
+
+    // The drop command itself is not recorded, but anything after it is.
+    recordCommand(&top, "test.coll");
+    top.cloneMap(usage);
+    ASSERT_EQ(0U, usage.count("test.coll"));
+    recordCommand(&top, "test.coll");
+    top.cloneMap(usage);
+    ASSERT_EQ(1, usage["test.coll"].commands.count);
+}
+
 }  // namespace
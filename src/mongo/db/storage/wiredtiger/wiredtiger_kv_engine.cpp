@@ -86,12 +86,14 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/ticket_admission_controller.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 #if !defined(__has_feature)
 #define __has_feature(x) 0
@@ -382,10 +384,12 @@ class TicketServerParameter : public ServerParameter {
 
 public:
     TicketServerParameter(TicketHolder* holder, const std::string& name)
-        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true), _holder(holder) {}
+        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true),
+          _holder(holder),
+          _configured(holder->outof()) {}
 
     virtual void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) {
-        b.append(name, _holder->outof());
+        b.append(name, configured());
     }
 
     virtual Status set(const BSONElement& newValueElement) {
@@ -407,11 +411,24 @@ public:
             return Status(ErrorCodes::BadValue, str::stream() << name() << " has to be > 0");
         }
 
-        return _holder->resize(newNum);
+        Status status = _holder->resize(newNum);
+        if (status.isOK()) {
+            _configured.store(newNum);
+        }
+        return status;
+    }
+
+    /**
+     * The number of tickets set by the user. With admission control enabled, the actual number of
+     * tickets varies up to this value.
+     */
+    int configured() const {
+        return _configured.load();
     }
 
 private:
     TicketHolder* _holder;
+    AtomicInt32 _configured;
 };
 
 TicketHolder openWriteTransaction(128);
@@ -425,8 +442,121 @@ TicketServerParameter openReadTransactionParam(&openReadTransaction,
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
+
+stdx::function<std::unique_ptr<WiredTigerKVEngine::CappedReclaimer>()> cappedReclaimerFactory;
+
+// When enabled, the number of read and write tickets is continuously adjusted, up to the values of
+// wiredTigerConcurrentReadTransactions and wiredTigerConcurrentWriteTransactions, to the
+// concurrency at which throughput peaks.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdmissionControl, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdmissionControlMinTickets, int, 8)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 5) {
+            return Status(ErrorCodes::BadValue,
+                          "wiredTigerAdmissionControlMinTickets must be at least 5");
+        }
+        return Status::OK();
+    });
+
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdmissionControlIntervalMillis, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal <= 0) {
+            return Status(ErrorCodes::BadValue,
+                          "wiredTigerAdmissionControlIntervalMillis must be greater than 0");
+        }
+        return Status::OK();
+    });
 }  // namespace
 
+class WiredTigerKVEngine::WiredTigerAdmissionController : public BackgroundJob {
+public:
+    WiredTigerAdmissionController() : BackgroundJob(false /* deleteSelf */) {}
+
+    virtual string name() const {
+        return "WTAdmissionController";
+    }
+
+    virtual void run() {
+        ThreadClient tc(name(), getGlobalServiceContext());
+        LOG(1) << "starting " << name() << " thread";
+
+        std::unique_ptr<TicketAdmissionController> readController;
+        std::unique_ptr<TicketAdmissionController> writeController;
+        Timer timer;
+
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(
+                    lock,
+                    Milliseconds(wiredTigerAdmissionControlIntervalMillis.load())
+                        .toSystemDuration(),
+                    [&] { return _shuttingDown.load(); });
+            }
+            if (_shuttingDown.load()) {
+                break;
+            }
+
+            const Milliseconds elapsed(timer.millis());
+            timer.reset();
+
+            if (!wiredTigerAdmissionControl.load()) {
+                if (readController) {
+                    // Hand the ticket counts back to the user settings.
+                    readController.reset();
+                    writeController.reset();
+                    _resetTickets(&openReadTransaction, openReadTransactionParam);
+                    _resetTickets(&openWriteTransaction, openWriteTransactionParam);
+                }
+                continue;
+            }
+
+            const int minTickets = wiredTigerAdmissionControlMinTickets.load();
+            if (!readController) {
+                readController = stdx::make_unique<TicketAdmissionController>(
+                    &openReadTransaction, minTickets, openReadTransactionParam.configured());
+                writeController = stdx::make_unique<TicketAdmissionController>(
+                    &openWriteTransaction, minTickets, openWriteTransactionParam.configured());
+                continue;
+            }
+
+            readController->setBounds(minTickets, openReadTransactionParam.configured());
+            writeController->setBounds(minTickets, openWriteTransactionParam.configured());
+            try {
+                readController->adjust(elapsed);
+                writeController->adjust(elapsed);
+            } catch (const DBException& ex) {
+                warning() << "Failed to adjust the number of storage tickets: " << ex.toStatus();
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            _condvar.notify_one();
+        }
+        wait();
+    }
+
+private:
+    static void _resetTickets(TicketHolder* holder, const TicketServerParameter& param) {
+        Status status = holder->resize(param.configured());
+        if (!status.isOK()) {
+            warning() << "Failed to restore the number of storage tickets: " << status;
+        }
+    }
+
+    stdx::mutex _mutex;  // protects _condvar
+    stdx::condition_variable _condvar;
+
+    AtomicBool _shuttingDown{false};
+};
+
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
                                        const std::string& path,
                                        ClockSource* cs,
@@ -574,6 +704,9 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sizeStorer = std::make_unique<WiredTigerSizeStorer>(_conn, _sizeStorerUri, _readOnly);
 
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
+
+    _admissionController = stdx::make_unique<WiredTigerAdmissionController>();
+    _admissionController->go();
 }
 
 
@@ -592,6 +725,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        bbb.append("queued", openWriteTransaction.queued());
         bbb.done();
     }
     {
@@ -599,6 +733,7 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        bbb.append("queued", openReadTransaction.queued());
         bbb.done();
     }
     bb.done();
@@ -674,6 +809,23 @@ void WiredTigerKVEngine::cleanShutdown() {
         return;
     }
 
+    if (_admissionController) {
+        _admissionController->shutdown();
+        _admissionController.reset();
+    }
+
+    std::unique_ptr<CappedReclaimer> cappedReclaimer;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_cappedReclaimerMutex);
+        _cappedReclaimerShutdown = true;
+        cappedReclaimer = std::move(_cappedReclaimer);
+    }
+    if (cappedReclaimer) {
+        log() << "Shutting down capped reclaimer thread";
+        cappedReclaimer->shutdown();
+        log() << "Finished shutting down capped reclaimer thread";
+    }
+
     // these must be the last things we do before _conn->close();
     if (_journalFlusher) {
         log() << "Shutting down journal flusher thread";
@@ -1361,6 +1513,28 @@ bool WiredTigerKVEngine::initRsOplogBackgroundThread(StringData ns) {
     return initRsOplogBackgroundThreadCallback(ns);
 }
 
+void WiredTigerKVEngine::setCappedReclaimerFactory(
+    stdx::function<std::unique_ptr<CappedReclaimer>()> factory) {
+    cappedReclaimerFactory = std::move(factory);
+}
+
+bool WiredTigerKVEngine::requestCappedDeletion(StringData ns,
+                                               std::shared_ptr<AtomicWord<bool>> requested) {
+    if (!cappedReclaimerFactory || _readOnly || _inRepairMode) {
+        return false;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_cappedReclaimerMutex);
+    if (_cappedReclaimerShutdown) {
+        return false;
+    }
+    if (!_cappedReclaimer) {
+        _cappedReclaimer = cappedReclaimerFactory();
+    }
+    _cappedReclaimer->request(ns, std::move(requested));
+    return true;
+}
+
 namespace {
 
 MONGO_FAIL_POINT_DEFINE(WTPreserveSnapshotHistoryIndefinitely);
@@ -45,6 +45,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/elapsed_tracker.h"
@@ -297,6 +298,42 @@ public:
      */
     static bool initRsOplogBackgroundThread(StringData ns);
 
+    /**
+     * Deletes the excess documents of capped collections in the background, on behalf of inserts.
+     * The implementation needs the catalog, so it is provided by the mongod-only library through
+     * `setCappedReclaimerFactory`.
+     */
+    class CappedReclaimer {
+    public:
+        virtual ~CappedReclaimer() = default;
+
+        /**
+         * Queues a deletion pass for the capped collection 'ns'. 'requested' is the flag the
+         * requesting record store set, and is reset once the pass is over, whatever its outcome.
+         */
+        virtual void request(StringData ns, std::shared_ptr<AtomicWord<bool>> requested) = 0;
+
+        /**
+         * Stops and joins the background job. Pending requests are dropped.
+         */
+        virtual void shutdown() = 0;
+    };
+
+    /**
+     * Sets the factory of the `CappedReclaimer` owned by each engine. Intended to be called from a
+     * MONGO_INITIALIZER and therefore in a single threaded context. Without one, capped
+     * collections always delete their excess documents on the insert path.
+     */
+    static void setCappedReclaimerFactory(
+        stdx::function<std::unique_ptr<CappedReclaimer>()> factory);
+
+    /**
+     * Asks the background job to remove excess documents from the capped collection 'ns', starting
+     * it on first use. Returns false if there is no background job to do so, in which case
+     * 'requested' is left for the caller to reset.
+     */
+    bool requestCappedDeletion(StringData ns, std::shared_ptr<AtomicWord<bool>> requested);
+
     static void appendGlobalStats(BSONObjBuilder& b);
 
     /**
@@ -345,6 +382,7 @@ public:
 private:
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerAdmissionController;
 
     /**
      * Opens a connection on the WiredTiger database 'path' with the configuration 'wtOpenConfig'.
@@ -429,6 +467,11 @@ private:
 
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerAdmissionController> _admissionController;
+
+    stdx::mutex _cappedReclaimerMutex;
+    bool _cappedReclaimerShutdown = false;
+    std::unique_ptr<CappedReclaimer> _cappedReclaimer;
 
     std::string _rsOptions;
     std::string _indexOptions;
@@ -48,6 +48,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/repl_settings.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/server_recovery.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
@@ -88,6 +89,45 @@ void checkOplogFormatVersion(OperationContext* opCtx, const std::string& uri) {
 
     fassertNoTrace(39998, appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
 }
+
+// The time it should take to fill an oplog stone. Stones which fill faster than this are made
+// smaller, so that truncating a single stone stays cheap under heavy write load. Setting this to 0
+// disables adaptive stone sizing.
+MONGO_EXPORT_SERVER_PARAMETER(oplogStoneTargetFillMillis, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "oplogStoneTargetFillMillis must be >= 0");
+        }
+        return Status::OK();
+    });
+
+// The amount of time a single call to reclaimOplog() may spend truncating before it returns, so
+// that the truncater thread periodically releases its locks while working through a backlog of
+// stones. Setting this to 0 lets a single call truncate every excess stone.
+MONGO_EXPORT_SERVER_PARAMETER(oplogTruncationMaxTimePerPassMillis, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0) {
+            return Status(ErrorCodes::BadValue, "oplogTruncationMaxTimePerPassMillis must be >= 0");
+        }
+        return Status::OK();
+    });
+
+// Whether capped collections without a maximum number of documents leave the deletion of their
+// oldest documents to a background job, as long as they do not exceed their maximum size by more
+// than the capped slack.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCappedDeletionInBackground, bool, true);
+
+// Process-wide statistics about oplog truncation.
+struct OplogTruncationStats {
+    AtomicInt64 passes;
+    AtomicInt64 passesReachingTimeLimit;
+    AtomicInt64 truncateCount;
+    AtomicInt64 totalTimeTruncatingMicros;
+    AtomicInt64 recordsTruncated;
+    AtomicInt64 bytesTruncated;
+    AtomicInt64 stoneSizeAdjustments;
+    AtomicInt64 minBytesPerStone;
+} oplogTruncationStats;
 }  // namespace
 
 MONGO_FAIL_POINT_DEFINE(WTWriteConflictException);
@@ -124,7 +164,7 @@ public:
 
         _oplogStones->_currentRecords.addAndFetch(_countInserted);
         int64_t newCurrentBytes = _oplogStones->_currentBytes.addAndFetch(_bytesInserted);
-        if (newCurrentBytes >= _oplogStones->_minBytesPerStone) {
+        if (newCurrentBytes >= _oplogStones->_minBytesPerStone.load()) {
             _oplogStones->createNewStoneIfNeeded(_highestInserted);
         }
     }
@@ -169,10 +209,13 @@ WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* opCtx, WiredTi
 
     unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
     size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
+    _baseMinBytesPerStone = maxSize / numStonesToKeep;
+    invariant(_baseMinBytesPerStone > 0);
+    _minBytesPerStone.store(_baseMinBytesPerStone);
+    oplogTruncationStats.minBytesPerStone.store(_baseMinBytesPerStone);
 
     _calculateStones(opCtx, numStonesToKeep);
+    _stoneFillTimer.reset();
     _pokeReclaimThreadIfNeeded();  // Reclaim stones if over the limit.
 }
 
@@ -240,7 +283,7 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
         return;
     }
 
-    if (_currentBytes.load() < _minBytesPerStone) {
+    if (_currentBytes.load() < _minBytesPerStone.load()) {
         // Must have raced to create a new stone, someone else already triggered it.
         return;
     }
@@ -256,9 +299,49 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
     OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
     _stones.push_back(stone);
 
+    _adaptStoneSize_inlock();
     _pokeReclaimThreadIfNeeded();
 }
 
+// static
+int64_t WiredTigerRecordStore::OplogStones::adaptMinBytesPerStone(int64_t current,
+                                                                   int64_t base,
+                                                                   Milliseconds fillTime,
+                                                                   Milliseconds targetFillTime) {
+    const int64_t smallest = std::max<int64_t>(1, base / kMaxStoneSplitFactor);
+    if (fillTime * 2 < targetFillTime) {
+        return std::max(smallest, current / 2);
+    }
+    if (fillTime > targetFillTime * 2) {
+        return std::min(base, current * 2);
+    }
+    return std::min(base, std::max(smallest, current));
+}
+
+void WiredTigerRecordStore::OplogStones::_adaptStoneSize_inlock() {
+    const Milliseconds fillTime(_stoneFillTimer.millis());
+    _stoneFillTimer.reset();
+
+    if (!_adaptiveStoneSize) {
+        return;
+    }
+
+    const Milliseconds targetFillTime(oplogStoneTargetFillMillis.load());
+    const int64_t current = _minBytesPerStone.load();
+    const int64_t next = targetFillTime == Milliseconds(0)
+        ? _baseMinBytesPerStone
+        : adaptMinBytesPerStone(current, _baseMinBytesPerStone, fillTime, targetFillTime);
+    if (next == current) {
+        return;
+    }
+
+    LOG(1) << "Changing the minimum size of oplog stones from " << current << " to " << next
+           << " bytes, the last stone took " << fillTime << " to fill";
+    _minBytesPerStone.store(next);
+    oplogTruncationStats.stoneSizeAdjustments.addAndFetch(1);
+    oplogTruncationStats.minBytesPerStone.store(next);
+}
+
 void WiredTigerRecordStore::OplogStones::updateCurrentStoneAfterInsertOnCommit(
     OperationContext* opCtx,
     int64_t bytesInserted,
@@ -308,7 +391,9 @@ void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
 
     // Only allow changing the minimum bytes per stone if no data has been inserted.
     invariant(_stones.size() == 0 && _currentRecords.load() == 0);
-    _minBytesPerStone = size;
+    _minBytesPerStone.store(size);
+    _baseMinBytesPerStone = size;
+    _adaptiveStoneSize = false;
 }
 
 void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCtx,
@@ -335,7 +420,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     // Use the oplog's average record size to estimate the number of records in each stone, and thus
     // estimate the combined size of the records.
     double avgRecordSize = double(dataSize) / double(numRecords);
-    double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
+    double estRecordsPerStone = std::ceil(_minBytesPerStone.load() / avgRecordSize);
     double estBytesPerStone = estRecordsPerStone * avgRecordSize;
 
     _calculateStonesBySampling(opCtx, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
@@ -351,7 +436,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
     while (auto record = cursor->next()) {
         _currentRecords.addAndFetch(1);
         int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
-        if (newCurrentBytes >= _minBytesPerStone) {
+        if (newCurrentBytes >= _minBytesPerStone.load()) {
             LOG(1) << "Placing a marker at optime "
                    << Timestamp(record->id.repr()).toStringPretty();
 
@@ -462,8 +547,17 @@ void WiredTigerRecordStore::OplogStones::adjust(int64_t maxSize) {
 
     unsigned long long numStones = maxSize / BSONObjMaxInternalSize;
     size_t numStonesToKeep = std::min(kMaxStonesToKeep, std::max(kMinStonesToKeep, numStones));
-    _minBytesPerStone = maxSize / numStonesToKeep;
-    invariant(_minBytesPerStone > 0);
+    _baseMinBytesPerStone = maxSize / numStonesToKeep;
+    invariant(_baseMinBytesPerStone > 0);
+    if (_adaptiveStoneSize) {
+        // Keep any reduction from adaptive sizing, within the bounds implied by the new size.
+        const int64_t smallest = std::max<int64_t>(1, _baseMinBytesPerStone / kMaxStoneSplitFactor);
+        const int64_t current = _minBytesPerStone.load();
+        _minBytesPerStone.store(std::min(_baseMinBytesPerStone, std::max(smallest, current)));
+    } else {
+        _minBytesPerStone.store(_baseMinBytesPerStone);
+    }
+    oplogTruncationStats.minBytesPerStone.store(_minBytesPerStone.load());
     _pokeReclaimThreadIfNeeded();
 }
 
@@ -910,6 +1004,21 @@ int64_t WiredTigerRecordStore::_cappedDeleteAsNeeded(OperationContext* opCtx,
     if (!cappedAndNeedDelete())
         return 0;
 
+    // A collection capped only by size may exceed its size by up to the slack before inserts
+    // delete documents themselves. Until then, hand the deletions to the background job, so that
+    // inserts neither contend on the deleter mutex nor pay for the deletions. Only the insert that
+    // sets the flag makes the request.
+    if (_cappedMaxDocs == -1 && wiredTigerCappedDeletionInBackground.load() &&
+        (_sizeInfo->dataSize.load() - _cappedMaxSize) < _cappedMaxSizeSlack) {
+        if (_cappedDeletionRequested->load() || _cappedDeletionRequested->swap(true)) {
+            return 0;
+        }
+        if (_kvEngine && _kvEngine->requestCappedDeletion(ns(), _cappedDeletionRequested)) {
+            return 0;
+        }
+        _cappedDeletionRequested->store(false);
+    }
+
     // ensure only one thread at a time can do deletes, otherwise they'll conflict.
     stdx::unique_lock<stdx::timed_mutex> lock(_cappedDeleterMutex, stdx::defer_lock);
 
@@ -1126,6 +1235,29 @@ int64_t WiredTigerRecordStore::_cappedDeleteAsNeeded_inlock(OperationContext* op
     return docsRemoved;
 }
 
+int64_t WiredTigerRecordStore::reclaimCappedSpace(OperationContext* opCtx) {
+    invariant(_isCapped);
+    invariant(!_oplogStones);
+    dassert(opCtx->lockState()->isCollectionLockedForMode(ns(), MODE_IX));
+
+    // Clear the request before deleting, so that inserts which race with this pass can make
+    // another one.
+    _cappedDeletionRequested->store(false);
+
+    int64_t docsRemoved = 0;
+    while (cappedAndNeedDelete()) {
+        // Release the mutex between batches, so that inserts which exceed the slack can make
+        // progress on their own.
+        stdx::unique_lock<stdx::timed_mutex> lock(_cappedDeleterMutex);
+        const int64_t removed = _cappedDeleteAsNeeded_inlock(opCtx, RecordId::max());
+        if (removed == 0) {
+            break;
+        }
+        docsRemoved += removed;
+    }
+    return docsRemoved;
+}
+
 bool WiredTigerRecordStore::yieldAndAwaitOplogDeletionRequest(OperationContext* opCtx) {
     // Create another reference to the oplog stones while holding a lock on the collection to
     // prevent it from being destructed.
@@ -1160,6 +1292,8 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
 
 void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayTruncateUpTo) {
     Timer timer;
+    const Milliseconds maxTime(oplogTruncationMaxTimePerPassMillis.load());
+    oplogTruncationStats.passes.addAndFetch(1);
     while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
         invariant(stone->lastRecord.isValid());
 
@@ -1168,6 +1302,14 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
             return;
         }
 
+        if (maxTime > Milliseconds(0) && Milliseconds(timer.millis()) >= maxTime) {
+            // Let the caller release its locks before truncating the remaining stones.
+            LOG(1) << "Oplog truncation pass reached its time limit of " << maxTime
+                   << " with excess stones remaining";
+            oplogTruncationStats.passesReachingTimeLimit.addAndFetch(1);
+            break;
+        }
+
         LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
                << stone->lastRecord << " to remove approximately " << stone->records
                << " records totaling to " << stone->bytes << " bytes";
@@ -1176,6 +1318,7 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
         WT_SESSION* session = ru->getSession()->getSession();
 
         try {
+            Timer truncateTimer;
             WriteUnitOfWork wuow(opCtx);
 
             WiredTigerCursor cwrap(_uri, _tableId, true, opCtx);
@@ -1202,6 +1345,11 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
 
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
             _oplogStones->firstRecord = stone->lastRecord;
+
+            oplogTruncationStats.truncateCount.addAndFetch(1);
+            oplogTruncationStats.totalTimeTruncatingMicros.addAndFetch(truncateTimer.micros());
+            oplogTruncationStats.recordsTruncated.addAndFetch(stone->records);
+            oplogTruncationStats.bytesTruncated.addAndFetch(stone->bytes);
         } catch (const WriteConflictException&) {
             LOG(1) << "Caught WriteConflictException while truncating oplog entries, retrying";
         }
@@ -1213,6 +1361,19 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
     log() << "WiredTiger record store oplog truncation finished in: " << timer.millis() << "ms";
 }
 
+// static
+void WiredTigerRecordStore::appendOplogTruncationStats(BSONObjBuilder* builder) {
+    builder->append("passes", oplogTruncationStats.passes.load());
+    builder->append("passesReachingTimeLimit", oplogTruncationStats.passesReachingTimeLimit.load());
+    builder->append("truncateCount", oplogTruncationStats.truncateCount.load());
+    builder->append("totalTimeTruncatingMicros",
+                    oplogTruncationStats.totalTimeTruncatingMicros.load());
+    builder->append("recordsTruncated", oplogTruncationStats.recordsTruncated.load());
+    builder->append("bytesTruncated", oplogTruncationStats.bytesTruncated.load());
+    builder->append("stoneSizeAdjustments", oplogTruncationStats.stoneSizeAdjustments.load());
+    builder->append("minBytesPerStone", oplogTruncationStats.minBytesPerStone.load());
+}
+
 Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
                                             std::vector<Record>* records,
                                             const std::vector<Timestamp>& timestamps) {
@@ -259,6 +259,20 @@ public:
     // Returns false if the oplog was dropped while waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* opCtx);
 
+    /**
+     * Deletes the oldest documents of this capped collection, in batches, until it no longer
+     * exceeds its maximum size. Called by the background job that services the requests made by
+     * inserts through WiredTigerKVEngine::requestCappedDeletion(). The caller must hold the
+     * collection lock in at least MODE_IX. Returns the number of documents deleted.
+     */
+    int64_t reclaimCappedSpace(OperationContext* opCtx);
+
+    /**
+     * Appends process-wide statistics about oplog truncation, as reported in the
+     * "oplogTruncation" serverStatus section.
+     */
+    static void appendOplogTruncationStats(BSONObjBuilder* builder);
+
     bool haveCappedWaiters();
 
     void notifyCappedWaitersIfNeeded();
@@ -347,6 +361,10 @@ private:
     const int64_t _cappedMaxSizeSlack;  // when to start applying backpressure
     const int64_t _cappedMaxDocs;
     RecordId _cappedFirstRecord;
+    // True while a background deletion requested by an insert has not started yet. Shared with the
+    // request, so that the background job can reset it even if this record store went away.
+    const std::shared_ptr<AtomicWord<bool>> _cappedDeletionRequested =
+        std::make_shared<AtomicWord<bool>>(false);
     AtomicInt64 _cappedSleep;
     AtomicInt64 _cappedSleepMS;
     CappedCallback* _cappedCallback;
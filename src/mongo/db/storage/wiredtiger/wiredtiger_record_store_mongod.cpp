@@ -32,14 +32,17 @@
 
 #include "mongo/platform/basic.h"
 
+#include <map>
 #include <set>
 
 #include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog_raii.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
@@ -47,8 +50,10 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 
@@ -166,8 +171,138 @@ bool initRsOplogBackgroundThread(StringData ns) {
     return true;
 }
 
+/**
+ * Deletes the excess documents of capped collections on behalf of inserts, which request it
+ * through WiredTigerKVEngine::requestCappedDeletion() once a collection exceeds its maximum size.
+ * Requests for the same collection are coalesced, so that each pass deletes everything that
+ * accumulated since the last one. Owned by the engine, which stops it at shutdown.
+ */
+class CappedReclaimerThread : public BackgroundJob, public WiredTigerKVEngine::CappedReclaimer {
+public:
+    CappedReclaimerThread() : BackgroundJob(false /* deleteSelf */) {}
+
+    std::string name() const override {
+        return "WTCappedReclaimer";
+    }
+
+    void request(StringData ns, std::shared_ptr<AtomicWord<bool>> requested) override {
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            auto& pending = _pending[NamespaceString(ns)];
+            // A collection recreated under the same name has a new flag. The old one no longer
+            // has a request in flight.
+            if (pending && pending != requested) {
+                pending->store(false);
+            }
+            pending = std::move(requested);
+        }
+        _cv.notify_one();
+    }
+
+    void shutdown() override {
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            _shuttingDown = true;
+            for (auto&& pending : _pending) {
+                pending.second->store(false);
+            }
+            _pending.clear();
+        }
+        _cv.notify_one();
+        wait();
+    }
+
+    void run() override {
+        ThreadClient tc(name(), getGlobalServiceContext());
+
+        while (true) {
+            NamespaceString nss;
+            std::shared_ptr<AtomicWord<bool>> requested;
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _cv.wait(lock, [&] { return _shuttingDown || !_pending.empty(); });
+                if (_shuttingDown) {
+                    return;
+                }
+                nss = _pending.begin()->first;
+                requested = std::move(_pending.begin()->second);
+                _pending.erase(_pending.begin());
+            }
+
+            _reclaim(nss);
+            // Reset the request whether or not the pass found the collection or completed, so
+            // that the next insert which exceeds the maximum size can make another one.
+            requested->store(false);
+        }
+    }
+
+private:
+    void _reclaim(const NamespaceString& nss) {
+        const ServiceContext::UniqueOperationContext opCtx = cc().makeOperationContext();
+
+        try {
+            AutoGetCollection autoColl(opCtx.get(), nss, MODE_IX);
+            Collection* collection = autoColl.getCollection();
+            if (!collection) {
+                LOG(2) << "no collection " << nss << " to delete capped documents from";
+                return;
+            }
+
+            auto rs = dynamic_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+            if (!rs || !rs->isCapped()) {
+                return;
+            }
+
+            const int64_t docsRemoved = rs->reclaimCappedSpace(opCtx.get());
+            LOG(2) << "deleted " << docsRemoved << " documents from capped collection " << nss;
+        } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+            return;
+        } catch (const DBException& ex) {
+            warning() << "error deleting documents from capped collection " << nss << ": "
+                      << redact(ex.toStatus());
+        }
+    }
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    bool _shuttingDown = false;
+    std::map<NamespaceString, std::shared_ptr<AtomicWord<bool>>> _pending;
+};
+
+std::unique_ptr<WiredTigerKVEngine::CappedReclaimer> makeCappedReclaimer() {
+    auto reclaimer = stdx::make_unique<CappedReclaimerThread>();
+    reclaimer->go();
+    return std::move(reclaimer);
+}
+
+class OplogTruncationServerStatusSection : public ServerStatusSection {
+public:
+    OplogTruncationServerStatusSection() : ServerStatusSection("oplogTruncation") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        {
+            // Omit the section unless this node truncates an oplog.
+            stdx::lock_guard<stdx::mutex> lock(_backgroundThreadMutex);
+            if (_backgroundThreadNamespaces.empty()) {
+                return BSONObj();
+            }
+        }
+
+        BSONObjBuilder builder;
+        WiredTigerRecordStore::appendOplogTruncationStats(&builder);
+        return builder.obj();
+    }
+} oplogTruncationServerStatusSection;
+
 MONGO_INITIALIZER(SetInitRsOplogBackgroundThreadCallback)(InitializerContext* context) {
     WiredTigerKVEngine::setInitRsOplogBackgroundThreadCallback(initRsOplogBackgroundThread);
+    WiredTigerKVEngine::setCappedReclaimerFactory(makeCappedReclaimer);
     return Status::OK();
 }
 
@@ -36,6 +36,8 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -91,6 +93,21 @@ public:
     // Resize oplog size
     void adjust(int64_t maxSize);
 
+    /**
+     * Returns the minimum size of the next stone, given the current minimum size 'current', the
+     * size derived from the oplog's maximum size 'base', the time 'fillTime' it took to fill the
+     * last stone and the desired time 'targetFillTime' to fill a stone. Stones shrink, down to
+     * 1/kMaxStoneSplitFactor of 'base', while they fill faster than the target, so that each
+     * truncation removes a bounded amount of data under heavy write load, and grow back to 'base'
+     * once writes slow down.
+     */
+    static int64_t adaptMinBytesPerStone(int64_t current,
+                                         int64_t base,
+                                         Milliseconds fillTime,
+                                         Milliseconds targetFillTime);
+
+    static const int64_t kMaxStoneSplitFactor = 16;
+
     // The start point of where to truncate next. Used by the background reclaim thread to
     // efficiently truncate records with WiredTiger by skipping over tombstones, etc.
     RecordId firstRecord;
@@ -112,6 +129,11 @@ public:
         return _currentRecords.load();
     }
 
+    int64_t minBytesPerStone() const {
+        return _minBytesPerStone.load();
+    }
+
+    // Fixes the minimum number of bytes per stone, disabling adaptive stone sizing.
     void setMinBytesPerStone(int64_t size);
 
 private:
@@ -126,6 +148,9 @@ private:
 
     void _pokeReclaimThreadIfNeeded();
 
+    // Resizes the stone being filled based on how long the stone just created took to fill.
+    void _adaptStoneSize_inlock();
+
     static const uint64_t kRandomSamplesPerStone = 10;
 
     WiredTigerRecordStore* _rs;
@@ -138,8 +163,18 @@ private:
     bool _isDead = false;
 
     // Minimum number of bytes the stone being filled should contain before it gets added to the
-    // deque of oplog stones.
-    int64_t _minBytesPerStone;
+    // deque of oplog stones. Read without holding '_mutex' by committing inserts.
+    AtomicInt64 _minBytesPerStone;
+
+    // Minimum number of bytes per stone derived from the oplog's maximum size, which adaptive
+    // sizing never exceeds.
+    int64_t _baseMinBytesPerStone;
+
+    // False if the stone size was fixed by setMinBytesPerStone().
+    bool _adaptiveStoneSize = true;
+
+    // Measures the time taken to fill the stone currently being filled.
+    Timer _stoneFillTimer;
 
     AtomicInt64 _currentRecords;  // Number of records in the stone being filled.
     AtomicInt64 _currentBytes;    // Number of bytes in the stone being filled.
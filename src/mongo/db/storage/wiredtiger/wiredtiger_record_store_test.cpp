@@ -868,5 +868,80 @@ TEST(WiredTigerRecordStoreTest, OplogStones_AscendingOrder) {
     }
 }
 
+// Verify that stones shrink while they fill faster than the target and grow back otherwise, within
+// the bounds implied by the oplog's maximum size.
+TEST(WiredTigerRecordStoreTest, OplogStones_AdaptMinBytesPerStone) {
+    using OplogStones = WiredTigerRecordStore::OplogStones;
+
+    const int64_t base = 1600;
+    const int64_t smallest = base / OplogStones::kMaxStoneSplitFactor;
+    const Milliseconds target(1000);
+
+    // Stones filling in less than half the target time are halved, down to the smallest size.
+    ASSERT_EQ(800, OplogStones::adaptMinBytesPerStone(base, base, Milliseconds(100), target));
+    ASSERT_EQ(smallest,
+              OplogStones::adaptMinBytesPerStone(smallest, base, Milliseconds(0), target));
+
+    // Stones filling in more than twice the target time are doubled, up to the base size.
+    ASSERT_EQ(400, OplogStones::adaptMinBytesPerStone(200, base, Milliseconds(3000), target));
+    ASSERT_EQ(base, OplogStones::adaptMinBytesPerStone(base, base, Milliseconds(3000), target));
+
+    // Stones filling in about the target time keep their size.
+    ASSERT_EQ(200, OplogStones::adaptMinBytesPerStone(200, base, Milliseconds(600), target));
+    ASSERT_EQ(200, OplogStones::adaptMinBytesPerStone(200, base, Milliseconds(2000), target));
+
+    // The size is clamped when the base size changed.
+    ASSERT_EQ(base, OplogStones::adaptMinBytesPerStone(2 * base, base, target, target));
+    ASSERT_EQ(smallest, OplogStones::adaptMinBytesPerStone(1, base, target, target));
+}
+
+// Verify that reclaiming oplog stones is reflected in the oplog truncation statistics.
+TEST(WiredTigerRecordStoreTest, OplogStones_TruncationStats) {
+    std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper->newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(wtrs->updateCappedSize(opCtx.get(), 230U));
+    }
+
+    oplogStones->setMinBytesPerStone(100);
+
+    auto getStats = [] {
+        BSONObjBuilder builder;
+        WiredTigerRecordStore::appendOplogTruncationStats(&builder);
+        return builder.obj();
+    };
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 110), RecordId(1, 2));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 120), RecordId(1, 3));
+        ASSERT_EQ(3U, oplogStones->numStones());
+    }
+
+    const BSONObj before = getStats();
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        wtrs->reclaimOplog(opCtx.get(), Timestamp(1, 3));
+        ASSERT_EQ(2U, oplogStones->numStones());
+    }
+
+    const BSONObj after = getStats();
+    ASSERT_EQ(before["passes"].numberLong() + 1, after["passes"].numberLong());
+    ASSERT_EQ(before["truncateCount"].numberLong() + 1, after["truncateCount"].numberLong());
+    ASSERT_EQ(before["recordsTruncated"].numberLong() + 1, after["recordsTruncated"].numberLong());
+    ASSERT_EQ(before["bytesTruncated"].numberLong() + 100, after["bytesTruncated"].numberLong());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -46,7 +46,9 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/cpu_hint.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -225,11 +227,24 @@ uint64_t WiredTigerSession::genTableId() {
 
 // -----------------------
 
+namespace {
+// Upper bound on the number of idle session partitions, regardless of the number of cores.
+const size_t kMaxIdleSessionPartitions = 64;
+
+size_t numIdleSessionPartitions() {
+    const size_t numCores = ProcessInfo::getNumAvailableCores();
+    return std::max<size_t>(1, std::min(numCores, kMaxIdleSessionPartitions));
+}
+}  // namespace
+
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _shuttingDown(0) {}
+    : _engine(engine),
+      _conn(engine->getConnection()),
+      _shuttingDown(0),
+      _idleSessions(numIdleSessionPartitions()) {}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _shuttingDown(0) {}
+    : _engine(NULL), _conn(conn), _shuttingDown(0), _idleSessions(numIdleSessionPartitions()) {}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -349,9 +364,11 @@ void WiredTigerSessionCache::notifyPreparedUnitOfWorkHasCommittedOrAborted() {
 
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto&& partition : _idleSessions) {
+        stdx::lock_guard<stdx::mutex> lock(partition.mutex);
+        for (auto&& session : partition.sessions) {
+            session->closeAllCursors(uri);
+        }
     }
 }
 
@@ -359,25 +376,66 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto&& partition : _idleSessions) {
+        stdx::lock_guard<stdx::mutex> lock(partition.mutex);
+        for (auto&& session : partition.sessions) {
+            session->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
+    // Increment the epoch as we are now closing all sessions with this epoch. This must happen
+    // before the partitions are emptied, as releaseSession only caches a session after checking
+    // its epoch while holding the lock of the partition it is added to.
+    _epoch.fetchAndAdd(1);
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+    std::vector<WiredTigerSession*> swap;
+    for (auto&& partition : _idleSessions) {
+        {
+            stdx::lock_guard<stdx::mutex> lock(partition.mutex);
+            partition.sessions.swap(swap);
+            partition.count.store(0);
+        }
+
+        for (auto&& session : swap) {
+            delete session;
+        }
+        swap.clear();
     }
+}
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+WiredTigerSessionCache::AlignedIdleSessions& WiredTigerSessionCache::_homePartition() {
+    // Sessions released on a core are reused from the same core, while they are likely still in
+    // its caches.
+    return _idleSessions[currentCPUHint() % _idleSessions.size()];
+}
+
+WiredTigerSession* WiredTigerSessionCache::_popIdleSession(AlignedIdleSessions& partition,
+                                                           bool tryOnly) {
+    if (partition.count.load() == 0) {
+        return nullptr;
+    }
+
+    stdx::unique_lock<stdx::mutex> lock(partition.mutex, stdx::defer_lock);
+    if (tryOnly) {
+        if (!lock.try_lock()) {
+            return nullptr;
+        }
+    } else {
+        lock.lock();
     }
+
+    if (partition.sessions.empty()) {
+        return nullptr;
+    }
+
+    // Get the most recently used session so that if we discard sessions, we're discarding older
+    // ones.
+    WiredTigerSession* session = partition.sessions.back();
+    partition.sessions.pop_back();
+    partition.count.store(partition.sessions.size());
+    return session;
 }
 
 bool WiredTigerSessionCache::isEphemeral() {
@@ -389,18 +447,23 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+    // Prefer the home partition, where the sessions last used on this core are.
+    AlignedIdleSessions& home = _homePartition();
+    if (WiredTigerSession* cachedSession = _popIdleSession(home, false)) {
+        return UniqueWiredTigerSession(cachedSession);
+    }
+
+    // Before opening a new session, take an idle one from any other partition that is not
+    // currently in use, starting with the neighbouring partitions.
+    const size_t homeIndex = &home - _idleSessions.data();
+    for (size_t i = 1; i < _idleSessions.size(); ++i) {
+        auto& partition = _idleSessions[(homeIndex + i) % _idleSessions.size()];
+        if (WiredTigerSession* cachedSession = _popIdleSession(partition, true)) {
             return UniqueWiredTigerSession(cachedSession);
         }
     }
 
-    // Outside of the cache partition lock, but on release will be put back on the cache
+    // Outside of the cache partition locks, but on release will be put back on the cache
     return UniqueWiredTigerSession(
         new WiredTigerSession(_conn, this, _epoch.load(), _cursorEpoch.load()));
 }
@@ -454,10 +517,12 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     session->dropQueuedIdentsAtSessionEndAllowed(true);
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        AlignedIdleSessions& home = _homePartition();
+        stdx::lock_guard<stdx::mutex> lock(home.mutex);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            home.sessions.push_back(session);
+            home.count.store(home.sessions.size());
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
@@ -34,6 +34,9 @@
 
 #include <list>
 #include <string>
+#include <vector>
+
+#include <boost/align/aligned_allocator.hpp>
 
 #include <wiredtiger.h>
 
@@ -42,6 +45,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
@@ -185,6 +189,11 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Idle sessions are kept in a number of independently locked partitions, so that threads
+ *  returning and acquiring sessions on different cores do not contend on a single mutex. Each
+ *  core has a home partition which threads running on it release sessions into and acquire them
+ *  from first, so a session and its cached cursors tend to stay on the core that used them last.
  */
 class WiredTigerSessionCache {
 public:
@@ -286,6 +295,29 @@ public:
     }
 
 private:
+    /**
+     * A partition of the idle sessions. The count mirrors 'sessions.size()' so that empty
+     * partitions can be skipped without taking their lock.
+     */
+    struct IdleSessions {
+        stdx::mutex mutex;
+        std::vector<WiredTigerSession*> sessions;
+        AtomicWord<size_t> count{0};
+    };
+    using AlignedIdleSessions = CacheAligned<IdleSessions>;
+
+    /**
+     * Returns the partition of the core the current thread runs on, which it releases sessions into
+     * and acquires them from first.
+     */
+    AlignedIdleSessions& _homePartition();
+
+    /**
+     * Pops the most recently released session from 'partition' or returns nullptr if there is
+     * none. If 'tryOnly' is true, returns nullptr rather than waiting for a contended partition.
+     */
+    static WiredTigerSession* _popIdleSession(AlignedIdleSessions& partition, bool tryOnly);
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -296,15 +328,16 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
-    typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+    // Partitions of idle sessions, sized by the number of cores. Sessions are only ever added to
+    // a partition while holding its mutex and after checking that their epoch is current.
+    std::vector<AlignedIdleSessions, boost::alignment::aligned_allocator<AlignedIdleSessions>>
+        _idleSessions;
 
     // Bumped when all open sessions need to be closed
-    AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
+    AtomicUInt64 _epoch;  // atomic so we can check it outside of the partition locks
 
     // Bumped when all open cursors need to be closed
-    AtomicUInt64 _cursorEpoch;  // atomic so we can check it outside of the lock
+    AtomicUInt64 _cursorEpoch;  // atomic so we can check it outside of the partition locks
 
     // Counter and critical section mutex for waitUntilDurable
     AtomicUInt32 _lastSyncTime;
@@ -0,0 +1,118 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const int kMaxPerfThreads = 64;  // max number of threads to use for session cache perf
+
+const std::string kTableUri = "table:session_cache_bm";
+
+/**
+ * Owns a WiredTiger connection in a temporary directory and a session cache on top of it. Shared
+ * by all benchmarks and threads, as opening a connection is far more expensive than any of the
+ * operations measured.
+ */
+class SessionCacheHarness {
+public:
+    SessionCacheHarness() : _dbpath("wt_session_cache_bm"), _conn(_openConnection()) {
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        invariantWTOK(s->create(s, kTableUri.c_str(), "key_format=q,value_format=u"));
+    }
+
+    ~SessionCacheHarness() {
+        _sessionCache.reset();
+        invariantWTOK(_conn->close(_conn, NULL));
+    }
+
+    WiredTigerSessionCache* sessionCache() {
+        return _sessionCache.get();
+    }
+
+    uint64_t tableId() const {
+        return _tableId;
+    }
+
+private:
+    WT_CONNECTION* _openConnection() {
+        WT_CONNECTION* conn = nullptr;
+        invariantWTOK(wiredtiger_open(_dbpath.path().c_str(), NULL, "create", &conn));
+        return conn;
+    }
+
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+    const uint64_t _tableId = WiredTigerSession::genTableId();
+};
+
+SessionCacheHarness& harness() {
+    static SessionCacheHarness harness;
+    return harness;
+}
+
+void BM_GetAndReleaseSession(benchmark::State& state) {
+    WiredTigerSessionCache* sessionCache = harness().sessionCache();
+
+    for (auto keepRunning : state) {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        benchmark::DoNotOptimize(session.get());
+    }
+}
+
+void BM_GetAndReleaseSessionWithCursor(benchmark::State& state) {
+    WiredTigerSessionCache* sessionCache = harness().sessionCache();
+    const uint64_t tableId = harness().tableId();
+
+    for (auto keepRunning : state) {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        WT_CURSOR* cursor = session->getCursor(kTableUri, tableId, true);
+        session->releaseCursor(tableId, cursor);
+    }
+}
+
+BENCHMARK(BM_GetAndReleaseSession)->ThreadRange(1, kMaxPerfThreads);
+BENCHMARK(BM_GetAndReleaseSessionWithCursor)->ThreadRange(1, kMaxPerfThreads);
+
+}  // namespace
+}  // namespace mongo
@@ -50,13 +50,16 @@ void WiredTigerSnapshotManager::setCommittedSnapshot(const Timestamp& timestamp)
 }
 
 void WiredTigerSnapshotManager::setLocalSnapshot(const Timestamp& timestamp) {
-    stdx::lock_guard<stdx::mutex> lock(_localSnapshotMutex);
-    _localSnapshot = timestamp;
+    invariant(!timestamp.isNull());
+    _localSnapshot.store(timestamp.asULL());
 }
 
 boost::optional<Timestamp> WiredTigerSnapshotManager::getLocalSnapshot() {
-    stdx::lock_guard<stdx::mutex> lock(_localSnapshotMutex);
-    return _localSnapshot;
+    const auto localSnapshot = _localSnapshot.load();
+    if (!localSnapshot) {
+        return boost::none;
+    }
+    return Timestamp(localSnapshot);
 }
 
 void WiredTigerSnapshotManager::dropAllSnapshots() {
@@ -91,16 +94,25 @@ Timestamp WiredTigerSnapshotManager::beginTransactionOnCommittedSnapshot(
 
 Timestamp WiredTigerSnapshotManager::beginTransactionOnLocalSnapshot(
     WT_SESSION* session, WiredTigerBeginTxnBlock::IgnorePrepared ignorePrepared) const {
-    WiredTigerBeginTxnBlock txnOpen(session, ignorePrepared);
-
-    stdx::lock_guard<stdx::mutex> lock(_localSnapshotMutex);
-    invariant(_localSnapshot);
-    LOG(3) << "begin_transaction on local snapshot " << _localSnapshot.get().toString();
-    auto status = txnOpen.setTimestamp(_localSnapshot.get());
-    fassert(50775, status);
-
-    txnOpen.done();
-    return *_localSnapshot;
+    auto localSnapshot = Timestamp(_localSnapshot.load());
+    invariant(!localSnapshot.isNull());
+    while (true) {
+        WiredTigerBeginTxnBlock txnOpen(session, ignorePrepared);
+        LOG(3) << "begin_transaction on local snapshot " << localSnapshot.toString();
+        auto status = txnOpen.setTimestamp(localSnapshot);
+
+        // The oldest timestamp is only advanced after the local snapshot, so a read timestamp
+        // that fell behind it means a newer local snapshot is available to retry with.
+        const auto latestSnapshot = Timestamp(_localSnapshot.load());
+        if (status == ErrorCodes::BadValue && latestSnapshot != localSnapshot) {
+            localSnapshot = latestSnapshot;
+            continue;
+        }
+        fassert(50775, status);
+
+        txnOpen.done();
+        return localSnapshot;
+    }
 }
 
 }  // namespace mongo
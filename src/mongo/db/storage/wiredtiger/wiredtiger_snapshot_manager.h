@@ -37,6 +37,7 @@
 #include "mongo/bson/timestamp.h"
 #include "mongo/db/storage/snapshot_manager.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_begin_transaction_block.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
 
 namespace mongo {
@@ -69,6 +70,10 @@ public:
     /**
      * Starts a transaction on the last stable local timestamp, set by setLocalSnapshot.
      *
+     * Does not block concurrent calls to setLocalSnapshot. If the local snapshot advances and the
+     * oldest timestamp moves past the one that was read before the transaction could be
+     * timestamped, retries with the newer local snapshot.
+     *
      * Throws if no local snapshot has been set.
      */
     Timestamp beginTransactionOnLocalSnapshot(
@@ -89,8 +94,8 @@ private:
     mutable stdx::mutex _committedSnapshotMutex;  // Guards _committedSnapshot.
     boost::optional<Timestamp> _committedSnapshot;
 
-    // Snapshot to use for reads at a local stable timestamp.
-    mutable stdx::mutex _localSnapshotMutex;  // Guards _localSnapshot.
-    boost::optional<Timestamp> _localSnapshot;
+    // Snapshot to use for reads at a local stable timestamp, or 0 if none has been set. Every read
+    // on a secondary starts a transaction here, so this is read without taking a mutex.
+    AtomicUInt64 _localSnapshot{0};
 };
 }
@@ -36,6 +36,10 @@
 
 #include "mongo/db/ttl.h"
 
+#include <algorithm>
+#include <map>
+#include <set>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
@@ -46,6 +50,7 @@
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync_locked.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
@@ -57,19 +62,25 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/ttl_collection_cache.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
 Counter64 ttlPasses;
 Counter64 ttlDeletedDocuments;
+Counter64 ttlThrottledBatches;
 
 ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
 ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments",
                                                               &ttlDeletedDocuments);
+ServerStatusMetricField<Counter64> ttlThrottledBatchesDisplay("ttl.throttledBatches",
+                                                              &ttlThrottledBatches);
 
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorEnabled, bool, true);
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60)
@@ -79,6 +90,143 @@ MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60)
         return Status::OK();
     });  // used for testing
 
+// Number of collections the TTL monitor processes concurrently.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ttlMonitorWorkerThreads, int, 4)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 1 || newVal > 64)
+            return Status(ErrorCodes::BadValue, "ttlMonitorWorkerThreads must be between 1 and 64");
+        return Status::OK();
+    });
+
+// Maximum number of documents deleted from a TTL index before the collection lock is released and
+// the deletion rate is re-evaluated.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorBatchSize, int, 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal <= 0)
+            return Status(ErrorCodes::BadValue, "ttlMonitorBatchSize must be strictly positive");
+        return Status::OK();
+    });
+
+// Deletions are throttled while the majority commit point lags the last applied optime by more
+// than this many seconds. A value of 0 disables throttling on replication lag.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxReplicationLagSecs, int, 10)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0)
+            return Status(ErrorCodes::BadValue,
+                          "ttlMonitorMaxReplicationLagSecs must be greater than or equal to 0");
+        return Status::OK();
+    });
+
+// Longest a single collection waits for lag or cache pressure to subside before the remainder of
+// its expired documents is left for the next pass.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxThrottleMillis, int, 10 * 1000)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0)
+            return Status(ErrorCodes::BadValue,
+                          "ttlMonitorMaxThrottleMillis must be greater than or equal to 0");
+        return Status::OK();
+    });
+
+// Longest deletions stay deferred by lag or cache pressure, across passes and collections, before
+// the TTL monitor deletes regardless. This keeps a node whose majority commit point cannot advance,
+// such as a PSA replica set with its secondary down, from accumulating expired documents forever.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxDeferralSecs, int, 10 * 60)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0)
+            return Status(ErrorCodes::BadValue,
+                          "ttlMonitorMaxDeferralSecs must be greater than or equal to 0");
+        return Status::OK();
+    });
+
+namespace {
+
+/**
+ * Cumulative TTL statistics for a single collection.
+ */
+struct TTLCollectionStats {
+    long long passes = 0;
+    long long deletedDocuments = 0;
+    long long throttledBatches = 0;
+    long long lastPassDeletedDocuments = 0;
+    long long lastPassMillis = 0;
+
+    // True if the last pass stopped before removing every expired document.
+    bool backlog = false;
+};
+
+stdx::mutex ttlCollectionStatsMutex;
+std::map<std::string, TTLCollectionStats> ttlCollectionStats;
+
+bool hasTTLBacklog(const std::string& ns) {
+    stdx::lock_guard<stdx::mutex> lk(ttlCollectionStatsMutex);
+    auto it = ttlCollectionStats.find(ns);
+    return it != ttlCollectionStats.end() && it->second.backlog;
+}
+
+/**
+ * Drops the statistics of collections which no longer have a TTL index.
+ */
+void pruneTTLCollectionStats(const std::set<std::string>& ttlCollections) {
+    stdx::lock_guard<stdx::mutex> lk(ttlCollectionStatsMutex);
+    for (auto it = ttlCollectionStats.begin(); it != ttlCollectionStats.end();) {
+        if (ttlCollections.count(it->first)) {
+            ++it;
+        } else {
+            it = ttlCollectionStats.erase(it);
+        }
+    }
+}
+
+class TTLServerStatusSection : public ServerStatusSection {
+public:
+    TTLServerStatusSection() : ServerStatusSection("ttl") {}
+
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder builder;
+        builder.append("passes", ttlPasses.get());
+        builder.append("deletedDocuments", ttlDeletedDocuments.get());
+        builder.append("throttledBatches", ttlThrottledBatches.get());
+
+        long long collectionsWithBacklog = 0;
+        BSONObjBuilder collectionsBuilder(builder.subobjStart("collections"));
+        {
+            stdx::lock_guard<stdx::mutex> lk(ttlCollectionStatsMutex);
+            for (const auto& entry : ttlCollectionStats) {
+                const TTLCollectionStats& stats = entry.second;
+                BSONObjBuilder collBuilder(collectionsBuilder.subobjStart(entry.first));
+                collBuilder.append("passes", stats.passes);
+                collBuilder.append("deletedDocuments", stats.deletedDocuments);
+                collBuilder.append("throttledBatches", stats.throttledBatches);
+                collBuilder.append("lastPassDeletedDocuments", stats.lastPassDeletedDocuments);
+                collBuilder.append("lastPassMillis", stats.lastPassMillis);
+                collBuilder.append("backlog", stats.backlog);
+                if (stats.backlog) {
+                    ++collectionsWithBacklog;
+                }
+            }
+        }
+        collectionsBuilder.doneFast();
+        builder.append("collectionsWithBacklog", collectionsWithBacklog);
+        return builder.obj();
+    }
+} ttlServerStatusSection;
+
+/**
+ * Outcome of deleting expired documents through a single TTL index.
+ */
+struct TTLIndexPassResult {
+    long long deletedDocuments = 0;
+    long long throttledBatches = 0;
+    bool backlog = false;
+};
+
+}  // namespace
+
 class TTLMonitor : public BackgroundJob {
 public:
     TTLMonitor() {}
@@ -94,6 +242,17 @@ public:
         ThreadClient tc(name(), getGlobalServiceContext());
         AuthorizationSession::get(cc())->grantInternalAuthorization();
 
+        ThreadPool::Options options;
+        options.poolName = "TTLMonitorWorkers";
+        options.minThreads = 0;
+        options.maxThreads = static_cast<size_t>(ttlMonitorWorkerThreads);
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        };
+        _workers = stdx::make_unique<ThreadPool>(options);
+        _workers->startup();
+
         while (!globalInShutdownDeprecated()) {
             {
                 MONGO_IDLE_THREAD_BLOCK;
@@ -120,63 +279,126 @@ public:
                 LOG(1) << "got WriteConflictException";
             }
         }
+
+        _workers->shutdown();
+        _workers->join();
     }
 
 private:
     void doTTLPass() {
-        const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
-        OperationContext& opCtx = *opCtxPtr;
-
-        // If part of replSet but not in a readable state (e.g. during initial sync), skip.
-        if (repl::ReplicationCoordinator::get(&opCtx)->getReplicationMode() ==
-                repl::ReplicationCoordinator::modeReplSet &&
-            !repl::ReplicationCoordinator::get(&opCtx)->getMemberState().readable())
-            return;
-
-        TTLCollectionCache& ttlCollectionCache = TTLCollectionCache::get(getGlobalServiceContext());
-        std::vector<std::string> ttlCollections = ttlCollectionCache.getCollections();
-        std::vector<BSONObj> ttlIndexes;
-
-        ttlPasses.increment();
+        // Maps each collection to its TTL indexes. All indexes of a collection are processed by
+        // the same worker so that no two workers contend on one collection.
+        std::map<std::string, std::vector<BSONObj>> ttlIndexesByCollection;
+
+        {
+            const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
+            OperationContext& opCtx = *opCtxPtr;
+
+            // If part of replSet but not in a readable state (e.g. during initial sync), skip.
+            if (repl::ReplicationCoordinator::get(&opCtx)->getReplicationMode() ==
+                    repl::ReplicationCoordinator::modeReplSet &&
+                !repl::ReplicationCoordinator::get(&opCtx)->getMemberState().readable())
+                return;
+
+            TTLCollectionCache& ttlCollectionCache =
+                TTLCollectionCache::get(getGlobalServiceContext());
+            std::vector<std::string> ttlCollections = ttlCollectionCache.getCollections();
+
+            ttlPasses.increment();
+
+            // Get all TTL indexes from every collection.
+            for (const std::string& collectionNS : ttlCollections) {
+                UninterruptibleLockGuard noInterrupt(opCtx.lockState());
+                NamespaceString collectionNSS(collectionNS);
+                AutoGetCollection autoGetCollection(&opCtx, collectionNSS, MODE_IS);
+                Collection* coll = autoGetCollection.getCollection();
+                if (!coll) {
+                    // Skip since collection has been dropped.
+                    continue;
+                }
 
-        // Get all TTL indexes from every collection.
-        for (const std::string& collectionNS : ttlCollections) {
-            UninterruptibleLockGuard noInterrupt(opCtx.lockState());
-            NamespaceString collectionNSS(collectionNS);
-            AutoGetCollection autoGetCollection(&opCtx, collectionNSS, MODE_IS);
-            Collection* coll = autoGetCollection.getCollection();
-            if (!coll) {
-                // Skip since collection has been dropped.
-                continue;
+                CollectionCatalogEntry* collEntry = coll->getCatalogEntry();
+                std::vector<std::string> indexNames;
+                collEntry->getAllIndexes(&opCtx, &indexNames);
+                for (const std::string& name : indexNames) {
+                    BSONObj spec = collEntry->getIndexSpec(&opCtx, name);
+                    if (spec.hasField(secondsExpireField)) {
+                        ttlIndexesByCollection[collectionNS].push_back(spec.getOwned());
+                    }
+                }
             }
+        }
 
-            CollectionCatalogEntry* collEntry = coll->getCatalogEntry();
-            std::vector<std::string> indexNames;
-            collEntry->getAllIndexes(&opCtx, &indexNames);
-            for (const std::string& name : indexNames) {
-                BSONObj spec = collEntry->getIndexSpec(&opCtx, name);
-                if (spec.hasField(secondsExpireField)) {
-                    ttlIndexes.push_back(spec.getOwned());
-                }
+        std::set<std::string> namespaces;
+        std::vector<std::string> schedule;
+        for (const auto& entry : ttlIndexesByCollection) {
+            namespaces.insert(entry.first);
+            schedule.push_back(entry.first);
+        }
+        pruneTTLCollectionStats(namespaces);
+
+        // Collections which were left with expired documents by the previous pass go first, so
+        // that a burst of expirations on one collection cannot starve it indefinitely.
+        std::stable_partition(schedule.begin(), schedule.end(), hasTTLBacklog);
+
+        for (const std::string& ns : schedule) {
+            const std::vector<BSONObj>& indexes = ttlIndexesByCollection[ns];
+            Status status =
+                _workers->schedule([this, ns, indexes] { doTTLForCollection(ns, indexes); });
+            if (!status.isOK()) {
+                // The pool only refuses work once it has been shut down.
+                LOG(1) << "unable to schedule ttl job for " << ns << ": " << status;
+                break;
             }
         }
 
-        for (const BSONObj& idx : ttlIndexes) {
+        _workers->waitForIdle();
+    }
+
+    /**
+     * Processes every TTL index of a collection. Runs on one of the worker threads.
+     */
+    void doTTLForCollection(const std::string& ns, const std::vector<BSONObj>& indexes) {
+        const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
+        opCtxPtr->lockState()->setAdmissionPriority(AdmissionPriority::kHigh);
+        Timer timer;
+
+        TTLIndexPassResult collectionResult;
+        for (const BSONObj& idx : indexes) {
+            TTLIndexPassResult indexResult;
             try {
-                doTTLForIndex(&opCtx, idx);
+                doTTLForIndex(opCtxPtr.get(), idx, &indexResult);
+            } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+                LOG(1) << "ttl job for " << ns << " interrupted";
+                return;
             } catch (const DBException& dbex) {
                 error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
                 // Continue on to the next index.
-                continue;
             }
+            collectionResult.deletedDocuments += indexResult.deletedDocuments;
+            collectionResult.throttledBatches += indexResult.throttledBatches;
+            collectionResult.backlog = collectionResult.backlog || indexResult.backlog;
         }
+
+        stdx::lock_guard<stdx::mutex> lk(ttlCollectionStatsMutex);
+        TTLCollectionStats& stats = ttlCollectionStats[ns];
+        stats.passes++;
+        stats.deletedDocuments += collectionResult.deletedDocuments;
+        stats.throttledBatches += collectionResult.throttledBatches;
+        stats.lastPassDeletedDocuments = collectionResult.deletedDocuments;
+        stats.lastPassMillis = timer.millis();
+        stats.backlog = collectionResult.backlog;
     }
 
     /**
      * Remove documents from the collection using the specified TTL index after a sufficient amount
      * of time has passed according to its expiry specification.
+     *
+     * Documents are deleted in index order, in batches of at most 'ttlMonitorBatchSize'. The
+     * collection lock is released between batches, and the next batch waits while the node is
+     * under replication lag or cache pressure.
      */
-    void doTTLForIndex(OperationContext* opCtx, BSONObj idx) {
+    void doTTLForIndex(OperationContext* opCtx, BSONObj idx, TTLIndexPassResult* result) {
         const NamespaceString collectionNSS(idx["ns"].String());
         if (collectionNSS.isDropPendingNamespace()) {
             return;
@@ -188,7 +410,7 @@ private:
         }
 
         const BSONObj key = idx["key"].Obj();
-        const StringData name = idx["name"].valueStringData();
+        const std::string name = idx["name"].String();
         if (key.nFields() != 1) {
             error() << "key for ttl index can only have 1 field, skipping ttl job for: " << idx;
             return;
@@ -196,31 +418,64 @@ private:
 
         LOG(1) << "ns: " << collectionNSS << " key: " << key << " name: " << name;
 
+        // The expiration time is fixed for the whole pass, so that documents which expire while
+        // the pass is running do not keep it going.
+        const Date_t passStartTime = Date_t::now();
+        while (!globalInShutdownDeprecated()) {
+            if (!waitForDeletionCapacity(opCtx, result)) {
+                LOG(1) << "ttl deletions for " << collectionNSS
+                       << " throttled, deferring remaining documents to the next pass";
+                result->backlog = true;
+                return;
+            }
+
+            const long long batchSize = ttlMonitorBatchSize.load();
+            const long long deleted =
+                deleteExpiredBatch(opCtx, collectionNSS, name, passStartTime, batchSize);
+            result->deletedDocuments += deleted;
+            if (deleted < batchSize) {
+                return;
+            }
+        }
+        result->backlog = true;
+    }
+
+    /**
+     * Deletes up to 'batchSize' documents which expired at 'passStartTime' through the index
+     * 'indexName'. Returns the number of documents deleted; a value below 'batchSize' means that
+     * the index has no more expired documents or can not be used.
+     */
+    long long deleteExpiredBatch(OperationContext* opCtx,
+                                 const NamespaceString& collectionNSS,
+                                 const std::string& indexName,
+                                 Date_t passStartTime,
+                                 long long batchSize) {
         AutoGetCollection autoGetCollection(opCtx, collectionNSS, MODE_IX);
         Collection* collection = autoGetCollection.getCollection();
         if (!collection) {
             // Collection was dropped.
-            return;
+            return 0;
         }
 
         if (!repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx, collectionNSS)) {
-            return;
+            return 0;
         }
 
-        IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, name);
+        IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByName(opCtx, indexName);
         if (!desc) {
             LOG(1) << "index not found (index build in progress? index dropped?), skipping "
-                   << "ttl job for: " << idx;
-            return;
+                   << "ttl job for: " << indexName << " on " << collectionNSS;
+            return 0;
         }
 
-        // Re-read 'idx' from the descriptor, in case the collection or index definition changed
-        // before we re-acquired the collection lock.
-        idx = desc->infoObj();
+        // Re-read the index from the descriptor, in case the collection or index definition
+        // changed before we re-acquired the collection lock.
+        const BSONObj idx = desc->infoObj();
+        const BSONObj key = desc->keyPattern();
 
         if (IndexType::INDEX_BTREE != IndexNames::nameToType(desc->getAccessMethodName())) {
             error() << "special index can't be used as a ttl index, skipping ttl job for: " << idx;
-            return;
+            return 0;
         }
 
         BSONElement secondsExpireElt = idx[secondsExpireField];
@@ -228,12 +483,12 @@ private:
             error() << "ttl indexes require the " << secondsExpireField << " field to be "
                     << "numeric but received a type of " << typeName(secondsExpireElt.type())
                     << ", skipping ttl job for: " << idx;
-            return;
+            return 0;
         }
 
         const Date_t kDawnOfTime =
             Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
-        const Date_t expirationTime = Date_t::now() - Seconds(secondsExpireElt.numberLong());
+        const Date_t expirationTime = passStartTime - Seconds(secondsExpireElt.numberLong());
         const BSONObj startKey = BSON("" << kDawnOfTime);
         const BSONObj endKey = BSON("" << expirationTime);
         // The canonical check as to whether a key pattern element is "ascending" or
@@ -255,6 +510,7 @@ private:
 
         DeleteStageParams params;
         params.isMulti = true;
+        params.limit = batchSize;
         params.canonicalQuery = canonicalQuery.getValue().get();
 
         auto exec =
@@ -272,13 +528,89 @@ private:
         if (!result.isOK()) {
             error() << "ttl query execution for index " << idx
                     << " failed with status: " << redact(result);
-            return;
+            return 0;
         }
 
         const long long numDeleted = DeleteStage::getNumDeleted(*exec);
         ttlDeletedDocuments.increment(numDeleted);
+
         LOG(1) << "deleted: " << numDeleted;
+        return numDeleted;
     }
+
+    /**
+     * Blocks while the majority commit point lags too far behind or the storage engine cache is
+     * under pressure, backing off exponentially. Returns false if the condition persists for
+     * longer than 'ttlMonitorMaxThrottleMillis'. Once deletions have been deferred for longer than
+     * 'ttlMonitorMaxDeferralSecs' in total, returns true without waiting.
+     */
+    bool waitForDeletionCapacity(OperationContext* opCtx, TTLIndexPassResult* result) {
+        if (!shouldThrottleDeletions(opCtx)) {
+            _deferredSinceMillis.store(0);
+            _deferralExceeded.store(false);
+            return true;
+        }
+
+        result->throttledBatches++;
+        ttlThrottledBatches.increment();
+
+        const long long deferredSince = _deferredSinceMillis.load();
+        if (deferredSince != 0 &&
+            Date_t::now() - Date_t::fromMillisSinceEpoch(deferredSince) >=
+                Seconds(ttlMonitorMaxDeferralSecs.load())) {
+            if (!_deferralExceeded.swap(true)) {
+                warning() << "TTL deletions have been throttled for longer than "
+                          << ttlMonitorMaxDeferralSecs.load()
+                          << " seconds, deleting expired documents without throttling";
+            }
+            return true;
+        }
+
+        const Milliseconds maxThrottle(ttlMonitorMaxThrottleMillis.load());
+        const Date_t deadline = Date_t::now() + maxThrottle;
+        Milliseconds backoff(10);
+        do {
+            const Date_t now = Date_t::now();
+            if (now >= deadline) {
+                // Only the first deferral since deletions last went through starts the clock.
+                _deferredSinceMillis.compareAndSwap(0, now.toMillisSinceEpoch());
+                return false;
+            }
+            opCtx->sleepFor(std::min(backoff, deadline - now));
+            backoff = std::min(backoff * 2, Milliseconds(1000));
+        } while (shouldThrottleDeletions(opCtx));
+        _deferredSinceMillis.store(0);
+        _deferralExceeded.store(false);
+        return true;
+    }
+
+    bool shouldThrottleDeletions(OperationContext* opCtx) {
+        if (getGlobalServiceContext()->getStorageEngine()->isCacheUnderPressure(opCtx)) {
+            return true;
+        }
+
+        const int maxLagSecs = ttlMonitorMaxReplicationLagSecs.load();
+        auto replCoord = repl::ReplicationCoordinator::get(opCtx);
+        if (maxLagSecs == 0 ||
+            replCoord->getReplicationMode() != repl::ReplicationCoordinator::modeReplSet) {
+            return false;
+        }
+
+        const Timestamp lastCommitted = replCoord->getLastCommittedOpTime().getTimestamp();
+        if (lastCommitted.isNull()) {
+            return false;
+        }
+        const Timestamp lastApplied = replCoord->getMyLastAppliedOpTime().getTimestamp();
+        return lastApplied.getSecs() > lastCommitted.getSecs() + maxLagSecs;
+    }
+
+    std::unique_ptr<ThreadPool> _workers;
+
+    // When deletions were first deferred since they last went through unthrottled, in milliseconds
+    // since the epoch, or 0. Shared by the workers, so that deferrals add up across collections.
+    AtomicInt64 _deferredSinceMillis{0};
+    // Set once the deferral exceeds 'ttlMonitorMaxDeferralSecs', to log it only once.
+    AtomicWord<bool> _deferralExceeded{false};
 };
 
 namespace {
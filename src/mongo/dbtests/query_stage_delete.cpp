@@ -181,6 +181,46 @@ public:
     }
 };
 
+// Use the delete stage with a limit to delete some of the objects retrieved by a collscan. We
+// expect the delete stage to reach EOF once it has deleted 'limit' objects.
+class QueryStageDeleteStopsAtLimit : public QueryStageDeleteBase {
+public:
+    void run() {
+        dbtests::WriteContextForTests ctx(&_opCtx, nss.ns());
+
+        Collection* coll = ctx.getCollection();
+        ASSERT(coll);
+
+        // Configure the scan.
+        CollectionScanParams collScanParams;
+        collScanParams.direction = CollectionScanParams::FORWARD;
+        collScanParams.tailable = false;
+
+        // Configure the delete stage.
+        DeleteStageParams deleteStageParams;
+        deleteStageParams.isMulti = true;
+        deleteStageParams.limit = 10;
+
+        WorkingSet ws;
+        DeleteStage deleteStage(&_opCtx,
+                                deleteStageParams,
+                                &ws,
+                                coll,
+                                new CollectionScan(&_opCtx, coll, collScanParams, &ws, NULL));
+
+        const DeleteStats* stats = static_cast<const DeleteStats*>(deleteStage.getSpecificStats());
+
+        while (!deleteStage.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = deleteStage.work(&id);
+            ASSERT(PlanStage::NEED_TIME == state || PlanStage::IS_EOF == state);
+        }
+
+        ASSERT_EQUALS(10U, stats->docsDeleted);
+        ASSERT_EQUALS(numObj() - 10, coll->numRecords(&_opCtx));
+    }
+};
+
 /**
  * Test that the delete stage returns an owned copy of the original document if returnDeleted is
  * specified.
@@ -256,6 +296,7 @@ public:
     void setupTests() {
         // Stage-specific tests below.
         add<QueryStageDeleteUpcomingObjectWasDeleted>();
+        add<QueryStageDeleteStopsAtLimit>();
         add<QueryStageDeleteReturnOldDoc>();
     }
 };
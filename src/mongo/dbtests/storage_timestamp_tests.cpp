@@ -910,6 +910,60 @@ public:
     }
 };
 
+class SecondaryGroupedUpdateAndDeleteTimes : public StorageTimestampTest {
+public:
+    void run() {
+        // In order for the applier to assign timestamps, we must be in non-replicated mode.
+        repl::UnreplicatedWritesBlock uwb(_opCtx);
+
+        // Create a new collection.
+        NamespaceString nss("unittests.timestampedGroupedUpdatesAndDeletes");
+        reset(nss);
+
+        AutoGetCollection autoColl(_opCtx, nss, LockMode::MODE_X, LockMode::MODE_IX);
+        const auto uuid = autoColl.getCollection()->uuid().get();
+
+        // An upsert of a missing document, an update of it and its delete, applied as one group.
+        const LogicalTime beforeTime = _clock->reserveTicks(4);
+        auto makeOp = [&](int tick, StringData opType, BSONObj o) {
+            BSONObjBuilder bob;
+            bob.append("ts", beforeTime.addTicks(tick).asTimestamp());
+            bob.append("t", 1LL);
+            bob.append("h", 0xBEEFBEEFLL);
+            bob.append("v", 2);
+            bob.append("op", opType);
+            bob.append("ns", nss.ns());
+            uuid.appendToBuilder(&bob, "ui");
+            if (opType == "u") {
+                bob.append("o2", BSON("_id" << 0));
+            }
+            bob.append("o", o);
+            return repl::OplogEntry(bob.obj());
+        };
+        std::vector<repl::OplogEntry> ops = {
+            makeOp(1, "u", BSON("$set" << BSON("val" << 1))),
+            makeOp(2, "u", BSON("$set" << BSON("val" << 2))),
+            makeOp(3, "d", BSON("_id" << 0))};
+        repl::MultiApplier::OperationPtrs opPtrs;
+        for (auto&& op : ops) {
+            opPtrs.push_back(&op);
+        }
+
+        ASSERT_OK(repl::SyncTail::syncApplyUpdatesAndDeletes(
+            _opCtx, opPtrs.cbegin(), opPtrs.cend(), repl::OplogApplication::Mode::kSecondary));
+
+        // Although the group was applied in a single WriteUnitOfWork, each write is visible at
+        // the timestamp of its own operation.
+        auto coll = autoColl.getCollection();
+        assertDocumentAtTimestamp(coll, beforeTime.asTimestamp(), BSONObj());
+        assertDocumentAtTimestamp(
+            coll, beforeTime.addTicks(1).asTimestamp(), BSON("_id" << 0 << "val" << 1));
+        assertDocumentAtTimestamp(
+            coll, beforeTime.addTicks(2).asTimestamp(), BSON("_id" << 0 << "val" << 2));
+        assertDocumentAtTimestamp(coll, beforeTime.addTicks(3).asTimestamp(), BSONObj());
+    }
+};
+
 class SecondaryAtomicApplyOps : public StorageTimestampTest {
 public:
     void run() {
@@ -2684,6 +2738,7 @@ public:
         add<SecondaryDeleteTimes>();
         add<SecondaryUpdateTimes>();
         add<SecondaryInsertToUpsert>();
+        add<SecondaryGroupedUpdateAndDeleteTimes>();
         add<SecondaryAtomicApplyOps>();
         add<SecondaryAtomicApplyOpsWCEToNonAtomic>();
         add<SecondaryCreateCollection>();
@@ -49,6 +49,9 @@ struct OpMsg {
     static constexpr uint32_t kChecksumPresent = 1 << 0;
     static constexpr uint32_t kMoreToCome = 1 << 1;
     static constexpr uint32_t kExhaustSupported = 1 << 16;
+    // Set by clients that accept the batches of find and getMore replies as document sequences
+    // named "cursor.firstBatch" and "cursor.nextBatch", rather than as arrays in the body.
+    static constexpr uint32_t kDocumentSequencesSupported = 1 << 17;
 
     /**
      * Returns the unvalidated flags for the given message if it is an OP_MSG message.
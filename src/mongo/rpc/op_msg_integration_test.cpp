@@ -346,6 +346,110 @@ TEST(OpMsg, ServerHandlesExhaustCorrectly) {
     ASSERT_BSONOBJ_EQ(nextBatch[0].embeddedObject(), BSON("_id" << 4));
 }
 
+TEST(OpMsg, FindAndGetMoreReturnBatchesAsDocumentSequencesIfSupported) {
+    std::string errMsg;
+    auto conn = std::unique_ptr<DBClientBase>(
+        unittest::getFixtureConnectionString().connect("integration_test", errMsg));
+    uassert(ErrorCodes::SocketException, errMsg, conn);
+
+    NamespaceString nss("test", "coll");
+    conn->dropCollection(nss.toString());
+    for (int i = 0; i < 5; i++) {
+        conn->insert(nss.toString(), BSON("_id" << i), 0);
+    }
+
+    auto findCmd = BSON("find" << nss.coll() << "batchSize" << 2 << "sort" << BSON("_id" << 1));
+    auto request = OpMsgRequest::fromDBAndBody(nss.db(), findCmd).serialize();
+    OpMsg::setFlag(&request, OpMsg::kDocumentSequencesSupported);
+
+    // The batch is a document sequence, and the cursor object in the body has no batch field.
+    Message reply;
+    ASSERT(conn->call(request, reply));
+    auto opMsgReply = OpMsg::parse(reply);
+    ASSERT_OK(getStatusFromCommandResult(opMsgReply.body));
+    ASSERT_EQ(opMsgReply.sequences.size(), 1U);
+    ASSERT_EQ(opMsgReply.sequences[0].name, "cursor.firstBatch");
+    ASSERT_EQ(opMsgReply.sequences[0].objs.size(), 2U);
+    ASSERT_BSONOBJ_EQ(opMsgReply.sequences[0].objs[0], BSON("_id" << 0));
+    ASSERT_BSONOBJ_EQ(opMsgReply.sequences[0].objs[1], BSON("_id" << 1));
+    auto cursorObj = opMsgReply.body["cursor"].Obj();
+    ASSERT_FALSE(cursorObj.hasField("firstBatch"));
+    ASSERT_EQ(cursorObj["ns"].str(), nss.ns());
+    const long long cursorId = cursorObj["id"].numberLong();
+    ASSERT_NE(cursorId, 0);
+
+    GetMoreRequest gmr(nss, cursorId, 2, boost::none, boost::none, boost::none);
+    request = OpMsgRequest::fromDBAndBody(nss.db(), gmr.toBSON()).serialize();
+    OpMsg::setFlag(&request, OpMsg::kDocumentSequencesSupported);
+
+    ASSERT(conn->call(request, reply));
+    opMsgReply = OpMsg::parse(reply);
+    ASSERT_OK(getStatusFromCommandResult(opMsgReply.body));
+    ASSERT_EQ(opMsgReply.sequences.size(), 1U);
+    ASSERT_EQ(opMsgReply.sequences[0].name, "cursor.nextBatch");
+    ASSERT_EQ(opMsgReply.sequences[0].objs.size(), 2U);
+    ASSERT_BSONOBJ_EQ(opMsgReply.sequences[0].objs[0], BSON("_id" << 2));
+    ASSERT_BSONOBJ_EQ(opMsgReply.sequences[0].objs[1], BSON("_id" << 3));
+    cursorObj = opMsgReply.body["cursor"].Obj();
+    ASSERT_FALSE(cursorObj.hasField("nextBatch"));
+    ASSERT_EQ(cursorObj["id"].numberLong(), cursorId);
+
+    // Without the flag, the batch stays an array in the body.
+    request = OpMsgRequest::fromDBAndBody(nss.db(), gmr.toBSON()).serialize();
+    ASSERT(conn->call(request, reply));
+    opMsgReply = OpMsg::parse(reply);
+    ASSERT_OK(getStatusFromCommandResult(opMsgReply.body));
+    ASSERT(opMsgReply.sequences.empty());
+    cursorObj = opMsgReply.body["cursor"].Obj();
+    std::vector<BSONElement> nextBatch = cursorObj["nextBatch"].Array();
+    ASSERT_EQ(nextBatch.size(), 1U);
+    ASSERT_BSONOBJ_EQ(nextBatch[0].embeddedObject(), BSON("_id" << 4));
+    ASSERT_EQ(cursorObj["id"].numberLong(), 0);
+}
+
+TEST(OpMsg, ExhaustStreamKeepsDocumentSequences) {
+    std::string errMsg;
+    auto conn = std::unique_ptr<DBClientBase>(
+        unittest::getFixtureConnectionString().connect("integration_test", errMsg));
+    uassert(ErrorCodes::SocketException, errMsg, conn);
+
+    // Only test exhaust against a single server.
+    if (conn->isReplicaSetMember() || conn->isMongos()) {
+        return;
+    }
+
+    NamespaceString nss("test", "coll");
+    conn->dropCollection(nss.toString());
+    for (int i = 0; i < 3; i++) {
+        conn->insert(nss.toString(), BSON("_id" << i), 0);
+    }
+
+    auto findCmd = BSON("find" << nss.coll() << "batchSize" << 2 << "sort" << BSON("_id" << 1));
+    auto request = OpMsgRequest::fromDBAndBody(nss.db(), findCmd).serialize();
+    OpMsg::setFlag(&request, OpMsg::kExhaustSupported);
+    OpMsg::setFlag(&request, OpMsg::kDocumentSequencesSupported);
+
+    Message reply;
+    ASSERT(conn->call(request, reply));
+    ASSERT(OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+    auto opMsgReply = OpMsg::parse(reply);
+    ASSERT_OK(getStatusFromCommandResult(opMsgReply.body));
+    ASSERT_EQ(opMsgReply.sequences.size(), 1U);
+    ASSERT_EQ(opMsgReply.sequences[0].name, "cursor.firstBatch");
+    ASSERT_EQ(opMsgReply.sequences[0].objs.size(), 2U);
+
+    // The getMore that the server runs on behalf of the client replies in the same format.
+    ASSERT(conn->recv(reply, reply.header().getId()));
+    ASSERT(!OpMsg::isFlagSet(reply, OpMsg::kMoreToCome));
+    opMsgReply = OpMsg::parse(reply);
+    ASSERT_OK(getStatusFromCommandResult(opMsgReply.body));
+    ASSERT_EQ(opMsgReply.sequences.size(), 1U);
+    ASSERT_EQ(opMsgReply.sequences[0].name, "cursor.nextBatch");
+    ASSERT_EQ(opMsgReply.sequences[0].objs.size(), 1U);
+    ASSERT_BSONOBJ_EQ(opMsgReply.sequences[0].objs[0], BSON("_id" << 2));
+    ASSERT_EQ(opMsgReply.body["cursor"]["id"].numberLong(), 0);
+}
+
 TEST(OpMsg, ExhaustWithDBClientCursorBehavesCorrectly) {
     // This test simply tries to verify that using the exhaust option with DBClientCursor works
     // correctly. The externally visible behavior should technically be the same as a non-exhaust
@@ -137,8 +137,24 @@ public:
      */
     virtual void reserveBytes(const std::size_t bytes) = 0;
 
+    /**
+     * Records whether the client accepts cursor batches as document sequences, which it signals
+     * with the OP_MSG kDocumentSequencesSupported flag. Commands that return cursors check this
+     * before building their batches with getDocSequenceBuilder().
+     */
+    void setDocumentSequencesSupported(bool supported) {
+        _documentSequencesSupported = supported;
+    }
+
+    bool documentSequencesSupported() const {
+        return _documentSequencesSupported;
+    }
+
 protected:
     ReplyBuilderInterface() = default;
+
+private:
+    bool _documentSequencesSupported = false;
 };
 
 }  // namespace rpc
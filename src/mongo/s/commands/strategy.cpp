@@ -55,6 +55,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_time_tracker.h"
 #include "mongo/db/ops/write_ops.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/query_request.h"
@@ -640,7 +641,9 @@ DbResponse Strategy::queryOp(OperationContext* opCtx, const NamespaceString& nss
 
 DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
     auto reply = rpc::makeReplyBuilder(rpc::protocolForMessage(m));
+    reply->setDocumentSequencesSupported(OpMsg::isFlagSet(m, OpMsg::kDocumentSequencesSupported));
     BSONObjBuilder errorBuilder;
+    boost::optional<BSONObj> nextExhaustInvocation;
 
     bool propagateException = false;
 
@@ -665,6 +668,11 @@ DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
             LOG(3) << "Command begin db: " << db << " msg id: " << m.header().getId();
             runCommand(opCtx, request, m.operation(), reply.get(), &errorBuilder);
             LOG(3) << "Command end db: " << db << " msg id: " << m.header().getId();
+
+            if (OpMsg::isFlagSet(m, OpMsg::kExhaustSupported)) {
+                nextExhaustInvocation =
+                    getNextExhaustInvocation(request, reply->getBodyBuilder().asTempObj());
+            }
         } catch (const DBException& ex) {
             LOG(1) << "Exception thrown while processing command on " << db
                    << " msg id: " << m.header().getId() << causedBy(redact(ex));
@@ -678,6 +686,7 @@ DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
             throw;
         }
         reply->reset();
+        nextExhaustInvocation = boost::none;
         auto bob = reply->getBodyBuilder();
         CommandHelpers::appendCommandStatusNoThrow(bob, ex.toStatus());
         appendRequiredFieldsToResponse(opCtx, &bob);
@@ -688,7 +697,9 @@ DbResponse Strategy::clientCommand(OperationContext* opCtx, const Message& m) {
         return {};  // Don't reply.
     }
 
-    return DbResponse{reply->done()};
+    DbResponse dbResponse{reply->done()};
+    dbResponse.nextInvocation = std::move(nextExhaustInvocation);
+    return dbResponse;
 }
 
 void Strategy::commandOp(OperationContext* opCtx,
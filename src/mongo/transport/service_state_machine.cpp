@@ -95,60 +95,39 @@ Message makeLegacyExhaustMessage(Message* m, const DbResponse& dbresponse) {
 }
 
 /**
- * Given a request and its already generated response, checks for exhaust flags. If exhaust is
- * allowed, modifies the given request message to produce the subsequent exhaust message, and
- * modifies the response message to indicate it is part of an exhaust stream. Returns the modified
- * request message for it to be used as the subsequent, 'synthetic' exhaust request. Returns an
- * empty message if exhaust is not allowed.
+ * Given a request and its already generated response, checks whether the response is one batch of
+ * an exhaust stream. If so, modifies the response message to indicate it is part of an exhaust
+ * stream and returns the subsequent, 'synthetic' exhaust request. Returns an empty message if
+ * exhaust is not allowed.
  *
- * Currently only supports exhaust for 'getMore' commands.
+ * For OP_MSG requests, the service entry point decides whether the stream continues and what to run
+ * next (see DbResponse::nextInvocation), so that the reply doesn't have to be parsed again here.
  */
 Message makeExhaustMessage(Message requestMsg, DbResponse* dbresponse) {
     if (requestMsg.operation() == dbQuery) {
         return makeLegacyExhaustMessage(&requestMsg, *dbresponse);
     }
 
-    if (!OpMsgRequest::isFlagSet(requestMsg, OpMsg::kExhaustSupported)) {
-        return Message();
-    }
-
-    // Only support exhaust for 'getMore' commands.
-    auto request = OpMsgRequest::parse(requestMsg);
-    if (request.getCommandName() != "getMore"_sd) {
-        return Message();
-    }
-
-    auto reply = OpMsg::parse(dbresponse->response);
-
-    // Check for a non-OK response.
-    auto resOk = reply.body["ok"].number();
-    if (resOk != 1.0) {
-        return Message();
-    }
-
-    // Check the validity of the 'cursor' object in the response.
-    auto cursorObj = reply.body.getObjectField("cursor");
-    if (cursorObj.isEmpty()) {
-        return Message();
-    }
-
-    // A returned cursor id of '0' indicates that the cursor is exhausted and so the exhaust stream
-    // should be terminated. Also make sure the cursor namespace is valid.
-    auto cursorId = cursorObj.getField("id").numberLong();
-    auto cursorNs = cursorObj.getField("ns").str();
-    if (cursorId == 0 || cursorNs.empty()) {
+    if (!dbresponse->nextInvocation) {
         return Message();
     }
 
     // Indicate that the response is part of an exhaust stream.
     OpMsg::setFlag(&dbresponse->response, OpMsg::kMoreToCome);
 
-    // Return an augmented form of the initial request, which is to be used as the next request to
-    // be processed by the database. The id of the response is used as the request id of this
-    // 'synthetic' request.
-    requestMsg.header().setId(dbresponse->response.header().getId());
-    requestMsg.header().setResponseToMsgId(dbresponse->response.header().getResponseToMsgId());
-    return requestMsg;
+    // Build the next request to be processed by the database, which keeps the exhaust flag so that
+    // the stream continues. The id of the response is used as the request id of this 'synthetic'
+    // request.
+    OpMsgBuilder builder;
+    builder.setBody(*dbresponse->nextInvocation);
+    Message exhaustMsg = builder.finish();
+    OpMsg::setFlag(&exhaustMsg, OpMsg::kExhaustSupported);
+    if (OpMsg::isFlagSet(requestMsg, OpMsg::kDocumentSequencesSupported)) {
+        OpMsg::setFlag(&exhaustMsg, OpMsg::kDocumentSequencesSupported);
+    }
+    exhaustMsg.header().setId(dbresponse->response.header().getId());
+    exhaustMsg.header().setResponseToMsgId(dbresponse->response.header().getResponseToMsgId());
+    return exhaustMsg;
 }
 
 }  // namespace
@@ -425,7 +404,11 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
     auto& compressorMgr = MessageCompressorManager::forSession(_session());
 
-    _compressorId = boost::none;
+    // The synthetic requests of an exhaust stream are never compressed, but their replies are
+    // compressed in the same way as the reply to the request that started the stream.
+    if (!_inExhaust) {
+        _compressorId = boost::none;
+    }
     if (_inMessage.operation() == dbCompressed) {
         MessageCompressorId compressorId;
         auto swm = compressorMgr.decompressMessage(_inMessage, &compressorId);
@@ -456,12 +439,14 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         toSink.header().setId(nextMessageId());
         toSink.header().setResponseToMsgId(_inMessage.header().getId());
 
-        // If the incoming message has the exhaust flag set and is a 'getMore' command, then we
-        // bypass the normal RPC behavior. We will sink the response to the network, but we also
-        // synthesize a new 'getMore' request, as if we sourced a new message from the network. This
-        // new request is sent to the database once again to be processed. This cycle repeats as
-        // long as the associated cursor is not exhausted. Once it is exhausted, we will send a
-        // final response, terminating the exhaust stream.
+        // If the incoming message has the exhaust flag set and is a 'find' or 'getMore' command,
+        // then we bypass the normal RPC behavior. We will sink the response to the network, but we
+        // also synthesize a new 'getMore' request, as if we sourced a new message from the network.
+        // This new request is sent to the database once again to be processed. This cycle repeats
+        // as long as the associated cursor is not exhausted. Once it is exhausted, we will send a
+        // final response, terminating the exhaust stream. The next batch is only produced once the
+        // previous one has been handed to the transport layer, so a slow reader throttles the
+        // stream.
         _inMessage = makeExhaustMessage(_inMessage, &dbresponse);
         _inExhaust = !_inMessage.empty();
 
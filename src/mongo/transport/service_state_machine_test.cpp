@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/service_context.h"
 #include "mongo/rpc/op_msg.h"
 #include "mongo/stdx/memory.h"
@@ -75,6 +76,7 @@ public:
     DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
         log() << "In handleRequest";
         _ranHandler = true;
+        _lastRequest = request;
         ASSERT_TRUE(haveClient());
 
         // Build out a dummy OK response, if no custom response message was set. Otherwise, use the
@@ -89,7 +91,13 @@ public:
         if (_uassertInHandler)
             uassert(40469, "Synthetic uassert failure", false);
 
-        return DbResponse{res};
+        // Continue exhaust streams in the same way as the real service entry points.
+        DbResponse dbResponse{res};
+        if (OpMsg::isFlagSet(request, OpMsg::kExhaustSupported)) {
+            dbResponse.nextInvocation =
+                getNextExhaustInvocation(OpMsgRequest::parse(request), OpMsg::parse(res).body);
+        }
+        return dbResponse;
     }
 
     void endAllSessions(transport::Session::TagMask tags) override {}
@@ -122,10 +130,17 @@ public:
         return ret;
     }
 
+    const Message& lastRequest() const {
+        return _lastRequest;
+    }
+
 private:
     bool _uassertInHandler = false;
     bool _ranHandler = false;
 
+    // The last request passed to 'handleRequest'.
+    Message _lastRequest;
+
     // A custom response message to return from 'handleRequest'.
     Message _responseMessage;
 };
@@ -579,20 +594,81 @@ TEST_F(ServiceStateMachineFixture, TestGetMoreWithExhaustAndNonOKResponse) {
 }
 
 
-TEST_F(ServiceStateMachineFixture, TestExhaustOnlySupportedForGetMoreCommand) {
-    // Construct a 'find' OP_MSG request with the exhaust flag set. We should ignore exhaust flags
-    // for non 'getMore' commands.
+TEST_F(ServiceStateMachineFixture, TestFindWithExhaust) {
+    // Construct a 'find' OP_MSG request with the exhaust flag set.
+    const int32_t initRequestId = 1;
+    const long long cursorId = 42;
     const std::string nss = "test.coll";
-    Message findWithExhaust = buildOpMsg(BSON("find" << nss));
+    Message findWithExhaust = buildOpMsg(BSON("find"
+                                              << "coll"
+                                              << "batchSize"
+                                              << 2
+                                              << "$db"
+                                              << "test"));
+    findWithExhaust.header().setId(initRequestId);
     OpMsg::setFlag(&findWithExhaust, OpMsg::kExhaustSupported);
 
+    // Construct a 'find' response with a non-zero cursor id.
+    BSONObj findResBody =
+        BSON("ok" << 1 << "cursor"
+                  << BSON("id" << cursorId << "ns" << nss << "firstBatch" << BSONArray()));
+    Message findRes = buildOpMsg(findResBody);
+
+    // The first batch is sunk as part of an exhaust stream, and the state machine goes on to
+    // process the next batch rather than waiting for another request from the client.
+    runSourceAndSinkTest(_tl, _sep, findWithExhaust, findRes, State::Process, State::Process);
+
+    auto msg = _tl->getLastSunk();
+    ASSERT(!msg.empty());
+    ASSERT_EQ(initRequestId, msg.header().getResponseToMsgId());
+    ASSERT(OpMsg::isFlagSet(msg, OpMsg::kMoreToCome));
+    ASSERT_BSONOBJ_EQ(findResBody, OpMsg::parse(msg).body);
+    auto firstResponseId = msg.header().getId();
+
+    // Terminate the stream with a final 'getMore' response.
+    BSONObj getMoreTerminalResBody =
+        BSON("ok" << 1 << "cursor" << BSON("id" << 0 << "ns" << nss << "nextBatch" << BSONArray()));
+    _sep->setResponseMessage(buildOpMsg(getMoreTerminalResBody));
+
+    _ssm->runNext();
+    ASSERT_FALSE(haveClient());
+    ASSERT_EQ(_ssm->state(), State::Source);
+
+    // The database was asked to run a 'getMore' on the cursor returned by the 'find'.
+    auto request = _sep->lastRequest();
+    ASSERT(OpMsg::isFlagSet(request, OpMsg::kExhaustSupported));
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(request).body,
+                      BSON("getMore" << cursorId << "collection"
+                                     << "coll"
+                                     << "batchSize"
+                                     << 2LL
+                                     << "$db"
+                                     << "test"));
+
+    msg = _tl->getLastSunk();
+    ASSERT(!msg.empty());
+    ASSERT(!OpMsg::isFlagSet(msg, OpMsg::kMoreToCome));
+    ASSERT_BSONOBJ_EQ(getMoreTerminalResBody, OpMsg::parse(msg).body);
+    ASSERT_EQ(firstResponseId, msg.header().getResponseToMsgId());
+}
+
+TEST_F(ServiceStateMachineFixture, TestExhaustNotSupportedForOtherCommands) {
+    // Construct an 'aggregate' OP_MSG request with the exhaust flag set. We should ignore exhaust
+    // flags for commands other than 'find' and 'getMore'.
+    const std::string nss = "test.coll";
+    Message aggWithExhaust = buildOpMsg(BSON("aggregate"
+                                             << "coll"
+                                             << "$db"
+                                             << "test"));
+    OpMsg::setFlag(&aggWithExhaust, OpMsg::kExhaustSupported);
+
     // Construct an OK response.
-    Message findRes = buildOpMsg(BSON(
+    Message aggRes = buildOpMsg(BSON(
         "ok" << 1 << "cursor" << BSON("id" << 42 << "ns" << nss << "firstBatch" << BSONArray())));
 
-    // Let the 'find' request be sourced from the network, processed in the database, and
+    // Let the 'aggregate' request be sourced from the network, processed in the database, and
     // and the response sunk to the TransportLayer.
-    runSourceAndSinkTest(_tl, _sep, findWithExhaust, findRes, State::Process, State::Source);
+    runSourceAndSinkTest(_tl, _sep, aggWithExhaust, aggRes, State::Process, State::Source);
 
     // Check the last sunk message.
     auto msg = _tl->getLastSunk();
@@ -34,6 +34,7 @@
 
 #include "mongo/base/system_error.h"
 #include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/transport/asio_utils.h"
 #include "mongo/transport/baton.h"
@@ -55,6 +56,18 @@ namespace transport {
 
 MONGO_FAIL_POINT_DEFINE(transportLayerASIOshortOpportunisticReadWrite);
 
+// Size of the per-session buffer that unencrypted sessions read into ahead of the message being
+// sourced, so that a small message costs a single read and pipelined messages are picked up
+// without going back to the socket. A value of 0 reads each message directly from the socket.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(transportLayerASIOReadAheadBytes, int, 4096)
+    ->withValidator([](const int& newVal) {
+        if (newVal < 0 || newVal > 16 * 1024 * 1024) {
+            return Status(ErrorCodes::BadValue,
+                          "transportLayerASIOReadAheadBytes must be between 0 and 16MB");
+        }
+        return Status::OK();
+    });
+
 template <typename SuccessValue>
 auto futurize(const std::error_code& ec, SuccessValue&& successValue) {
     using Result = Future<std::decay_t<SuccessValue>>;
@@ -181,6 +194,10 @@ public:
         if (!getSocket().is_open())
             return false;
 
+        // Data that was already read ahead means the peer was connected when it sent it.
+        if (_readAheadEnd > _readAheadBegin)
+            return true;
+
         auto swPollEvents = pollASIOSocket(getSocket(), POLLIN, Milliseconds{0});
         if (!swPollEvents.isOK()) {
             if (swPollEvents != ErrorCodes::NetworkTimeout) {
@@ -346,6 +363,10 @@ private:
     Future<Message> sourceMessageImpl(const transport::BatonHandle& baton = nullptr) {
         static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
 
+        if (canReadAhead()) {
+            return sourceReadAheadMessage(baton);
+        }
+
         auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
         auto ptr = headerBuffer.get();
         return read(asio::buffer(ptr, kHeaderSize), baton)
@@ -355,14 +376,9 @@ private:
                 }
 
                 const auto msgLen = size_t(MSGHEADER::View(headerBuffer.get()).getMessageLength());
-                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
-                    StringBuilder sb;
-                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
-                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
-                    const auto str = sb.str();
-                    LOG(0) << str;
-
-                    return Future<Message>::makeReady(Status(ErrorCodes::ProtocolError, str));
+                auto status = validateMessageLength(msgLen);
+                if (!status.isOK()) {
+                    return Future<Message>::makeReady(std::move(status));
                 }
 
                 if (msgLen == kHeaderSize) {
@@ -387,6 +403,161 @@ private:
             });
     }
 
+    Status validateMessageLength(size_t msgLen) {
+        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+        if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+            StringBuilder sb;
+            sb << "recv(): message msgLen " << msgLen << " is invalid. "
+               << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+            const auto str = sb.str();
+            LOG(0) << str;
+
+            return Status(ErrorCodes::ProtocolError, str);
+        }
+        return Status::OK();
+    }
+
+    /**
+     * Returns whether messages can be sourced through the read ahead buffer. Nothing may be
+     * consumed from the socket before we know whether the peer is starting an SSL handshake, and
+     * SSL sessions already read through the buffers of the SSL stream.
+     */
+    bool canReadAhead() const {
+        if (_readAheadEnd > _readAheadBegin) {
+            return true;
+        }
+        if (transportLayerASIOReadAheadBytes == 0) {
+            return false;
+        }
+#ifdef MONGO_CONFIG_SSL
+        if (_sslSocket || !_ranHandshake) {
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * Sources a message out of the read ahead buffer, refilling it with whatever the socket has
+     * available when it doesn't yet hold the whole message. Messages larger than the buffer are
+     * read directly into their own allocation once the buffered prefix has been copied over.
+     */
+    Future<Message> sourceReadAheadMessage(const transport::BatonHandle& baton) {
+        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+        if (!_readAhead) {
+            _readAheadSize =
+                std::max(size_t(transportLayerASIOReadAheadBytes), size_t(kHeaderSize));
+            _readAhead = std::make_unique<char[]>(_readAheadSize);
+        }
+
+        const auto buffered = _readAheadEnd - _readAheadBegin;
+        if (buffered < kHeaderSize) {
+            return fillReadAhead(baton).then(
+                [this, baton] { return sourceReadAheadMessage(baton); });
+        }
+
+        const char* begin = _readAhead.get() + _readAheadBegin;
+        if (checkForHTTPRequest(asio::buffer(begin, kHeaderSize))) {
+            return sendHTTPResponse(baton);
+        }
+
+        const auto msgLen = size_t(MSGHEADER::ConstView(begin).getMessageLength());
+        auto status = validateMessageLength(msgLen);
+        if (!status.isOK()) {
+            return Future<Message>::makeReady(std::move(status));
+        }
+
+        if (msgLen <= buffered) {
+            auto buffer = SharedBuffer::allocate(msgLen);
+            memcpy(buffer.get(), begin, msgLen);
+            consumeReadAhead(msgLen);
+            if (_isIngressSession) {
+                networkCounter.hitPhysicalIn(msgLen);
+            }
+            return Future<Message>::makeReady(Message(std::move(buffer)));
+        }
+
+        if (msgLen <= _readAheadSize) {
+            return fillReadAhead(baton).then(
+                [this, baton] { return sourceReadAheadMessage(baton); });
+        }
+
+        auto buffer = SharedBuffer::allocate(msgLen);
+        memcpy(buffer.get(), begin, buffered);
+        consumeReadAhead(buffered);
+
+        auto ptr = buffer.get() + buffered;
+        return read(asio::buffer(ptr, msgLen - buffered), baton)
+            .then([ this, buffer = std::move(buffer), msgLen ]() mutable {
+                if (_isIngressSession) {
+                    networkCounter.hitPhysicalIn(msgLen);
+                }
+                return Message(std::move(buffer));
+            });
+    }
+
+    /**
+     * Reads whatever the socket has available into the free space at the end of the read ahead
+     * buffer, waiting for data to arrive only if none is available yet.
+     *
+     * With the transportLayerASIOshortOpportunisticReadWrite fail point enabled, each fill reads a
+     * single byte and always waits for the socket first, so that messages are reassembled from
+     * many fills and the asynchronous path is exercised. 'waited' is set once the wait is done.
+     */
+    Future<void> fillReadAhead(const transport::BatonHandle& baton, bool waited = false) {
+        if (_readAheadBegin > 0) {
+            memmove(_readAhead.get(),
+                    _readAhead.get() + _readAheadBegin,
+                    _readAheadEnd - _readAheadBegin);
+            _readAheadEnd -= _readAheadBegin;
+            _readAheadBegin = 0;
+        }
+
+        auto buffer =
+            asio::buffer(_readAhead.get() + _readAheadEnd, _readAheadSize - _readAheadEnd);
+
+        std::error_code ec;
+        size_t size = 0;
+        if (MONGO_FAIL_POINT(transportLayerASIOshortOpportunisticReadWrite) &&
+            _blockingMode == Async) {
+            buffer = asio::buffer(buffer, 1);
+            if (waited) {
+                size = _socket.read_some(buffer, ec);
+            } else {
+                ec = asio::error::would_block;
+            }
+        } else {
+            size = _socket.read_some(buffer, ec);
+        }
+
+        if (!ec) {
+            _readAheadEnd += size;
+            return Future<void>::makeReady();
+        }
+
+        if (((ec == asio::error::would_block) || (ec == asio::error::try_again)) &&
+            (_blockingMode == Async)) {
+            if (baton) {
+                return baton->addSession(*this, Baton::Type::In).then([this, baton] {
+                    return fillReadAhead(baton, true);
+                });
+            }
+
+            return _socket.async_read_some(buffer, UseFuture{}).then([this](size_t size) {
+                _readAheadEnd += size;
+            });
+        }
+        return futurize(ec);
+    }
+
+    void consumeReadAhead(size_t size) {
+        _readAheadBegin += size;
+        if (_readAheadBegin == _readAheadEnd) {
+            _readAheadBegin = _readAheadEnd = 0;
+        }
+    }
+
     template <typename MutableBufferSequence>
     Future<void> read(const MutableBufferSequence& buffers,
                       const transport::BatonHandle& baton = nullptr) {
@@ -711,6 +882,13 @@ private:
     bool _ranHandshake = false;
 #endif
 
+    // Bytes in [_readAheadBegin, _readAheadEnd) have been read from the socket but not yet
+    // returned as part of a message. Allocated on first use.
+    std::unique_ptr<char[]> _readAhead;
+    size_t _readAheadSize = 0;
+    size_t _readAheadBegin = 0;
+    size_t _readAheadEnd = 0;
+
     TransportLayerASIO* const _tl;
     bool _isIngressSession;
 };
@@ -0,0 +1,213 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#include <sys/socket.h>
+#endif
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/assert_util.h"
+
+#include "asio.hpp"
+
+#ifdef __linux__
+namespace {
+mongo::AtomicInt64 recvmsgCalls{0};
+}  // namespace
+
+// Counts the reads that asio makes on its sockets, so that the benchmark can report the syscalls
+// per message. Definitions in the executable take precedence over the ones in libc.
+extern "C" ssize_t recvmsg(int fd, struct msghdr* msg, int flags) {
+    using RecvmsgFn = ssize_t (*)(int, struct msghdr*, int);
+    static const auto realRecvmsg = reinterpret_cast<RecvmsgFn>(dlsym(RTLD_NEXT, "recvmsg"));
+    recvmsgCalls.fetchAndAdd(1);
+    return realRecvmsg(fd, msg, flags);
+}
+#endif
+
+namespace mongo {
+namespace {
+
+/**
+ * Keeps the sessions accepted by the transport layer, so that the benchmark can source messages
+ * from them on its own thread.
+ */
+class SessionCollectingSEP : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _sessions.push_back(std::move(session));
+        _cv.notify_one();
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _sessions.clear();
+    }
+
+    Status start() override {
+        return Status::OK();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    void appendStats(BSONObjBuilder*) const override {}
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    transport::SessionHandle waitForSession() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return !_sessions.empty(); });
+        return _sessions.back();
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::vector<transport::SessionHandle> _sessions;
+};
+
+Message makePingMessage(size_t paddingBytes) {
+    OpMsgBuilder builder;
+    builder.setBody(BSON("ping" << 1 << "padding" << std::string(paddingBytes, 'x')));
+    Message msg = builder.finish();
+    msg.header().setResponseToMsgId(0);
+    msg.header().setId(0);
+    return msg;
+}
+
+/**
+ * Sources messages from a synchronous ASIO session. The client writes a batch of messages with a
+ * single write, and the benchmark times sourcing the whole batch on the server side.
+ *
+ * Arguments:
+ *  - transportLayerASIOReadAheadBytes for the session; 0 reads each message directly.
+ *  - Number of messages pipelined in each write.
+ *  - Padding added to each message, to exercise messages larger than the read ahead buffer.
+ *
+ * Reports the 99th percentile time to source a batch and, on Linux, the recvmsg calls made per
+ * message.
+ */
+void BM_SourceMessage(benchmark::State& state) {
+    const auto readAheadBytes = state.range(0);
+    const auto messagesPerWrite = state.range(1);
+    const auto paddingBytes = state.range(2);
+
+    auto readAheadParam =
+        ServerParameterSet::getGlobal()->getMap().find("transportLayerASIOReadAheadBytes");
+    invariant(readAheadParam != ServerParameterSet::getGlobal()->getMap().end());
+    invariant(readAheadParam->second->setFromString(std::to_string(readAheadBytes)));
+
+    SessionCollectingSEP sep;
+    ServerGlobalParams params;
+    params.noUnixSocket = true;
+    transport::TransportLayerASIO::Options opts(&params);
+    opts.port = 0;
+    auto tla = stdx::make_unique<transport::TransportLayerASIO>(opts, &sep);
+    invariant(tla->setup());
+    invariant(tla->start());
+
+    asio::io_context ctx;
+    asio::ip::tcp::socket client(ctx);
+    client.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), tla->listenerPort()));
+    auto session = sep.waitForSession();
+
+    std::string batch;
+    const auto msg = makePingMessage(paddingBytes);
+    for (int i = 0; i < messagesPerWrite; ++i) {
+        batch.append(msg.buf(), msg.size());
+    }
+
+    std::vector<std::chrono::nanoseconds> samples;
+#ifdef __linux__
+    const auto recvmsgCallsBefore = recvmsgCalls.load();
+#endif
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        asio::write(client, asio::buffer(batch));
+        for (int i = 0; i < messagesPerWrite; ++i) {
+            invariant(session->sourceMessage().getStatus());
+        }
+        samples.push_back(std::chrono::steady_clock::now() - start);
+    }
+#ifdef __linux__
+    state.counters["recvmsgPerMessage"] = double(recvmsgCalls.load() - recvmsgCallsBefore) /
+        (state.iterations() * messagesPerWrite);
+#endif
+
+    if (!samples.empty()) {
+        const auto p99 = samples.begin() + (samples.size() - 1) * 99 / 100;
+        std::nth_element(samples.begin(), p99, samples.end());
+        state.counters["p99Micros"] =
+            std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(*p99).count();
+    }
+    state.SetItemsProcessed(state.iterations() * messagesPerWrite);
+
+    session->end();
+    session.reset();
+    tla->shutdown();
+}
+
+BENCHMARK(BM_SourceMessage)
+    ->Args({0, 1, 0})
+    ->Args({4096, 1, 0})
+    ->Args({0, 16, 0})
+    ->Args({4096, 16, 0})
+    ->Args({0, 1, 64 * 1024})
+    ->Args({4096, 1, 64 * 1024});
+
+}  // namespace
+}  // namespace mongo
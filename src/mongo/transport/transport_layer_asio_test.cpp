@@ -255,15 +255,34 @@ public:
     }
 
     void sendMessage() {
+        sendMessages({makePingMessage()});
+    }
+
+    /**
+     * Writes all of the messages with a single write, so that the server sees them pipelined.
+     */
+    void sendMessages(const std::vector<Message>& msgs) {
+        std::string data;
+        for (const auto& msg : msgs) {
+            data.append(msg.buf(), msg.size());
+        }
+
+        std::error_code ec;
+        asio::write(_sock, asio::buffer(data), ec);
+        ASSERT_FALSE(ec);
+    }
+
+    static Message makePingMessage(size_t paddingBytes = 0) {
         OpMsgBuilder builder;
-        builder.setBody(BSON("ping" << 1));
+        if (paddingBytes) {
+            builder.setBody(BSON("ping" << 1 << "padding" << std::string(paddingBytes, 'x')));
+        } else {
+            builder.setBody(BSON("ping" << 1));
+        }
         Message msg = builder.finish();
         msg.header().setResponseToMsgId(0);
         msg.header().setId(0);
-
-        std::error_code ec;
-        asio::write(_sock, asio::buffer(msg.buf(), msg.size()), ec);
-        ASSERT_FALSE(ec);
+        return msg;
     }
 
 private:
@@ -364,5 +383,51 @@ TEST(TransportLayerASIO, SwitchTimeoutModes) {
     tla->shutdown();
 }
 
+/* check that messages pipelined in a single write are all sourced, including ones that don't
+ * fit in the read ahead buffer */
+class PipelinedSEP : public TimeoutSEP {
+public:
+    explicit PipelinedSEP(std::vector<size_t> expectedSizes)
+        : _expectedSizes(std::move(expectedSizes)) {}
+
+    void startSession(transport::SessionHandle session) override {
+        log() << "Accepted connection from " << session->remote();
+        stdx::thread([ this, session = std::move(session) ]() mutable {
+            for (auto expectedSize : _expectedSizes) {
+                auto swMsg = session->sourceMessage();
+                ASSERT_OK(swMsg.getStatus());
+                ASSERT_EQ(size_t(swMsg.getValue().size()), expectedSize);
+            }
+
+            session.reset();
+            notifyComplete();
+        }).detach();
+    }
+
+private:
+    const std::vector<size_t> _expectedSizes;
+};
+
+TEST(TransportLayerASIO, SourcePipelinedMessages) {
+    std::vector<Message> msgs;
+    for (size_t padding : {0, 100, 64 * 1024, 0, 3000, 10}) {
+        msgs.push_back(TimeoutConnector::makePingMessage(padding));
+    }
+
+    std::vector<size_t> sizes;
+    for (const auto& msg : msgs) {
+        sizes.push_back(msg.size());
+    }
+
+    PipelinedSEP sep(sizes);
+    auto tla = makeAndStartTL(&sep);
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    connector.sendMessages(msgs);
+
+    ASSERT_TRUE(sep.waitForTimeout(Milliseconds{30000}));
+    tla->shutdown();
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,59 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * Returns a number identifying the CPU on which the calling thread currently runs. Threads may
+ * migrate between CPUs at any time, so this is only a locality hint, suitable for picking one of
+ * several copies of a contended structure. Where the CPU can not be queried, each thread is given
+ * a fixed number instead.
+ */
+inline unsigned currentCPUHint() {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<unsigned>(cpu);
+    }
+#endif
+    static AtomicUInt32 nextThreadHint;
+    thread_local const unsigned threadHint = nextThreadHint.fetchAndAdd(1);
+    return threadHint;
+}
+
+}  // namespace mongo
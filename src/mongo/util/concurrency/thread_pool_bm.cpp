@@ -0,0 +1,112 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+namespace mongo {
+namespace {
+
+// Matches the default size of the replication writer pool.
+const size_t kNumWorkers = 16;
+
+/**
+ * Stands in for applying a single small oplog entry.
+ */
+void doWork(int64_t iterations) {
+    int64_t sum = 0;
+    for (int64_t i = 0; i < iterations; ++i) {
+        benchmark::DoNotOptimize(sum += i);
+    }
+}
+
+template <typename Pool>
+std::unique_ptr<Pool> makePool() {
+    typename Pool::Options options;
+    options.minThreads = kNumWorkers;
+    options.maxThreads = kNumWorkers;
+    auto pool = std::make_unique<Pool>(options);
+    pool->startup();
+    return pool;
+}
+
+/**
+ * Models oplog application: a batch of state.range(0) tasks is scheduled from outside the pool,
+ * and the batch ends when the pool is idle again.
+ */
+template <typename Pool>
+void BM_ApplyBatch(benchmark::State& state) {
+    auto pool = makePool<Pool>();
+    const auto batchSize = state.range(0);
+    for (auto keepRunning : state) {
+        for (int64_t i = 0; i < batchSize; ++i) {
+            invariant(pool->schedule([] { doWork(100); }));
+        }
+        pool->waitForIdle();
+    }
+    state.SetItemsProcessed(state.iterations() * batchSize);
+    pool->shutdown();
+    pool->join();
+}
+
+/**
+ * One task per worker, each of which fans out to state.range(0) tasks of its own from inside the
+ * pool, as when a task splits up its work.
+ */
+template <typename Pool>
+void BM_FanOut(benchmark::State& state) {
+    auto pool = makePool<Pool>();
+    const auto fanOut = state.range(0);
+    for (auto keepRunning : state) {
+        for (size_t i = 0; i < kNumWorkers; ++i) {
+            invariant(pool->schedule([&pool, fanOut] {
+                for (int64_t j = 0; j < fanOut; ++j) {
+                    invariant(pool->schedule([] { doWork(100); }));
+                }
+            }));
+        }
+        pool->waitForIdle();
+    }
+    state.SetItemsProcessed(state.iterations() * kNumWorkers * fanOut);
+    pool->shutdown();
+    pool->join();
+}
+
+BENCHMARK_TEMPLATE(BM_ApplyBatch, ThreadPool)->Arg(16)->Arg(1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ApplyBatch, WorkStealingThreadPool)->Arg(16)->Arg(1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FanOut, ThreadPool)->Arg(64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FanOut, WorkStealingThreadPool)->Arg(64)->UseRealTime();
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,120 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/ticket_admission_controller.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+constexpr double TicketAdmissionController::kMinElasticity;
+
+TicketAdmissionController::TicketAdmissionController(TicketHolder* holder,
+                                                     int minTickets,
+                                                     int maxTickets)
+    : _holder(holder), _lastStats(holder->getStats()) {
+    setBounds(minTickets, maxTickets);
+}
+
+void TicketAdmissionController::setBounds(int minTickets, int maxTickets) {
+    invariant(minTickets > 0);
+    _minTickets = minTickets;
+    _maxTickets = std::max(minTickets, maxTickets);
+}
+
+int TicketAdmissionController::adjust(Milliseconds elapsed) {
+    const TicketHolder::Stats stats = _holder->getStats();
+    const long long completed = stats.totalReleased - _lastStats.totalReleased;
+    const bool queueing =
+        stats.totalAcquiredAfterQueueing > _lastStats.totalAcquiredAfterQueueing ||
+        _holder->queued() > 0;
+    _lastStats = stats;
+
+    const double seconds = std::max<double>(durationCount<Milliseconds>(elapsed), 1) / 1000;
+    const int current = _holder->outof();
+    const int next = nextTicketCount(current, completed / seconds, queueing);
+    if (next != current) {
+        uassertStatusOK(_holder->resize(next));
+    }
+    return next;
+}
+
+int TicketAdmissionController::nextTicketCount(int currentTickets,
+                                               double throughput,
+                                               bool queueing) {
+    const int clamped = std::min(std::max(currentTickets, _minTickets), _maxTickets);
+    if (clamped != currentTickets) {
+        _lastThroughput = -1;
+        return clamped;
+    }
+
+    if (!queueing) {
+        // Throughput is not limited by the tickets, so it says nothing about the right count.
+        _lastThroughput = -1;
+        return currentTickets;
+    }
+
+    if (_lastThroughput >= 0) {
+        const double improvement =
+            _lastThroughput > 0 ? (throughput - _lastThroughput) / _lastThroughput : 1;
+        const double relativeStep =
+            static_cast<double>(std::abs(currentTickets - _lastTickets)) / _lastTickets;
+        const double threshold = kMinElasticity * relativeStep;
+
+        // Adding tickets has to pay for itself, removing them only has to not hurt too much, so
+        // that the count settles at the low end of a throughput plateau.
+        const bool keepDirection =
+            _direction > 0 ? improvement >= threshold : improvement > -threshold;
+        if (!keepDirection) {
+            _direction = -_direction;
+        }
+    }
+    _lastThroughput = throughput;
+    _lastTickets = currentTickets;
+
+    const int step = (currentTickets + 15) / 16;
+    int next = currentTickets + _direction * step;
+    if (next < _minTickets || next > _maxTickets) {
+        _direction = -_direction;
+        next = std::min(std::max(next, _minTickets), _maxTickets);
+        if (next == currentTickets) {
+            // Sitting at a bound, so there will be no step to judge on the next call.
+            _lastThroughput = -1;
+        }
+    }
+    return next;
+}
+
+}  // namespace mongo
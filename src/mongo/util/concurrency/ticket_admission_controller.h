@@ -0,0 +1,98 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Adjusts the size of a TicketHolder to the concurrency at which the system it protects completes
+ * the most work, by hill climbing on the observed throughput.
+ *
+ * Whenever operations had to queue for a ticket over the last interval, the controller moves the
+ * number of tickets one step of about 6% in its current direction. It keeps adding tickets while
+ * each step raises throughput by at least 'kMinElasticity' times the relative change in tickets,
+ * and keeps removing them while throughput drops by less than that. The count thus settles around
+ * the point where the system saturates; beyond it, extra tickets only add to the latency of every
+ * operation. Without queueing the ticket count is not what limits throughput, and it is left
+ * alone.
+ *
+ * Not thread-safe; meant to be driven by a single background thread.
+ */
+class TicketAdmissionController {
+    MONGO_DISALLOW_COPYING(TicketAdmissionController);
+
+public:
+    // Fraction of the relative change in tickets by which throughput has to follow for a step to
+    // be considered worthwhile.
+    static constexpr double kMinElasticity = 0.5;
+
+    TicketAdmissionController(TicketHolder* holder, int minTickets, int maxTickets);
+
+    /**
+     * Samples the ticket holder over the 'elapsed' interval since the previous call and resizes
+     * it if warranted. Returns the number of tickets in use from now on.
+     */
+    int adjust(Milliseconds elapsed);
+
+    /**
+     * Changes the range within which the ticket count is kept. The current count is clamped to
+     * the new range on the next call to adjust().
+     */
+    void setBounds(int minTickets, int maxTickets);
+
+    /**
+     * The decision step of adjust(), exposed for testing. Returns the ticket count to use given
+     * the current count, the throughput observed with it in operations per second, and whether any
+     * operation had to queue.
+     */
+    int nextTicketCount(int currentTickets, double throughput, bool queueing);
+
+private:
+    TicketHolder* const _holder;
+    int _minTickets;
+    int _maxTickets;
+
+    TicketHolder::Stats _lastStats;
+
+    // Throughput observed with '_lastTickets' tickets before the last step, or a negative value
+    // if there is no step to judge.
+    double _lastThroughput = -1;
+    int _lastTickets = 0;
+
+    // +1 while adding tickets, -1 while removing them.
+    int _direction = -1;
+};
+
+}  // namespace mongo
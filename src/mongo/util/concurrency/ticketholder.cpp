@@ -34,225 +34,169 @@
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
-
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
-
-/**
- * Accepts an errno code, prints its error message, and exits.
- */
-void failWithErrno(int err) {
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-
-/*
- * Checks the return value from a Linux semaphore function call, and fails with the set errno if the
- * call was unsucessful.
- */
-void check(int ret) {
-    if (ret == 0)
-        return;
-    failWithErrno(errno);
-}
-
-/**
- * Takes a Date_t deadline and sets the appropriate values in a timespec structure.
- */
-void tsFromDate(const Date_t& deadline, struct timespec& ts) {
-    ts.tv_sec = deadline.toTimeT();
-    ts.tv_nsec = (deadline.toMillisSinceEpoch() % 1000) * 1'000'000;
-}
-}  // namespace
-
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    check(sem_init(&_sem, 0, num));
-}
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num) {}
 
 TicketHolder::~TicketHolder() {
-    check(sem_destroy(&_sem));
+    invariant(_numQueued.load() == 0);
 }
 
 bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            failWithErrno(errno);
+    // Operations which are already queued go first, regardless of priority.
+    if (_numQueued.load() > 0) {
+        return false;
     }
-    return true;
+    return _tryTakeTicket();
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    waitForTicketUntil(opCtx, Date_t::max());
+void TicketHolder::waitForTicket(OperationContext* opCtx, AdmissionPriority priority) {
+    invariant(waitForTicketUntil(opCtx, Date_t::max(), priority));
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    const Milliseconds intervalMs(500);
-    struct timespec ts;
-
-    // To support interrupting ticket acquisition while still benefiting from semaphores, we do a
-    // timed wait on an interval to periodically check for interrupts.
-    // The wait period interval is the smaller of the default interval and the provided
-    // deadline.
-    Date_t deadline = std::min(until, Date_t::now() + intervalMs);
-    tsFromDate(deadline, ts);
-
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT) {
-            // If we reached the deadline without being interrupted, we have completely timed out.
-            if (deadline == until)
-                return false;
-
-            deadline = std::min(until, Date_t::now() + intervalMs);
-            tsFromDate(deadline, ts);
-        } else if (errno != EINTR) {
-            failWithErrno(errno);
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx,
+                                      Date_t until,
+                                      AdmissionPriority priority) {
+    if (tryAcquire()) {
+        return true;
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    Waiter waiter;
+    WaiterQueue* queue = &_queues[static_cast<int>(priority)];
+    const auto it = queue->insert(queue->end(), &waiter);
+    _numQueued.fetchAndAdd(1);
+
+    // A ticket may have been released between the failed attempt above and the increment of
+    // _numQueued, by a thread which therefore did not look for waiters.
+    _grantWaiters_inlock();
+
+    Timer queueTimer;
+    const auto granted = [&waiter] { return waiter.granted; };
+    try {
+        bool acquired;
+        if (opCtx) {
+            acquired = opCtx->waitForConditionOrInterruptUntil(waiter.cv, lk, until, granted);
+        } else if (until == Date_t::max()) {
+            waiter.cv.wait(lk, granted);
+            acquired = true;
+        } else {
+            acquired = waiter.cv.wait_until(lk, until.toSystemTimePoint(), granted);
         }
 
-        // To correctly handle errors from sem_timedwait, we should check for interrupts last.
-        // It is possible to unset 'errno' after a call to checkForInterrupt().
-        if (opCtx)
-            opCtx->checkForInterrupt();
+        if (!acquired) {
+            _abandonWait_inlock(queue, it, waiter);
+            return false;
+        }
+    } catch (...) {
+        _abandonWait_inlock(queue, it, waiter);
+        throw;
     }
+
+    // The waiter was removed from its queue by the thread which granted the ticket.
+    _totalAcquiredAfterQueueing.fetchAndAdd(1);
+    _totalQueueMicros.fetchAndAdd(queueTimer.micros());
     return true;
 }
 
 void TicketHolder::release() {
-    check(sem_post(&_sem));
+    _totalReleased.fetchAndAdd(1);
+    _available.fetchAndAdd(1);
+    if (_numQueued.load() == 0) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _grantWaiters_inlock();
 }
 
 Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Minimum value for semaphore is 5; given " << newSize);
-
-    if (newSize > SEM_VALUE_MAX)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given "
-                                    << newSize);
-
-    while (_outof.load() < newSize) {
-        release();
-        _outof.fetchAndAdd(1);
-    }
+                      str::stream() << "Minimum value for tickets is 5; given " << newSize);
 
-    while (_outof.load() > newSize) {
-        waitForTicket();
-        _outof.subtractAndFetch(1);
-    }
-
-    invariant(_outof.load() == newSize);
+    _available.fetchAndAdd(newSize - _outof.load());
+    _outof.store(newSize);
+    _grantWaiters_inlock();
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    int val = 0;
-    check(sem_getvalue(&_sem, &val));
-    return val;
+    return std::max(_available.load(), 0);
 }
 
 int TicketHolder::used() const {
-    return outof() - available();
+    return _outof.load() - _available.load();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
-
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
-}
-
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        opCtx->waitForConditionOrInterrupt(_newTicket, lk, [this] { return _tryAcquire(); });
-    } else {
-        _newTicket.wait(lk, [this] { return _tryAcquire(); });
-    }
+int TicketHolder::queued() const {
+    return _numQueued.load();
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    if (opCtx) {
-        return opCtx->waitForConditionOrInterruptUntil(
-            _newTicket, lk, until, [this] { return _tryAcquire(); });
-    } else {
-        return _newTicket.wait_until(
-            lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
-    }
+TicketHolder::Stats TicketHolder::getStats() const {
+    Stats stats;
+    stats.totalAcquired = _totalAcquired.load();
+    stats.totalAcquiredAfterQueueing = _totalAcquiredAfterQueueing.load();
+    stats.totalQueueMicros = _totalQueueMicros.load();
+    stats.totalReleased = _totalReleased.load();
+    return stats;
 }
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
+bool TicketHolder::_tryTakeTicket() {
+    int available = _available.load();
+    while (available > 0) {
+        const int previous = _available.compareAndSwap(available, available - 1);
+        if (previous == available) {
+            _totalAcquired.fetchAndAdd(1);
+            return true;
+        }
+        available = previous;
     }
-    _newTicket.notify_one();
+    return false;
 }
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+void TicketHolder::_grantWaiters_inlock() {
+    for (int priority = kNumPriorities - 1; priority >= 0; priority--) {
+        WaiterQueue& queue = _queues[priority];
+        while (!queue.empty()) {
+            if (!_tryTakeTicket()) {
+                return;
+            }
 
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
+            Waiter* waiter = queue.front();
+            queue.pop_front();
+            _numQueued.fetchAndSubtract(1);
 
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+            waiter->granted = true;
+            waiter->cv.notify_one();
+        }
     }
-
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
 }
 
-int TicketHolder::available() const {
-    return _num;
-}
-
-int TicketHolder::used() const {
-    return outof() - _num;
-}
+void TicketHolder::_abandonWait_inlock(WaiterQueue* queue,
+                                       WaiterQueue::iterator it,
+                                       const Waiter& waiter) {
+    if (!waiter.granted) {
+        queue->erase(it);
+        _numQueued.fetchAndSubtract(1);
+        return;
+    }
 
-int TicketHolder::outof() const {
-    return _outof.load();
+    // The ticket was handed to us after the wait gave up, so pass it on.
+    _totalAcquired.fetchAndSubtract(1);
+    _available.fetchAndAdd(1);
+    _grantWaiters_inlock();
 }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
-    }
-    _num--;
-    return true;
-}
-#endif
-}
+}  // namespace mongo
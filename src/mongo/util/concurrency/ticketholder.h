@@ -29,26 +29,51 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <list>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
-#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/admission_priority.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
 
+/**
+ * Limits the number of operations which concurrently hold a ticket. Operations which find no
+ * ticket available are queued, and tickets are handed out in order of AdmissionPriority and, within
+ * a priority, in the order in which the operations started waiting.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
 public:
+    /**
+     * Cumulative counters describing the use of the tickets, for sampling by admission
+     * controllers and for diagnostics.
+     */
+    struct Stats {
+        // Number of tickets handed out, including those acquired without waiting.
+        long long totalAcquired = 0;
+
+        // Number of tickets handed out to an operation which had to wait in the queue.
+        long long totalAcquiredAfterQueueing = 0;
+
+        // Total time spent in the queue by operations which eventually acquired a ticket.
+        long long totalQueueMicros = 0;
+
+        // Number of tickets returned.
+        long long totalReleased = 0;
+    };
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
+    /**
+     * Acquires a ticket if one is available and no other operation is queued for one.
+     */
     bool tryAcquire();
 
     /**
@@ -56,7 +81,8 @@ public:
      * 'opCtx' is killed, throwing an AssertionException.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    void waitForTicket(OperationContext* opCtx);
+    void waitForTicket(OperationContext* opCtx,
+                       AdmissionPriority priority = AdmissionPriority::kNormal);
     void waitForTicket() {
         waitForTicket(nullptr);
     }
@@ -68,12 +94,18 @@ public:
      * proceed.
      * If 'opCtx' is not provided or equal to nullptr, the wait is not interruptible.
      */
-    bool waitForTicketUntil(OperationContext* opCtx, Date_t until);
+    bool waitForTicketUntil(OperationContext* opCtx,
+                            Date_t until,
+                            AdmissionPriority priority = AdmissionPriority::kNormal);
     bool waitForTicketUntil(Date_t until) {
         return waitForTicketUntil(nullptr, until);
     }
     void release();
 
+    /**
+     * Changes the number of tickets. Shrinking never blocks: if more tickets than 'newSize' are in
+     * use, no new ticket is handed out until enough of them have been released.
+     */
     Status resize(int newSize);
 
     int available() const;
@@ -82,21 +114,63 @@ public:
 
     int outof() const;
 
+    /**
+     * Number of operations currently waiting for a ticket.
+     */
+    int queued() const;
+
+    Stats getStats() const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    // A single queued operation. Lives on the waiting thread's stack.
+    struct Waiter {
+        stdx::condition_variable cv;
+        bool granted = false;
+    };
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
-    AtomicInt32 _outof;
-    stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
+    using WaiterQueue = std::list<Waiter*>;
 
-    AtomicInt32 _outof;
-    int _num;
+    static constexpr int kNumPriorities = static_cast<int>(AdmissionPriority::kHigh) + 1;
+
+    /**
+     * Takes a ticket if one is available, without regard for queued operations. Lock-free.
+     */
+    bool _tryTakeTicket();
+
+    /**
+     * Hands available tickets to the queued operations, highest priority first.
+     */
+    void _grantWaiters_inlock();
+
+    /**
+     * Removes a waiter which timed out or was interrupted from its queue. If it was granted a
+     * ticket in the meantime, the ticket is returned.
+     */
+    void _abandonWait_inlock(WaiterQueue* queue, WaiterQueue::iterator it, const Waiter& waiter);
+
+    // Protects the waiter queues and serializes handing tickets to queued operations. Acquiring
+    // and releasing a ticket while nobody is queued does not take it.
     stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+
+    // Number of tickets which can be handed out. Negative after shrinking while more tickets than
+    // the new size were in use. Decremented only by compare-and-swap from a positive value.
+    AtomicInt32 _available;
+
+    // You can read _outof without a lock, but have to hold _mutex to change.
+    AtomicInt32 _outof;
+
+    WaiterQueue _queues[kNumPriorities];
+
+    // Total size of _queues. Only changed while holding _mutex, but read without it: a releasing
+    // thread which sees no queued operations does not take the mutex. A waiter increments it
+    // before checking _available and a releaser increments _available before checking it, so at
+    // least one of them sees the other and the ticket cannot be lost.
+    AtomicInt32 _numQueued;
+
+    AtomicInt64 _totalAcquired;
+    AtomicInt64 _totalAcquiredAfterQueueing;
+    AtomicInt64 _totalQueueMicros;
+    AtomicInt64 _totalReleased;
 };
 
 class ScopedTicket {
@@ -33,7 +33,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <vector>
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticket_admission_controller.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
 namespace {
@@ -73,4 +78,193 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, QueuedInPriorityAndArrivalOrder) {
+    TicketHolder holder(1);
+    ASSERT(holder.tryAcquire());
+
+    stdx::mutex mutex;
+    std::vector<int> admitted;
+    std::vector<stdx::thread> threads;
+
+    // Queues waiter 'id' and waits for it to show up in the queue, so that the arrival order is
+    // deterministic.
+    auto queueWaiter = [&](int id, AdmissionPriority priority) {
+        const int queuedBefore = holder.queued();
+        threads.emplace_back([&, id, priority] {
+            holder.waitForTicket(nullptr, priority);
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            admitted.push_back(id);
+        });
+        while (holder.queued() == queuedBefore) {
+            sleepmillis(1);
+        }
+    };
+
+    queueWaiter(0, AdmissionPriority::kNormal);
+    queueWaiter(1, AdmissionPriority::kNormal);
+    queueWaiter(2, AdmissionPriority::kHigh);
+    ASSERT_EQ(holder.queued(), 3);
+
+    // While others are queued, new arrivals may not jump the queue.
+    holder.release();
+    ASSERT_FALSE(holder.tryAcquire());
+
+    for (int i = 0; i < 2; i++) {
+        holder.release();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT(admitted == std::vector<int>({2, 0, 1}));
+    ASSERT_EQ(holder.queued(), 0);
+    ASSERT_EQ(holder.used(), 1);
+
+    const TicketHolder::Stats stats = holder.getStats();
+    ASSERT_EQ(stats.totalAcquired, 4);
+    ASSERT_EQ(stats.totalAcquiredAfterQueueing, 3);
+    ASSERT_EQ(stats.totalReleased, 3);
+    holder.release();
+}
+
+TEST(TicketholderTest, TimedOutWaiterLeavesQueue) {
+    TicketHolder holder(1);
+    ASSERT(holder.tryAcquire());
+
+    ASSERT_FALSE(holder.waitForTicketUntil(Date_t::now() + Milliseconds(5)));
+    ASSERT_EQ(holder.queued(), 0);
+
+    holder.release();
+    ASSERT(holder.tryAcquire());
+    holder.release();
+}
+
+TEST(TicketholderTest, ShrinkWithTicketsInUse) {
+    TicketHolder holder(10);
+    for (int i = 0; i < 8; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 8);
+    ASSERT_EQ(holder.available(), 0);
+    ASSERT_FALSE(holder.tryAcquire());
+
+    for (int i = 0; i < 3; i++) {
+        holder.release();
+    }
+    ASSERT_EQ(holder.available(), 0);
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    ASSERT_EQ(holder.available(), 1);
+
+    ASSERT_OK(holder.resize(6));
+    ASSERT_EQ(holder.available(), 2);
+    ASSERT_NOT_OK(holder.resize(4));
+}
+
+TEST(TicketholderTest, ConcurrentAcquireNeverExceedsTickets) {
+    const int kTickets = 4;
+    const int kThreads = 16;
+    const int kIterations = 2000;
+    TicketHolder holder(kTickets);
+
+    AtomicInt32 holding;
+    AtomicInt32 maxHolding;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < kIterations; j++) {
+                // Mix the lock-free path with the queued one.
+                if ((i + j) % 2 == 0 || !holder.tryAcquire()) {
+                    holder.waitForTicket();
+                }
+
+                const int now = holding.addAndFetch(1);
+                int max = maxHolding.load();
+                while (now > max) {
+                    max = maxHolding.compareAndSwap(max, now);
+                }
+                holding.fetchAndSubtract(1);
+                holder.release();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_LTE(maxHolding.load(), kTickets);
+    ASSERT_EQ(holder.queued(), 0);
+    ASSERT_EQ(holder.used(), 0);
+
+    const TicketHolder::Stats stats = holder.getStats();
+    ASSERT_EQ(stats.totalAcquired, kThreads * kIterations);
+    ASSERT_EQ(stats.totalReleased, kThreads * kIterations);
+}
+
+/**
+ * Runs the controller against a system whose throughput for a given number of tickets is given by
+ * 'throughputFn', and returns the ticket counts it went through.
+ */
+template <typename ThroughputFn>
+std::vector<int> runController(int startTickets, ThroughputFn throughputFn) {
+    TicketHolder holder(startTickets);
+    TicketAdmissionController controller(&holder, 5, 128);
+
+    std::vector<int> history;
+    int tickets = startTickets;
+    for (int i = 0; i < 200; i++) {
+        tickets = controller.nextTicketCount(tickets, throughputFn(tickets), true);
+        history.push_back(tickets);
+    }
+    return history;
+}
+
+TEST(TicketAdmissionControllerTest, SettlesAtSaturationPoint) {
+    // Throughput grows linearly up to 40 concurrent operations and is flat afterwards.
+    auto saturating = [](int tickets) { return 1000.0 * std::min(tickets, 40); };
+
+    for (int start : {5, 60, 128}) {
+        const auto history = runController(start, saturating);
+        for (size_t i = history.size() - 20; i < history.size(); i++) {
+            ASSERT_GTE(history[i], 34) << "start: " << start;
+            ASSERT_LTE(history[i], 46) << "start: " << start;
+        }
+    }
+}
+
+TEST(TicketAdmissionControllerTest, GrowsWhileThroughputScales) {
+    auto linear = [](int tickets) { return 1000.0 * tickets; };
+
+    const auto history = runController(5, linear);
+    for (size_t i = history.size() - 20; i < history.size(); i++) {
+        ASSERT_GTE(history[i], 120);
+    }
+}
+
+TEST(TicketAdmissionControllerTest, HoldsWithoutQueueing) {
+    TicketHolder holder(64);
+    TicketAdmissionController controller(&holder, 5, 128);
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(controller.nextTicketCount(64, 1000.0 * i, false), 64);
+    }
+
+    // Out of range counts are brought back within the bounds.
+    controller.setBounds(5, 32);
+    ASSERT_EQ(controller.nextTicketCount(64, 1000, false), 32);
+}
+
+TEST(TicketAdmissionControllerTest, AdjustResizesHolder) {
+    TicketHolder holder(64);
+    TicketAdmissionController controller(&holder, 5, 32);
+
+    ASSERT_EQ(controller.adjust(Milliseconds(100)), 32);
+    ASSERT_EQ(holder.outof(), 32);
+}
+
 }  // namespace
@@ -0,0 +1,374 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+#include "mongo/base/status.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+// Counter used to assign unique names to otherwise-unnamed thread pools.
+AtomicInt32 nextUnnamedWorkStealingThreadPoolId{1};
+
+// The pool and worker index of the current thread, if it is a worker of a WorkStealingThreadPool.
+thread_local const WorkStealingThreadPool* currentPool = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+
+/**
+ * Sets defaults and checks bounds limits on "options", and returns it.
+ *
+ * This method is just a helper for the WorkStealingThreadPool constructor.
+ */
+WorkStealingThreadPool::Options cleanUpOptions(WorkStealingThreadPool::Options&& options) {
+    if (options.poolName.empty()) {
+        options.poolName = str::stream() << "WorkStealingThreadPool"
+                                         << nextUnnamedWorkStealingThreadPoolId.fetchAndAdd(1);
+    }
+    if (options.threadNamePrefix.empty()) {
+        options.threadNamePrefix = str::stream() << options.poolName << '-';
+    }
+    if (options.maxThreads < 1) {
+        severe() << "Tried to create pool " << options.poolName << " with a maximum of "
+                 << options.maxThreads << " but the maximum must be at least 1";
+        fassertFailed(51440);
+    }
+    return {std::move(options)};
+}
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(Options options)
+    : _options(cleanUpOptions(std::move(options))) {
+    _workers.reserve(_options.maxThreads);
+    for (size_t i = 0; i < _options.maxThreads; ++i) {
+        _workers.emplace_back(stdx::make_unique<Worker>());
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _shutdown_inlock();
+    if (shutdownComplete != _state) {
+        _join_inlock(&lk);
+    }
+
+    if (shutdownComplete != _state) {
+        severe() << "Failed to shutdown pool during destruction";
+        fassertFailed(51443);
+    }
+    invariant(_numOutstandingTasks.load() == 0);
+}
+
+void WorkStealingThreadPool::startup() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_state != preStart) {
+        severe() << "Attempting to start pool " << _options.poolName
+                 << ", but it has already started";
+        fassertFailed(51441);
+    }
+    _setState_inlock(running);
+    _numThreads = _workers.size();
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        const std::string threadName = str::stream() << _options.threadNamePrefix << i;
+        _workers[i]->thread =
+            stdx::thread([this, i, threadName] { _workerThreadBody(i, threadName); });
+    }
+}
+
+void WorkStealingThreadPool::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _shutdown_inlock();
+}
+
+void WorkStealingThreadPool::_shutdown_inlock() {
+    switch (_state) {
+        case preStart:
+        case running:
+            _shutdownRequested.store(true);
+            _setState_inlock(joinRequired);
+            _workAvailable.notify_all();
+            return;
+        case joinRequired:
+        case joining:
+        case shutdownComplete:
+            return;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void WorkStealingThreadPool::join() {
+    try {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _join_inlock(&lk);
+    } catch (...) {
+        severe() << "Exception escaped join in thread pool " << _options.poolName << ": "
+                 << exceptionToStatus();
+        std::terminate();
+    }
+}
+
+void WorkStealingThreadPool::_join_inlock(stdx::unique_lock<stdx::mutex>* lk) {
+    _stateChange.wait(*lk, [this] {
+        switch (_state) {
+            case preStart:
+                return false;
+            case running:
+                return false;
+            case joinRequired:
+                return true;
+            case joining:
+            case shutdownComplete:
+                severe() << "Attempted to join pool " << _options.poolName << " more than once";
+                fassertFailed(51442);
+        }
+        MONGO_UNREACHABLE;
+    });
+    _setState_inlock(joining);
+    const bool started = _numThreads > 0;
+    lk->unlock();
+    // The workers drain the remaining tasks before exiting, but a pool that was never started has
+    // no workers.
+    if (!started) {
+        _drainPendingTasks();
+    }
+    for (auto& worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    lk->lock();
+    invariant(_state == joining);
+    invariant(_numOutstandingTasks.load() == 0);
+    _numThreads = 0;
+    _setState_inlock(shutdownComplete);
+}
+
+void WorkStealingThreadPool::_drainPendingTasks() {
+    // Tasks cannot be run inline because they can create OperationContexts and the join() caller
+    // may already have one associated with the thread.
+    stdx::thread cleanThread = stdx::thread([&] {
+        const std::string threadName = str::stream() << _options.threadNamePrefix
+                                                     << _workers.size();
+        setThreadName(threadName);
+        _options.onCreateThread(threadName);
+        _drainTasks(0);
+    });
+    cleanThread.join();
+}
+
+Status WorkStealingThreadPool::schedule(Task task) {
+    // Count the task before checking for shutdown, so that workers draining the pool wait for it to
+    // be queued.
+    _numOutstandingTasks.addAndFetch(1);
+    if (_shutdownRequested.load()) {
+        _taskDone();
+        return Status(ErrorCodes::ShutdownInProgress,
+                      str::stream() << "Shutdown of thread pool " << _options.poolName
+                                    << " in progress");
+    }
+
+    const size_t workerIndex = (currentPool == this)
+        ? currentWorkerIndex
+        : static_cast<size_t>(_nextWorker.fetchAndAdd(1) % _workers.size());
+    {
+        auto& worker = *_workers[workerIndex];
+        stdx::lock_guard<stdx::mutex> lk(worker.mutex);
+        worker.tasks.emplace_back(std::move(task));
+        _numPendingTasks.addAndFetch(1);
+    }
+
+    // Pairs with the increment of _numSleepingWorkers in _waitForWork_inlock(), so that either the
+    // sleeping worker sees this task or this thread sees the sleeping worker.
+    if (_numSleepingWorkers.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _workAvailable.notify_one();
+    }
+    return Status::OK();
+}
+
+void WorkStealingThreadPool::waitForIdle() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    // If there are any pending or running tasks, the pool is not idle.
+    _poolIsIdle.wait(lk, [this] { return _numOutstandingTasks.load() == 0; });
+}
+
+WorkStealingThreadPool::Stats WorkStealingThreadPool::getStats() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Stats result;
+    result.options = _options;
+    result.numThreads = _numThreads;
+    const auto numRunningTasks = static_cast<size_t>(_numRunningTasks.load());
+    result.numIdleThreads = result.numThreads - std::min(result.numThreads, numRunningTasks);
+    result.numPendingTasks = _numPendingTasks.load();
+    return result;
+}
+
+void WorkStealingThreadPool::_workerThreadBody(size_t workerIndex, const std::string& threadName) {
+    setThreadName(threadName);
+    _options.onCreateThread(threadName);
+    currentPool = this;
+    currentWorkerIndex = workerIndex;
+    LOG(1) << "starting thread in pool " << _options.poolName;
+    try {
+        _consumeTasks(workerIndex);
+    } catch (...) {
+        severe() << "Exception reached top of stack in thread pool " << _options.poolName << ": "
+                 << exceptionToStatus();
+        std::terminate();
+    }
+    currentPool = nullptr;
+    LOG(1) << "shutting down thread in pool " << _options.poolName;
+}
+
+void WorkStealingThreadPool::_consumeTasks(size_t workerIndex) {
+    Task task;
+    while (true) {
+        if (_takeTask(workerIndex, &task)) {
+            _runTask(&task);
+            continue;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (_state != running) {
+            break;
+        }
+        MONGO_IDLE_THREAD_BLOCK;
+        _waitForWork_inlock(&lk);
+    }
+
+    // The pool is shutting down, so this thread lends a hand in draining the remaining tasks.
+    _drainTasks(workerIndex);
+}
+
+void WorkStealingThreadPool::_drainTasks(size_t workerIndex) {
+    Task task;
+    while (true) {
+        if (_takeTask(workerIndex, &task)) {
+            _runTask(&task);
+            continue;
+        }
+
+        // A task may still be running, or on its way into a queue from a call to schedule() that
+        // raced with shutdown, so the pool is only drained once nothing is outstanding.
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (_numOutstandingTasks.load() == 0) {
+            return;
+        }
+        _waitForWork_inlock(&lk);
+    }
+}
+
+void WorkStealingThreadPool::_waitForWork_inlock(stdx::unique_lock<stdx::mutex>* lk) {
+    _numSleepingWorkers.addAndFetch(1);
+    if (_numPendingTasks.load() == 0) {
+        _workAvailable.wait(*lk);
+    }
+    _numSleepingWorkers.subtractAndFetch(1);
+}
+
+bool WorkStealingThreadPool::_takeTask(size_t workerIndex, Task* task) {
+    if (_numPendingTasks.load() == 0) {
+        return false;
+    }
+
+    // Run this worker's most recently queued task, which is the most likely to find its data in
+    // cache.
+    {
+        auto& worker = *_workers[workerIndex];
+        stdx::lock_guard<stdx::mutex> lk(worker.mutex);
+        if (!worker.tasks.empty()) {
+            *task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            _numPendingTasks.subtractAndFetch(1);
+            return true;
+        }
+    }
+
+    // Otherwise steal the oldest task of another worker.
+    for (size_t i = 1; i < _workers.size(); ++i) {
+        auto& victim = *_workers[(workerIndex + i) % _workers.size()];
+        stdx::lock_guard<stdx::mutex> lk(victim.mutex);
+        if (!victim.tasks.empty()) {
+            *task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _numPendingTasks.subtractAndFetch(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::_runTask(Task* task) {
+    _numRunningTasks.addAndFetch(1);
+    try {
+        LOG(3) << "Executing a task on behalf of pool " << _options.poolName;
+        (*task)();
+        *task = nullptr;
+    } catch (...) {
+        severe() << "Exception escaped task in thread pool " << _options.poolName << ": "
+                 << exceptionToStatus();
+        std::terminate();
+    }
+    _numRunningTasks.subtractAndFetch(1);
+    _taskDone();
+}
+
+void WorkStealingThreadPool::_taskDone() {
+    if (_numOutstandingTasks.subtractAndFetch(1) == 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _poolIsIdle.notify_all();
+        if (_shutdownRequested.load()) {
+            // Wakes up the workers draining the pool.
+            _workAvailable.notify_all();
+        }
+    }
+}
+
+void WorkStealingThreadPool::_setState_inlock(const LifecycleState newState) {
+    if (newState == _state) {
+        return;
+    }
+    _state = newState;
+    _stateChange.notify_all();
+}
+
+}  // namespace mongo
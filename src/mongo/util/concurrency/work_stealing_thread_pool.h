@@ -0,0 +1,213 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/thread_pool_interface.h"
+
+namespace mongo {
+
+class Status;
+
+/**
+ * A thread pool in which every worker thread has its own queue of tasks, for workloads that
+ * schedule many short tasks and would otherwise have all of the workers serialize on the single
+ * task queue of ThreadPool.
+ *
+ * Tasks scheduled by a task running in the pool are queued on the current worker, which runs the
+ * most recently queued of its tasks first. Tasks scheduled from outside the pool are spread over
+ * the workers in turn. A worker whose queue is empty steals the oldest task from another worker's
+ * queue before going to sleep.
+ *
+ * The pool is configured with ThreadPool::Options and runs exactly 'maxThreads' workers from
+ * startup() until it is joined; 'minThreads' and 'maxIdleThreadAge' are ignored.
+ */
+class WorkStealingThreadPool final : public ThreadPoolInterface {
+    MONGO_DISALLOW_COPYING(WorkStealingThreadPool);
+
+public:
+    using Options = ThreadPool::Options;
+    using Stats = ThreadPool::Stats;
+
+    explicit WorkStealingThreadPool(Options options);
+
+    ~WorkStealingThreadPool() override;
+
+    void startup() override;
+    void shutdown() override;
+    void join() override;
+    Status schedule(Task task) override;
+
+    /**
+     * Blocks the caller until there are no pending or running tasks on this pool.
+     *
+     * Has the same guarantees as ThreadPool::waitForIdle(), and may not be called by a task in the
+     * thread pool either.
+     */
+    void waitForIdle();
+
+    /**
+     * Returns statistics about the thread pool's utilization. 'lastFullUtilizationDate' is not
+     * tracked.
+     */
+    Stats getStats() const;
+
+private:
+    /**
+     * A worker thread and its queue of tasks. The owning thread takes tasks from the back of the
+     * queue, and other workers steal from the front.
+     */
+    struct Worker {
+        stdx::mutex mutex;
+        std::deque<Task> tasks;
+        stdx::thread thread;
+    };
+
+    // Same lifecycle as ThreadPool, see ThreadPool::LifecycleState.
+    enum LifecycleState { preStart, running, joinRequired, joining, shutdownComplete };
+
+    /**
+     * This is the thread body for worker threads.
+     */
+    void _workerThreadBody(size_t workerIndex, const std::string& threadName);
+
+    /**
+     * Runs tasks until the pool is shut down, and then drains the remaining tasks.
+     */
+    void _consumeTasks(size_t workerIndex);
+
+    /**
+     * Runs tasks until there are no pending or running tasks left. Only called once the pool is
+     * shutting down.
+     */
+    void _drainTasks(size_t workerIndex);
+
+    /**
+     * Blocks the calling worker on _workAvailable unless there are pending tasks. Caller must own
+     * _mutex through "lk".
+     */
+    void _waitForWork_inlock(stdx::unique_lock<stdx::mutex>* lk);
+
+    /**
+     * Takes the next task for the worker at 'workerIndex', first from its own queue and otherwise
+     * from the queues of the other workers. Returns false if no task was found.
+     */
+    bool _takeTask(size_t workerIndex, Task* task);
+
+    /**
+     * Runs and destroys '*task', terminating the process if it throws.
+     */
+    void _runTask(Task* task);
+
+    /**
+     * Accounts for a task that ran or was rejected, waking up the waiters for idleness once no
+     * tasks are outstanding.
+     */
+    void _taskDone();
+
+    /**
+     * Runs the remaining tasks on a new thread as part of the join process, blocking until
+     * complete. Caller must not hold the mutex!
+     */
+    void _drainPendingTasks();
+
+    /**
+     * Implementation of shutdown once _mutex is locked.
+     */
+    void _shutdown_inlock();
+
+    /**
+     * Implementation of join once _mutex is owned by "lk".
+     */
+    void _join_inlock(stdx::unique_lock<stdx::mutex>* lk);
+
+    /**
+     * Changes the lifecycle state (_state) of the pool and wakes up any threads waiting for a state
+     * change. Has no effect if _state == newState.
+     */
+    void _setState_inlock(LifecycleState newState);
+
+    // These are the options with which the pool was configured at construction time.
+    const Options _options;
+
+    // One entry per worker thread, fixed at construction.
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // Set along with leaving the running state, and read without the mutex by schedule().
+    AtomicBool _shutdownRequested{false};
+
+    // Number of tasks queued on any of the workers.
+    AtomicWord<long long> _numPendingTasks{0};
+
+    // Number of tasks either queued or running.
+    AtomicWord<long long> _numOutstandingTasks{0};
+
+    // Number of tasks running right now.
+    AtomicWord<long long> _numRunningTasks{0};
+
+    // Number of workers waiting on _workAvailable.
+    AtomicWord<long long> _numSleepingWorkers{0};
+
+    // Round robin counter for tasks scheduled from outside the pool.
+    AtomicWord<unsigned long long> _nextWorker{0};
+
+    // Mutex guarding _state and used to wait on the condition variables below. Workers don't take
+    // it while there is work for them to do.
+    mutable stdx::mutex _mutex;
+
+    // This variable represents the lifecycle state of the pool.
+    LifecycleState _state = preStart;
+
+    // Number of worker threads started and not yet joined.
+    size_t _numThreads = 0;
+
+    // Condition signaled to indicate that a task was queued while workers were asleep, or that the
+    // system is shutting down.
+    stdx::condition_variable _workAvailable;
+
+    // Condition signaled to indicate that there are no pending or running tasks.
+    stdx::condition_variable _poolIsIdle;
+
+    // Condition variable signaled whenever _state changes.
+    stdx::condition_variable _stateChange;
+};
+
+}  // namespace mongo
@@ -0,0 +1,204 @@
+
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/base/init.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/death_test.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/thread_pool_test_common.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+namespace {
+using namespace mongo;
+
+MONGO_INITIALIZER(WorkStealingThreadPoolCommonTests)(InitializerContext*) {
+    addTestsForThreadPool("WorkStealingThreadPoolCommon", []() {
+        return stdx::make_unique<WorkStealingThreadPool>(WorkStealingThreadPool::Options());
+    });
+    return Status::OK();
+}
+
+DEATH_TEST(WorkStealingThreadPoolTest, MaxThreadsTooFewDies, "but the maximum must be at least 1") {
+    WorkStealingThreadPool::Options options;
+    options.maxThreads = 0;
+    WorkStealingThreadPool pool(options);
+}
+
+TEST(WorkStealingThreadPoolTest, IdleWorkerStealsTaskQueuedOnBusyWorker) {
+    WorkStealingThreadPool::Options options;
+    options.maxThreads = 2;
+    WorkStealingThreadPool pool(options);
+    pool.startup();
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    bool childRan = false;
+    std::string parentThreadName;
+    std::string childThreadName;
+
+    // The child task is queued on the worker running the parent, which blocks until the child has
+    // run, so only the other worker can run it.
+    ASSERT_OK(pool.schedule([&] {
+        parentThreadName = getThreadName().toString();
+        ASSERT_OK(pool.schedule([&] {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            childThreadName = getThreadName().toString();
+            childRan = true;
+            cv.notify_all();
+        }));
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return childRan; });
+    }));
+    pool.waitForIdle();
+
+    ASSERT_TRUE(childRan);
+    ASSERT_NOT_EQUALS(parentThreadName, childThreadName);
+}
+
+TEST(WorkStealingThreadPoolTest, WorkerRunsItsMostRecentlyScheduledTaskFirst) {
+    WorkStealingThreadPool::Options options;
+    options.maxThreads = 1;
+    WorkStealingThreadPool pool(options);
+    pool.startup();
+
+    std::vector<int> order;
+    ASSERT_OK(pool.schedule([&] {
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_OK(pool.schedule([&order, i] { order.push_back(i); }));
+        }
+    }));
+    pool.waitForIdle();
+
+    ASSERT(order == std::vector<int>({2, 1, 0}));
+}
+
+TEST(WorkStealingThreadPoolTest, WaitForIdleWaitsForAllTasks) {
+    WorkStealingThreadPool::Options options;
+    options.maxThreads = 4;
+    WorkStealingThreadPool pool(options);
+
+    // Tasks scheduled before startup are run once the workers start.
+    AtomicInt32 count{0};
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(pool.schedule([&] { count.fetchAndAdd(1); }));
+    }
+    ASSERT_EQUALS(100U, pool.getStats().numPendingTasks);
+    pool.startup();
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(pool.schedule([&] {
+            for (int j = 0; j < 10; ++j) {
+                ASSERT_OK(pool.schedule([&] { count.fetchAndAdd(1); }));
+            }
+        }));
+    }
+    pool.waitForIdle();
+
+    ASSERT_EQUALS(1100, count.load());
+    const auto stats = pool.getStats();
+    ASSERT_EQUALS(4U, stats.numThreads);
+    ASSERT_EQUALS(4U, stats.numIdleThreads);
+    ASSERT_EQUALS(0U, stats.numPendingTasks);
+}
+
+TEST(WorkStealingThreadPoolTest, StatsCountBusyWorkersAndPendingTasks) {
+    WorkStealingThreadPool::Options options;
+    options.maxThreads = 2;
+    WorkStealingThreadPool pool(options);
+    ASSERT_EQUALS(0U, pool.getStats().numThreads);
+    pool.startup();
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    size_t numStarted = 0;
+    bool done = false;
+    auto blockingTask = [&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ++numStarted;
+        cv.notify_all();
+        cv.wait(lk, [&] { return done; });
+    };
+
+    ASSERT_OK(pool.schedule(blockingTask));
+    ASSERT_OK(pool.schedule(blockingTask));
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return numStarted == 2U; });
+    }
+    ASSERT_OK(pool.schedule([] {}));
+
+    auto stats = pool.getStats();
+    ASSERT_EQUALS(2U, stats.numThreads);
+    ASSERT_EQUALS(0U, stats.numIdleThreads);
+    ASSERT_EQUALS(1U, stats.numPendingTasks);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        done = true;
+        cv.notify_all();
+    }
+    pool.shutdown();
+    pool.join();
+
+    stats = pool.getStats();
+    ASSERT_EQUALS(0U, stats.numThreads);
+    ASSERT_EQUALS(0U, stats.numPendingTasks);
+}
+
+TEST(WorkStealingThreadPoolTest, WorkerThreadsAreNamedAfterThePool) {
+    std::vector<std::string> threadNames;
+    stdx::mutex mutex;
+    WorkStealingThreadPool::Options options;
+    options.threadNamePrefix = "mythread";
+    options.maxThreads = 2U;
+    options.onCreateThread = [&](const std::string& threadName) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        threadNames.push_back(threadName);
+    };
+
+    WorkStealingThreadPool pool(options);
+    pool.startup();
+    pool.shutdown();
+    pool.join();
+
+    std::sort(threadNames.begin(), threadNames.end());
+    ASSERT(threadNames == std::vector<std::string>({"mythread0", "mythread1"}));
+}
+
+}  // namespace